@@ -0,0 +1,119 @@
+/*?*************************************************************************
+*                           Switch_ChangeVersionLog.cpp
+*                           -----------------------
+*    copyright            : (C) 2014 by Wouter Charle
+*    email                : wouter.charle@gmail.com
+*
+*    DISCLAIMER OF DAMAGES
+*    ---------------------
+*    Wouter Charle has made every effort possible to ensure that the software
+*    is free of any bugs or errors, however in no way is the software to
+*    be considered error or bug free. You assume all responsibility for
+*    any damages or lost data that may result from any errors or bugs in
+*    the software.
+*
+*    IN NO EVENT WILL VISION++ BE LIABLE TO YOU FOR ANY GENERAL, SPECIAL,
+*    INDIRECT, CONSEQUENTIAL, INCIDENTAL OR OTHER DAMAGES ARISING OUT OF
+*    THIS LICENSE.
+*
+*    In no case shall Wouter Charle's liability exceed the purchase price for
+*    the software or services.
+*
+***************************************************************************/
+
+#include "Switch_ChangeVersionLog.h"
+
+// third-party includes
+#include <algorithm>
+
+
+Switch::ChangeVersionLog::DeviceVersions::DeviceVersions ()
+: m_version (0),
+  m_summaryVersion (0),
+  m_valuesVersion (0)
+{
+}
+
+bool Switch::ChangeVersionLog::DeviceVersions::HasSummaryChangedSince (const uint64_t& i_version) const
+{
+  return (i_version < m_summaryVersion);
+}
+
+bool Switch::ChangeVersionLog::DeviceVersions::HaveAllValuesChangedSince (const uint64_t& i_version) const
+{
+  return (i_version < m_valuesVersion);
+}
+
+bool Switch::ChangeVersionLog::DeviceVersions::HasElementChangedSince (const uint32_t& i_elementAddress, const uint64_t& i_version) const
+{
+  std::map <uint32_t, uint64_t>::const_iterator itElementVersion = m_elementVersions.find (i_elementAddress);
+  return (m_elementVersions.end () != itElementVersion) && (i_version < itElementVersion->second);
+}
+
+Switch::ChangeVersionLog::ChangeVersionLog ()
+: m_version (0),
+  m_baseVersion (0)
+{
+}
+
+void Switch::ChangeVersionLog::Reset (const uint64_t& i_startVersion)
+{
+  m_deviceVersions.clear ();
+  m_baseVersion = std::max (i_startVersion, m_version + 1);
+  m_version = m_baseVersion;
+}
+
+/*!
+  \brief Records a change of the type or the connection state of a device.
+
+  \param [in] i_deviceAddress The device address of the node.
+  \param [in] i_allValues     Flags if all desired values changed as well, e.g. when the device was identified.
+ */
+void Switch::ChangeVersionLog::RecordSummaryChange (const switch_device_address_type& i_deviceAddress, const bool& i_allValues)
+{
+  DeviceVersions& versions = m_deviceVersions [i_deviceAddress];
+  versions.m_version        = ++m_version;
+  versions.m_summaryVersion = m_version;
+  if (i_allValues)
+  {
+    versions.m_valuesVersion = m_version;
+    versions.m_elementVersions.clear ();
+  }
+}
+
+/*!
+  \brief Records changes of the desired values of a device.
+
+  \param [in] i_deviceAddress     The device address of the node.
+  \param [in] i_changedElements   The changed elements of the desired state.
+ */
+void Switch::ChangeVersionLog::RecordValueChanges (const switch_device_address_type& i_deviceAddress, const std::list <Switch::DataContainer::Element>& i_changedElements)
+{
+  if (i_changedElements.empty ())
+  {
+    return;
+  }
+
+  DeviceVersions& versions = m_deviceVersions [i_deviceAddress];
+  versions.m_version = ++m_version;
+  std::list <Switch::DataContainer::Element>::const_iterator itElement;
+  for (itElement = i_changedElements.begin (); i_changedElements.end () != itElement; ++itElement)
+  {
+    versions.m_elementVersions [itElement->m_address] = m_version;
+  }
+}
+
+uint64_t Switch::ChangeVersionLog::GetVersion () const
+{
+  return m_version;
+}
+
+bool Switch::ChangeVersionLog::IsKnown (const uint64_t& i_version) const
+{
+  return (m_baseVersion <= i_version) && (m_version >= i_version);
+}
+
+const Switch::ChangeVersionLog::device_versions_type& Switch::ChangeVersionLog::GetDeviceVersions () const
+{
+  return m_deviceVersions;
+}
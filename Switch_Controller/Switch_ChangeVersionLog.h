@@ -0,0 +1,112 @@
+/*?*************************************************************************
+*                           Switch_ChangeVersionLog.h
+*                           -----------------------
+*    copyright            : (C) 2014 by Wouter Charle
+*    email                : wouter.charle@gmail.com
+*
+*    DISCLAIMER OF DAMAGES
+*    ---------------------
+*    Wouter Charle has made every effort possible to ensure that the software
+*    is free of any bugs or errors, however in no way is the software to
+*    be considered error or bug free. You assume all responsibility for
+*    any damages or lost data that may result from any errors or bugs in
+*    the software.
+*
+*    IN NO EVENT WILL VISION++ BE LIABLE TO YOU FOR ANY GENERAL, SPECIAL,
+*    INDIRECT, CONSEQUENTIAL, INCIDENTAL OR OTHER DAMAGES ARISING OUT OF
+*    THIS LICENSE.
+*
+*    In no case shall Wouter Charle's liability exceed the purchase price for
+*    the software or services.
+*
+***************************************************************************/
+
+#ifndef _SWITCH_CHANGEVERSIONLOG
+#define _SWITCH_CHANGEVERSIONLOG
+
+// switch includes
+#include <Switch_Base/Switch_CompilerConfiguration.h>
+#include <Switch_Base/Switch_Types.h>
+#include <Switch_Device/Switch_DataContainer.h>
+
+// third party includes
+#include <map>
+#include <list>
+
+
+namespace Switch
+{
+  /*!
+    \brief Versions of the changes of the devices, telling a client what changed since the version it read last.
+
+    The versions increase within a run of the controller. A run starts above the
+    versions of the previous runs of the process, but the start version is taken
+    from the system clock, which may be set back, e.g. on a device without a real
+    time clock. A version the log did not issue, older than the start or newer than
+    the latest change, therefore gets all devices and values.
+
+    \note The change version log is not thread-safe.
+   */
+  class ChangeVersionLog
+  {
+  public:
+
+    /*!
+      \brief Versions of the latest changes of a device.
+     */
+    class DeviceVersions
+    {
+    public:
+      DeviceVersions ();
+
+      bool HasSummaryChangedSince (const uint64_t& i_version) const;
+      bool HaveAllValuesChangedSince (const uint64_t& i_version) const;
+      bool HasElementChangedSince (const uint32_t& i_elementAddress, const uint64_t& i_version) const;
+
+      uint64_t                      m_version;          ///< Version of the latest change of the device.
+      uint64_t                      m_summaryVersion;   ///< Version of the latest change of the type or the connection state.
+      uint64_t                      m_valuesVersion;    ///< Version of the latest change of all desired values, when the device was identified.
+      std::map <uint32_t, uint64_t> m_elementVersions;  ///< Versions of the latest changes of the desired values, mapped to from the element addresses.
+    };
+
+    typedef std::map <switch_device_address_type, DeviceVersions> device_versions_type;
+
+    /*!
+      \brief Default constructor.
+     */
+    ChangeVersionLog ();
+
+    /*!
+      \brief Forgets all changes and starts a new run.
+
+      \param [in] i_startVersion The version to start at, raised above the versions of the previous runs.
+     */
+    void Reset (const uint64_t& i_startVersion);
+
+    void RecordSummaryChange (const switch_device_address_type& i_deviceAddress, const bool& i_allValues);
+    void RecordValueChanges (const switch_device_address_type& i_deviceAddress, const std::list <Switch::DataContainer::Element>& i_changedElements);
+
+    /*!
+      \brief Gets the version of the latest change of any device, the high-water mark of the clients.
+     */
+    uint64_t GetVersion () const;
+
+    /*!
+      \brief Checks if a version was issued in the current run, such that the changes since can be told.
+     */
+    bool IsKnown (const uint64_t& i_version) const;
+
+    /*!
+      \brief Gets the versions of the devices changed since the start, ordered by device address.
+     */
+    const device_versions_type& GetDeviceVersions () const;
+
+  private:
+
+    device_versions_type  m_deviceVersions; ///< Versions of the changes of the devices changed since the start.
+    uint64_t              m_version;        ///< Version of the latest change of any device.
+    uint64_t              m_baseVersion;    ///< Version at the start of the run.
+  };
+}
+
+#endif // _SWITCH_CHANGEVERSIONLOG
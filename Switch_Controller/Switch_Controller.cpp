@@ -25,13 +25,20 @@
 
 // project includes
 #include "Switch_InterfaceTranslations.h"
+#include "Switch_ControllerWorkerPool.h"
 
 // switch includes
 #include <Switch_Device/Switch_DeviceStore.h>
 #include <Switch_Router/Switch_Router.h>
 #include <Switch_Network/Switch_DataPayload.h>
+#include <Switch_Serialization/Switch_JsonSerializer.h>
 
 // third-party includes
+#include <thread>
+#include <limits>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
 
 // other declarations
 using namespace std::placeholders;
@@ -43,6 +50,13 @@ using namespace std::placeholders;
 Switch::Controller::Parameters::Parameters ()
 {
   m_updateCycleTimeMicros = 500000;
+  m_nrWorkerThreads       = 0;
+  m_setDeviceValuesWindowMicros = 20000;
+  m_rulesFile             = "./resources/rules.srf";
+  m_maxNrRetransmissions  = 5;
+  m_maxNrRetransmissionsPerSecond = 10;
+  m_maxNrQueuedCommands   = 256;
+  m_maxCommandDrainTimeMicros = 2000000;
 }
 
 /*!
@@ -61,6 +75,13 @@ void Switch::Controller::_SetupParameterContainer ()
   // add parameters
   Parameters myParameters;
   _AddParameter (myParameters, myParameters.m_updateCycleTimeMicros,            "Update cycle time (us)", "The time in microseconds between two update cycles.", "General");
+  _AddParameter (myParameters, myParameters.m_nrWorkerThreads,                  "Nr. worker threads", "The number of worker threads handling device data. Zero handles all data on the controller thread.", "General");
+  _AddParameter (myParameters, myParameters.m_setDeviceValuesWindowMicros,      "Set values window (us)", "The time in microseconds during which values set in the same device are merged into one transmission.", "General");
+  _AddParameter (myParameters, myParameters.m_rulesFile,                        "Rules file", "Path to the file with the automation rules. Automation is disabled if the file does not exist.", "Automation");
+  _AddParameter (myParameters, myParameters.m_maxNrRetransmissions,             "Max. nr. retransmissions", "The maximum number of retransmissions of desired values not confirmed by a device.", "Reconciliation");
+  _AddParameter (myParameters, myParameters.m_maxNrRetransmissionsPerSecond,    "Max. retransmissions per second", "The maximum number of retransmissions per second, shared by all devices.", "Reconciliation");
+  _AddParameter (myParameters, myParameters.m_maxNrQueuedCommands,              "Max. nr. queued commands", "The number of queued commands above which new commands are rejected. Zero for no limit.", "Admission");
+  _AddParameter (myParameters, myParameters.m_maxCommandDrainTimeMicros,        "Max. command drain time (us)", "The estimated time in microseconds to drain the queued commands above which new commands are rejected. Zero for no limit.", "Admission");
   // note: add validation criterium to parameter
 
   // add sub-module parameters
@@ -86,9 +107,22 @@ void Switch::Controller::_SetParameters (const Switch::ParameterizedObject::Para
   }
 
   // validate parameters
+  uint32_t setDeviceValuesWindowMicros = pInParameters->m_setDeviceValuesWindowMicros;
+  if (CONTROLLER_MAX_SET_DEVICE_VALUES_WINDOW_MICROS < setDeviceValuesWindowMicros)
+  {
+    SWITCH_DEBUG_MSG_1 ("set values window limited to %uus ... ", CONTROLLER_MAX_SET_DEVICE_VALUES_WINDOW_MICROS);
+    setDeviceValuesWindowMicros = CONTROLLER_MAX_SET_DEVICE_VALUES_WINDOW_MICROS;
+  }
 
   // store parameters
   m_updateCycleTimeMicros = pInParameters->m_updateCycleTimeMicros;
+  m_nrWorkerThreads       = pInParameters->m_nrWorkerThreads;
+  m_setDeviceValuesWindowMicros = setDeviceValuesWindowMicros;
+  m_rulesFile             = pInParameters->m_rulesFile;
+  m_maxNrRetransmissions  = pInParameters->m_maxNrRetransmissions;
+  m_maxNrRetransmissionsPerSecond = pInParameters->m_maxNrRetransmissionsPerSecond;
+  m_maxNrQueuedCommands   = pInParameters->m_maxNrQueuedCommands;
+  m_maxCommandDrainTimeMicros = pInParameters->m_maxCommandDrainTimeMicros;
 
   SWITCH_DEBUG_MSG_0 ("success\n\r");
 }
@@ -107,14 +141,29 @@ void Switch::Controller::_GetParameters (Switch::ParameterizedObject::Parameters
 
   // read parameters
   pOutParameters->m_updateCycleTimeMicros = m_updateCycleTimeMicros;
+  pOutParameters->m_nrWorkerThreads       = m_nrWorkerThreads;
+  pOutParameters->m_setDeviceValuesWindowMicros = m_setDeviceValuesWindowMicros;
+  pOutParameters->m_rulesFile             = m_rulesFile;
+  pOutParameters->m_maxNrRetransmissions  = m_maxNrRetransmissions;
+  pOutParameters->m_maxNrRetransmissionsPerSecond = m_maxNrRetransmissionsPerSecond;
+  pOutParameters->m_maxNrQueuedCommands   = m_maxNrQueuedCommands;
+  pOutParameters->m_maxCommandDrainTimeMicros = m_maxCommandDrainTimeMicros;
 }
 
 /*!
   \brief Default constructor
  */
 Switch::Controller::Controller ()
-: m_pDeviceStore (0x0),
-  m_pRouter (0x0)
+: m_routerEventsPosted (false),
+  m_rxMessagesRetained (false),
+  m_reconcileBudget (0.0),
+  m_nextSceneId (1),
+  m_nrPayloadsInFlight (0),
+  m_transmitMicros (CONTROLLER_INITIAL_TRANSMIT_MICROS),
+  m_deviceConnectionVersion (0),
+  m_pDeviceStore (0x0),
+  m_pRouter (0x0),
+  m_pWorkerPool (0x0)
 {
   _Construct ();
 
@@ -127,8 +176,16 @@ Switch::Controller::Controller ()
   \brief Constructor
  */
 Switch::Controller::Controller (const Switch::Controller::Parameters& i_parameters)
-: m_pDeviceStore (0x0),
-  m_pRouter (0x0)
+: m_routerEventsPosted (false),
+  m_rxMessagesRetained (false),
+  m_reconcileBudget (0.0),
+  m_nextSceneId (1),
+  m_nrPayloadsInFlight (0),
+  m_transmitMicros (CONTROLLER_INITIAL_TRANSMIT_MICROS),
+  m_deviceConnectionVersion (0),
+  m_pDeviceStore (0x0),
+  m_pRouter (0x0),
+  m_pWorkerPool (0x0)
 {
   _Construct ();
 
@@ -150,7 +207,8 @@ void Switch::Controller::_Construct ()
       std::bind (&Switch::Controller::_OnRouterNewNodeDiscovered, this, _1, _2),
       std::bind (&Switch::Controller::_OnRouterNodeConnectionUpdate, this, _1, _2),
       std::bind (&Switch::Controller::_OnRouterNodeDataReceived, this, _1, _2),
-      std::bind (&Switch::Controller::_OnRouterNodeDataTransmitted, this, _1, _2)
+      std::bind (&Switch::Controller::_OnRouterNodeDataTransmitted, this, _1, _2),
+      std::bind (&Switch::Controller::_OnRouterCycleCompleted, this)
     );
     m_pRouter->SetEventHandler (routerEventHandler);
 
@@ -195,6 +253,10 @@ void Switch::Controller::_Prepare ()
     const Switch::DeviceStore::DeviceMap& identifiedDevices = m_pDeviceStore->GetDevices ();
     const Switch::DeviceStore::DeviceMap& unidentifiedDevices = m_pDeviceStore->GetUnidentfiedDevices ();
 
+    // load the automation rules and schedules
+    _LoadRules ();
+    _LoadSchedules ();
+
     // prepare the router
     m_pRouter->Prepare ();
     // enable routing all already known devices
@@ -208,6 +270,30 @@ void Switch::Controller::_Prepare ()
       m_pRouter->EnableNodeRouting (itDevices->first);
     }
 
+    // start without unconfirmed values
+    m_reconcileStates.clear ();
+    {
+      std::unique_lock <std::mutex> scenesLock (m_scenesMutex);
+      m_scenes.clear ();
+    }
+    m_nrPayloadsInFlight = 0;
+    m_reconcileBudget = 0.0;
+    m_reconcileBudgetTime = std::chrono::high_resolution_clock::now ();
+
+    // start the change versions at the time, versions of a previous run are unknown to the log and get all devices
+    {
+      std::unique_lock <std::mutex> changeVersionsLock (m_changeVersionsMutex);
+      uint64_t startVersion = static_cast <uint64_t> (std::chrono::duration_cast <std::chrono::microseconds> (std::chrono::system_clock::now ().time_since_epoch ()).count ());
+      m_changeVersionLog.Reset (startVersion);
+    }
+
+    // start the worker threads
+    SWITCH_ASSERT_THROW (0x0 == m_pWorkerPool, std::runtime_error ("controller worker pool already running"));
+    if (0 < m_nrWorkerThreads)
+    {
+      m_pWorkerPool = new Switch::ControllerWorkerPool (m_nrWorkerThreads, std::bind (&Switch::Controller::_HandleRouterEvent, this, _1));
+    }
+
     // start the thread
     SWITCH_ASSERT_THROW (!m_controllerThread.joinable (), std::runtime_error ("controller thread already running"));
     m_controllerThread = std::thread (std::bind (&Switch::Controller::_Run, this));
@@ -220,6 +306,8 @@ void Switch::Controller::_Prepare ()
     SWITCH_DEBUG_MSG_0 ("exception thrown\n\r");
 
     // cleanup
+    delete m_pWorkerPool;
+    m_pWorkerPool = 0x0;
 
     // forward
     throw;
@@ -265,6 +353,9 @@ void Switch::Controller::_Pause ()
 
   SWITCH_ASSERT (m_controllerThread.joinable ());
 
+  // pause the router first, the controller thread drains its events until it is paused
+  m_pRouter->Pause ();
+
   // switch the router's state to ready
   m_controllerState.store (OS_READY);
 
@@ -272,7 +363,6 @@ void Switch::Controller::_Pause ()
   std::unique_lock <std::mutex> controllLock (m_controllerMutex);
 
   // pause the modules
-  m_pRouter->Pause ();
   m_pDeviceStore->Pause ();
 
   SWITCH_DEBUG_MSG_0 ("success!\n\r");
@@ -297,6 +387,10 @@ void Switch::Controller::_Stop ()
   m_controllerThread.join ();
   controllLock.lock ();
 
+  // finish the pending device tasks and stop the worker threads
+  delete m_pWorkerPool;
+  m_pWorkerPool = 0x0;
+
   // stop the submodules
   m_pRouter->Stop ();
   m_pDeviceStore->Stop ();
@@ -325,22 +419,27 @@ void Switch::Controller::_Run ()
       sleepAllowed = true;
 
       // do controller tasks
-      sleepAllowed &= _HandleDataNodeConnectionUpdate ();
-      sleepAllowed &= _HandleDataNodeDataTransmitted ();
-      sleepAllowed &= _HandleDataNodeDataReceived ();
+      sleepAllowed &= _HandleRouterEvents ();
+      sleepAllowed &= _HandleSchedules ();
       sleepAllowed &= _HandleDataSetDeviceValues ();
-      sleepAllowed &= _HandleDataNewNodeDiscovered ();
       sleepAllowed &= _HandleDataAddDevice ();
+      sleepAllowed &= _ReconcileDevices ();
+      _TransmitPendingData ();
 
       // compute the time spent
       endTime = std::chrono::high_resolution_clock::now ();
       microsecondsElapsed = std::chrono::duration_cast <std::chrono::microseconds> (endTime - beginTime).count ();
       sleepAllowed &= (microsecondsElapsed < m_updateCycleTimeMicros);
-      // sleep if no more tasks need to be done
+
+      // sleep if no more tasks need to be done
       if (sleepAllowed)
       {
         // wait until notification or time elapsed
-        m_updateCondition.wait_for (controllLock, std::chrono::microseconds (m_updateCycleTimeMicros - microsecondsElapsed));
+        // note: wake up in time to transmit the pending device values, to fire the schedules and to retransmit unconfirmed values
+        uint32_t microsecondsToSleep = std::min (m_updateCycleTimeMicros - microsecondsElapsed, _GetSetDeviceValuesDelayMicros ());
+        microsecondsToSleep = std::min (microsecondsToSleep, m_scheduler.GetDelayMicros ());
+        microsecondsToSleep = std::min (microsecondsToSleep, _GetReconcileDelayMicros ());
+        m_updateCondition.wait_for (controllLock, std::chrono::microseconds (microsecondsToSleep));
       }
       else
       {
@@ -358,338 +457,1517 @@ void Switch::Controller::_Run ()
 }
 
 /*!
-  \brief Handles the data from the router's NewNodeDiscovered callback.
+  \brief Handles a batch of the events posted by the router.
+
+  The events are handled in the order they were posted. At most
+  CONTROLLER_MAX_NR_ROUTER_EVENTS_HANDLED_IN_ONE_BATCH events are handled
+  per call, such that the interface input is not starved.
 
-  \return True if all data has been handled, false otherwise.
+  \return True if all events have been handled, false otherwise.
  */
-bool Switch::Controller::_HandleDataNewNodeDiscovered ()
+bool Switch::Controller::_HandleRouterEvents ()
 {
-  std::pair <switch_device_address_type, Switch::DeviceInfo> data;
+  Switch::RouterEvent event;
 
+  for (uint32_t i=0; i<CONTROLLER_MAX_NR_ROUTER_EVENTS_HANDLED_IN_ONE_BATCH; ++i)
   {
-    std::unique_lock <std::mutex> dataLock (m_routerDataMutex);
-
-    // check if new nodes were discovered
-    if (m_dataNewNodeDiscovered.empty ())
+    if (!m_routerEventQueue.Pop (event))
     {
       return true;
     }
 
-    // get the address of the first discovered node
-    data = m_dataNewNodeDiscovered.front ();
-    m_dataNewNodeDiscovered.pop_front ();
+    if (0x0 != m_pWorkerPool)
+    {
+      // hand off to the worker owning the device
+      m_pWorkerPool->Post (event);
+    }
+    else
+    {
+      _HandleRouterEvent (event);
+    }
+  }
+
+  return m_routerEventQueue.IsEmpty ();
+}
+
+/*!
+  \brief Handles a single event posted by the router, or by the controller thread to a worker.
+
+  Runs on the controller thread, or on the worker owning the device if worker threads are enabled.
+
+  \param [in] i_event The event to handle.
+ */
+void Switch::Controller::_HandleRouterEvent (const Switch::RouterEvent& i_event)
+{
+  switch (i_event.m_type)
+  {
+    case Switch::RouterEvent::RE_NEW_NODE_DISCOVERED:
+      _HandleNewNodeDiscovered (i_event.m_deviceAddress, i_event.m_deviceInfo);
+      break;
+    case Switch::RouterEvent::RE_NODE_CONNECTION_UPDATE:
+      _HandleNodeConnectionUpdate (i_event.m_deviceAddress, i_event.m_flag);
+      break;
+    case Switch::RouterEvent::RE_NODE_DATA_RECEIVED:
+      _HandleNodeDataReceived (i_event.m_deviceAddress, i_event.m_dataPayload);
+      break;
+    case Switch::RouterEvent::RE_NODE_DATA_TRANSMITTED:
+      _HandleNodeDataTransmitted (i_event.m_deviceAddress, i_event.m_flag);
+      break;
+    case Switch::RouterEvent::RE_SET_DEVICE_VALUES:
+      _HandleSetDeviceValues (i_event.m_deviceAddress, i_event.m_elements, i_event.m_sceneIds);
+      break;
+    case Switch::RouterEvent::RE_RECONCILE_DEVICE:
+      _ReconcileDevice (i_event.m_deviceAddress);
+      break;
+    default:
+      SWITCH_ASSERT (false);
+      break;
   }
+}
+
+/*!
+  \brief Handles a node discovered by the router.
 
-  // handle the discovered node
+  \param [in] i_deviceAddress The device address of the new node.
+  \param [in] i_deviceInfo    Information about the device. E.g., brand, product and version.
+ */
+void Switch::Controller::_HandleNewNodeDiscovered (const switch_device_address_type& i_deviceAddress, const Switch::DeviceInfo& i_deviceInfo)
+{
   SWITCH_ASSERT_THROW (nullptr != m_pDeviceStore, std::runtime_error ("device store not allocated"));
+  std::unique_lock <std::mutex> deviceStoreLock (m_deviceStoreMutex);
   Switch::DeviceStore::DeviceMap& deviceMap = m_pDeviceStore->GetDevices ();
 
-  Switch::DeviceStore::DeviceMap::iterator itDevice = deviceMap.find (data.first);
+  Switch::DeviceStore::DeviceMap::iterator itDevice = deviceMap.find (i_deviceAddress);
   if (itDevice == deviceMap.end ())
   {
     // node is unidentified
     // note: this check is needed because the first time the node is discovered it will be treated as a new node by the router
-    m_pDeviceStore->SetDeviceType (data.first, data.second.brandId, data.second.productId, data.second.productVersion);
+    m_pDeviceStore->SetDeviceType (i_deviceAddress, i_deviceInfo.brandId, i_deviceInfo.productId, i_deviceInfo.productVersion);
+    _RecordSummaryChange (i_deviceAddress, true);
   }
-
-  return false;
 }
 
 /*!
-  \brief Handles the data from the router's NodeConnectionUpdate callback.
+  \brief Handles a connection update of a node.
 
-  \return True if all data has been handled, false otherwise.
+  \param [in] i_deviceAddress The device address of the node.
+  \param [in] i_connected     The new connection status. True if connected, false otherwise.
  */
-bool Switch::Controller::_HandleDataNodeConnectionUpdate ()
+void Switch::Controller::_HandleNodeConnectionUpdate (const switch_device_address_type& i_deviceAddress, const bool& i_connected)
 {
-  std::pair <switch_device_address_type, bool> data;
-
+  // . get the device
+  SWITCH_ASSERT_THROW (nullptr != m_pDeviceStore, std::runtime_error ("device store not allocated"));
+  Switch::DeviceStore::DeviceMap::iterator itDevice;
   {
-    std::unique_lock <std::mutex> dataLock (m_routerDataMutex);
+    // note: the lock only guards the lookup, the data of the device is written by the thread owning the device under m_deviceDataMutex
+    std::unique_lock <std::mutex> deviceStoreLock (m_deviceStoreMutex);
+    Switch::DeviceStore::DeviceMap& deviceMap = m_pDeviceStore->GetDevices ();
+    itDevice = deviceMap.find (i_deviceAddress);
+    SWITCH_ASSERT_THROW (itDevice != deviceMap.end (), std::runtime_error ("connection update received for unknown device"));
+  }
 
-    // check if new nodes were discovered
-    if (m_dataNodeConnectionUpdate.empty ())
+  // . set the data in the device
+  // note: the owning thread reads the connection state without the lock, it is the only writer
+  if (itDevice->second.GetConnectionState () != i_connected)
+  {
+    // note: the connection state is part of the device catalog
     {
-      return true;
+      std::unique_lock <std::mutex> deviceDataLock (m_deviceDataMutex);
+      itDevice->second.SetConnectionState (i_connected);
     }
-
-    // get the address of the first discovered node
-    data = m_dataNodeConnectionUpdate.front ();
-    m_dataNodeConnectionUpdate.pop_front ();
+    ++m_deviceConnectionVersion;
+    _RecordSummaryChange (i_deviceAddress, false);
   }
 
-  // handle the connection update
-
-  // . get the device
-  SWITCH_ASSERT_THROW (nullptr != m_pDeviceStore, std::runtime_error ("device store not allocated"));
-  Switch::DeviceStore::DeviceMap& deviceMap = m_pDeviceStore->GetDevices ();
-  Switch::DeviceStore::DeviceMap::iterator itDevice = deviceMap.find (data.first);
-  SWITCH_ASSERT_THROW (itDevice != deviceMap.end (), std::runtime_error ("connection update received for unknown device"));
-
-  // . set the data in the device
-  itDevice->second.SetConnectionState (data.second);
+  // . retransmit unconfirmed values as soon as the device is back
+  if (i_connected)
+  {
+    std::unique_lock <std::mutex> reconcileLock (m_reconcileMutex);
+    std::map <switch_device_address_type, ReconcileState>::iterator itState = m_reconcileStates.find (i_deviceAddress);
+    if ((m_reconcileStates.end () != itState) && itState->second.m_pending)
+    {
+      itState->second.m_nextAttempt = std::chrono::high_resolution_clock::now ();
+    }
+  }
 
   // . translate and forward the signal
-  if (0 != m_deviceConnectionUpdateSignal.num_slots ())
+  if (!m_deviceConnectionUpdateSignal.IsEmpty ())
   {
     Switch::Interface::Device::Connection connection;
-    connection.m_online = data.second;
+    connection.m_online = i_connected;
 
     // forward the signal
-    m_deviceConnectionUpdateSignal (static_cast <uint32_t> (data.first), connection);
+    m_deviceConnectionUpdateSignal.Emit (static_cast <uint32_t> (i_deviceAddress), connection);
   }
-
-  return false;
 }
 
 /*!
-  \brief Handles the data from the router's NodeDataReceived callback.
+  \brief Handles data received from a node.
 
-  \return True if all data has been handled, false otherwise.
+  \param [in] i_deviceAddress The device address of the node.
+  \param [in] i_dataPayload   The received data payload.
  */
-bool Switch::Controller::_HandleDataNodeDataReceived ()
+void Switch::Controller::_HandleNodeDataReceived (const switch_device_address_type& i_deviceAddress, const Switch::DataPayload& i_dataPayload)
 {
-  std::pair <switch_device_address_type, Switch::DataPayload> data;
-
+  // . get the device
+  SWITCH_ASSERT_THROW (nullptr != m_pDeviceStore, std::runtime_error ("device store not allocated"));
+  Switch::DeviceStore::DeviceMap::iterator itDevice;
   {
-    std::unique_lock <std::mutex> dataLock (m_routerDataMutex);
-
-    // check if new nodes were discovered
-    if (m_dataNodeDataReceived.empty ())
-    {
-      return true;
-    }
-
-    // get the address of the first discovered node
-    data = m_dataNodeDataReceived.front ();
-    m_dataNodeDataReceived.pop_front ();
+    // note: the lock only guards the lookup, the data of the device is written by the thread owning the device under m_deviceDataMutex
+    std::unique_lock <std::mutex> deviceStoreLock (m_deviceStoreMutex);
+    Switch::DeviceStore::DeviceMap& deviceMap = m_pDeviceStore->GetDevices ();
+    itDevice = deviceMap.find (i_deviceAddress);
+    SWITCH_ASSERT_THROW (itDevice != deviceMap.end (), std::runtime_error ("data received from unknown device"));
   }
 
-  // handle the received data
+  // . set the data in the reported state of the device
+  Switch::Device& device = itDevice->second;
+  // note: the writes are made under m_deviceDataMutex, such that readers of several devices get a consistent view
+  std::list <Switch::DataContainer::Element> changedElements;
+  bool dataChanged;
+  {
+    std::unique_lock <std::mutex> deviceDataLock (m_deviceDataMutex);
+    dataChanged = device.GetReportedDataContainer ().SetContent (changedElements, i_dataPayload.data);
+  }
 
-  // . get the device
-  SWITCH_ASSERT_THROW (nullptr != m_pDeviceStore, std::runtime_error ("device store not allocated"));
-  Switch::DeviceStore::DeviceMap& deviceMap = m_pDeviceStore->GetDevices ();
-  Switch::DeviceStore::DeviceMap::iterator itDevice = deviceMap.find (data.first);
-  SWITCH_ASSERT_THROW (itDevice != deviceMap.end (), std::runtime_error ("data received from unknown device"));
+  // . let the desired state follow the device, unless values set in the device are not yet confirmed
+  bool reconciling;
+  {
+    std::unique_lock <std::mutex> reconcileLock (m_reconcileMutex);
+    reconciling = (m_reconcileStates.end () != m_reconcileStates.find (i_deviceAddress));
+  }
+  if (reconciling)
+  {
+    _UpdateReconcileState (i_deviceAddress, device);
+  }
+  else if (dataChanged)
+  {
+    std::list <Switch::DataContainer::Element> changedDesiredElements;
+    std::unique_lock <std::mutex> deviceDataLock (m_deviceDataMutex);
+    device.GetDataContainer ().SetContent (changedDesiredElements, i_dataPayload.data);
+    _RecordValueChanges (i_deviceAddress, changedDesiredElements);
+  }
 
-  // . set the data in the device
-  Switch::DataContainer& deviceData = itDevice->second.GetDataContainer ();
-  std::list <Switch::DataContainer::Element> changedElements;
-  bool dataChanged = deviceData.SetContent (changedElements, data.second.data);
+  // re-arm the schedules watching the changed elements
+  if (dataChanged)
+  {
+    m_scheduler.HandleChangedElements (i_deviceAddress, changedElements);
+  }
+
+  // evaluate the automation rules on the changed elements
+  if (dataChanged && !m_ruleEngine.IsEmpty ())
+  {
+    std::list <Switch::Rule::Action> actions;
+    m_ruleEngine.Evaluate (actions, i_deviceAddress, changedElements);
+    _ExecuteRuleActions (actions);
+  }
 
   // handle dataChanged
-  if (dataChanged && (0 != m_deviceDataUpdateSignal.num_slots ()))
+  if (dataChanged)
   {
-    // translate the changed data elements
-    std::list <Switch::Interface::Device::Value> changedValues;
-    std::list <Switch::DataContainer::Element>::iterator itElement;
-    for (itElement=changedElements.begin (); changedElements.end ()!=itElement; ++itElement)
+    _EmitDeviceDataUpdate (i_deviceAddress, changedElements);
+  }
+}
+
+/*!
+  \brief Executes the actions of the automation rules that fired.
+
+  The values are set directly in the target devices, bypassing the merge window
+  of the interface input. With worker threads, the values are due immediately
+  and the controller thread hands them to the workers owning the target devices.
+
+  \param [in] i_actions The actions to execute.
+ */
+void Switch::Controller::_ExecuteRuleActions (const std::list <Switch::Rule::Action>& i_actions)
+{
+  if (0x0 != m_pWorkerPool)
+  {
+    // note: workers never post to each other, the controller thread is the only one waiting for room in their queues
+    std::chrono::high_resolution_clock::time_point now = std::chrono::high_resolution_clock::now ();
     {
-      Switch::Interface::Device::Value changedValue;
-      Switch::Interface::Translate (changedValue, *itElement);
-      changedValues.push_back (changedValue);
+      std::unique_lock <std::mutex> interfaceDataLock (m_interfaceDataMutex);
+
+      std::list <Switch::Rule::Action>::const_iterator itAction;
+      for (itAction = i_actions.begin (); i_actions.end () != itAction; ++itAction)
+      {
+        _QueueDeviceElements (itAction->m_deviceAddress, itAction->m_elements, now);
+      }
     }
+    m_updateCondition.notify_all ();
+    return;
+  }
 
-    // forward the signal
-    m_deviceDataUpdateSignal (static_cast <uint32_t> (data.first), changedValues);
-  }
+  std::list <Switch::Rule::Action>::const_iterator itAction;
+  for (itAction = i_actions.begin (); i_actions.end () != itAction; ++itAction)
+  {
+    _HandleSetDeviceValues (itAction->m_deviceAddress, itAction->m_elements, std::list <uint32_t> ());
+  }
+}
 
-  return false;
-}
-
 /*!
-  \brief Handles the data from the router's NodeDataTransmitted callback.
+  \brief Loads the automation rules from the rules file.
 
-  \return True if all data has been handled, false otherwise.
- */
-bool Switch::Controller::_HandleDataNodeDataTransmitted ()
-{
-  std::pair <switch_device_address_type, bool> data;
+  A rules file that can not be parsed is ignored, the controller then runs without rules.
+ */
+void Switch::Controller::_LoadRules ()
+{
+  Switch::RuleSet ruleSet;
 
+  std::ifstream rulesStream (m_rulesFile);
+  if (rulesStream.good ())
   {
-    std::unique_lock <std::mutex> dataLock (m_routerDataMutex);
-
-    // check if new nodes were discovered
-    if (m_dataNodeDataTransmitted.empty ())
+    try
     {
-      return true;
+      Switch::JsonSerializer::Deserialize (ruleSet, rulesStream);
+    }
+    catch (const std::exception& i_exception)
+    {
+      // run without rules rather than with a part of them
+      SWITCH_DEBUG_MSG_2 ("rules file %s ignored: %s ... ", m_rulesFile.c_str (), i_exception.what ());
+      ruleSet.m_rules.clear ();
     }
-
-    // get the address of the first discovered node
-    data = m_dataNodeDataTransmitted.front ();
-    m_dataNodeDataTransmitted.pop_front ();
   }
 
-  // handle the transmission result
-  // TODO: schedule to re-transmit?
-
-  return false;
+  m_ruleEngine.SetRules (ruleSet);
 }
 
-bool Switch::Controller::_HandleDataAddDevice ()
+/*!
+  \brief Loads the schedules from the device store and arms them.
+ */
+void Switch::Controller::_LoadSchedules ()
 {
-  std::list <switch_device_address_type> data;
+  Switch::Scheduler::ScheduleMap schedules;
 
+  const Switch::DeviceStore::ScheduleMap& definitions = m_pDeviceStore->GetSchedules ();
+  Switch::DeviceStore::ScheduleMap::const_iterator itDefinition;
+  for (itDefinition = definitions.begin (); definitions.end () != itDefinition; ++itDefinition)
   {
-    std::unique_lock <std::mutex> dataLock (m_interfaceDataMutex);
-
-    // check if new nodes were discovered
-    if (m_dataAddDevice.empty ())
+    try
     {
-      return true;
+      std::stringstream definitionStream (itDefinition->second);
+      Switch::JsonSerializer::Deserialize (schedules [itDefinition->first], definitionStream);
     }
+    catch (const std::exception& i_exception)
+    {
+      SWITCH_DEBUG_MSG_2 ("schedule %u ignored: %s ... ", itDefinition->first, i_exception.what ());
+      schedules.erase (itDefinition->first);
+    }
+  }
 
-    // get the address of the nodes to add
-    data.splice (data.begin (), m_dataAddDevice);
+  m_scheduler.SetSchedules (schedules);
+}
+
+/*!
+  \brief Advances the schedules and queues the values of the schedules that fired.
+
+  The values are due immediately, such that they are transmitted in the same
+  controller cycle, merged with the values set through the interface.
+
+  \return True if no schedules fired, false otherwise.
+ */
+bool Switch::Controller::_HandleSchedules ()
+{
+  std::list <Switch::Rule::Action> actions;
+  std::list <uint32_t> finishedScheduleIds;
+  m_scheduler.Advance (actions, finishedScheduleIds);
+
+  if (actions.empty ())
+  {
+    return true;
   }
 
-  std::list <switch_device_address_type>::iterator itData;
-  for (itData = data.begin (); data.end () != itData; ++itData)
+  // forget the one-shot schedules that fired
+  if (!finishedScheduleIds.empty ())
   {
-    switch_device_address_type& deviceAddress = *itData;
-    m_pDeviceStore->AddDevice (deviceAddress);
-    m_pRouter->EnableNodeRouting (deviceAddress);
+    std::unique_lock <std::mutex> deviceStoreLock (m_deviceStoreMutex);
+
+    std::list <uint32_t>::const_iterator itScheduleId;
+    for (itScheduleId = finishedScheduleIds.begin (); finishedScheduleIds.end () != itScheduleId; ++itScheduleId)
+    {
+      m_pDeviceStore->RemoveSchedule (*itScheduleId);
+    }
   }
 
-  return false;
-}
+  // feed the values to the regular set values path
+  std::chrono::high_resolution_clock::time_point now = std::chrono::high_resolution_clock::now ();
 
-bool Switch::Controller::_HandleDataSetDeviceValues ()
-{
-  std::pair <switch_device_address_type, std::list <Switch::DataContainer::Element>> dataSetDeviceValues;
+  std::unique_lock <std::mutex> interfaceDataLock (m_interfaceDataMutex);
 
+  std::list <Switch::Rule::Action>::const_iterator itAction;
+  for (itAction = actions.begin (); actions.end () != itAction; ++itAction)
   {
-    std::unique_lock <std::mutex> dataLock (m_interfaceDataMutex);
+    _QueueDeviceElements (itAction->m_deviceAddress, itAction->m_elements, now);
+  }
 
-    // check if new nodes were discovered
-    if (m_dataSetDeviceValues.empty ())
+  return false;
+}
+
+/*!
+  \brief Handles the result of a transmission to a node.
+
+  \param [in] i_deviceAddress The device address of the node.
+  \param [in] i_result        Flags if the transmission was successfull (true) or not (false).
+ */
+void Switch::Controller::_HandleNodeDataTransmitted (const switch_device_address_type& i_deviceAddress, const bool& i_result)
+{
+  // . get the device
+  Switch::DeviceStore::DeviceMap::iterator itDevice;
+  {
+    std::unique_lock <std::mutex> deviceStoreLock (m_deviceStoreMutex);
+    Switch::DeviceStore::DeviceMap& deviceMap = m_pDeviceStore->GetDevices ();
+    itDevice = deviceMap.find (i_deviceAddress);
+    if (deviceMap.end () == itDevice)
     {
-      return true;
+      return;
     }
-
-    // get the device address and the values to set in the device
-    dataSetDeviceValues = m_dataSetDeviceValues.front ();
-    m_dataSetDeviceValues.pop_front ();
   }
+  Switch::Device& device = itDevice->second;
 
-  Switch::DeviceStore::DeviceMap& devices = m_pDeviceStore->GetDevices ();
-  Switch::DeviceStore::DeviceMap::iterator itDevice = devices.find (dataSetDeviceValues.first);
-  if (devices.end () == itDevice)
+  // . get the transmitted payload
+  Switch::DataPayload dataPayload;
   {
-    return false;
+    std::unique_lock <std::mutex> reconcileLock (m_reconcileMutex);
+    std::map <switch_device_address_type, ReconcileState>::iterator itState = m_reconcileStates.find (i_deviceAddress);
+    if ((m_reconcileStates.end () == itState) || itState->second.m_inFlight.empty ())
+    {
+      return;
+    }
+    dataPayload = itState->second.m_inFlight.front ();
+    itState->second.m_inFlight.pop_front ();
+
+    // estimate the transmit time from the intervals between results while the router was busy
+    std::chrono::high_resolution_clock::time_point now = std::chrono::high_resolution_clock::now ();
+    if (1 < m_nrPayloadsInFlight.fetch_sub (1))
+    {
+      uint64_t intervalMicros = std::chrono::duration_cast <std::chrono::microseconds> (now - m_lastTransmittedTime).count ();
+      intervalMicros = std::min (intervalMicros, static_cast <uint64_t> (CONTROLLER_RECONCILE_MAX_BACKOFF_MICROS));
+      m_transmitMicros = static_cast <uint32_t> ((7 * static_cast <uint64_t> (m_transmitMicros.load ()) + intervalMicros) / 8);
+    }
+    m_lastTransmittedTime = now;
+
+    // schedule a retransmission if the payload did not reach the device
+    if (!i_result)
+    {
+      uint32_t backoffShift = std::min (itState->second.m_nrRetransmissions, static_cast <uint32_t> (16));
+      uint64_t backoffMicros = std::min (static_cast <uint64_t> (CONTROLLER_RECONCILE_MIN_BACKOFF_MICROS) << backoffShift, static_cast <uint64_t> (CONTROLLER_RECONCILE_MAX_BACKOFF_MICROS));
+      itState->second.m_pending     = true;
+      itState->second.m_nextAttempt = std::chrono::high_resolution_clock::now () + std::chrono::microseconds (backoffMicros);
+    }
   }
 
-  // set the data in the device
-  Switch::Device& device = itDevice->second;
-  Switch::DataContainer& dataContainer = device.GetDataContainer ();
+  // . the device acknowledged the payload, it reports the transmitted values
   std::list <Switch::DataContainer::Element> changedElements;
-  bool dataChanged = dataContainer.SetElements (changedElements, dataSetDeviceValues.second);
-  if (!dataChanged)
+  bool dataChanged = false;
+  if (i_result)
   {
-    return false;
+    std::unique_lock <std::mutex> deviceDataLock (m_deviceDataMutex);
+    dataChanged = device.GetReportedDataContainer ().SetContent (changedElements, dataPayload.data);
+    if (dataChanged)
+    {
+      // note: the confirmed values are versioned, such that delta clients learn about them
+      _RecordValueChanges (i_deviceAddress, changedElements);
+    }
   }
 
-  // transmit the data to the device
-  Switch::DataPayload txPayload;
-  dataContainer.GetContent (txPayload.data);
-  m_pRouter->TransmitData (dataSetDeviceValues.first, txPayload);
+  _UpdateReconcileState (i_deviceAddress, device);
 
-  return false;
+  // . forward the changed reported values, as if the device had reported them
+  if (dataChanged)
+  {
+    _EmitDeviceDataUpdate (i_deviceAddress, changedElements);
+  }
 }
 
 /*!
-  \brief Signals that a new node was discovered in the network with specified device address.
+  \brief Forwards changed elements of the reported state of a device to the data update observers.
 
-  \param [in] i_deviceAddress The device address of the new node.
+  \param [in] i_deviceAddress   The device address of the node.
+  \param [in] i_changedElements The changed elements of the reported state.
  */
-void Switch::Controller::_OnRouterNewNodeDiscovered (const switch_device_address_type& i_deviceAddress, const Switch::DeviceInfo& i_deviceInfo)
+void Switch::Controller::_EmitDeviceDataUpdate (const switch_device_address_type& i_deviceAddress, const std::list <Switch::DataContainer::Element>& i_changedElements)
 {
-  SWITCH_DEBUG_MSG_0 ("_OnRouterNewNodeDiscovered ... ");
-  std::unique_lock <std::mutex> dataLock (m_routerDataMutex);
-
-  m_dataNewNodeDiscovered.push_back (std::make_pair (i_deviceAddress, i_deviceInfo));
+  if (m_deviceDataUpdateSignal.IsEmpty ())
+  {
+    return;
+  }
 
-  m_updateCondition.notify_all ();
+  // translate the changed data elements
+  std::list <Switch::Interface::Device::Value> changedValues;
+  std::list <Switch::DataContainer::Element>::const_iterator itElement;
+  for (itElement=i_changedElements.begin (); i_changedElements.end ()!=itElement; ++itElement)
+  {
+    Switch::Interface::Device::Value changedValue;
+    Switch::Interface::Translate (changedValue, *itElement);
+    changedValues.push_back (changedValue);
+  }
 
-  SWITCH_DEBUG_MSG_0 ("done\n");
+  // forward the signal
+  m_deviceDataUpdateSignal.Emit (static_cast <uint32_t> (i_deviceAddress), changedValues);
 }
 
 /*!
-  \brief Signals that a node's connection status has changed
+  \brief Forgets the reconciliation state of a device once it confirmed its desired values.
 
-  \param [in] i_connected The new connection status. True if connected, false otherwise.
   \param [in] i_deviceAddress The device address of the node.
+  \param [in] i_device        The device.
  */
-void Switch::Controller::_OnRouterNodeConnectionUpdate (const switch_device_address_type& i_deviceAddress, const bool& i_connected)
+void Switch::Controller::_UpdateReconcileState (const switch_device_address_type& i_deviceAddress, const Switch::Device& i_device)
 {
-  SWITCH_DEBUG_MSG_0 ("_OnRouterNodeConnectionUpdate ... ");
-  std::unique_lock <std::mutex> dataLock (m_routerDataMutex);
+  bool inSync;
+  {
+    std::unique_lock <std::mutex> deviceDataLock (m_deviceDataMutex);
+    inSync = i_device.IsInSync ();
+  }
 
-  m_dataNodeConnectionUpdate.push_back (std::make_pair (i_deviceAddress, i_connected));
+  std::list <uint32_t> confirmedSceneIds;
+  {
+    std::unique_lock <std::mutex> reconcileLock (m_reconcileMutex);
+    std::map <switch_device_address_type, ReconcileState>::iterator itState = m_reconcileStates.find (i_deviceAddress);
+    if (m_reconcileStates.end () == itState)
+    {
+      return;
+    }
 
-  m_updateCondition.notify_all ();
+    // wait for the results of all transmissions
+    if (!itState->second.m_inFlight.empty ())
+    {
+      return;
+    }
 
-  SWITCH_DEBUG_MSG_0 ("done\n");
+    if (inSync)
+    {
+      confirmedSceneIds.swap (itState->second.m_sceneIds);
+      m_reconcileStates.erase (itState);
+    }
+    else if (!itState->second.m_pending)
+    {
+      // the device reported other values than desired
+      itState->second.m_pending     = true;
+      itState->second.m_nextAttempt = std::chrono::high_resolution_clock::now () + std::chrono::microseconds (CONTROLLER_RECONCILE_MIN_BACKOFF_MICROS);
+    }
+  }
+
+  _CompleteScenes (confirmedSceneIds, i_deviceAddress, CR_OK);
 }
 
 /*!
-  \brief Signals that data was received from a node
+  \brief Lets scenes wait for a device to confirm its desired values.
 
-  \param [in] i_dataPayload Const reference to the received data payload
-  \param [in] i_deviceAddress The device address of the node.
+  The scenes complete immediately if no confirmation of the device is pending.
 
-  \return True if the data may be released, false otherwise.
+  \param [in] i_deviceAddress The device address of the node.
+  \param [in] i_device        The device.
+  \param [in] i_sceneIds      The ids of the scenes.
  */
-bool Switch::Controller::_OnRouterNodeDataReceived (const switch_device_address_type& i_deviceAddress, const Switch::DataPayload& i_dataPayload)
+void Switch::Controller::_WaitForConfirmation (const switch_device_address_type& i_deviceAddress, const Switch::Device& i_device, const std::list <uint32_t>& i_sceneIds)
 {
-  SWITCH_DEBUG_MSG_0 ("_OnRouterNodeDataReceived ... ");
-  std::unique_lock <std::mutex> dataLock (m_routerDataMutex);
-
-  m_dataNodeDataReceived.push_back (std::make_pair (i_deviceAddress, i_dataPayload));
-
-  m_updateCondition.notify_all ();
+  if (i_sceneIds.empty ())
+  {
+    return;
+  }
 
-  SWITCH_DEBUG_MSG_0 ("done\n");
+  bool inSync;
+  {
+    std::unique_lock <std::mutex> deviceDataLock (m_deviceDataMutex);
+    inSync = i_device.IsInSync ();
+  }
+  {
+    std::unique_lock <std::mutex> reconcileLock (m_reconcileMutex);
+    std::map <switch_device_address_type, ReconcileState>::iterator itState = m_reconcileStates.find (i_deviceAddress);
+    if (m_reconcileStates.end () != itState)
+    {
+      itState->second.m_sceneIds.insert (itState->second.m_sceneIds.end (), i_sceneIds.begin (), i_sceneIds.end ());
+      return;
+    }
+  }
 
-  return true;
+  // the device confirmed its values before, or they were given up
+  _CompleteScenes (i_sceneIds, i_deviceAddress, inSync ? CR_OK : CR_NOT_CONFIRMED);
 }
 
 /*!
-  \brief Signals that data was transmitted to a node
+  \brief Sets the result of a device in the scenes waiting for it.
 
+  \param [in] i_sceneIds      The ids of the scenes.
   \param [in] i_deviceAddress The device address of the node.
-  \param [in] i_result Flags if the transmission was successfull (true) or not (false).
+  \param [in] i_result        The result of the device.
  */
-void Switch::Controller::_OnRouterNodeDataTransmitted (const switch_device_address_type& i_deviceAddress, const bool& i_result)
+void Switch::Controller::_CompleteScenes (const std::list <uint32_t>& i_sceneIds, const switch_device_address_type& i_deviceAddress, const eCallResult& i_result)
 {
-  SWITCH_DEBUG_MSG_0 ("_OnRouterNodeDataTransmitted ... ");
-  std::unique_lock <std::mutex> dataLock (m_routerDataMutex);
-
-  m_dataNodeDataTransmitted.push_back (std::make_pair (i_deviceAddress, i_result));
-
-  m_updateCondition.notify_all ();
+  if (i_sceneIds.empty ())
+  {
+    return;
+  }
 
-  SWITCH_DEBUG_MSG_0 ("done\n");
+  std::unique_lock <std::mutex> scenesLock (m_scenesMutex);
 
-  return;
+  std::list <uint32_t>::const_iterator itSceneId;
+  for (itSceneId = i_sceneIds.begin (); i_sceneIds.end () != itSceneId; ++itSceneId)
+  {
+    // note: scenes pushed out of the bounded history are no longer reported
+    std::map <uint32_t, Scene>::iterator itScene = m_scenes.find (*itSceneId);
+    if (m_scenes.end () == itScene)
+    {
+      continue;
+    }
+    std::map <uint32_t, eCallResult>::iterator itResult = itScene->second.m_results.find (static_cast <uint32_t> (i_deviceAddress));
+    if (itScene->second.m_results.end () != itResult)
+    {
+      itResult->second = i_result;
+    }
+  }
 }
 
-//************* Interface methods *************//
+/*!
+  \brief Starts the retransmissions that are due.
 
-boost::signals2::connection Switch::Controller::ConnectToDeviceConnectionUpdateSignal (const DeviceConnectionUpdateSignal::slot_type& i_receiver)
-{
-  return m_deviceConnectionUpdateSignal.connect (i_receiver);
+  The retransmissions of all devices share a budget of m_maxNrRetransmissionsPerSecond,
+  such that devices failing to confirm their values can not take up all airtime.
+
+  \return True if no more retransmissions are due, false otherwise.
+ */
+bool Switch::Controller::_ReconcileDevices ()
+{
+  std::chrono::high_resolution_clock::time_point now = std::chrono::high_resolution_clock::now ();
+
+  // refill the budget
+  double elapsedSeconds = std::chrono::duration_cast <std::chrono::duration <double>> (now - m_reconcileBudgetTime).count ();
+  m_reconcileBudget = std::min (m_reconcileBudget + elapsedSeconds * m_maxNrRetransmissionsPerSecond, static_cast <double> (m_maxNrRetransmissionsPerSecond));
+  m_reconcileBudgetTime = now;
+
+  // collect the devices of which a retransmission is due
+  std::list <switch_device_address_type> dueDevices;
+  bool budgetExhausted = false;
+  {
+    std::unique_lock <std::mutex> reconcileLock (m_reconcileMutex);
+
+    std::map <switch_device_address_type, ReconcileState>::iterator itState;
+    for (itState = m_reconcileStates.begin (); m_reconcileStates.end () != itState; ++itState)
+    {
+      ReconcileState& state = itState->second;
+      if (!state.m_pending || !state.m_inFlight.empty () || (now < state.m_nextAttempt))
+      {
+        continue;
+      }
+      if (1.0 > m_reconcileBudget)
+      {
+        budgetExhausted = true;
+        break;
+      }
+
+      m_reconcileBudget -= 1.0;
+      state.m_pending = false;
+      dueDevices.push_back (itState->first);
+    }
+  }
+
+  Switch::RouterEvent event;
+  event.m_type = Switch::RouterEvent::RE_RECONCILE_DEVICE;
+
+  std::list <switch_device_address_type>::const_iterator itDevice;
+  for (itDevice = dueDevices.begin (); dueDevices.end () != itDevice; ++itDevice)
+  {
+    if (0x0 != m_pWorkerPool)
+    {
+      // hand off to the worker owning the device
+      event.m_deviceAddress = *itDevice;
+      m_pWorkerPool->Post (event);
+    }
+    else
+    {
+      _ReconcileDevice (*itDevice);
+    }
+  }
+
+  return !budgetExhausted;
+}
+
+/*!
+  \brief Retransmits the desired values of a device that did not confirm them.
+
+  Gives up when the device used up its retransmissions, the desired and reported
+  values then remain different until new values are set.
+
+  \param [in] i_deviceAddress The device address of the node.
+ */
+void Switch::Controller::_ReconcileDevice (const switch_device_address_type& i_deviceAddress)
+{
+  // . get the device
+  Switch::DeviceStore::DeviceMap::iterator itDevice;
+  {
+    std::unique_lock <std::mutex> deviceStoreLock (m_deviceStoreMutex);
+    Switch::DeviceStore::DeviceMap& deviceMap = m_pDeviceStore->GetDevices ();
+    itDevice = deviceMap.find (i_deviceAddress);
+    if (deviceMap.end () == itDevice)
+    {
+      return;
+    }
+  }
+  const Switch::Device& device = itDevice->second;
+  bool inSync;
+  {
+    std::unique_lock <std::mutex> deviceDataLock (m_deviceDataMutex);
+    inSync = device.IsInSync ();
+  }
+
+  std::list <uint32_t> completedSceneIds;
+  {
+    std::unique_lock <std::mutex> reconcileLock (m_reconcileMutex);
+    std::map <switch_device_address_type, ReconcileState>::iterator itState = m_reconcileStates.find (i_deviceAddress);
+    if (m_reconcileStates.end () == itState)
+    {
+      return;
+    }
+    ReconcileState& state = itState->second;
+
+    if (inSync)
+    {
+      if (state.m_inFlight.empty ())
+      {
+        completedSceneIds.swap (state.m_sceneIds);
+        m_reconcileStates.erase (itState);
+        reconcileLock.unlock ();
+        _CompleteScenes (completedSceneIds, i_deviceAddress, CR_OK);
+      }
+      return;
+    }
+
+    uint32_t backoffShift = std::min (state.m_nrRetransmissions, static_cast <uint32_t> (16));
+    uint64_t backoffMicros = std::min (static_cast <uint64_t> (CONTROLLER_RECONCILE_MIN_BACKOFF_MICROS) << backoffShift, static_cast <uint64_t> (CONTROLLER_RECONCILE_MAX_BACKOFF_MICROS));
+    if (!device.GetConnectionState ())
+    {
+      // wait for the device to connect, without using up its retransmissions
+      state.m_pending     = true;
+      state.m_nextAttempt = std::chrono::high_resolution_clock::now () + std::chrono::microseconds (backoffMicros);
+      return;
+    }
+
+    if (m_maxNrRetransmissions <= state.m_nrRetransmissions)
+    {
+      SWITCH_DEBUG_MSG_1 ("device %u did not confirm its values, retransmissions given up\n", i_deviceAddress);
+      completedSceneIds.swap (state.m_sceneIds);
+      if (state.m_inFlight.empty ())
+      {
+        m_reconcileStates.erase (itState);
+      }
+      reconcileLock.unlock ();
+      _CompleteScenes (completedSceneIds, i_deviceAddress, CR_NOT_CONFIRMED);
+      return;
+    }
+
+    ++state.m_nrRetransmissions;
+  }
+
+  _TransmitDesiredContent (i_deviceAddress, device, true);
+}
+
+/*!
+  \brief Gets the time until the first retransmission is due.
+
+  \return The time in microseconds, or the maximum value if no retransmissions are pending.
+ */
+uint32_t Switch::Controller::_GetReconcileDelayMicros () const
+{
+  std::unique_lock <std::mutex> reconcileLock (m_reconcileMutex);
+
+  bool pending = false;
+  std::chrono::high_resolution_clock::time_point nextAttempt;
+  std::map <switch_device_address_type, ReconcileState>::const_iterator itState;
+  for (itState = m_reconcileStates.begin (); m_reconcileStates.end () != itState; ++itState)
+  {
+    if (itState->second.m_pending && (!pending || (itState->second.m_nextAttempt < nextAttempt)))
+    {
+      pending = true;
+      nextAttempt = itState->second.m_nextAttempt;
+    }
+  }
+
+  if (!pending)
+  {
+    return std::numeric_limits <uint32_t>::max ();
+  }
+
+  // wait for the budget to refill
+  uint32_t budgetDelayMicros = 0;
+  if ((1.0 > m_reconcileBudget) && (0 < m_maxNrRetransmissionsPerSecond))
+  {
+    budgetDelayMicros = static_cast <uint32_t> ((1.0 - m_reconcileBudget) * 1000000.0 / m_maxNrRetransmissionsPerSecond);
+  }
+
+  std::chrono::high_resolution_clock::time_point now = std::chrono::high_resolution_clock::now ();
+  uint32_t attemptDelayMicros = (nextAttempt <= now) ? 0 : static_cast <uint32_t> (std::chrono::duration_cast <std::chrono::microseconds> (nextAttempt - now).count ());
+
+  return std::max (attemptDelayMicros, budgetDelayMicros);
+}
+
+bool Switch::Controller::_HandleDataAddDevice ()
+{
+  std::list <switch_device_address_type> data;
+
+  {
+    std::unique_lock <std::mutex> dataLock (m_interfaceDataMutex);
+
+    // check if new nodes were discovered
+    if (m_dataAddDevice.empty ())
+    {
+      return true;
+    }
+
+    // get the address of the nodes to add
+    data.splice (data.begin (), m_dataAddDevice);
+  }
+
+  std::unique_lock <std::mutex> deviceStoreLock (m_deviceStoreMutex);
+
+  std::list <switch_device_address_type>::iterator itData;
+  for (itData = data.begin (); data.end () != itData; ++itData)
+  {
+    switch_device_address_type& deviceAddress = *itData;
+    m_pDeviceStore->AddDevice (deviceAddress);
+    m_pRouter->EnableNodeRouting (deviceAddress);
+  }
+
+  return false;
+}
+
+/*!
+  \brief Transmits the device values of which the merge window has elapsed.
+
+  All due devices are handled at once, such that their payloads are handed
+  over to the router as one batch.
+
+  \return True if no more values are due, false otherwise.
+ */
+bool Switch::Controller::_HandleDataSetDeviceValues ()
+{
+  std::list <std::pair <switch_device_address_type, PendingDeviceValues>> dataSetDeviceValues;
+
+  {
+    std::unique_lock <std::mutex> dataLock (m_interfaceDataMutex);
+
+    // check if values must be set
+    if (m_dataSetDeviceValuesOrder.empty ())
+    {
+      return true;
+    }
+
+    // collect all pending values of which the window has elapsed
+    std::chrono::high_resolution_clock::time_point now = std::chrono::high_resolution_clock::now ();
+    std::list <switch_device_address_type>::iterator itOrder = m_dataSetDeviceValuesOrder.begin ();
+    while (m_dataSetDeviceValuesOrder.end () != itOrder)
+    {
+      std::map <switch_device_address_type, PendingDeviceValues>::iterator itPending = m_dataSetDeviceValues.find (*itOrder);
+      SWITCH_ASSERT (m_dataSetDeviceValues.end () != itPending);
+      if (now < itPending->second.m_deadline)
+      {
+        ++itOrder;
+        continue;
+      }
+
+      // get the device address and the merged values to set in the device
+      dataSetDeviceValues.push_back (std::make_pair (itPending->first, PendingDeviceValues ()));
+      dataSetDeviceValues.back ().second.m_elements.swap (itPending->second.m_elements);
+      dataSetDeviceValues.back ().second.m_sceneIds.swap (itPending->second.m_sceneIds);
+      m_dataSetDeviceValues.erase (itPending);
+      itOrder = m_dataSetDeviceValuesOrder.erase (itOrder);
+    }
+  }
+
+  if (dataSetDeviceValues.empty ())
+  {
+    return true;
+  }
+
+  Switch::RouterEvent event;
+  event.m_type = Switch::RouterEvent::RE_SET_DEVICE_VALUES;
+
+  std::list <std::pair <switch_device_address_type, PendingDeviceValues>>::iterator itData;
+  for (itData = dataSetDeviceValues.begin (); dataSetDeviceValues.end () != itData; ++itData)
+  {
+    if (0x0 != m_pWorkerPool)
+    {
+      // hand off to the worker owning the device
+      event.m_deviceAddress = itData->first;
+      event.m_elements.swap (itData->second.m_elements);
+      event.m_sceneIds.swap (itData->second.m_sceneIds);
+      m_pWorkerPool->Post (event);
+    }
+    else
+    {
+      _HandleSetDeviceValues (itData->first, itData->second.m_elements, itData->second.m_sceneIds);
+    }
+  }
+
+  return false;
+}
+
+/*!
+  \brief Gets the time until the first pending device values must be transmitted.
+
+  \return The time in microseconds, or the maximum value if no values are pending.
+ */
+uint32_t Switch::Controller::_GetSetDeviceValuesDelayMicros () const
+{
+  std::unique_lock <std::mutex> dataLock (m_interfaceDataMutex);
+
+  if (m_dataSetDeviceValues.empty ())
+  {
+    return std::numeric_limits <uint32_t>::max ();
+  }
+
+  // find the first deadline
+  std::map <switch_device_address_type, PendingDeviceValues>::const_iterator itPending = m_dataSetDeviceValues.begin ();
+  std::chrono::high_resolution_clock::time_point deadline = itPending->second.m_deadline;
+  for (++itPending; m_dataSetDeviceValues.end () != itPending; ++itPending)
+  {
+    deadline = std::min (deadline, itPending->second.m_deadline);
+  }
+
+  std::chrono::high_resolution_clock::time_point now = std::chrono::high_resolution_clock::now ();
+  if (deadline <= now)
+  {
+    return 0;
+  }
+
+  return static_cast <uint32_t> (std::chrono::duration_cast <std::chrono::microseconds> (deadline - now).count ());
+}
+
+/*!
+  \brief Merges values to set in a device with its pending values.
+
+  Opens a new merge window if no values are pending for the device.
+
+  \param [in] i_deviceAddress The device address of the node.
+  \param [in] i_values        The values to set.
+  \param [in] i_deadline      The time at which the values must be transmitted if a new window is opened.
+
+  \note Requires m_interfaceDataMutex to be locked.
+ */
+void Switch::Controller::_QueueDeviceValues (const switch_device_address_type& i_deviceAddress, const std::list <Switch::Interface::Device::Value>& i_values, const std::chrono::high_resolution_clock::time_point& i_deadline)
+{
+  // translate the values
+  std::list <Switch::DataContainer::Element> elements;
+  std::list <Switch::Interface::Device::Value>::const_iterator itValue;
+  for (itValue = i_values.begin (); i_values.end () != itValue; ++itValue)
+  {
+    Switch::DataContainer::Element element;
+    Switch::Interface::Translate (element, *itValue);
+    elements.push_back (element);
+  }
+
+  _QueueDeviceElements (i_deviceAddress, elements, i_deadline);
+}
+
+/*!
+  \brief Merges elements to set in a device with its pending values.
+
+  Opens a new merge window if no values are pending for the device.
+
+  \param [in] i_deviceAddress The device address of the node.
+  \param [in] i_elements      The elements to set.
+  \param [in] i_deadline      The time at which the values must be transmitted if a new window is opened.
+
+  \note Requires m_interfaceDataMutex to be locked.
+ */
+void Switch::Controller::_QueueDeviceElements (const switch_device_address_type& i_deviceAddress, const std::list <Switch::DataContainer::Element>& i_elements, const std::chrono::high_resolution_clock::time_point& i_deadline)
+{
+  // get the pending values of the device, or open a new merge window
+  std::map <switch_device_address_type, PendingDeviceValues>::iterator itPending = m_dataSetDeviceValues.find (i_deviceAddress);
+  if (m_dataSetDeviceValues.end () == itPending)
+  {
+    itPending = m_dataSetDeviceValues.insert (std::make_pair (i_deviceAddress, PendingDeviceValues ())).first;
+    itPending->second.m_deadline = i_deadline;
+    m_dataSetDeviceValuesOrder.push_back (i_deviceAddress);
+  }
+
+  // merge the elements, later values override earlier values of the same element
+  std::list <Switch::DataContainer::Element>& containerElements = itPending->second.m_elements;
+  std::list <Switch::DataContainer::Element>::const_iterator itNewElement;
+  for (itNewElement = i_elements.begin (); i_elements.end () != itNewElement; ++itNewElement)
+  {
+    std::list <Switch::DataContainer::Element>::iterator itElement;
+    for (itElement = containerElements.begin (); containerElements.end () != itElement; ++itElement)
+    {
+      if (itElement->m_address == itNewElement->m_address)
+      {
+        *itElement = *itNewElement;
+        break;
+      }
+    }
+    if (containerElements.end () == itElement)
+    {
+      containerElements.push_back (*itNewElement);
+    }
+  }
+}
+
+/*!
+  \brief Hands over all pending payloads to the router as one batch.
+ */
+void Switch::Controller::_TransmitPendingData ()
+{
+  std::list <std::pair <switch_device_address_type, Switch::DataPayload>> transmitData;
+
+  {
+    std::unique_lock <std::mutex> dataLock (m_transmitDataMutex);
+
+    if (m_transmitData.empty ())
+    {
+      return;
+    }
+
+    transmitData.splice (transmitData.begin (), m_transmitData);
+  }
+
+  // note: the router spreads the batch over its cycles and child pipes
+  m_pRouter->TransmitData (transmitData);
+}
+
+/*!
+  \brief Gets the number of queued commands.
+
+  \note Requires m_interfaceDataMutex to be locked.
+ */
+uint32_t Switch::Controller::_GetNrQueuedCommands () const
+{
+  // note: the pending values of a device become one payload
+  return static_cast <uint32_t> (m_dataSetDeviceValues.size ()) + m_nrPayloadsInFlight.load ();
+}
+
+/*!
+  \brief Estimates the time to transmit queued commands.
+
+  \param [in] i_nrQueuedCommands The number of queued commands.
+
+  \return The time in microseconds.
+ */
+uint32_t Switch::Controller::_GetDrainTimeMicros (const uint32_t& i_nrQueuedCommands) const
+{
+  uint64_t drainTimeMicros = static_cast <uint64_t> (i_nrQueuedCommands) * m_transmitMicros.load ();
+  return static_cast <uint32_t> (std::min (drainTimeMicros, static_cast <uint64_t> (std::numeric_limits <uint32_t>::max ())));
+}
+
+/*!
+  \brief Checks if a number of queued commands exceeds the backlog limits.
+
+  \param [in] i_nrQueuedCommands The number of queued commands, including the new ones.
+
+  \return True if new commands must be rejected, false otherwise.
+ */
+bool Switch::Controller::_IsBacklogFull (const uint32_t& i_nrQueuedCommands) const
+{
+  return ((0 != m_maxNrQueuedCommands) && (m_maxNrQueuedCommands < i_nrQueuedCommands)) ||
+         ((0 != m_maxCommandDrainTimeMicros) && (m_maxCommandDrainTimeMicros < _GetDrainTimeMicros (i_nrQueuedCommands)));
+}
+
+/*!
+  \brief Records a change of the type or the connection state of a device.
+
+  \param [in] i_deviceAddress The device address of the node.
+  \param [in] i_allValues     Flags if all desired values changed as well, e.g. when the device was identified.
+ */
+void Switch::Controller::_RecordSummaryChange (const switch_device_address_type& i_deviceAddress, const bool& i_allValues)
+{
+  std::unique_lock <std::mutex> changeVersionsLock (m_changeVersionsMutex);
+  m_changeVersionLog.RecordSummaryChange (i_deviceAddress, i_allValues);
+}
+
+/*!
+  \brief Records changes of the desired values of a device.
+
+  \param [in] i_deviceAddress     The device address of the node.
+  \param [in] i_changedElements   The changed elements of the desired state.
+
+  \note Call after changing the data container, such that a client reading the changes gets the new values.
+ */
+void Switch::Controller::_RecordValueChanges (const switch_device_address_type& i_deviceAddress, const std::list <Switch::DataContainer::Element>& i_changedElements)
+{
+  if (i_changedElements.empty ())
+  {
+    return;
+  }
+
+  std::unique_lock <std::mutex> changeVersionsLock (m_changeVersionsMutex);
+  m_changeVersionLog.RecordValueChanges (i_deviceAddress, i_changedElements);
+}
+
+/*!
+  \brief Sets values in a device and transmits the resulting content to the device.
+
+  \param [in] i_deviceAddress The device address of the node.
+  \param [in] i_elements      The elements to set.
+  \param [in] i_sceneIds      The scenes waiting for the device to confirm the elements.
+ */
+void Switch::Controller::_HandleSetDeviceValues (const switch_device_address_type& i_deviceAddress, const std::list <Switch::DataContainer::Element>& i_elements, const std::list <uint32_t>& i_sceneIds)
+{
+  Switch::DeviceStore::DeviceMap::iterator itDevice;
+  {
+    std::unique_lock <std::mutex> deviceStoreLock (m_deviceStoreMutex);
+    Switch::DeviceStore::DeviceMap& devices = m_pDeviceStore->GetDevices ();
+    itDevice = devices.find (i_deviceAddress);
+    if (devices.end () == itDevice)
+    {
+      deviceStoreLock.unlock ();
+      _CompleteScenes (i_sceneIds, i_deviceAddress, CR_UNKNOWN_DEVICE);
+      return;
+    }
+  }
+
+  // set the data in the device
+  Switch::Device& device = itDevice->second;
+  Switch::DataContainer& dataContainer = device.GetDataContainer ();
+  std::list <Switch::DataContainer::Element> changedElements;
+  bool dataChanged;
+  {
+    std::unique_lock <std::mutex> deviceDataLock (m_deviceDataMutex);
+    dataChanged = dataContainer.SetElements (changedElements, i_elements);
+    if (dataChanged)
+    {
+      _RecordValueChanges (i_deviceAddress, changedElements);
+    }
+  }
+
+  if (dataChanged)
+  {
+    // re-arm the schedules watching the changed elements
+    m_scheduler.HandleChangedElements (i_deviceAddress, changedElements);
+
+    // queue the data for transmission to the device
+    _TransmitDesiredContent (i_deviceAddress, device, false);
+  }
+
+  // the scenes complete when the device confirmed the desired values
+  _WaitForConfirmation (i_deviceAddress, device, i_sceneIds);
+}
+
+/*!
+  \brief Queues the desired content of a device for transmission.
+
+  The payload is tracked until the router reports the transmission result, such
+  that an acknowledged payload updates the reported state of the device.
+
+  \param [in] i_deviceAddress   The device address of the node.
+  \param [in] i_device          The device.
+  \param [in] i_retransmission  Flags if the desired values are retransmitted (true) or were newly set (false).
+ */
+void Switch::Controller::_TransmitDesiredContent (const switch_device_address_type& i_deviceAddress, const Switch::Device& i_device, const bool& i_retransmission)
+{
+  Switch::DataPayload dataPayload;
+  i_device.GetDataContainer ().GetContent (dataPayload.data);
+
+  // track the payload
+  {
+    std::unique_lock <std::mutex> reconcileLock (m_reconcileMutex);
+    std::map <switch_device_address_type, ReconcileState>::iterator itState = m_reconcileStates.find (i_deviceAddress);
+    if (m_reconcileStates.end () == itState)
+    {
+      itState = m_reconcileStates.insert (std::make_pair (i_deviceAddress, ReconcileState ())).first;
+      itState->second.m_pending = false;
+      itState->second.m_nrRetransmissions = 0;
+    }
+    if (!i_retransmission)
+    {
+      // new values get a new set of retransmissions
+      itState->second.m_nrRetransmissions = 0;
+    }
+    itState->second.m_inFlight.push_back (dataPayload);
+    if (0 == m_nrPayloadsInFlight.fetch_add (1))
+    {
+      // note: the router was idle, the interval to the first result is a transmit time
+      m_lastTransmittedTime = std::chrono::high_resolution_clock::now ();
+    }
+  }
+
+  // queue the data for transmission to the device
+  {
+    std::unique_lock <std::mutex> dataLock (m_transmitDataMutex);
+    m_transmitData.push_back (std::make_pair (i_deviceAddress, dataPayload));
+  }
+
+  if (0x0 != m_pWorkerPool)
+  {
+    // wake up the controller to hand over the data to the router
+    m_updateCondition.notify_all ();
+  }
+}
+
+/*!
+  \brief Posts an event of the router to the controller thread.
+
+  Called from the router thread. The controller thread is not woken up per
+  event, but once per router cycle in _OnRouterCycleCompleted.
+
+  \param [in] i_event The event to post.
+  \param [in] i_wait  Flags if the router thread waits until the queue has room for the event.
+
+  \return True if the event was queued, false if the queue is full or the controller stopped.
+
+  \note The router is paused before the controller, the queue is always drained while waiting.
+ */
+bool Switch::Controller::_PostRouterEvent (const Switch::RouterEvent& i_event, const bool& i_wait)
+{
+  if (!m_routerEventQueue.Push (i_event))
+  {
+    // queue is full, wake up the controller and give it the chance to drain
+    m_updateCondition.notify_all ();
+
+    if (!i_wait)
+    {
+      std::this_thread::yield ();
+      if (!m_routerEventQueue.Push (i_event))
+      {
+        SWITCH_DEBUG_MSG_2 ("router event queue full, retaining event of type %i for device %u\n", static_cast <int> (i_event.m_type), static_cast <uint32_t> (i_event.m_deviceAddress));
+        return false;
+      }
+    }
+    else
+    {
+      // sleep until the controller pops an event
+      while (!m_routerEventQueue.Push (i_event, std::chrono::microseconds (CONTROLLER_ROUTER_EVENT_QUEUE_WAIT_MICROS)))
+      {
+        if (OS_STOPPED == m_controllerState.load ())
+        {
+          SWITCH_DEBUG_MSG_2 ("controller stopped, dropping event of type %i for device %u\n", static_cast <int> (i_event.m_type), static_cast <uint32_t> (i_event.m_deviceAddress));
+          return false;
+        }
+        m_updateCondition.notify_all ();
+      }
+    }
+  }
+
+  m_routerEventsPosted.store (true);
+  return true;
+}
+
+/*!
+  \brief Posts the received data retained in the router's rx message queue.
+
+  Called from the router thread. The messages are posted in the order they were
+  received, each message is released once it is queued. Waits for room in the
+  queue if the rx message queue could not hold the messages of the next cycle,
+  such that the router never runs out of slots.
+ */
+void Switch::Controller::_PostRetainedRxMessages ()
+{
+  Switch::RouterEvent event;
+  event.m_type = Switch::RouterEvent::RE_NODE_DATA_RECEIVED;
+
+  while (0 != m_pRouter->GetNrRxMessagesQueued ())
+  {
+    event.m_dataPayload = m_pRouter->GetRxMessagePayload (event.m_deviceAddress);
+
+    const bool wait = (NODE_RX_MESSAGE_QUEUE_SIZE < m_pRouter->GetNrRxMessagesQueued () + NODE_MAX_NR_CONSECUTIVE_RX_READS);
+    if (!_PostRouterEvent (event, wait))
+    {
+      return;
+    }
+
+    m_pRouter->ReleaseRxMessage ();
+  }
+
+  m_rxMessagesRetained = false;
+}
+
+/*!
+  \brief Signals that a new node was discovered in the network with specified device address.
+
+  \param [in] i_deviceAddress The device address of the new node.
+  \param [in] i_deviceInfo    Information about the device. E.g., brand, product and version.
+ */
+void Switch::Controller::_OnRouterNewNodeDiscovered (const switch_device_address_type& i_deviceAddress, const Switch::DeviceInfo& i_deviceInfo)
+{
+  Switch::RouterEvent event;
+  event.m_type          = Switch::RouterEvent::RE_NEW_NODE_DISCOVERED;
+  event.m_deviceAddress = i_deviceAddress;
+  event.m_deviceInfo    = i_deviceInfo;
+
+  _PostRouterEvent (event, true);
+}
+
+/*!
+  \brief Signals that a node's connection status has changed
+
+  \param [in] i_connected The new connection status. True if connected, false otherwise.
+  \param [in] i_deviceAddress The device address of the node.
+ */
+void Switch::Controller::_OnRouterNodeConnectionUpdate (const switch_device_address_type& i_deviceAddress, const bool& i_connected)
+{
+  Switch::RouterEvent event;
+  event.m_type          = Switch::RouterEvent::RE_NODE_CONNECTION_UPDATE;
+  event.m_deviceAddress = i_deviceAddress;
+  event.m_flag          = i_connected;
+
+  _PostRouterEvent (event, true);
+}
+
+/*!
+  \brief Signals that data was received from a node
+
+  \param [in] i_dataPayload Const reference to the received data payload
+  \param [in] i_deviceAddress The device address of the node.
+
+  \return True if the data may be released, false otherwise.
+ */
+bool Switch::Controller::_OnRouterNodeDataReceived (const switch_device_address_type& i_deviceAddress, const Switch::DataPayload& i_dataPayload)
+{
+  Switch::RouterEvent event;
+  event.m_type          = Switch::RouterEvent::RE_NODE_DATA_RECEIVED;
+  event.m_deviceAddress = i_deviceAddress;
+  event.m_dataPayload   = i_dataPayload;
+
+  // keep the order of the received data, newer data waits behind the retained messages
+  if (m_rxMessagesRetained || !_PostRouterEvent (event, false))
+  {
+    // the router keeps the data in its slot, it is posted again at the end of the cycle
+    m_rxMessagesRetained = true;
+    return false;
+  }
+
+  // note: the payload is copied into the event, the router's slot may be released
+  return true;
+}
+
+/*!
+  \brief Signals that data was transmitted to a node
+
+  \param [in] i_deviceAddress The device address of the node.
+  \param [in] i_result Flags if the transmission was successfull (true) or not (false).
+ */
+void Switch::Controller::_OnRouterNodeDataTransmitted (const switch_device_address_type& i_deviceAddress, const bool& i_result)
+{
+  Switch::RouterEvent event;
+  event.m_type          = Switch::RouterEvent::RE_NODE_DATA_TRANSMITTED;
+  event.m_deviceAddress = i_deviceAddress;
+  event.m_flag          = i_result;
+
+  _PostRouterEvent (event, true);
+}
+
+/*!
+  \brief Signals that the router completed an update cycle.
+
+  Posts the retained received data, then wakes up the controller thread once if
+  events were posted during the cycle.
+ */
+void Switch::Controller::_OnRouterCycleCompleted ()
+{
+  if (m_rxMessagesRetained)
+  {
+    _PostRetainedRxMessages ();
+  }
+
+  if (m_routerEventsPosted.exchange (false))
+  {
+    m_updateCondition.notify_all ();
+  }
+}
+
+//************* Interface methods *************//
+
+Switch::ObserverConnection Switch::Controller::ConnectToDeviceConnectionUpdateSignal (const DeviceConnectionUpdateSlot& i_receiver)
+{
+  return m_deviceConnectionUpdateSignal.Connect (i_receiver);
+}
+
+Switch::ObserverConnection Switch::Controller::ConnectToDeviceDataUpdateSignal (const DeviceDataUpdateSlot& i_receiver)
+{
+  return m_deviceDataUpdateSignal.Connect (i_receiver);
+}
+
+Switch::Controller::eCallResult Switch::Controller::AddDevice (const uint32_t& i_deviceAddress)
+{
+  SWITCH_DEBUG_MSG_0 ("AddDevice ... ");
+
+  std::unique_lock <std::mutex> stateLock (m_stateMutex);
+
+  if (OS_STARTED != m_objectState)
+  {
+    return CR_STOPPED;
+  }
+
+  std::unique_lock <std::mutex> interfaceDataLock (m_interfaceDataMutex);
+
+  m_dataAddDevice.push_back (static_cast <switch_device_address_type> (i_deviceAddress));
+
+  m_updateCondition.notify_all ();
+
+  SWITCH_DEBUG_MSG_0 ("done\n");
+
+  return CR_OK;
+}
+
+Switch::Controller::eCallResult Switch::Controller::EnumerateDevices (std::list <Switch::Interface::Device::Summary>& o_deviceInfo)
+{
+  SWITCH_DEBUG_MSG_0 ("EnumerateDevices ... ");
+  o_deviceInfo.clear ();
+
+  std::unique_lock <std::mutex> stateLock (m_stateMutex);
+
+  if (OS_STARTED != m_objectState)
+  {
+    return CR_STOPPED;
+  }
+
+  std::unique_lock <std::mutex> deviceStoreLock (m_deviceStoreMutex);
+  std::unique_lock <std::mutex> deviceDataLock (m_deviceDataMutex);
+
+  const Switch::DeviceStore::DeviceMap& devices = m_pDeviceStore->GetDevices ();
+  Switch::DeviceStore::DeviceMap::const_iterator itDevice;
+  for (itDevice = devices.begin (); devices.end () != itDevice; ++itDevice)
+  {
+    Switch::Interface::Device::Summary deviceSummary;
+
+    deviceSummary.m_deviceId = (*itDevice).first;
+    const Switch::Device& device = (*itDevice).second;
+
+    // set device product information
+    Switch::Interface::Translate (deviceSummary.m_productInfo, device);
+
+    // set device connection information
+    deviceSummary.m_online = device.GetConnectionState ();
+
+    o_deviceInfo.push_back (deviceSummary);
+  }
+
+  SWITCH_DEBUG_MSG_0 ("done\n");
+
+  return CR_OK;
+}
+
+/*!
+  \brief Passes the summaries of a range of devices to a visitor, one at a time.
+
+  The summaries are made and visited under the device store and device data locks, none are kept.
+  Devices are visited in the order of their addresses.
+
+  \param [out] o_nextDeviceAddress  The address to continue from, 0 if all devices were visited.
+  \param [in]  i_visitor            The visitor, it must not call the controller.
+  \param [in]  i_firstDeviceAddress The lowest address of the devices to visit.
+  \param [in]  i_maxNrDevices       The maximum number of devices to visit.
+ */
+Switch::Controller::eCallResult Switch::Controller::VisitDevices (uint32_t& o_nextDeviceAddress, const DeviceSummaryVisitor& i_visitor, const uint32_t& i_firstDeviceAddress, const uint32_t& i_maxNrDevices)
+{
+  o_nextDeviceAddress = 0;
+
+  std::unique_lock <std::mutex> stateLock (m_stateMutex);
+
+  if (OS_STARTED != m_objectState)
+  {
+    return CR_STOPPED;
+  }
+
+  std::unique_lock <std::mutex> deviceStoreLock (m_deviceStoreMutex);
+  std::unique_lock <std::mutex> deviceDataLock (m_deviceDataMutex);
+
+  const Switch::DeviceStore::DeviceMap& devices = m_pDeviceStore->GetDevices ();
+  Switch::DeviceStore::DeviceMap::const_iterator itDevice = devices.lower_bound (static_cast <switch_device_address_type> (i_firstDeviceAddress));
+  Switch::Interface::Device::Summary deviceSummary;
+  for (uint32_t nrDevices = 0; (devices.end () != itDevice) && (i_maxNrDevices > nrDevices); ++itDevice, ++nrDevices)
+  {
+    const Switch::Device& device = itDevice->second;
+    deviceSummary.m_deviceId = itDevice->first;
+    Switch::Interface::Translate (deviceSummary.m_productInfo, device);
+    deviceSummary.m_online = device.GetConnectionState ();
+
+    i_visitor (deviceSummary);
+  }
+  if (devices.end () != itDevice)
+  {
+    o_nextDeviceAddress = itDevice->first;
+  }
+
+  return CR_OK;
+}
+
+Switch::Controller::eCallResult Switch::Controller::GetDeviceDetails (Switch::Interface::Device& o_deviceDetails, const uint32_t& i_deviceAddress)
+{
+  SWITCH_DEBUG_MSG_0 ("GetDeviceDetails ... ");
+
+  std::unique_lock <std::mutex> stateLock (m_stateMutex);
+
+  if (OS_STARTED != m_objectState)
+  {
+    return CR_STOPPED;
+  }
+
+  std::unique_lock <std::mutex> deviceStoreLock (m_deviceStoreMutex);
+
+  const Switch::DeviceStore::DeviceMap& devices = m_pDeviceStore->GetDevices ();
+  Switch::DeviceStore::DeviceMap::const_iterator itDevice = devices.find (i_deviceAddress);
+  if (itDevice == devices.end ())
+  {
+    return CR_UNKNOWN_DEVICE;
+  }
+
+  o_deviceDetails.m_deviceId = (*itDevice).first;
+  const Switch::Device& device = (*itDevice).second;
+
+  // set device product information
+  Switch::Interface::Translate (o_deviceDetails.m_productInfo, device);
+
+  // set device data format information
+  Switch::Interface::Translate (o_deviceDetails.m_dataFormat, device);
+
+  // set device connection information
+  {
+    std::unique_lock <std::mutex> deviceDataLock (m_deviceDataMutex);
+    o_deviceDetails.m_connectionInfo.m_online = device.GetConnectionState ();
+  }
+
+  SWITCH_DEBUG_MSG_0 ("done\n");
+
+  return CR_OK;
+}
+
+Switch::Controller::eCallResult Switch::Controller::GetDeviceCatalogVersion (uint64_t& o_version)
+{
+  std::unique_lock <std::mutex> stateLock (m_stateMutex);
+
+  if (OS_STARTED != m_objectState)
+  {
+    return CR_STOPPED;
+  }
+
+  // the catalog changes when devices are added or identified, or when their connection state changes
+  o_version = m_pDeviceStore->GetVersion () + m_deviceConnectionVersion.load ();
+
+  return CR_OK;
+}
+
+Switch::Controller::eCallResult Switch::Controller::GetDeviceValues (std::list <Switch::Interface::Device::Value>& o_values, const uint32_t& i_deviceAddress)
+{
+  SWITCH_DEBUG_MSG_0 ("GetDeviceValues ... ");
+
+  eCallResult result = _GetDeviceValues (o_values, i_deviceAddress, false);
+
+  SWITCH_DEBUG_MSG_0 ("done\n");
+
+  return result;
 }
 
-boost::signals2::connection Switch::Controller::ConnectToDeviceDataUpdateSignal (const DeviceDataUpdateSignal::slot_type& i_receiver)
+Switch::Controller::eCallResult Switch::Controller::GetDeviceReportedValues (std::list <Switch::Interface::Device::Value>& o_values, const uint32_t& i_deviceAddress)
 {
-  return m_deviceDataUpdateSignal.connect (i_receiver);
+  SWITCH_DEBUG_MSG_0 ("GetDeviceReportedValues ... ");
+
+  eCallResult result = _GetDeviceValues (o_values, i_deviceAddress, true);
+
+  SWITCH_DEBUG_MSG_0 ("done\n");
+
+  return result;
 }
 
-Switch::Controller::eCallResult Switch::Controller::AddDevice (const uint32_t& i_deviceAddress)
+/*!
+  \brief Gets the desired or reported values of a device.
+
+  \param [out] o_values        The values.
+  \param [in]  i_deviceAddress The address of the device.
+  \param [in]  i_reported      Flags to get the reported (true) or desired (false) values.
+
+  \return CR_OK on success, CR_STOPPED if the controller is not started, CR_UNKNOWN_DEVICE if the device is not known.
+ */
+Switch::Controller::eCallResult Switch::Controller::_GetDeviceValues (std::list <Switch::Interface::Device::Value>& o_values, const uint32_t& i_deviceAddress, const bool& i_reported)
 {
-  SWITCH_DEBUG_MSG_0 ("AddDevice ... ");
+  o_values.clear ();
 
   std::unique_lock <std::mutex> stateLock (m_stateMutex);
 
@@ -698,21 +1976,41 @@ Switch::Controller::eCallResult Switch::Controller::AddDevice (const uint32_t& i
     return CR_STOPPED;
   }
 
-  std::unique_lock <std::mutex> interfaceDataLock (m_interfaceDataMutex);
-
-  m_dataAddDevice.push_back (static_cast <switch_device_address_type> (i_deviceAddress));
+  std::unique_lock <std::mutex> deviceStoreLock (m_deviceStoreMutex);
 
-  m_updateCondition.notify_all ();
+  // find the device
+  const Switch::DeviceStore::DeviceMap& devices = m_pDeviceStore->GetDevices ();
+  Switch::DeviceStore::DeviceMap::const_iterator itDevice = devices.find (i_deviceAddress);
+  if (itDevice == devices.end ())
+  {
+    return CR_UNKNOWN_DEVICE;
+  }
 
-  SWITCH_DEBUG_MSG_0 ("done\n");
+  // translate the device's data values
+  const Switch::Device& device = itDevice->second;
+  std::list <Switch::DataContainer::Element> containerElements;
+  std::unique_lock <std::mutex> deviceDataLock (m_deviceDataMutex);
+  _TranslateDeviceValues (o_values, containerElements, i_reported ? device.GetReportedDataContainer () : device.GetDataContainer ());
 
   return CR_OK;
 }
 
-Switch::Controller::eCallResult Switch::Controller::EnumerateDevices (std::list <Switch::Interface::Device::Summary>& o_deviceInfo)
+/*!
+  \brief Gets the desired values of several devices at once.
+
+  All values are read under a single lock of the device store, the devices are consistent
+  with each other.
+
+  \param [out] o_values          The values, mapped to from the device addresses. Unknown devices are left out.
+  \param [in]  i_deviceAddresses The addresses of the devices.
+
+  \return CR_OK on success, CR_STOPPED if the controller is not started.
+ */
+Switch::Controller::eCallResult Switch::Controller::GetMultipleDeviceValues (std::map <uint32_t, std::list <Switch::Interface::Device::Value>>& o_values, const std::set <uint32_t>& i_deviceAddresses)
 {
-  SWITCH_DEBUG_MSG_0 ("EnumerateDevices ... ");
-  o_deviceInfo.clear ();
+  SWITCH_DEBUG_MSG_0 ("GetMultipleDeviceValues ... ");
+
+  o_values.clear ();
 
   std::unique_lock <std::mutex> stateLock (m_stateMutex);
 
@@ -721,22 +2019,82 @@ Switch::Controller::eCallResult Switch::Controller::EnumerateDevices (std::list
     return CR_STOPPED;
   }
 
+  std::unique_lock <std::mutex> deviceStoreLock (m_deviceStoreMutex);
+  std::unique_lock <std::mutex> deviceDataLock (m_deviceDataMutex);
+
+  // walk the addresses and the devices side by side, both are ordered by address
   const Switch::DeviceStore::DeviceMap& devices = m_pDeviceStore->GetDevices ();
-  Switch::DeviceStore::DeviceMap::const_iterator itDevice;
-  for (itDevice = devices.begin (); devices.end () != itDevice; ++itDevice)
+  Switch::DeviceStore::DeviceMap::const_iterator itDevice = devices.begin ();
+  std::set <uint32_t>::const_iterator itAddress = i_deviceAddresses.begin ();
+  std::list <Switch::DataContainer::Element> containerElements;
+  while ((i_deviceAddresses.end () != itAddress) && (devices.end () != itDevice))
   {
-    Switch::Interface::Device::Summary deviceSummary;
+    if (*itAddress < itDevice->first)
+    {
+      ++itAddress;
+    }
+    else if (itDevice->first < *itAddress)
+    {
+      itDevice = devices.lower_bound (*itAddress);
+    }
+    else
+    {
+      _TranslateDeviceValues (o_values [itDevice->first], containerElements, itDevice->second.GetDataContainer ());
+      ++itAddress;
+      ++itDevice;
+    }
+  }
 
-    deviceSummary.m_deviceId = (*itDevice).first;
-    const Switch::Device& device = (*itDevice).second;
+  SWITCH_DEBUG_MSG_0 ("done\n");
 
-    // set device product information
-    Switch::Interface::Translate (deviceSummary.m_productInfo, device);
+  return CR_OK;
+}
 
-    // set device connection information
-    deviceSummary.m_online = device.GetConnectionState ();
+/*!
+  \brief Translates the elements of a data container into interface values.
 
-    o_deviceInfo.push_back (deviceSummary);
+  \param [out]    o_values              The values, appended to.
+  \param [in,out] io_containerElements  Scratch list of the elements, reused between devices.
+  \param [in]     i_dataContainer       The data container.
+ */
+void Switch::Controller::_TranslateDeviceValues (std::list <Switch::Interface::Device::Value>& o_values, std::list <Switch::DataContainer::Element>& io_containerElements, const Switch::DataContainer& i_dataContainer) const
+{
+  // note: the container appends its elements
+  io_containerElements.clear ();
+  i_dataContainer.GetElements (io_containerElements);
+  std::list <Switch::DataContainer::Element>::const_iterator itElement;
+  for (itElement = io_containerElements.begin (); io_containerElements.end () != itElement; ++itElement)
+  {
+    o_values.push_back (Switch::Interface::Device::Value ());
+    Switch::Interface::Translate (o_values.back (), *itElement);
+  }
+}
+
+Switch::Controller::eCallResult Switch::Controller::SetDeviceValues (const uint32_t& i_deviceAddress, const std::list <Switch::Interface::Device::Value>& i_values)
+{
+  SWITCH_DEBUG_MSG_0 ("SetDeviceValues ... ");
+
+  std::unique_lock <std::mutex> stateLock (m_stateMutex);
+
+  if (OS_STARTED != m_objectState)
+  {
+    return CR_STOPPED;
+  }
+
+  std::unique_lock <std::mutex> interfaceDataLock (m_interfaceDataMutex);
+
+  // merge with the pending values of the device, new commands are only admitted within the backlog limits
+  bool newWindow = (m_dataSetDeviceValues.end () == m_dataSetDeviceValues.find (i_deviceAddress));
+  if (newWindow && _IsBacklogFull (_GetNrQueuedCommands () + 1))
+  {
+    SWITCH_DEBUG_MSG_0 ("busy\n");
+    return CR_BUSY;
+  }
+  _QueueDeviceValues (i_deviceAddress, i_values, std::chrono::high_resolution_clock::now () + std::chrono::microseconds (m_setDeviceValuesWindowMicros));
+  if (newWindow)
+  {
+    // wake up the controller to schedule the transmission
+    m_updateCondition.notify_all ();
   }
 
   SWITCH_DEBUG_MSG_0 ("done\n");
@@ -744,9 +2102,23 @@ Switch::Controller::eCallResult Switch::Controller::EnumerateDevices (std::list
   return CR_OK;
 }
 
-Switch::Controller::eCallResult Switch::Controller::GetDeviceDetails (Switch::Interface::Device& o_deviceDetails, const uint32_t& i_deviceAddress)
+/*!
+  \brief Sets the desired values of several devices, transmitted to them as one batch.
+
+  The values of the known devices are queued, the call does not wait for their transmission.
+  Whether the devices confirmed their values is queried with GetSceneResults.
+
+  \param [out] o_results The result per device: CR_OK if its values were queued, CR_UNKNOWN_DEVICE or CR_BUSY otherwise.
+  \param [out] o_sceneId The id of the scene, valid if the values were queued.
+  \param [in]  i_values  The values, mapped to from the device addresses.
+
+  \return CR_OK if the values were queued, CR_BUSY if the scene was rejected as a whole, CR_STOPPED if the controller is not started.
+ */
+Switch::Controller::eCallResult Switch::Controller::SetMultipleDeviceValues (std::map <uint32_t, eCallResult>& o_results, uint32_t& o_sceneId, const std::map <uint32_t, std::list <Switch::Interface::Device::Value>>& i_values)
 {
-  SWITCH_DEBUG_MSG_0 ("GetDeviceDetails ... ");
+  SWITCH_DEBUG_MSG_0 ("SetMultipleDeviceValues ... ");
+
+  o_results.clear ();
 
   std::unique_lock <std::mutex> stateLock (m_stateMutex);
 
@@ -755,35 +2127,98 @@ Switch::Controller::eCallResult Switch::Controller::GetDeviceDetails (Switch::In
     return CR_STOPPED;
   }
 
-  const Switch::DeviceStore::DeviceMap& devices = m_pDeviceStore->GetDevices ();
-  Switch::DeviceStore::DeviceMap::const_iterator itDevice = devices.find (i_deviceAddress);
-  if (itDevice == devices.end ())
+  // check which devices are known
+  std::map <uint32_t, std::list <Switch::Interface::Device::Value>>::const_iterator itValues;
   {
-    return CR_UNKNOWN_DEVICE;
+    std::unique_lock <std::mutex> deviceStoreLock (m_deviceStoreMutex);
+
+    const Switch::DeviceStore::DeviceMap& devices = m_pDeviceStore->GetDevices ();
+    for (itValues = i_values.begin (); i_values.end () != itValues; ++itValues)
+    {
+      o_results [itValues->first] = (devices.end () != devices.find (itValues->first)) ? CR_OK : CR_UNKNOWN_DEVICE;
+    }
   }
 
-  o_deviceDetails.m_deviceId = (*itDevice).first;
-  const Switch::Device& device = (*itDevice).second;
+  // queue the values of all known devices
+  // note: the values are due immediately, they are transmitted as one batch in the next controller cycle
+  std::chrono::high_resolution_clock::time_point now = std::chrono::high_resolution_clock::now ();
 
-  // set device product information
-  Switch::Interface::Translate (o_deviceDetails.m_productInfo, device);
+  std::unique_lock <std::mutex> interfaceDataLock (m_interfaceDataMutex);
 
-  // set device data format information
-  Switch::Interface::Translate (o_deviceDetails.m_dataFormat, device);
+  // note: a scene is admitted as a whole, or rejected as a whole
+  uint32_t nrQueuedCommands = _GetNrQueuedCommands ();
+  for (itValues = i_values.begin (); i_values.end () != itValues; ++itValues)
+  {
+    if ((CR_OK == o_results [itValues->first]) && (m_dataSetDeviceValues.end () == m_dataSetDeviceValues.find (itValues->first)))
+    {
+      ++nrQueuedCommands;
+    }
+  }
+  if (_IsBacklogFull (nrQueuedCommands))
+  {
+    std::map <uint32_t, eCallResult>::iterator itResult;
+    for (itResult = o_results.begin (); o_results.end () != itResult; ++itResult)
+    {
+      if (CR_OK == itResult->second)
+      {
+        itResult->second = CR_BUSY;
+      }
+    }
+    SWITCH_DEBUG_MSG_0 ("busy\n");
+    return CR_BUSY;
+  }
 
-  // set device connection information
-  o_deviceDetails.m_connectionInfo.m_online = device.GetConnectionState ();
+  // track the scene until all its devices confirmed their values
+  {
+    std::unique_lock <std::mutex> scenesLock (m_scenesMutex);
+
+    o_sceneId = m_nextSceneId++;
+    Scene& scene = m_scenes [o_sceneId];
+    std::map <uint32_t, eCallResult>::const_iterator itResult;
+    for (itResult = o_results.begin (); o_results.end () != itResult; ++itResult)
+    {
+      scene.m_results [itResult->first] = (CR_OK == itResult->second) ? CR_PENDING : itResult->second;
+    }
+
+    // forget the oldest scenes
+    while (CONTROLLER_MAX_NR_SCENES < m_scenes.size ())
+    {
+      m_scenes.erase (m_scenes.begin ());
+    }
+  }
+
+  for (itValues = i_values.begin (); i_values.end () != itValues; ++itValues)
+  {
+    if (CR_OK == o_results [itValues->first])
+    {
+      switch_device_address_type deviceAddress = static_cast <switch_device_address_type> (itValues->first);
+      _QueueDeviceValues (deviceAddress, itValues->second, now);
+      m_dataSetDeviceValues [deviceAddress].m_sceneIds.push_back (o_sceneId);
+    }
+  }
+
+  m_updateCondition.notify_all ();
 
   SWITCH_DEBUG_MSG_0 ("done\n");
 
   return CR_OK;
 }
 
-Switch::Controller::eCallResult Switch::Controller::GetDeviceValues (std::list <Switch::Interface::Device::Value>& o_values, const uint32_t& i_deviceAddress)
+/*!
+  \brief Gets the result per device of a scene set by SetMultipleDeviceValues.
+
+  \param [out] o_results The result per device: CR_PENDING while the device did not confirm its values,
+                          CR_OK once it did, CR_NOT_CONFIRMED if its retransmissions were given up,
+                          CR_UNKNOWN_DEVICE or CR_BUSY if its values were not queued.
+  \param [in]  i_sceneId The id of the scene.
+
+  \return CR_OK if the scene is known, CR_INVALID if it is unknown or was forgotten, CR_STOPPED if the controller is not started.
+ */
+Switch::Controller::eCallResult Switch::Controller::GetSceneResults (std::map <uint32_t, eCallResult>& o_results, const uint32_t& i_sceneId)
 {
-  SWITCH_DEBUG_MSG_0 ("GetDeviceValues ... ");
+  SWITCH_DEBUG_MSG_0 ("GetSceneResults ... ");
 
-  o_values.clear ();
+  o_results.clear ();
 
   std::unique_lock <std::mutex> stateLock (m_stateMutex);
 
@@ -792,25 +2227,137 @@ Switch::Controller::eCallResult Switch::Controller::GetDeviceValues (std::list <
     return CR_STOPPED;
   }
 
-  // find the device
-  const Switch::DeviceStore::DeviceMap& devices = m_pDeviceStore->GetDevices ();
-  Switch::DeviceStore::DeviceMap::const_iterator itDevice = devices.find (i_deviceAddress);
-  if (itDevice == devices.end ())
+  std::unique_lock <std::mutex> scenesLock (m_scenesMutex);
+
+  std::map <uint32_t, Scene>::const_iterator itScene = m_scenes.find (i_sceneId);
+  if (m_scenes.end () == itScene)
   {
-    return CR_UNKNOWN_DEVICE;
+    SWITCH_DEBUG_MSG_0 ("unknown scene\n");
+    return CR_INVALID;
   }
+  o_results = itScene->second.m_results;
 
-  // translate the device's data values
-  const Switch::Device& device = itDevice->second;
-  const Switch::DataContainer& dataContainer = device.GetDataContainer ();
+  SWITCH_DEBUG_MSG_0 ("done\n");
+
+  return CR_OK;
+}
+
+/*!
+  \brief Gets the number of queued commands and the estimated time to transmit them.
+
+  Commands are the values waiting for their merge window and the payloads handed to
+  the router of which the transmission result is pending.
+
+  \param [out] o_nrQueuedCommands The number of queued commands.
+  \param [out] o_drainTimeMicros  The estimated time in microseconds to transmit them.
+ */
+Switch::Controller::eCallResult Switch::Controller::GetCommandBacklog (uint32_t& o_nrQueuedCommands, uint32_t& o_drainTimeMicros)
+{
+  std::unique_lock <std::mutex> stateLock (m_stateMutex);
+
+  if (OS_STARTED != m_objectState)
+  {
+    return CR_STOPPED;
+  }
+
+  std::unique_lock <std::mutex> interfaceDataLock (m_interfaceDataMutex);
+
+  o_nrQueuedCommands = _GetNrQueuedCommands ();
+  o_drainTimeMicros  = _GetDrainTimeMicros (o_nrQueuedCommands);
+
+  return CR_OK;
+}
+
+/*!
+  \brief Gets the devices and desired values changed since a version.
+
+  Versions not issued since the start of the controller, such as 0 or the versions of a
+  previous run, get all devices and values.
+
+  \param [out] o_version The version of the latest change, to pass in the next call.
+  \param [out] o_devices The summaries of the devices of which the type or connection state changed.
+  \param [out] o_values  The changed desired values, mapped to from the device addresses.
+  \param [in]  i_version The version returned by the previous call.
+ */
+Switch::Controller::eCallResult Switch::Controller::GetChangesSince (uint64_t& o_version, std::list <Switch::Interface::Device::Summary>& o_devices, std::map <uint32_t, std::list <Switch::Interface::Device::Value>>& o_values, const uint64_t& i_version)
+{
+  SWITCH_DEBUG_MSG_0 ("GetChangesSince ... ");
+
+  o_devices.clear ();
+  o_values.clear ();
+
+  std::unique_lock <std::mutex> stateLock (m_stateMutex);
+
+  if (OS_STARTED != m_objectState)
+  {
+    return CR_STOPPED;
+  }
+
+  std::unique_lock <std::mutex> deviceStoreLock (m_deviceStoreMutex);
+  std::unique_lock <std::mutex> deviceDataLock (m_deviceDataMutex);
+  std::unique_lock <std::mutex> changeVersionsLock (m_changeVersionsMutex);
+
+  o_version = m_changeVersionLog.GetVersion ();
+  const bool allChanged = !m_changeVersionLog.IsKnown (i_version);
+  const Switch::ChangeVersionLog::device_versions_type& changeVersions = m_changeVersionLog.GetDeviceVersions ();
+  const Switch::DeviceStore::DeviceMap& devices = m_pDeviceStore->GetDevices ();
+  Switch::DeviceStore::DeviceMap::const_iterator itDevice = devices.begin ();
+  Switch::ChangeVersionLog::device_versions_type::const_iterator itVersions = changeVersions.begin ();
   std::list <Switch::DataContainer::Element> containerElements;
-  dataContainer.GetElements (containerElements);
-  std::list <Switch::DataContainer::Element>::iterator itElement;
-  for (itElement = containerElements.begin (); containerElements.end () != itElement; ++itElement)
+  while (devices.end () != itDevice)
   {
-    Switch::Interface::Device::Value value;
-    Switch::Interface::Translate (value, *itElement);
-    o_values.push_back (value);
+    // walk the devices and their change versions side by side, both are ordered by address
+    if (!allChanged)
+    {
+      while ((changeVersions.end () != itVersions) && (itDevice->first > itVersions->first))
+      {
+        ++itVersions;
+      }
+      if (changeVersions.end () == itVersions)
+      {
+        break;
+      }
+      if ((itDevice->first < itVersions->first) || (i_version >= itVersions->second.m_version))
+      {
+        ++itDevice;
+        continue;
+      }
+    }
+    const Switch::Device& device = itDevice->second;
+    const Switch::ChangeVersionLog::DeviceVersions* pVersions = allChanged ? 0x0 : &itVersions->second;
+
+    if ((0x0 == pVersions) || pVersions->HasSummaryChangedSince (i_version))
+    {
+      Switch::Interface::Device::Summary deviceSummary;
+      deviceSummary.m_deviceId = itDevice->first;
+      Switch::Interface::Translate (deviceSummary.m_productInfo, device);
+      deviceSummary.m_online = device.GetConnectionState ();
+      o_devices.push_back (deviceSummary);
+    }
+
+    const bool allValuesChanged = (0x0 == pVersions) || pVersions->HaveAllValuesChangedSince (i_version);
+    if (allValuesChanged || !pVersions->m_elementVersions.empty ())
+    {
+      std::list <Switch::Interface::Device::Value> values;
+      containerElements.clear ();
+      device.GetDataContainer ().GetElements (containerElements);
+      std::list <Switch::DataContainer::Element>::const_iterator itElement;
+      for (itElement = containerElements.begin (); containerElements.end () != itElement; ++itElement)
+      {
+        if (!allValuesChanged && !pVersions->HasElementChangedSince (itElement->m_address, i_version))
+        {
+          continue;
+        }
+        values.push_back (Switch::Interface::Device::Value ());
+        Switch::Interface::Translate (values.back (), *itElement);
+      }
+      if (!values.empty ())
+      {
+        o_values [itDevice->first].swap (values);
+      }
+    }
+
+    ++itDevice;
   }
 
   SWITCH_DEBUG_MSG_0 ("done\n");
@@ -818,9 +2365,9 @@ Switch::Controller::eCallResult Switch::Controller::GetDeviceValues (std::list <
   return CR_OK;
 }
 
-Switch::Controller::eCallResult Switch::Controller::SetDeviceValues (const uint32_t& i_deviceAddress, const std::list <Switch::Interface::Device::Value>& i_values)
+Switch::Controller::eCallResult Switch::Controller::AddSchedule (uint32_t& o_scheduleId, const Switch::Schedule& i_schedule)
 {
-  SWITCH_DEBUG_MSG_0 ("SetDeviceValues ... ");
+  SWITCH_DEBUG_MSG_0 ("AddSchedule ... ");
 
   std::unique_lock <std::mutex> stateLock (m_stateMutex);
 
@@ -829,17 +2376,55 @@ Switch::Controller::eCallResult Switch::Controller::SetDeviceValues (const uint3
     return CR_STOPPED;
   }
 
-  std::unique_lock <std::mutex> interfaceDataLock (m_interfaceDataMutex);
+  if (!i_schedule.IsValid ())
+  {
+    return CR_INVALID;
+  }
 
-  m_dataSetDeviceValues.push_back (std::make_pair (i_deviceAddress, std::list <Switch::DataContainer::Element> ()));
+  {
+    std::unique_lock <std::mutex> deviceStoreLock (m_deviceStoreMutex);
 
-  std::list <Switch::DataContainer::Element>& containerElements = m_dataSetDeviceValues.back ().second;
-  std::list <Switch::Interface::Device::Value>::const_iterator itValue;
-  for (itValue = i_values.begin (); i_values.end () != itValue; ++itValue)
+    const Switch::DeviceStore::DeviceMap& devices = m_pDeviceStore->GetDevices ();
+    if (devices.end () == devices.find (i_schedule.m_deviceAddress))
+    {
+      return CR_UNKNOWN_DEVICE;
+    }
+
+    // persist the schedule
+    std::stringstream definitionStream;
+    Switch::JsonSerializer::Serialize (definitionStream, i_schedule);
+    o_scheduleId = m_pDeviceStore->AddSchedule (definitionStream.str ());
+  }
+
+  // arm the schedule and wake up the controller to account for its time
+  m_scheduler.AddSchedule (o_scheduleId, i_schedule);
+  m_updateCondition.notify_all ();
+
+  SWITCH_DEBUG_MSG_0 ("done\n");
+
+  return CR_OK;
+}
+
+Switch::Controller::eCallResult Switch::Controller::RemoveSchedule (const uint32_t& i_scheduleId)
+{
+  SWITCH_DEBUG_MSG_0 ("RemoveSchedule ... ");
+
+  std::unique_lock <std::mutex> stateLock (m_stateMutex);
+
+  if (OS_STARTED != m_objectState)
   {
-    Switch::DataContainer::Element element;
-    Switch::Interface::Translate (element, *itValue);
-    containerElements.push_back (element);
+    return CR_STOPPED;
+  }
+
+  // note: one-shot schedules that fired are already removed
+  if (!m_scheduler.RemoveSchedule (i_scheduleId))
+  {
+    return CR_INVALID;
+  }
+
+  {
+    std::unique_lock <std::mutex> deviceStoreLock (m_deviceStoreMutex);
+    m_pDeviceStore->RemoveSchedule (i_scheduleId);
   }
 
   SWITCH_DEBUG_MSG_0 ("done\n");
@@ -847,3 +2432,16 @@ Switch::Controller::eCallResult Switch::Controller::SetDeviceValues (const uint3
   return CR_OK;
 }
 
+Switch::Controller::eCallResult Switch::Controller::EnumerateSchedules (std::map <uint32_t, Switch::Schedule>& o_schedules)
+{
+  std::unique_lock <std::mutex> stateLock (m_stateMutex);
+
+  if (OS_STARTED != m_objectState)
+  {
+    return CR_STOPPED;
+  }
+
+  m_scheduler.GetSchedules (o_schedules);
+
+  return CR_OK;
+}
@@ -27,6 +27,10 @@
 // project includes
 #include "Switch_InterfaceDevice.h"
 #include "Switch_ControllerFunctionalInterface.h"
+#include "Switch_RouterEventQueue.h"
+#include "Switch_RuleEngine.h"
+#include "Switch_Scheduler.h"
+#include "Switch_ChangeVersionLog.h"
 
 // switch includes
 #include <Switch_Base/Switch_CompilerConfiguration.h>
@@ -39,9 +43,9 @@
 #include <thread>
 #include <condition_variable>
 #include <atomic>
-
-#define BOOST_BIND_NO_PLACEHOLDERS
-#include <boost/signals2.hpp>
+#include <chrono>
+#include <map>
+#include <deque>
 
 
 namespace Switch
@@ -50,13 +54,15 @@ namespace Switch
   class DeviceStore;
   class Router;
   class DataPayload;
+  class Device;
+  class ControllerWorkerPool;
 
   class Controller : public ControllerFunctionalInterface, public Switch::ApplicationModule
   {
   public:
 
-    typedef boost::signals2::signal <void (const uint32_t&, const Switch::Interface::Device::Connection&)> DeviceConnectionUpdateSignal;
-    typedef boost::signals2::signal <void (const uint32_t&, const std::list <Switch::Interface::Device::Value>&)> DeviceDataUpdateSignal;
+    typedef Switch::ObserverRegistry <const uint32_t&, const Switch::Interface::Device::Connection&> DeviceConnectionUpdateSignal;
+    typedef Switch::ObserverRegistry <const uint32_t&, const std::list <Switch::Interface::Device::Value>&> DeviceDataUpdateSignal;
 
     /*!
       \brief Parameters container class
@@ -80,6 +86,13 @@ namespace Switch
 
       // parameter members
       uint32_t    m_updateCycleTimeMicros;            ///< The time in microseconds between two update cycles.
+      uint32_t    m_nrWorkerThreads;                  ///< The number of worker threads handling device data. Zero handles all data on the controller thread.
+      uint32_t    m_setDeviceValuesWindowMicros;      ///< The time in microseconds during which values set in the same device are merged into one transmission.
+      std::string m_rulesFile;                        ///< Path to the file with the automation rules.
+      uint32_t    m_maxNrRetransmissions;             ///< The maximum number of retransmissions of desired values not confirmed by a device.
+      uint32_t    m_maxNrRetransmissionsPerSecond;    ///< The maximum number of retransmissions per second, shared by all devices.
+      uint32_t    m_maxNrQueuedCommands;              ///< The number of queued commands above which new commands are rejected. Zero for no limit.
+      uint32_t    m_maxCommandDrainTimeMicros;        ///< The estimated time in microseconds to drain the queued commands above which new commands are rejected. Zero for no limit.
     };
 
     /*!
@@ -102,15 +115,28 @@ namespace Switch
     Controller& operator= (const Controller& i_other) = delete;
 
     // signals
-    boost::signals2::connection ConnectToDeviceConnectionUpdateSignal (const DeviceConnectionUpdateSlot& i_receiver);
-    boost::signals2::connection ConnectToDeviceDataUpdateSignal (const DeviceDataUpdateSlot& i_receiver);
+    Switch::ObserverConnection ConnectToDeviceConnectionUpdateSignal (const DeviceConnectionUpdateSlot& i_receiver);
+    Switch::ObserverConnection ConnectToDeviceDataUpdateSignal (const DeviceDataUpdateSlot& i_receiver);
 
     // functionality
     eCallResult AddDevice        (const uint32_t& i_deviceAddress);
     eCallResult EnumerateDevices (std::list <Switch::Interface::Device::Summary>& o_deviceInfo);
+    eCallResult VisitDevices     (uint32_t& o_nextDeviceAddress, const DeviceSummaryVisitor& i_visitor, const uint32_t& i_firstDeviceAddress, const uint32_t& i_maxNrDevices);
     eCallResult GetDeviceDetails (Switch::Interface::Device& o_deviceDetails, const uint32_t& i_deviceAddress);
+    eCallResult GetDeviceCatalogVersion (uint64_t& o_version);
     eCallResult GetDeviceValues  (std::list <Switch::Interface::Device::Value>& o_values, const uint32_t& i_deviceAddress);
+    eCallResult GetMultipleDeviceValues (std::map <uint32_t, std::list <Switch::Interface::Device::Value>>& o_values, const std::set <uint32_t>& i_deviceAddresses);
+    eCallResult GetDeviceReportedValues (std::list <Switch::Interface::Device::Value>& o_values, const uint32_t& i_deviceAddress);
     eCallResult SetDeviceValues  (const uint32_t& i_deviceAddress, const std::list <Switch::Interface::Device::Value>& i_values);
+    eCallResult SetMultipleDeviceValues (std::map <uint32_t, eCallResult>& o_results, uint32_t& o_sceneId, const std::map <uint32_t, std::list <Switch::Interface::Device::Value>>& i_values);
+    eCallResult GetSceneResults (std::map <uint32_t, eCallResult>& o_results, const uint32_t& i_sceneId);
+    eCallResult GetCommandBacklog (uint32_t& o_nrQueuedCommands, uint32_t& o_drainTimeMicros);
+    eCallResult GetChangesSince  (uint64_t& o_version, std::list <Switch::Interface::Device::Summary>& o_devices, std::map <uint32_t, std::list <Switch::Interface::Device::Value>>& o_values, const uint64_t& i_version);
+
+    // schedules
+    eCallResult AddSchedule        (uint32_t& o_scheduleId, const Switch::Schedule& i_schedule);
+    eCallResult RemoveSchedule     (const uint32_t& i_scheduleId);
+    eCallResult EnumerateSchedules (std::map <uint32_t, Switch::Schedule>& o_schedules);
 
   protected:
 
@@ -125,21 +151,83 @@ namespace Switch
 
   private:
 
+    /*!
+      \brief Values to set in a device, waiting to be transmitted.
+     */
+    class PendingDeviceValues
+    {
+    public:
+      std::chrono::high_resolution_clock::time_point  m_deadline;   ///< The time at which the values must be transmitted.
+      std::list <Switch::DataContainer::Element>      m_elements;   ///< The merged elements. Holds at most one element per address.
+      std::list <uint32_t>                            m_sceneIds;   ///< The scenes waiting for the device to confirm the elements.
+    };
+
+    /*!
+      \brief Reconciliation state of a device of which the desired values are not yet confirmed.
+     */
+    class ReconcileState
+    {
+    public:
+      std::deque <Switch::DataPayload>                m_inFlight;           ///< Payloads handed to the router, of which the transmission result is pending. In order of transmission.
+      bool                                            m_pending;            ///< Flags if a retransmission is due at m_nextAttempt.
+      std::chrono::high_resolution_clock::time_point  m_nextAttempt;        ///< The time of the next retransmission.
+      uint32_t                                        m_nrRetransmissions;  ///< The number of retransmissions since the desired values were last set.
+      std::list <uint32_t>                            m_sceneIds;           ///< The scenes waiting for the device to confirm its desired values.
+    };
+
+    /*!
+      \brief Scene set by SetMultipleDeviceValues, holding the result of each of its devices.
+     */
+    class Scene
+    {
+    public:
+      std::map <uint32_t, eCallResult>                m_results;            ///< The result per device. CR_PENDING until the device confirmed its values or they were given up.
+    };
+
     // utility methods
     void _Construct ();
     void _Run ();
-    bool _HandleDataNewNodeDiscovered ();
-    bool _HandleDataNodeConnectionUpdate ();
-    bool _HandleDataNodeDataReceived ();
-    bool _HandleDataNodeDataTransmitted ();
+    bool _HandleRouterEvents ();
+    void _HandleRouterEvent (const Switch::RouterEvent& i_event);
+    void _HandleNewNodeDiscovered (const switch_device_address_type& i_deviceAddress, const Switch::DeviceInfo& i_deviceInfo);
+    void _HandleNodeConnectionUpdate (const switch_device_address_type& i_deviceAddress, const bool& i_connected);
+    void _HandleNodeDataReceived (const switch_device_address_type& i_deviceAddress, const Switch::DataPayload& i_dataPayload);
+    void _HandleNodeDataTransmitted (const switch_device_address_type& i_deviceAddress, const bool& i_result);
+    void _EmitDeviceDataUpdate (const switch_device_address_type& i_deviceAddress, const std::list <Switch::DataContainer::Element>& i_changedElements);
     bool _HandleDataAddDevice ();
     bool _HandleDataSetDeviceValues ();
+    uint32_t _GetSetDeviceValuesDelayMicros () const;
+    void _HandleSetDeviceValues (const switch_device_address_type& i_deviceAddress, const std::list <Switch::DataContainer::Element>& i_elements, const std::list <uint32_t>& i_sceneIds);
+    void _TransmitDesiredContent (const switch_device_address_type& i_deviceAddress, const Switch::Device& i_device, const bool& i_retransmission);
+    bool _ReconcileDevices ();
+    void _ReconcileDevice (const switch_device_address_type& i_deviceAddress);
+    void _UpdateReconcileState (const switch_device_address_type& i_deviceAddress, const Switch::Device& i_device);
+    uint32_t _GetReconcileDelayMicros () const;
+    void _WaitForConfirmation (const switch_device_address_type& i_deviceAddress, const Switch::Device& i_device, const std::list <uint32_t>& i_sceneIds);
+    void _CompleteScenes (const std::list <uint32_t>& i_sceneIds, const switch_device_address_type& i_deviceAddress, const eCallResult& i_result);
+    eCallResult _GetDeviceValues (std::list <Switch::Interface::Device::Value>& o_values, const uint32_t& i_deviceAddress, const bool& i_reported);
+    void _TranslateDeviceValues (std::list <Switch::Interface::Device::Value>& o_values, std::list <Switch::DataContainer::Element>& io_containerElements, const Switch::DataContainer& i_dataContainer) const;
+    void _QueueDeviceValues (const switch_device_address_type& i_deviceAddress, const std::list <Switch::Interface::Device::Value>& i_values, const std::chrono::high_resolution_clock::time_point& i_deadline);
+    void _QueueDeviceElements (const switch_device_address_type& i_deviceAddress, const std::list <Switch::DataContainer::Element>& i_elements, const std::chrono::high_resolution_clock::time_point& i_deadline);
+    void _TransmitPendingData ();
+    uint32_t _GetNrQueuedCommands () const;
+    uint32_t _GetDrainTimeMicros (const uint32_t& i_nrQueuedCommands) const;
+    bool _IsBacklogFull (const uint32_t& i_nrQueuedCommands) const;
+    void _RecordSummaryChange (const switch_device_address_type& i_deviceAddress, const bool& i_allValues);
+    void _RecordValueChanges (const switch_device_address_type& i_deviceAddress, const std::list <Switch::DataContainer::Element>& i_changedElements);
+    void _LoadRules ();
+    void _ExecuteRuleActions (const std::list <Switch::Rule::Action>& i_actions);
+    void _LoadSchedules ();
+    bool _HandleSchedules ();
 
     // callback handlers
     void _OnRouterNewNodeDiscovered (const switch_device_address_type& i_deviceAddress, const Switch::DeviceInfo& i_deviceInfo);
     void _OnRouterNodeConnectionUpdate (const switch_device_address_type& i_deviceAddress, const bool& i_connected);
     bool _OnRouterNodeDataReceived (const switch_device_address_type& i_deviceAddress, const Switch::DataPayload& i_dataPayload);
     void _OnRouterNodeDataTransmitted (const switch_device_address_type& i_deviceAddress, const bool& i_result);
+    void _OnRouterCycleCompleted ();
+    bool _PostRouterEvent (const Switch::RouterEvent& i_event, const bool& i_wait);
+    void _PostRetainedRxMessages ();
 
     // variables
 
@@ -154,23 +242,59 @@ namespace Switch
     DeviceDataUpdateSignal        m_deviceDataUpdateSignal;
 
     // router callback variables
-    mutable std::mutex m_routerDataMutex;
-    std::list <std::pair <switch_device_address_type, Switch::DeviceInfo>>  m_dataNewNodeDiscovered;
-    std::list <std::pair <switch_device_address_type, bool>>                m_dataNodeConnectionUpdate;
-    std::list <std::pair <switch_device_address_type, Switch::DataPayload>> m_dataNodeDataReceived;
-    std::list <std::pair <switch_device_address_type, bool>>                m_dataNodeDataTransmitted;
+    Switch::RouterEventQueue  m_routerEventQueue;     ///< Events posted by the router thread, handled by the controller thread.
+    std::atomic <bool>        m_routerEventsPosted;   ///< Flags if events were posted since the last wakeup of the controller thread.
+    bool                      m_rxMessagesRetained;   ///< Flags if received data is retained in the router's rx message queue. Router thread only.
 
     // interface input variables
     mutable std::mutex m_interfaceDataMutex;
     std::list <switch_device_address_type>                                                          m_dataAddDevice;
-    std::list <std::pair <switch_device_address_type, std::list <Switch::DataContainer::Element>>>  m_dataSetDeviceValues;
+    std::map <switch_device_address_type, PendingDeviceValues>                                      m_dataSetDeviceValues;
+    std::list <switch_device_address_type>                                                          m_dataSetDeviceValuesOrder;   ///< Devices with pending values, in order of arrival.
+
+    // transmit variables
+    mutable std::mutex m_transmitDataMutex;
+    std::list <std::pair <switch_device_address_type, Switch::DataPayload>>                         m_transmitData;               ///< Payloads to hand over to the router as one batch.
+
+    // reconciliation variables
+    mutable std::mutex                                          m_reconcileMutex;
+    std::map <switch_device_address_type, ReconcileState>       m_reconcileStates;        ///< Devices with unconfirmed desired values or pending transmission results.
+    double                                                      m_reconcileBudget;        ///< The number of retransmissions that may be started. Only used by the controller thread.
+    std::chrono::high_resolution_clock::time_point              m_reconcileBudgetTime;    ///< The time the budget was last refilled.
+
+    // scene variables
+    mutable std::mutex                                          m_scenesMutex;            ///< Protects the scenes, locked after m_interfaceDataMutex. Not locked together with m_reconcileMutex.
+    std::map <uint32_t, Scene>                                  m_scenes;                 ///< The most recent scenes, by increasing id.
+    uint32_t                                                    m_nextSceneId;            ///< The id of the next scene.
+
+    // admission variables
+    std::atomic <uint32_t>                                      m_nrPayloadsInFlight;     ///< The number of payloads handed to the router of which the transmission result is pending.
+    std::atomic <uint32_t>                                      m_transmitMicros;         ///< Estimate of the time in microseconds the router takes to transmit one payload.
+    std::chrono::high_resolution_clock::time_point              m_lastTransmittedTime;    ///< The time of the last transmission result. Only used by the controller thread.
+
+    // delta synchronization variables
+    mutable std::mutex                                          m_changeVersionsMutex;    ///< Protects the change version log, locked after m_deviceStoreMutex and m_deviceDataMutex.
+    Switch::ChangeVersionLog                                    m_changeVersionLog;       ///< Versions of the changes of the devices, read by GetChangesSince.
 
     // data members
-    Switch::DeviceStore*  m_pDeviceStore;
-    Switch::Router*       m_pRouter;
+    mutable std::mutex              m_deviceStoreMutex;   ///< Protects the structure of the device store when device data is handled by worker threads.
+    mutable std::mutex              m_deviceDataMutex;    ///< Held while the data containers and connection states of the devices are written, and read by other threads than the owners. Locked after m_deviceStoreMutex.
+    std::atomic <uint64_t>          m_deviceConnectionVersion;  ///< Incremented whenever the connection state of a device changes.
+    Switch::DeviceStore*            m_pDeviceStore;
+    Switch::Router*                 m_pRouter;
+    Switch::ControllerWorkerPool*   m_pWorkerPool;
+    Switch::RuleEngine              m_ruleEngine;
+    Switch::Scheduler               m_scheduler;          ///< Timed actions, advanced by the controller thread.
 
     // parameters
     uint32_t    m_updateCycleTimeMicros;            ///< The time in microseconds between two update cycles.
+    uint32_t    m_nrWorkerThreads;                  ///< The number of worker threads handling device data. Zero handles all data on the controller thread.
+    uint32_t    m_setDeviceValuesWindowMicros;      ///< The time in microseconds during which values set in the same device are merged into one transmission.
+    std::string m_rulesFile;                        ///< Path to the file with the automation rules.
+    uint32_t    m_maxNrRetransmissions;             ///< The maximum number of retransmissions of desired values not confirmed by a device.
+    uint32_t    m_maxNrRetransmissionsPerSecond;    ///< The maximum number of retransmissions per second, shared by all devices.
+    uint32_t    m_maxNrQueuedCommands;              ///< The number of queued commands above which new commands are rejected. Zero for no limit.
+    uint32_t    m_maxCommandDrainTimeMicros;        ///< The estimated time in microseconds to drain the queued commands above which new commands are rejected. Zero for no limit.
   };
 }
 
@@ -0,0 +1,85 @@
+/*?*************************************************************************
+*                           Switch_ControllerConfiguration.h
+*                           -----------------------
+*    copyright            : (C) 2014 by Wouter Charle
+*    email                : wouter.charle@gmail.com
+*
+*    DISCLAIMER OF DAMAGES
+*    ---------------------
+*    Wouter Charle has made every effort possible to ensure that the software
+*    is free of any bugs or errors, however in no way is the software to
+*    be considered error or bug free. You assume all responsibility for
+*    any damages or lost data that may result from any errors or bugs in
+*    the software.
+*
+*    IN NO EVENT WILL VISION++ BE LIABLE TO YOU FOR ANY GENERAL, SPECIAL,
+*    INDIRECT, CONSEQUENTIAL, INCIDENTAL OR OTHER DAMAGES ARISING OUT OF
+*    THIS LICENSE.
+*
+*    In no case shall Wouter Charle's liability exceed the purchase price for
+*    the software or services.
+*
+***************************************************************************/
+
+#ifndef _SWITCH_CONTROLLERCONFIGURATION
+#define _SWITCH_CONTROLLERCONFIGURATION
+
+/*
+  The number of slots in the queue of events posted by the router to the controller
+  => Must be a power of two!
+ */
+#define CONTROLLER_ROUTER_EVENT_QUEUE_SIZE 256
+
+/*
+  The time in microseconds the router thread waits for room in the full event queue
+  before it wakes up the controller thread again and checks if the controller stopped
+ */
+#define CONTROLLER_ROUTER_EVENT_QUEUE_WAIT_MICROS 10000
+
+/*
+  The maximum number of router events handled by the controller in one batch
+ */
+#define CONTROLLER_MAX_NR_ROUTER_EVENTS_HANDLED_IN_ONE_BATCH 32
+
+/*
+  Upper bound in microseconds on the window during which values set in the same device
+  are merged into one transmission
+  => Bounds the latency added to interactive requests
+ */
+#define CONTROLLER_MAX_SET_DEVICE_VALUES_WINDOW_MICROS 100000
+
+/*
+  The resolution in microseconds of the timer wheel driving the schedules
+ */
+#define CONTROLLER_TIMER_WHEEL_TICK_MICROS 100000
+
+/*
+  The number of levels of the timer wheel and the number of slots per level
+  => The number of slots must be 64 or a multiple of 64
+  => The wheel spans NR_SLOTS^NR_LEVELS ticks, timers further
+     in the future are re-armed when they reach the end of the wheel
+ */
+#define CONTROLLER_TIMER_WHEEL_NR_LEVELS 4
+#define CONTROLLER_TIMER_WHEEL_NR_SLOT_BITS 8
+#define CONTROLLER_TIMER_WHEEL_NR_SLOTS (1 << CONTROLLER_TIMER_WHEEL_NR_SLOT_BITS)
+
+/*
+  The delay in microseconds before the first retransmission of desired values that
+  were not confirmed by a device, and the upper bound of the doubling delay thereafter
+ */
+#define CONTROLLER_RECONCILE_MIN_BACKOFF_MICROS 500000
+#define CONTROLLER_RECONCILE_MAX_BACKOFF_MICROS 60000000
+
+/*
+  The initial estimate in microseconds of the time the router takes to transmit one payload
+  => Refined from the intervals between transmission results while payloads are queued
+ */
+#define CONTROLLER_INITIAL_TRANSMIT_MICROS 10000
+
+/*
+  The number of most recent scenes of which the results per device are kept
+  => Older scenes are forgotten, querying them fails
+ */
+#define CONTROLLER_MAX_NR_SCENES 256
+
+#endif // _SWITCH_CONTROLLERCONFIGURATION
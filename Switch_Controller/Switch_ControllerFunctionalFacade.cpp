@@ -57,12 +57,12 @@ Switch::ControllerFunctionalFacade::ControllerFunctionalFacade (const Switch::Co
 {
 }
 
-boost::signals2::connection Switch::ControllerFunctionalFacade::ConnectToDeviceConnectionUpdateSignal (const DeviceConnectionUpdateSlot& i_receiver)
+Switch::ObserverConnection Switch::ControllerFunctionalFacade::ConnectToDeviceConnectionUpdateSignal (const DeviceConnectionUpdateSlot& i_receiver)
 {
   return mr_controller.ConnectToDeviceConnectionUpdateSignal (i_receiver);
 }
 
-boost::signals2::connection Switch::ControllerFunctionalFacade::ConnectToDeviceDataUpdateSignal (const DeviceDataUpdateSlot& i_receiver)
+Switch::ObserverConnection Switch::ControllerFunctionalFacade::ConnectToDeviceDataUpdateSignal (const DeviceDataUpdateSlot& i_receiver)
 {
   return mr_controller.ConnectToDeviceDataUpdateSignal (i_receiver);
 }
@@ -77,6 +77,11 @@ Switch::ControllerFunctionalFacade::eCallResult Switch::ControllerFunctionalFaca
   return mr_controller.EnumerateDevices (o_deviceInfo);
 }
 
+Switch::ControllerFunctionalFacade::eCallResult Switch::ControllerFunctionalFacade::VisitDevices (uint32_t& o_nextDeviceAddress, const DeviceSummaryVisitor& i_visitor, const uint32_t& i_firstDeviceAddress, const uint32_t& i_maxNrDevices)
+{
+  return mr_controller.VisitDevices (o_nextDeviceAddress, i_visitor, i_firstDeviceAddress, i_maxNrDevices);
+}
+
 Switch::ControllerFunctionalFacade::eCallResult Switch::ControllerFunctionalFacade::GetDeviceDetails (Switch::Interface::Device& o_deviceDetails, const uint32_t& i_deviceAddress)
 {
   return mr_controller.GetDeviceDetails (o_deviceDetails, i_deviceAddress);
@@ -87,8 +92,42 @@ Switch::ControllerFunctionalFacade::eCallResult Switch::ControllerFunctionalFaca
   return mr_controller.GetDeviceValues (o_values, i_deviceAddress);
 }
 
+Switch::ControllerFunctionalFacade::eCallResult Switch::ControllerFunctionalFacade::GetMultipleDeviceValues (std::map <uint32_t, std::list <Switch::Interface::Device::Value>>& o_values, const std::set <uint32_t>& i_deviceAddresses)
+{
+  return mr_controller.GetMultipleDeviceValues (o_values, i_deviceAddresses);
+}
+
+Switch::ControllerFunctionalFacade::eCallResult Switch::ControllerFunctionalFacade::GetDeviceCatalogVersion (uint64_t& o_version)
+{
+  return mr_controller.GetDeviceCatalogVersion (o_version);
+}
+
+Switch::ControllerFunctionalFacade::eCallResult Switch::ControllerFunctionalFacade::GetDeviceReportedValues (std::list <Switch::Interface::Device::Value>& o_values, const uint32_t& i_deviceAddress)
+{
+  return mr_controller.GetDeviceReportedValues (o_values, i_deviceAddress);
+}
+
 Switch::ControllerFunctionalFacade::eCallResult Switch::ControllerFunctionalFacade::SetDeviceValues (const uint32_t& i_deviceAddress, const std::list <Switch::Interface::Device::Value>& i_values)
 {
   return mr_controller.SetDeviceValues (i_deviceAddress, i_values);
 }
 
+Switch::ControllerFunctionalFacade::eCallResult Switch::ControllerFunctionalFacade::SetMultipleDeviceValues (std::map <uint32_t, eCallResult>& o_results, uint32_t& o_sceneId, const std::map <uint32_t, std::list <Switch::Interface::Device::Value>>& i_values)
+{
+  return mr_controller.SetMultipleDeviceValues (o_results, o_sceneId, i_values);
+}
+
+Switch::ControllerFunctionalFacade::eCallResult Switch::ControllerFunctionalFacade::GetSceneResults (std::map <uint32_t, eCallResult>& o_results, const uint32_t& i_sceneId)
+{
+  return mr_controller.GetSceneResults (o_results, i_sceneId);
+}
+
+Switch::ControllerFunctionalFacade::eCallResult Switch::ControllerFunctionalFacade::GetCommandBacklog (uint32_t& o_nrQueuedCommands, uint32_t& o_drainTimeMicros)
+{
+  return mr_controller.GetCommandBacklog (o_nrQueuedCommands, o_drainTimeMicros);
+}
+
+Switch::ControllerFunctionalFacade::eCallResult Switch::ControllerFunctionalFacade::GetChangesSince (uint64_t& o_version, std::list <Switch::Interface::Device::Summary>& o_devices, std::map <uint32_t, std::list <Switch::Interface::Device::Value>>& o_values, const uint64_t& i_version)
+{
+  return mr_controller.GetChangesSince (o_version, o_devices, o_values, i_version);
+}
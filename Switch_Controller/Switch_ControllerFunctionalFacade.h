@@ -33,8 +33,6 @@
 #include <Switch_Base/Switch_Types.h>
 
 // third party includes
-#define BOOST_BIND_NO_PLACEHOLDERS
-#include <boost/signals2.hpp>
 
 
 namespace Switch
@@ -57,15 +55,23 @@ namespace Switch
     ControllerFunctionalFacade& operator= (const ControllerFunctionalFacade& i_other) = delete;
 
     // signals
-    boost::signals2::connection ConnectToDeviceConnectionUpdateSignal (const DeviceConnectionUpdateSlot& i_receiver);
-    boost::signals2::connection ConnectToDeviceDataUpdateSignal (const DeviceDataUpdateSlot& i_receiver);
+    Switch::ObserverConnection ConnectToDeviceConnectionUpdateSignal (const DeviceConnectionUpdateSlot& i_receiver);
+    Switch::ObserverConnection ConnectToDeviceDataUpdateSignal (const DeviceDataUpdateSlot& i_receiver);
 
     // functionality
     eCallResult AddDevice        (const uint32_t& i_deviceAddress);
     eCallResult EnumerateDevices (std::list <Switch::Interface::Device::Summary>& o_deviceInfo);
+    eCallResult VisitDevices     (uint32_t& o_nextDeviceAddress, const DeviceSummaryVisitor& i_visitor, const uint32_t& i_firstDeviceAddress, const uint32_t& i_maxNrDevices);
     eCallResult GetDeviceDetails (Switch::Interface::Device& o_deviceDetails, const uint32_t& i_deviceAddress);
+    eCallResult GetDeviceCatalogVersion (uint64_t& o_version);
     eCallResult GetDeviceValues  (std::list <Switch::Interface::Device::Value>& o_values, const uint32_t& i_deviceAddress);
+    eCallResult GetMultipleDeviceValues (std::map <uint32_t, std::list <Switch::Interface::Device::Value>>& o_values, const std::set <uint32_t>& i_deviceAddresses);
+    eCallResult GetDeviceReportedValues (std::list <Switch::Interface::Device::Value>& o_values, const uint32_t& i_deviceAddress);
     eCallResult SetDeviceValues  (const uint32_t& i_deviceAddress, const std::list <Switch::Interface::Device::Value>& i_values);
+    eCallResult SetMultipleDeviceValues (std::map <uint32_t, eCallResult>& o_results, uint32_t& o_sceneId, const std::map <uint32_t, std::list <Switch::Interface::Device::Value>>& i_values);
+    eCallResult GetSceneResults (std::map <uint32_t, eCallResult>& o_results, const uint32_t& i_sceneId);
+    eCallResult GetCommandBacklog (uint32_t& o_nrQueuedCommands, uint32_t& o_drainTimeMicros);
+    eCallResult GetChangesSince  (uint64_t& o_version, std::list <Switch::Interface::Device::Summary>& o_devices, std::map <uint32_t, std::list <Switch::Interface::Device::Value>>& o_values, const uint64_t& i_version);
 
   private:
 
@@ -26,13 +26,15 @@
 
 // project includes
 #include "Switch_InterfaceDevice.h"
+#include "Switch_ObserverRegistry.h"
 
 // switch includes
 #include <Switch_Base/Switch_CompilerConfiguration.h>
 
 // third party includes
-#define BOOST_BIND_NO_PLACEHOLDERS
-#include <boost/signals2.hpp>
+#include <map>
+#include <set>
+#include <functional>
 
 
 namespace Switch
@@ -41,15 +43,19 @@ namespace Switch
   {
   public:
 
-    typedef boost::signals2::signal <void (const uint32_t&, const Switch::Interface::Device::Connection&)>::slot_type DeviceConnectionUpdateSlot;
-    typedef boost::signals2::signal <void (const uint32_t&, const std::list <Switch::Interface::Device::Value>&)>::slot_type DeviceDataUpdateSlot;
+    typedef Switch::ObserverRegistry <const uint32_t&, const Switch::Interface::Device::Connection&>::Slot DeviceConnectionUpdateSlot;
+    typedef Switch::ObserverRegistry <const uint32_t&, const std::list <Switch::Interface::Device::Value>&>::Slot DeviceDataUpdateSlot;
+    typedef std::function <void (const Switch::Interface::Device::Summary&)> DeviceSummaryVisitor;
 
     enum eCallResult
     {
       CR_INVALID        =-1,
       CR_OK             = 0,
       CR_STOPPED        = 1,
-      CR_UNKNOWN_DEVICE = 2
+      CR_UNKNOWN_DEVICE = 2,
+      CR_BUSY           = 8,  ///< The command queue is over its limits, retry later. Numbered after the results of the API's client calls.
+      CR_PENDING        = 9,  ///< The device did not confirm the values of a scene yet.
+      CR_NOT_CONFIRMED  = 10  ///< The device did not confirm the values of a scene before its retransmissions were given up.
     };
 
     // contsructor and destructor
@@ -61,15 +67,23 @@ namespace Switch
     ControllerFunctionalInterface& operator= (const ControllerFunctionalInterface& i_other) = delete;
 
     // signals
-    virtual boost::signals2::connection ConnectToDeviceConnectionUpdateSignal (const DeviceConnectionUpdateSlot& i_receiver) = 0;
-    virtual boost::signals2::connection ConnectToDeviceDataUpdateSignal (const DeviceDataUpdateSlot& i_receiver) = 0;
+    virtual Switch::ObserverConnection ConnectToDeviceConnectionUpdateSignal (const DeviceConnectionUpdateSlot& i_receiver) = 0;
+    virtual Switch::ObserverConnection ConnectToDeviceDataUpdateSignal (const DeviceDataUpdateSlot& i_receiver) = 0;
 
     // functionality
     virtual eCallResult AddDevice        (const uint32_t& i_deviceAddress) = 0;
     virtual eCallResult EnumerateDevices (std::list <Switch::Interface::Device::Summary>& o_deviceInfo) = 0;
+    virtual eCallResult VisitDevices     (uint32_t& o_nextDeviceAddress, const DeviceSummaryVisitor& i_visitor, const uint32_t& i_firstDeviceAddress, const uint32_t& i_maxNrDevices) = 0;
     virtual eCallResult GetDeviceDetails (Switch::Interface::Device& o_deviceDetails, const uint32_t& i_deviceAddress) = 0;
+    virtual eCallResult GetDeviceCatalogVersion (uint64_t& o_version) = 0;
     virtual eCallResult GetDeviceValues  (std::list <Switch::Interface::Device::Value>& o_values, const uint32_t& i_deviceAddress) = 0;
+    virtual eCallResult GetMultipleDeviceValues (std::map <uint32_t, std::list <Switch::Interface::Device::Value>>& o_values, const std::set <uint32_t>& i_deviceAddresses) = 0;
+    virtual eCallResult GetDeviceReportedValues (std::list <Switch::Interface::Device::Value>& o_values, const uint32_t& i_deviceAddress) = 0;
     virtual eCallResult SetDeviceValues  (const uint32_t& i_deviceAddress, const std::list <Switch::Interface::Device::Value>& i_values) = 0;
+    virtual eCallResult SetMultipleDeviceValues (std::map <uint32_t, eCallResult>& o_results, uint32_t& o_sceneId, const std::map <uint32_t, std::list <Switch::Interface::Device::Value>>& i_values) = 0;
+    virtual eCallResult GetSceneResults (std::map <uint32_t, eCallResult>& o_results, const uint32_t& i_sceneId) = 0;
+    virtual eCallResult GetCommandBacklog (uint32_t& o_nrQueuedCommands, uint32_t& o_drainTimeMicros) = 0;
+    virtual eCallResult GetChangesSince  (uint64_t& o_version, std::list <Switch::Interface::Device::Summary>& o_devices, std::map <uint32_t, std::list <Switch::Interface::Device::Value>>& o_values, const uint64_t& i_version) = 0;
 
   };
 }
@@ -0,0 +1,176 @@
+/*?*************************************************************************
+*                           Switch_ControllerWorkerPool.cpp
+*                           -----------------------
+*    copyright            : (C) 2014 by Wouter Charle
+*    email                : wouter.charle@gmail.com
+*
+*    DISCLAIMER OF DAMAGES
+*    ---------------------
+*    Wouter Charle has made every effort possible to ensure that the software
+*    is free of any bugs or errors, however in no way is the software to
+*    be considered error or bug free. You assume all responsibility for
+*    any damages or lost data that may result from any errors or bugs in
+*    the software.
+*
+*    IN NO EVENT WILL VISION++ BE LIABLE TO YOU FOR ANY GENERAL, SPECIAL,
+*    INDIRECT, CONSEQUENTIAL, INCIDENTAL OR OTHER DAMAGES ARISING OUT OF
+*    THIS LICENSE.
+*
+*    In no case shall Wouter Charle's liability exceed the purchase price for
+*    the software or services.
+*
+***************************************************************************/
+
+#include "Switch_ControllerWorkerPool.h"
+
+// switch includes
+#include <Switch_Base/Switch_Debug.h>
+
+// third-party includes
+#include <stdexcept>
+
+
+/*!
+  \brief Constructor
+ */
+Switch::ControllerWorkerPool::ControllerWorkerPool (const uint32_t& i_nrWorkers, const EventHandler& i_eventHandler)
+: m_eventHandler (i_eventHandler)
+{
+  SWITCH_ASSERT_THROW (0 < i_nrWorkers, std::runtime_error ("worker pool requires at least one worker"));
+
+  try
+  {
+    for (uint32_t i=0; i<i_nrWorkers; ++i)
+    {
+      Worker* pWorker = new Worker ();
+      pWorker->m_stop = false;
+      m_workers.push_back (pWorker);
+
+      pWorker->m_thread = std::thread (std::bind (&Switch::ControllerWorkerPool::_Run, this, std::ref (*pWorker)));
+    }
+  }
+  catch (...)
+  {
+    // cleanup
+    _StopWorkers ();
+
+    // forward
+    throw;
+  }
+}
+
+/*!
+  \brief Destructor
+ */
+Switch::ControllerWorkerPool::~ControllerWorkerPool ()
+{
+  _StopWorkers ();
+}
+
+/*!
+  \brief Stops the workers once their queues are empty, joins and deallocates them.
+ */
+void Switch::ControllerWorkerPool::_StopWorkers ()
+{
+  std::vector <Worker*>::iterator itWorker;
+
+  // request all workers to stop
+  for (itWorker = m_workers.begin (); m_workers.end () != itWorker; ++itWorker)
+  {
+    std::unique_lock <std::mutex> workerLock ((*itWorker)->m_mutex);
+    (*itWorker)->m_stop = true;
+    (*itWorker)->m_condition.notify_all ();
+  }
+
+  // join and deallocate the workers
+  for (itWorker = m_workers.begin (); m_workers.end () != itWorker; ++itWorker)
+  {
+    if ((*itWorker)->m_thread.joinable ())
+    {
+      (*itWorker)->m_thread.join ();
+    }
+    delete *itWorker;
+  }
+  m_workers.clear ();
+}
+
+void Switch::ControllerWorkerPool::Post (const Switch::RouterEvent& i_event)
+{
+  Worker& worker = *m_workers [_GetWorkerIndex (i_event.m_deviceAddress)];
+
+  // wait for the worker to make room
+  // note: the workers only stop once nothing is posted anymore, a full queue is always drained
+  while (!worker.m_events.Push (i_event, std::chrono::microseconds (CONTROLLER_ROUTER_EVENT_QUEUE_WAIT_MICROS)))
+  {
+    SWITCH_DEBUG_MSG_1 ("controller worker queue full, waiting to post event for device %u\n", static_cast <uint32_t> (i_event.m_deviceAddress));
+  }
+
+  // wake up the worker
+  std::unique_lock <std::mutex> workerLock (worker.m_mutex);
+  worker.m_condition.notify_all ();
+}
+
+uint32_t Switch::ControllerWorkerPool::GetNrWorkers () const
+{
+  return static_cast <uint32_t> (m_workers.size ());
+}
+
+/*!
+  \brief Maps a device address onto a worker.
+
+  Device addresses are not uniformly distributed, so the address is mixed
+  before reducing it to a worker index.
+
+  \param [in] i_deviceAddress The device address.
+
+  \return The index of the worker owning the device.
+ */
+uint32_t Switch::ControllerWorkerPool::_GetWorkerIndex (const switch_device_address_type& i_deviceAddress) const
+{
+  uint32_t hash = static_cast <uint32_t> (i_deviceAddress);
+  hash ^= hash >> 16;
+  hash *= 0x45d9f3b;
+  hash ^= hash >> 16;
+
+  return hash % static_cast <uint32_t> (m_workers.size ());
+}
+
+/*!
+  \brief Worker thread main loop.
+
+  \param [in,out] io_worker The worker to run.
+ */
+void Switch::ControllerWorkerPool::_Run (Worker& io_worker)
+{
+  Switch::RouterEvent event;
+
+  std::unique_lock <std::mutex> workerLock (io_worker.m_mutex);
+  while (true)
+  {
+    // wait for work
+    while (io_worker.m_events.IsEmpty () && !io_worker.m_stop)
+    {
+      io_worker.m_condition.wait (workerLock);
+    }
+    if (io_worker.m_events.IsEmpty ())
+    {
+      // stop requested and all events handled
+      break;
+    }
+
+    // handle the events without holding the lock
+    workerLock.unlock ();
+    while (io_worker.m_events.Pop (event))
+    {
+      try
+      {
+        m_eventHandler (event);
+      }
+      catch (const std::exception& i_exception)
+      {
+        SWITCH_DEBUG_MSG_1 ("controller worker event failed: %s\n", i_exception.what ());
+      }
+    }
+    workerLock.lock ();
+  }
+}
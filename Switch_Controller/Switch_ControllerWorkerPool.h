@@ -0,0 +1,118 @@
+/*?*************************************************************************
+*                           Switch_ControllerWorkerPool.h
+*                           -----------------------
+*    copyright            : (C) 2014 by Wouter Charle
+*    email                : wouter.charle@gmail.com
+*
+*    DISCLAIMER OF DAMAGES
+*    ---------------------
+*    Wouter Charle has made every effort possible to ensure that the software
+*    is free of any bugs or errors, however in no way is the software to
+*    be considered error or bug free. You assume all responsibility for
+*    any damages or lost data that may result from any errors or bugs in
+*    the software.
+*
+*    IN NO EVENT WILL VISION++ BE LIABLE TO YOU FOR ANY GENERAL, SPECIAL,
+*    INDIRECT, CONSEQUENTIAL, INCIDENTAL OR OTHER DAMAGES ARISING OUT OF
+*    THIS LICENSE.
+*
+*    In no case shall Wouter Charle's liability exceed the purchase price for
+*    the software or services.
+*
+***************************************************************************/
+
+#ifndef _SWITCH_CONTROLLERWORKERPOOL
+#define _SWITCH_CONTROLLERWORKERPOOL
+
+// project includes
+#include "Switch_RouterEventQueue.h"
+
+// switch includes
+#include <Switch_Base/Switch_CompilerConfiguration.h>
+#include <Switch_Base/Switch_Types.h>
+
+// third party includes
+#include <vector>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+
+namespace Switch
+{
+  /*!
+    \brief Pool of controller worker threads sharded by device address.
+
+    Every device address is mapped onto exactly one worker. Events posted for
+    the same device are therefore handled sequentially and in posting order,
+    while events of different devices may be handled in parallel. Every worker
+    has a bounded event queue, posting to a full queue waits for the worker.
+   */
+  class ControllerWorkerPool
+  {
+  public:
+
+    typedef std::function <void (const Switch::RouterEvent&)> EventHandler;
+
+    /*!
+      \brief Constructor. Starts the worker threads.
+
+      \param [in] i_nrWorkers     The number of worker threads. Must be larger than zero.
+      \param [in] i_eventHandler  The handler the workers call for every event.
+     */
+    ControllerWorkerPool (const uint32_t& i_nrWorkers, const EventHandler& i_eventHandler);
+    /*!
+      \brief Destructor. Handles all pending events and joins the worker threads.
+     */
+    ~ControllerWorkerPool ();
+
+    // copy constructor and assignment operator are disabled
+    ControllerWorkerPool (const ControllerWorkerPool& i_other) = delete;
+    ControllerWorkerPool& operator= (const ControllerWorkerPool& i_other) = delete;
+
+    /*!
+      \brief Posts an event on the worker owning its device.
+
+      Waits for room if the queue of the worker is full.
+
+      \param [in] i_event The event to handle.
+
+      \note Posting is not synchronized between producers, only one thread may post.
+     */
+    void Post (const Switch::RouterEvent& i_event);
+
+    /*!
+      \brief Gets the number of worker threads.
+
+      \return The number of worker threads.
+     */
+    uint32_t GetNrWorkers () const;
+
+  private:
+
+    /*!
+      \brief Worker thread with its event queue.
+     */
+    class Worker
+    {
+    public:
+      std::thread               m_thread;     ///< The worker thread.
+      Switch::RouterEventQueue  m_events;     ///< Events waiting to be handled.
+      std::mutex                m_mutex;      ///< Guards the worker waiting for events and the stop flag.
+      std::condition_variable   m_condition;  ///< Signals new events or a stop request.
+      bool                      m_stop;       ///< Flags that the worker must stop once its queue is empty.
+    };
+
+    // utility methods
+    void _Run (Worker& io_worker);
+    void _StopWorkers ();
+    uint32_t _GetWorkerIndex (const switch_device_address_type& i_deviceAddress) const;
+
+    // variables
+    EventHandler          m_eventHandler;
+    std::vector <Worker*> m_workers;
+  };
+}
+
+#endif // _SWITCH_CONTROLLERWORKERPOOL
@@ -28,6 +28,13 @@
 
 // project includes
 #include "Switch_Controller.h"
+#include "Switch_RouterEventQueue.h"
+#include "Switch_ControllerWorkerPool.h"
+#include "Switch_TimerWheel.h"
+#include "Switch_RuleEngine.h"
+#include "Switch_Scheduler.h"
+#include "Switch_ChangeVersionLog.h"
+#include "Switch_ObserverRegistry.h"
 
 // switch includes
 #include "../Switch_Base/Switch_CompilerConfiguration.h"
@@ -38,7 +45,15 @@
 // third party includes
 #include <string>
 #include <fstream>
+#include <sstream>
+#include <map>
+#include <limits>
 #include <thread>
+#include <vector>
+#include <chrono>
+#include <atomic>
+#define BOOST_BIND_NO_PLACEHOLDERS
+#include <boost/signals2.hpp>
 #include <SSVUtils/Core/FileSystem/FileSystem.hpp>
 
 namespace Switch
@@ -50,6 +65,14 @@ namespace Switch
     void TestParameters ();
     void TestStates ();
     void TestFunctional ();
+    void TestRouterEventQueue ();
+    void TestControllerWorkerPool ();
+    void TestTimerWheel ();
+    void TestRuleEngine ();
+    void TestScheduler ();
+    void TestChangeVersionLog ();
+    void TestObserverRegistry ();
+    void BenchmarkObserverRegistry ();
   }
 }
 
@@ -228,6 +251,792 @@ void Switch::ControllerTests::TestFunctional ()
   controller.Stop ();
 }
 
+void Switch::ControllerTests::TestRouterEventQueue ()
+{
+  const uint32_t nrProducers = 4;
+  const uint32_t nrEventsPerProducer = 10000;
+
+  Switch::RouterEventQueue queue;
+  Switch::RouterEvent event;
+
+  // single threaded: fill up, overflow and drain in order
+  SWITCH_ASSERT (queue.IsEmpty ());
+  for (uint32_t i=0; i<CONTROLLER_ROUTER_EVENT_QUEUE_SIZE; ++i)
+  {
+    event.m_deviceAddress = i;
+    SWITCH_ASSERT (queue.Push (event));
+  }
+  SWITCH_ASSERT (!queue.Push (event));
+  for (uint32_t i=0; i<CONTROLLER_ROUTER_EVENT_QUEUE_SIZE; ++i)
+  {
+    SWITCH_ASSERT (queue.Pop (event));
+    SWITCH_ASSERT (i == event.m_deviceAddress);
+  }
+  SWITCH_ASSERT (!queue.Pop (event));
+
+  // waiting for room: a full queue times out, a pop wakes up the waiting producer
+  for (uint32_t i=0; i<CONTROLLER_ROUTER_EVENT_QUEUE_SIZE; ++i)
+  {
+    SWITCH_ASSERT (queue.Push (event));
+  }
+  SWITCH_ASSERT (!queue.Push (event, std::chrono::microseconds (1000)));
+  std::thread consumer ([&queue] ()
+  {
+    Switch::RouterEvent consumerEvent;
+    std::this_thread::sleep_for (std::chrono::milliseconds (10));
+    SWITCH_ASSERT (queue.Pop (consumerEvent));
+  });
+  SWITCH_ASSERT (queue.Push (event, std::chrono::microseconds (10000000)));
+  consumer.join ();
+  while (queue.Pop (event))
+  {
+  }
+
+  // multi threaded: events of every producer arrive in order, none are lost
+  std::list <std::thread> producers;
+  for (uint32_t p=0; p<nrProducers; ++p)
+  {
+    producers.push_back (std::thread ([&queue, p, nrEventsPerProducer] ()
+    {
+      Switch::RouterEvent producerEvent;
+      producerEvent.m_deviceAddress = p;
+      for (uint32_t i=0; i<nrEventsPerProducer; ++i)
+      {
+        producerEvent.m_dataPayload.data [0] = static_cast <uint8_t> (i);
+        while (!queue.Push (producerEvent))
+        {
+          std::this_thread::yield ();
+        }
+      }
+    }));
+  }
+
+  uint32_t nrEventsReceived [nrProducers] = {0};
+  uint32_t nrEventsTotal = 0;
+  while (nrProducers*nrEventsPerProducer > nrEventsTotal)
+  {
+    if (!queue.Pop (event))
+    {
+      std::this_thread::yield ();
+      continue;
+    }
+
+    SWITCH_ASSERT (nrProducers > event.m_deviceAddress);
+    SWITCH_ASSERT (static_cast <uint8_t> (nrEventsReceived [event.m_deviceAddress]) == event.m_dataPayload.data [0]);
+    ++nrEventsReceived [event.m_deviceAddress];
+    ++nrEventsTotal;
+  }
+  SWITCH_ASSERT (queue.IsEmpty ());
+
+  std::list <std::thread>::iterator itProducer;
+  for (itProducer = producers.begin (); producers.end () != itProducer; ++itProducer)
+  {
+    itProducer->join ();
+  }
+}
+
+void Switch::ControllerTests::TestControllerWorkerPool ()
+{
+  const uint32_t nrWorkers = 3;
+  const uint32_t nrDevices = 16;
+  const uint32_t nrEventsPerDevice = 2000;
+
+  // the sequence numbers of the handled events and the thread handling them, per device
+  // note: the events of a device are handled by one worker, only that worker touches the records of the device
+  std::vector <std::vector <uint32_t>> sequences (nrDevices);
+  std::vector <std::thread::id> threadIds (nrDevices);
+  std::atomic <uint32_t> nrThreadSwitches (0);
+  {
+    Switch::ControllerWorkerPool workerPool (nrWorkers, [&sequences, &threadIds, &nrThreadSwitches, nrEventsPerDevice] (const Switch::RouterEvent& i_event)
+    {
+      std::vector <uint32_t>& deviceSequences = sequences [i_event.m_deviceAddress];
+      if (deviceSequences.empty ())
+      {
+        threadIds [i_event.m_deviceAddress] = std::this_thread::get_id ();
+      }
+      else if (threadIds [i_event.m_deviceAddress] != std::this_thread::get_id ())
+      {
+        ++nrThreadSwitches;
+      }
+
+      uint32_t sequence = i_event.m_dataPayload.data [0] | (static_cast <uint32_t> (i_event.m_dataPayload.data [1]) << 8);
+      deviceSequences.push_back (sequence);
+
+      // slow down on the first and last events, such that the queues fill up and are still full at shutdown
+      if ((0 == sequence) || (nrEventsPerDevice - 1 == sequence))
+      {
+        std::this_thread::sleep_for (std::chrono::milliseconds (1));
+      }
+    });
+    SWITCH_ASSERT (nrWorkers == workerPool.GetNrWorkers ());
+
+    // post more events than the queues hold, posting waits for the workers
+    Switch::RouterEvent event;
+    event.m_type = Switch::RouterEvent::RE_NODE_DATA_RECEIVED;
+    for (uint32_t i=0; i<nrEventsPerDevice; ++i)
+    {
+      for (uint32_t d=0; d<nrDevices; ++d)
+      {
+        event.m_deviceAddress = d;
+        event.m_dataPayload.data [0] = static_cast <uint8_t> (i);
+        event.m_dataPayload.data [1] = static_cast <uint8_t> (i >> 8);
+        workerPool.Post (event);
+      }
+    }
+
+    // destroying the pool handles the pending events before joining the workers
+  }
+
+  // every device got all its events, in posting order and on the same worker
+  for (uint32_t d=0; d<nrDevices; ++d)
+  {
+    SWITCH_ASSERT (nrEventsPerDevice == sequences [d].size ());
+    for (uint32_t i=0; i<sequences [d].size (); ++i)
+    {
+      SWITCH_ASSERT (i == sequences [d][i]);
+    }
+  }
+  SWITCH_ASSERT (0 == nrThreadSwitches.load ());
+}
+
+void Switch::ControllerTests::TestTimerWheel ()
+{
+  const uint32_t nrTimers = 20000;
+  const uint64_t startTick = 1000;
+
+  Switch::TimerWheel timerWheel;
+  timerWheel.Reset (startTick);
+  std::vector <uint32_t> expired;
+
+  // timers spread over all levels expire exactly on their tick
+  std::vector <uint64_t> expiryTicks (nrTimers);
+  std::vector <Switch::TimerWheel::timer_handle_type> handles (nrTimers);
+  uint64_t expiryTick = startTick;
+  for (uint32_t i=0; i<nrTimers; ++i)
+  {
+    expiryTick = expiryTick*6364136223846793005ULL + 1442695040888963407ULL;
+    expiryTicks [i] = startTick + 1 + (expiryTick >> 33) % ((0 == i%4) ? 0x100000000ULL : 100000);
+    handles [i] = timerWheel.Add (expiryTicks [i], i);
+  }
+  SWITCH_ASSERT (nrTimers == timerWheel.GetSize ());
+
+  // removed timers never expire, their handles become invalid
+  for (uint32_t i=0; i<nrTimers; i+=3)
+  {
+    SWITCH_ASSERT (timerWheel.Remove (handles [i]));
+    SWITCH_ASSERT (!timerWheel.Remove (handles [i]));
+  }
+
+  uint32_t nrExpired = 0;
+  while (0 != timerWheel.GetSize ())
+  {
+    uint64_t nextTick = timerWheel.GetNextTick ();
+    SWITCH_ASSERT (timerWheel.GetCurrentTick () < nextTick);
+
+    expired.clear ();
+    timerWheel.Advance (expired, nextTick);
+    for (uint32_t i=0; i<expired.size (); ++i)
+    {
+      SWITCH_ASSERT (0 != expired [i]%3);
+      SWITCH_ASSERT (nextTick == expiryTicks [expired [i]]);
+      SWITCH_ASSERT (!timerWheel.Remove (handles [expired [i]]));
+      ++nrExpired;
+    }
+  }
+  SWITCH_ASSERT (nrTimers - (nrTimers + 2)/3 == nrExpired);
+
+  // timers in the past expire on the next tick, advancing over a large gap expires all
+  timerWheel.Add (timerWheel.GetCurrentTick () - 10, 1);
+  timerWheel.Add (timerWheel.GetCurrentTick () + 0x200000000ULL, 2);
+  expired.clear ();
+  timerWheel.Advance (expired, timerWheel.GetCurrentTick () + 1);
+  SWITCH_ASSERT ((1 == expired.size ()) && (1 == expired [0]));
+  timerWheel.Advance (expired, timerWheel.GetCurrentTick () + 0x200000000ULL);
+  SWITCH_ASSERT ((2 == expired.size ()) && (2 == expired [1]));
+  SWITCH_ASSERT (0 == timerWheel.GetSize ());
+}
+
+void Switch::ControllerTests::TestRuleEngine ()
+{
+  const std::string rules =
+    "{ \"rules\" : ["
+    "  { \"name\" : \"on\",      \"deviceId\" : 1, \"address\" : 8, \"condition\" : \"==\",      \"operand\" : 1,"
+    "    \"actions\" : [ { \"deviceId\" : 2, \"values\" : [ { \"address\" : 4, \"magicNumber\" : 7, \"value\" : 1 } ] } ] },"
+    "  { \"name\" : \"any\",     \"deviceId\" : 1, \"address\" : 8, \"condition\" : \"changed\", \"operand\" : 0,"
+    "    \"actions\" : [ { \"deviceId\" : 3, \"values\" : [ { \"address\" : 4, \"magicNumber\" : 7, \"value\" : 2 },"
+    "                                              { \"address\" : 5, \"magicNumber\" : 7, \"value\" : 3 } ] },"
+    "                    { \"deviceId\" : 4, \"values\" : [] } ] },"
+    "  { \"name\" : \"warm\",    \"deviceId\" : 1, \"address\" : 9, \"condition\" : \">\",       \"operand\" : 20,"
+    "    \"actions\" : [ { \"deviceId\" : 5, \"values\" : [ { \"address\" : 4, \"magicNumber\" : 7, \"value\" : 0 } ] } ] },"
+    "  { \"name\" : \"other\",   \"deviceId\" : 2, \"address\" : 8, \"condition\" : \"<=\",      \"operand\" : 0,"
+    "    \"actions\" : [ { \"deviceId\" : 6, \"values\" : [ { \"address\" : 4, \"magicNumber\" : 7, \"value\" : 0 } ] } ] }"
+    "] }";
+
+  Switch::RuleSet ruleSet;
+  std::istringstream rulesStream (rules);
+  Switch::JsonSerializer::Deserialize (ruleSet, rulesStream);
+  SWITCH_ASSERT (4 == ruleSet.m_rules.size ());
+
+  Switch::RuleEngine ruleEngine;
+  SWITCH_ASSERT (ruleEngine.IsEmpty ());
+  ruleEngine.SetRules (ruleSet);
+  SWITCH_ASSERT (!ruleEngine.IsEmpty ());
+
+  Switch::DataContainer::Element element;
+  element.m_magicNumber = 7;
+  std::list <Switch::DataContainer::Element> changedElements;
+  std::list <Switch::Rule::Action> actions;
+
+  // only the rules on the changed (device, element) are triggered
+  element.m_address = 10;
+  element.m_value = 1;
+  changedElements.push_back (element);
+  ruleEngine.Evaluate (actions, 1, changedElements);
+  SWITCH_ASSERT (actions.empty ());
+
+  changedElements.front ().m_address = 8;
+  ruleEngine.Evaluate (actions, 3, changedElements);
+  SWITCH_ASSERT (actions.empty ());
+
+  // all matching rules fire, their actions are appended in rule order
+  ruleEngine.Evaluate (actions, 1, changedElements);
+  SWITCH_ASSERT (3 == actions.size ());
+  std::list <Switch::Rule::Action>::const_iterator itAction = actions.begin ();
+  SWITCH_ASSERT ((2 == itAction->m_deviceAddress) && (1 == itAction->m_elements.size ()));
+  SWITCH_ASSERT ((4 == itAction->m_elements.front ().m_address) && (1 == itAction->m_elements.front ().m_value));
+  ++itAction;
+  SWITCH_ASSERT ((3 == itAction->m_deviceAddress) && (2 == itAction->m_elements.size ()));
+  SWITCH_ASSERT ((5 == itAction->m_elements.back ().m_address) && (3 == itAction->m_elements.back ().m_value));
+  SWITCH_ASSERT (7 == itAction->m_elements.back ().m_magicNumber);
+  ++itAction;
+  SWITCH_ASSERT ((4 == itAction->m_deviceAddress) && itAction->m_elements.empty ());
+
+  // conditions that are not satisfied do not fire
+  actions.clear ();
+  changedElements.front ().m_value = 0;
+  ruleEngine.Evaluate (actions, 1, changedElements);
+  SWITCH_ASSERT ((2 == actions.size ()) && (3 == actions.front ().m_deviceAddress));
+
+  // several changed elements trigger their rules in the order of the elements
+  actions.clear ();
+  element.m_address = 9;
+  element.m_value = 21;
+  changedElements.push_front (element);
+  ruleEngine.Evaluate (actions, 1, changedElements);
+  SWITCH_ASSERT ((3 == actions.size ()) && (5 == actions.front ().m_deviceAddress) && (4 == actions.back ().m_deviceAddress));
+
+  actions.clear ();
+  changedElements.front ().m_value = 20;
+  changedElements.back ().m_value = -1;
+  ruleEngine.Evaluate (actions, 2, changedElements);
+  SWITCH_ASSERT ((1 == actions.size ()) && (6 == actions.front ().m_deviceAddress));
+
+  // serialized rules load the same rules
+  std::stringstream serializedStream;
+  Switch::JsonSerializer::Serialize (serializedStream, ruleSet);
+  Switch::RuleSet reloadedRuleSet;
+  Switch::JsonSerializer::Deserialize (reloadedRuleSet, serializedStream);
+  SWITCH_ASSERT (4 == reloadedRuleSet.m_rules.size ());
+  std::list <Switch::Rule>::const_iterator itRule = reloadedRuleSet.m_rules.begin ();
+  std::advance (itRule, 2);
+  SWITCH_ASSERT ((Switch::Rule::RC_GREATER == itRule->m_condition) && (20 == itRule->m_operand) && (1 == itRule->m_actions.size ()));
+
+  // replacing the rules replaces the index
+  ruleSet.m_rules.pop_front ();
+  ruleSet.m_rules.pop_front ();
+  ruleEngine.SetRules (ruleSet);
+  actions.clear ();
+  changedElements.front ().m_value = 21;
+  changedElements.back ().m_value = 1;
+  ruleEngine.Evaluate (actions, 1, changedElements);
+  SWITCH_ASSERT ((1 == actions.size ()) && (5 == actions.front ().m_deviceAddress));
+
+  // unknown conditions and malformed files are rejected
+  bool rejected = false;
+  try
+  {
+    std::istringstream unknownConditionStream ("{ \"rules\" : [ { \"deviceId\" : 1, \"address\" : 8, \"condition\" : \"~\" } ] }");
+    Switch::JsonSerializer::Deserialize (ruleSet, unknownConditionStream);
+  }
+  catch (const std::exception&)
+  {
+    rejected = true;
+  }
+  SWITCH_ASSERT (rejected);
+
+  rejected = false;
+  try
+  {
+    std::istringstream malformedStream ("{ \"rules\" : [ { \"deviceId\" : ");
+    Switch::JsonSerializer::Deserialize (ruleSet, malformedStream);
+  }
+  catch (const std::exception&)
+  {
+    rejected = true;
+  }
+  SWITCH_ASSERT (rejected);
+
+  ruleEngine.SetRules (Switch::RuleSet ());
+  SWITCH_ASSERT (ruleEngine.IsEmpty ());
+}
+
+void Switch::ControllerTests::TestScheduler ()
+{
+  // every schedule sets an element in its own device, the device address tells which schedule fired
+  const switch_device_address_type deviceOffset = 100;
+  const uint64_t nowSeconds = std::chrono::duration_cast <std::chrono::seconds> (std::chrono::system_clock::now ().time_since_epoch ()).count ();
+
+  Switch::DataContainer::Element element;
+  element.m_address = 4;
+  element.m_magicNumber = 7;
+  element.m_value = 1;
+
+  Switch::Schedule schedule;
+  schedule.m_elements.push_back (element);
+
+  Switch::Scheduler::ScheduleMap schedules;
+  schedule.m_type = Switch::Schedule::ST_ONE_SHOT;
+  schedule.m_deviceAddress = deviceOffset + 1;
+  schedule.m_time = nowSeconds - 10;
+  schedules [1] = schedule;
+  schedule.m_type = Switch::Schedule::ST_RECURRING;
+  schedule.m_deviceAddress = deviceOffset + 2;
+  schedule.m_time = nowSeconds - 5;
+  schedule.m_periodSeconds = 1;
+  schedules [2] = schedule;
+  schedule.m_type = Switch::Schedule::ST_ONE_SHOT;
+  schedule.m_deviceAddress = deviceOffset + 3;
+  schedule.m_time = nowSeconds + 3600;
+  schedules [3] = schedule;
+  schedule.m_elements.clear ();
+  schedules [9] = schedule;
+
+  // invalid schedules are ignored when loaded, rejected when added
+  Switch::Scheduler scheduler;
+  SWITCH_ASSERT (std::numeric_limits <uint32_t>::max () == scheduler.GetDelayMicros ());
+  scheduler.SetSchedules (schedules);
+  Switch::Scheduler::ScheduleMap armedSchedules;
+  scheduler.GetSchedules (armedSchedules);
+  SWITCH_ASSERT ((3 == armedSchedules.size ()) && (armedSchedules.end () == armedSchedules.find (9)));
+
+  bool rejected = false;
+  try
+  {
+    scheduler.AddSchedule (9, schedule);
+  }
+  catch (const std::exception&)
+  {
+    rejected = true;
+  }
+  SWITCH_ASSERT (rejected);
+
+  rejected = false;
+  try
+  {
+    scheduler.AddSchedule (3, schedules [3]);
+  }
+  catch (const std::exception&)
+  {
+    rejected = true;
+  }
+  SWITCH_ASSERT (rejected);
+
+  std::list <Switch::Rule::Action> actions;
+  std::list <Switch::Rule::Action>::const_iterator itAction;
+  std::list <uint32_t> finishedScheduleIds;
+  std::map <switch_device_address_type, uint32_t> nrFired;
+  std::map <switch_device_address_type, uint64_t> firstFiredMillis;
+  std::chrono::steady_clock::time_point phaseStart;
+  uint64_t elapsedMillis;
+
+  // a one-shot schedule of which the time passed fires once and is removed, a recurring schedule is re-armed
+  phaseStart = std::chrono::steady_clock::now ();
+  do
+  {
+    actions.clear ();
+    scheduler.Advance (actions, finishedScheduleIds);
+    elapsedMillis = std::chrono::duration_cast <std::chrono::milliseconds> (std::chrono::steady_clock::now () - phaseStart).count ();
+    for (itAction = actions.begin (); actions.end () != itAction; ++itAction)
+    {
+      SWITCH_ASSERT ((1 == itAction->m_elements.size ()) && (4 == itAction->m_elements.front ().m_address));
+      if (0 == nrFired [itAction->m_deviceAddress]++)
+      {
+        firstFiredMillis [itAction->m_deviceAddress] = elapsedMillis;
+      }
+    }
+    std::this_thread::sleep_for (std::chrono::milliseconds (10));
+  }
+  while (1500 > elapsedMillis);
+
+  SWITCH_ASSERT ((1 == nrFired [deviceOffset + 1]) && (500 > firstFiredMillis [deviceOffset + 1]));
+  SWITCH_ASSERT ((1 == finishedScheduleIds.size ()) && (1 == finishedScheduleIds.front ()));
+  SWITCH_ASSERT ((1 <= nrFired [deviceOffset + 2]) && (2 >= nrFired [deviceOffset + 2]));
+  SWITCH_ASSERT (0 == nrFired [deviceOffset + 3]);
+  scheduler.GetSchedules (armedSchedules);
+  SWITCH_ASSERT ((2 == armedSchedules.size ()) && (armedSchedules.end () == armedSchedules.find (1)));
+  SWITCH_ASSERT (1100000 >= scheduler.GetDelayMicros ());
+
+  // off after on schedules are armed by the watched element of their device only, re-armed by the next on and cancelled by an off
+  schedule.m_type = Switch::Schedule::ST_OFF_AFTER_ON;
+  schedule.m_elements.push_back (element);
+  schedule.m_time = 0;
+  schedule.m_periodSeconds = 1;
+  schedule.m_deviceAddress = deviceOffset + 4;
+  schedule.m_elementAddress = 8;
+  scheduler.AddSchedule (4, schedule);
+  schedule.m_deviceAddress = deviceOffset + 5;
+  schedule.m_elementAddress = 9;
+  scheduler.AddSchedule (5, schedule);
+  schedule.m_deviceAddress = deviceOffset + 6;
+  schedule.m_elementAddress = 8;
+  scheduler.AddSchedule (6, schedule);
+  std::map <switch_device_address_type, std::list <Switch::DataContainer::Element>> changedElements;
+  element.m_address = 8;
+  changedElements [deviceOffset + 4].push_back (element);
+  changedElements [deviceOffset + 5].push_back (element);
+  element.m_address = 9;
+  changedElements [deviceOffset + 4].push_back (element);
+  changedElements [deviceOffset + 5].push_back (element);
+  changedElements [deviceOffset + 6].push_back (element);
+  element.m_address = 10;
+  changedElements [deviceOffset + 6].push_back (element);
+
+  nrFired.clear ();
+  firstFiredMillis.clear ();
+  finishedScheduleIds.clear ();
+  bool switchedAgain = false;
+  phaseStart = std::chrono::steady_clock::now ();
+  std::map <switch_device_address_type, std::list <Switch::DataContainer::Element>>::const_iterator itChangedElements;
+  for (itChangedElements = changedElements.begin (); changedElements.end () != itChangedElements; ++itChangedElements)
+  {
+    scheduler.HandleChangedElements (itChangedElements->first, itChangedElements->second);
+  }
+  do
+  {
+    actions.clear ();
+    scheduler.Advance (actions, finishedScheduleIds);
+    elapsedMillis = std::chrono::duration_cast <std::chrono::milliseconds> (std::chrono::steady_clock::now () - phaseStart).count ();
+    for (itAction = actions.begin (); actions.end () != itAction; ++itAction)
+    {
+      if (0 == nrFired [itAction->m_deviceAddress]++)
+      {
+        firstFiredMillis [itAction->m_deviceAddress] = elapsedMillis;
+      }
+    }
+    if (!switchedAgain && (500 <= elapsedMillis))
+    {
+      // switch the element watched by schedule 4 on again, the one watched by schedule 5 off
+      changedElements [deviceOffset + 4].front ().m_value = 2;
+      changedElements [deviceOffset + 5].back ().m_value = 0;
+      scheduler.HandleChangedElements (deviceOffset + 4, changedElements [deviceOffset + 4]);
+      scheduler.HandleChangedElements (deviceOffset + 5, changedElements [deviceOffset + 5]);
+      switchedAgain = true;
+    }
+    std::this_thread::sleep_for (std::chrono::milliseconds (10));
+  }
+  while (2200 > elapsedMillis);
+
+  SWITCH_ASSERT ((1 == nrFired [deviceOffset + 4]) && (1500 <= firstFiredMillis [deviceOffset + 4]));
+  SWITCH_ASSERT (0 == nrFired [deviceOffset + 5]);
+  SWITCH_ASSERT (0 == nrFired [deviceOffset + 6]);
+  SWITCH_ASSERT (finishedScheduleIds.empty ());
+
+  // schedules reloaded from their serialized definitions are armed as before
+  std::map <uint32_t, std::string> definitions;
+  scheduler.GetSchedules (armedSchedules);
+  SWITCH_ASSERT (5 == armedSchedules.size ());
+  Switch::Scheduler::ScheduleMap::const_iterator itSchedule;
+  for (itSchedule = armedSchedules.begin (); armedSchedules.end () != itSchedule; ++itSchedule)
+  {
+    std::stringstream definitionStream;
+    Switch::JsonSerializer::Serialize (definitionStream, itSchedule->second);
+    definitions [itSchedule->first] = definitionStream.str ();
+  }
+  definitions [10] = "{ \"type\" : \"daily\", \"deviceId\" : 110, \"values\" : [] }";
+
+  Switch::Scheduler::ScheduleMap reloadedSchedules;
+  std::map <uint32_t, std::string>::const_iterator itDefinition;
+  for (itDefinition = definitions.begin (); definitions.end () != itDefinition; ++itDefinition)
+  {
+    try
+    {
+      std::stringstream definitionStream (itDefinition->second);
+      Switch::JsonSerializer::Deserialize (reloadedSchedules [itDefinition->first], definitionStream);
+    }
+    catch (const std::exception&)
+    {
+      reloadedSchedules.erase (itDefinition->first);
+    }
+  }
+  SWITCH_ASSERT ((5 == reloadedSchedules.size ()) && (reloadedSchedules.end () == reloadedSchedules.find (10)));
+
+  scheduler.SetSchedules (reloadedSchedules);
+  scheduler.GetSchedules (reloadedSchedules);
+  SWITCH_ASSERT (armedSchedules.size () == reloadedSchedules.size ());
+  Switch::Scheduler::ScheduleMap::const_iterator itReloadedSchedule;
+  for (itSchedule = armedSchedules.begin (), itReloadedSchedule = reloadedSchedules.begin (); armedSchedules.end () != itSchedule; ++itSchedule, ++itReloadedSchedule)
+  {
+    SWITCH_ASSERT (itSchedule->first == itReloadedSchedule->first);
+    SWITCH_ASSERT (itSchedule->second.m_type == itReloadedSchedule->second.m_type);
+    SWITCH_ASSERT (itSchedule->second.m_deviceAddress == itReloadedSchedule->second.m_deviceAddress);
+    SWITCH_ASSERT (itSchedule->second.m_time == itReloadedSchedule->second.m_time);
+    SWITCH_ASSERT (itSchedule->second.m_periodSeconds == itReloadedSchedule->second.m_periodSeconds);
+    SWITCH_ASSERT (itSchedule->second.m_elementAddress == itReloadedSchedule->second.m_elementAddress);
+    SWITCH_ASSERT (itSchedule->second.m_elements.size () == itReloadedSchedule->second.m_elements.size ());
+    SWITCH_ASSERT (itSchedule->second.m_elements.front ().m_value == itReloadedSchedule->second.m_elements.front ().m_value);
+  }
+
+  // the watch index is rebuilt, removed schedules no longer fire
+  SWITCH_ASSERT (scheduler.RemoveSchedule (5));
+  SWITCH_ASSERT (!scheduler.RemoveSchedule (5));
+  changedElements [deviceOffset + 4].front ().m_value = 1;
+  changedElements [deviceOffset + 5].back ().m_value = 1;
+
+  nrFired.clear ();
+  phaseStart = std::chrono::steady_clock::now ();
+  for (itChangedElements = changedElements.begin (); changedElements.end () != itChangedElements; ++itChangedElements)
+  {
+    scheduler.HandleChangedElements (itChangedElements->first, itChangedElements->second);
+  }
+  do
+  {
+    actions.clear ();
+    scheduler.Advance (actions, finishedScheduleIds);
+    elapsedMillis = std::chrono::duration_cast <std::chrono::milliseconds> (std::chrono::steady_clock::now () - phaseStart).count ();
+    for (itAction = actions.begin (); actions.end () != itAction; ++itAction)
+    {
+      ++nrFired [itAction->m_deviceAddress];
+    }
+    std::this_thread::sleep_for (std::chrono::milliseconds (10));
+  }
+  while (1400 > elapsedMillis);
+
+  SWITCH_ASSERT (1 == nrFired [deviceOffset + 4]);
+  SWITCH_ASSERT (0 == nrFired [deviceOffset + 5]);
+  SWITCH_ASSERT (1 <= nrFired [deviceOffset + 2]);
+  SWITCH_ASSERT (0 == nrFired [deviceOffset + 3]);
+}
+
+void Switch::ControllerTests::TestChangeVersionLog ()
+{
+  const uint64_t startVersion = 1000;
+  const switch_device_address_type deviceAddress1 = 1;
+  const switch_device_address_type deviceAddress2 = 2;
+
+  Switch::DataContainer::Element element;
+  element.m_magicNumber = 0;
+  element.m_value = 0;
+  std::list <Switch::DataContainer::Element> changedElements;
+
+  // a run starts at the start version, only the versions issued since are known
+  Switch::ChangeVersionLog changeVersionLog;
+  changeVersionLog.Reset (startVersion);
+  SWITCH_ASSERT (startVersion == changeVersionLog.GetVersion ());
+  SWITCH_ASSERT (changeVersionLog.IsKnown (startVersion));
+  SWITCH_ASSERT (!changeVersionLog.IsKnown (0));
+  SWITCH_ASSERT (!changeVersionLog.IsKnown (startVersion + 1));
+
+  // every change gets the next version
+  changeVersionLog.RecordSummaryChange (deviceAddress1, true);
+  const uint64_t identifiedVersion = changeVersionLog.GetVersion ();
+  SWITCH_ASSERT (startVersion + 1 == identifiedVersion);
+
+  element.m_address = 8;
+  changedElements.push_back (element);
+  changeVersionLog.RecordValueChanges (deviceAddress2, changedElements);
+  const uint64_t valuesVersion = changeVersionLog.GetVersion ();
+  SWITCH_ASSERT (identifiedVersion + 1 == valuesVersion);
+
+  changedElements.clear ();
+  changeVersionLog.RecordValueChanges (deviceAddress2, changedElements);
+  SWITCH_ASSERT (valuesVersion == changeVersionLog.GetVersion ());
+
+  changeVersionLog.RecordSummaryChange (deviceAddress2, false);
+  const uint64_t connectionVersion = changeVersionLog.GetVersion ();
+  SWITCH_ASSERT (valuesVersion + 1 == connectionVersion);
+
+  // walking the versions from a version tells exactly the later changes
+  const Switch::ChangeVersionLog::device_versions_type& deviceVersions = changeVersionLog.GetDeviceVersions ();
+  SWITCH_ASSERT (2 == deviceVersions.size ());
+  const Switch::ChangeVersionLog::DeviceVersions& versions1 = deviceVersions.find (deviceAddress1)->second;
+  const Switch::ChangeVersionLog::DeviceVersions& versions2 = deviceVersions.find (deviceAddress2)->second;
+  SWITCH_ASSERT (versions1.HasSummaryChangedSince (startVersion) && versions1.HaveAllValuesChangedSince (startVersion));
+  SWITCH_ASSERT (!versions1.HasSummaryChangedSince (identifiedVersion) && !versions1.HaveAllValuesChangedSince (identifiedVersion));
+  SWITCH_ASSERT (versions2.HasElementChangedSince (8, identifiedVersion) && !versions2.HasElementChangedSince (16, identifiedVersion));
+  SWITCH_ASSERT (!versions2.HasElementChangedSince (8, valuesVersion) && versions2.HasSummaryChangedSince (valuesVersion));
+  SWITCH_ASSERT (!versions2.HaveAllValuesChangedSince (startVersion));
+  SWITCH_ASSERT (connectionVersion == versions2.m_version);
+
+  // identifying a device again supersedes its element versions
+  changeVersionLog.RecordSummaryChange (deviceAddress2, true);
+  SWITCH_ASSERT (versions2.HaveAllValuesChangedSince (connectionVersion) && versions2.m_elementVersions.empty ());
+
+  // a new run starts above the previous run, even if the clock was set back
+  const uint64_t previousVersion = changeVersionLog.GetVersion ();
+  changeVersionLog.Reset (startVersion);
+  SWITCH_ASSERT (previousVersion + 1 == changeVersionLog.GetVersion ());
+  SWITCH_ASSERT (changeVersionLog.GetDeviceVersions ().empty ());
+  SWITCH_ASSERT (!changeVersionLog.IsKnown (previousVersion));
+
+  // versions of a run of another process, ahead of the clock, are unknown rather than current
+  Switch::ChangeVersionLog restartedVersionLog;
+  restartedVersionLog.Reset (startVersion);
+  restartedVersionLog.RecordSummaryChange (deviceAddress1, false);
+  SWITCH_ASSERT (!restartedVersionLog.IsKnown (previousVersion + startVersion));
+  SWITCH_ASSERT (restartedVersionLog.IsKnown (restartedVersionLog.GetVersion ()));
+}
+
+void Switch::ControllerTests::TestObserverRegistry ()
+{
+  typedef Switch::ObserverRegistry <const uint32_t&, const std::list <uint32_t>&> Registry;
+
+  Registry registry;
+  SWITCH_ASSERT (registry.IsEmpty ());
+
+  // observers are called in the order they were connected
+  std::vector <uint32_t> calls;
+  Switch::ObserverConnection connection1 = registry.Connect ([&calls] (const uint32_t& i_id, const std::list <uint32_t>&) { calls.push_back (i_id + 1); });
+  Switch::ObserverConnection connection2 = registry.Connect ([&calls] (const uint32_t& i_id, const std::list <uint32_t>&) { calls.push_back (i_id + 2); });
+  SWITCH_ASSERT (!registry.IsEmpty ());
+  SWITCH_ASSERT (connection1.IsConnected () && connection2.IsConnected ());
+
+  std::list <uint32_t> values;
+  registry.Emit (10, values);
+  SWITCH_ASSERT ((2 == calls.size ()) && (11 == calls [0]) && (12 == calls [1]));
+
+  // disconnected observers are no longer called
+  connection1.Disconnect ();
+  SWITCH_ASSERT (!connection1.IsConnected ());
+  calls.clear ();
+  registry.Emit (10, values);
+  SWITCH_ASSERT ((1 == calls.size ()) && (12 == calls [0]));
+
+  // observers may disconnect themselves while being called
+  Switch::ObserverConnection selfConnection;
+  uint32_t nrSelfCalls = 0;
+  selfConnection = registry.Connect ([&selfConnection, &nrSelfCalls] (const uint32_t&, const std::list <uint32_t>&) { ++nrSelfCalls; selfConnection.Disconnect (); });
+  registry.Emit (10, values);
+  registry.Emit (10, values);
+  SWITCH_ASSERT (1 == nrSelfCalls);
+  connection2.Disconnect ();
+  SWITCH_ASSERT (registry.IsEmpty ());
+
+  // concurrent emissions, connects and disconnects; a disconnected observer is never called afterwards
+  std::atomic <bool> stop (false);
+  std::atomic <uint32_t> nrCalls (0);
+  std::list <std::thread> emitters;
+  for (uint32_t i=0; i<2; ++i)
+  {
+    emitters.push_back (std::thread ([&registry, &stop, &values] ()
+    {
+      while (!stop.load ())
+      {
+        registry.Emit (0, values);
+      }
+    }));
+  }
+  for (uint32_t i=0; i<1000; ++i)
+  {
+    std::shared_ptr <std::atomic <bool>> pDisconnected (new std::atomic <bool> (false));
+    Switch::ObserverConnection connection = registry.Connect ([pDisconnected, &nrCalls] (const uint32_t&, const std::list <uint32_t>&)
+    {
+      SWITCH_ASSERT (!pDisconnected->load ());
+      ++nrCalls;
+    });
+    std::this_thread::yield ();
+    connection.Disconnect ();
+    pDisconnected->store (true);
+  }
+  stop.store (true);
+
+  std::list <std::thread>::iterator itEmitter;
+  for (itEmitter = emitters.begin (); emitters.end () != itEmitter; ++itEmitter)
+  {
+    itEmitter->join ();
+  }
+
+  // disconnecting from within the emission of another registry waits for the emissions of the registry on other threads
+  Registry otherRegistry;
+  std::atomic <bool> started (false);
+  std::atomic <bool> finished (false);
+  Switch::ObserverConnection slowConnection = registry.Connect ([&started, &finished] (const uint32_t&, const std::list <uint32_t>&)
+  {
+    started.store (true);
+    std::this_thread::sleep_for (std::chrono::milliseconds (50));
+    finished.store (true);
+  });
+  bool finishedOnDisconnect = false;
+  Switch::ObserverConnection disconnectingConnection = otherRegistry.Connect ([&slowConnection, &finished, &finishedOnDisconnect] (const uint32_t&, const std::list <uint32_t>&)
+  {
+    slowConnection.Disconnect ();
+    finishedOnDisconnect = finished.load ();
+  });
+  std::thread slowEmitter ([&registry, &values] () { registry.Emit (0, values); });
+  while (!started.load ())
+  {
+    std::this_thread::yield ();
+  }
+  otherRegistry.Emit (0, values);
+  slowEmitter.join ();
+  SWITCH_ASSERT (finishedOnDisconnect);
+  disconnectingConnection.Disconnect ();
+
+  // connections outlive the registry
+  Switch::ObserverConnection orphanConnection;
+  {
+    Registry orphanRegistry;
+    orphanConnection = orphanRegistry.Connect ([] (const uint32_t&, const std::list <uint32_t>&) {});
+  }
+  SWITCH_ASSERT (!orphanConnection.IsConnected ());
+  orphanConnection.Disconnect ();
+}
+
+void Switch::ControllerTests::BenchmarkObserverRegistry ()
+{
+  const uint32_t nrObservers = 4;
+  const uint32_t nrEmissions = 1000000;
+
+  std::list <Switch::Interface::Device::Value> values (4);
+  uint32_t sum = 0;
+
+  // boost::signals2, as used on the update path before
+  boost::signals2::signal <void (const uint32_t&, const std::list <Switch::Interface::Device::Value>&)> signal;
+  for (uint32_t i=0; i<nrObservers; ++i)
+  {
+    signal.connect ([&sum] (const uint32_t& i_id, const std::list <Switch::Interface::Device::Value>& i_values) { sum += i_id + i_values.size (); });
+  }
+
+  std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now ();
+  for (uint32_t i=0; i<nrEmissions; ++i)
+  {
+    if (0 != signal.num_slots ())
+    {
+      signal (i, values);
+    }
+  }
+  double signalNanos = std::chrono::duration_cast <std::chrono::duration <double, std::nano>> (std::chrono::high_resolution_clock::now () - start).count ();
+
+  // observer registry
+  Switch::ObserverRegistry <const uint32_t&, const std::list <Switch::Interface::Device::Value>&> registry;
+  for (uint32_t i=0; i<nrObservers; ++i)
+  {
+    registry.Connect ([&sum] (const uint32_t& i_id, const std::list <Switch::Interface::Device::Value>& i_values) { sum += i_id + i_values.size (); });
+  }
+
+  start = std::chrono::high_resolution_clock::now ();
+  for (uint32_t i=0; i<nrEmissions; ++i)
+  {
+    if (!registry.IsEmpty ())
+    {
+      registry.Emit (i, values);
+    }
+  }
+  double registryNanos = std::chrono::duration_cast <std::chrono::duration <double, std::nano>> (std::chrono::high_resolution_clock::now () - start).count ();
+
+  std::cout << "Emitting to " << nrObservers << " observers: boost::signals2 " << signalNanos/nrEmissions << " ns, observer registry "
+            << registryNanos/nrEmissions << " ns per emission (" << sum << ")" << std::endl;
+}
+
 void Switch::ControllerTests::Cleanup ()
 {
   if (ssvu::FileSystem::exists ("./switch.db"))
@@ -261,6 +1070,15 @@ void Switch::ControllerTests::Run ()
     std::cout << "Press enter to continue ... ";
     std::cin.ignore().get();*/
 
+    TestRouterEventQueue ();
+    TestControllerWorkerPool ();
+    TestTimerWheel ();
+    TestRuleEngine ();
+    TestScheduler ();
+    TestChangeVersionLog ();
+    TestObserverRegistry ();
+    BenchmarkObserverRegistry ();
+
     TestFunctional ();
   }
   catch (const std::exception& i_exception)
@@ -71,6 +71,7 @@ namespace Switch
           uint32_t    m_magicNumber;  ///< Magic number for value adressing verification.
           std::string m_name;         ///< Value name.
           std::string m_description;  ///< Value description.
+          std::string m_group;        ///< Name of the group the value belongs to.
           uint32_t    m_minValue;     ///< Minimum value.
           uint32_t    m_maxValue;     ///< Maximum value.
         };
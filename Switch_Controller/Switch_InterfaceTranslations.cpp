@@ -35,6 +35,7 @@ void Switch::Interface::_Translate (std::list <Switch::Interface::Device::Value:
 
     valueDataFormat.m_name        = dataFormat.m_name;
     valueDataFormat.m_description = dataFormat.m_description;
+    valueDataFormat.m_group       = dataFormat.m_group;
     valueDataFormat.m_address     = io_address;
     valueDataFormat.m_magicNumber = dataFormat.ComputeMagicNumber (io_address);
     valueDataFormat.m_minValue    = dataFormat.m_minValue;
@@ -0,0 +1,135 @@
+/*?*************************************************************************
+*                           Switch_ObserverRegistry.cpp
+*                           -----------------------
+*    copyright            : (C) 2014 by Wouter Charle
+*    email                : wouter.charle@gmail.com
+*
+*    DISCLAIMER OF DAMAGES
+*    ---------------------
+*    Wouter Charle has made every effort possible to ensure that the software
+*    is free of any bugs or errors, however in no way is the software to
+*    be considered error or bug free. You assume all responsibility for
+*    any damages or lost data that may result from any errors or bugs in
+*    the software.
+*
+*    IN NO EVENT WILL VISION++ BE LIABLE TO YOU FOR ANY GENERAL, SPECIAL,
+*    INDIRECT, CONSEQUENTIAL, INCIDENTAL OR OTHER DAMAGES ARISING OUT OF
+*    THIS LICENSE.
+*
+*    In no case shall Wouter Charle's liability exceed the purchase price for
+*    the software or services.
+*
+***************************************************************************/
+
+#include "Switch_ObserverRegistry.h"
+
+// project includes
+
+// switch includes
+
+// third-party includes
+#include <thread>
+#include <algorithm>
+
+
+thread_local std::vector <const Switch::ObserverRegistryBase*> Switch::ObserverRegistryBase::s_emittingRegistries;
+
+/*!
+  \brief Default constructor
+ */
+Switch::ObserverConnection::ObserverConnection ()
+: m_slotId (0)
+{
+}
+
+/*!
+  \brief Constructor
+ */
+Switch::ObserverConnection::ObserverConnection (const std::weak_ptr <Switch::ObserverRegistryBase>& i_registry, const uint64_t& i_slotId)
+: m_registry (i_registry),
+  m_slotId (i_slotId)
+{
+}
+
+/*!
+  \brief Destructor
+ */
+Switch::ObserverConnection::~ObserverConnection ()
+{
+}
+
+void Switch::ObserverConnection::Disconnect ()
+{
+  std::shared_ptr <Switch::ObserverRegistryBase> pRegistry = m_registry.lock ();
+  if (pRegistry)
+  {
+    pRegistry->Disconnect (m_slotId);
+  }
+  m_registry.reset ();
+}
+
+bool Switch::ObserverConnection::IsConnected () const
+{
+  std::shared_ptr <Switch::ObserverRegistryBase> pRegistry = m_registry.lock ();
+  return (pRegistry && pRegistry->IsConnected (m_slotId));
+}
+
+/*!
+  \brief Default constructor
+ */
+Switch::ObserverRegistryBase::ObserverRegistryBase ()
+: m_nextSlotId (1),
+  m_epoch (0)
+{
+  m_nrReaders [0] = 0;
+  m_nrReaders [1] = 0;
+}
+
+/*!
+  \brief Destructor
+ */
+Switch::ObserverRegistryBase::~ObserverRegistryBase ()
+{
+}
+
+/*!
+  \brief Enters the reader counter of the current epoch.
+ */
+Switch::ObserverRegistryBase::ReadGuard::ReadGuard (const Switch::ObserverRegistryBase& i_registry)
+: mr_registry (i_registry),
+  m_readerIndex (i_registry.m_epoch.load () & 1)
+{
+  mr_registry.m_nrReaders [m_readerIndex].fetch_add (1);
+  s_emittingRegistries.push_back (&mr_registry);
+}
+
+/*!
+  \brief Leaves the reader counter entered on construction.
+ */
+Switch::ObserverRegistryBase::ReadGuard::~ReadGuard ()
+{
+  s_emittingRegistries.pop_back ();
+  mr_registry.m_nrReaders [m_readerIndex].fetch_sub (1);
+}
+
+bool Switch::ObserverRegistryBase::_Synchronize ()
+{
+  // note: waiting here would wait for the emission this thread is part of, emissions of other registries are waited for
+  if (s_emittingRegistries.end () != std::find (s_emittingRegistries.begin (), s_emittingRegistries.end (), this))
+  {
+    return false;
+  }
+
+  // flip the epoch twice, a reader that read a stale epoch is counted in the other counter
+  for (uint32_t i=0; i<2; ++i)
+  {
+    uint32_t readerIndex = m_epoch.load () & 1;
+    m_epoch.store (readerIndex ^ 1);
+    while (0 != m_nrReaders [readerIndex].load ())
+    {
+      std::this_thread::yield ();
+    }
+  }
+
+  return true;
+}
@@ -0,0 +1,426 @@
+/*?*************************************************************************
+*                           Switch_ObserverRegistry.h
+*                           -----------------------
+*    copyright            : (C) 2014 by Wouter Charle
+*    email                : wouter.charle@gmail.com
+*
+*    DISCLAIMER OF DAMAGES
+*    ---------------------
+*    Wouter Charle has made every effort possible to ensure that the software
+*    is free of any bugs or errors, however in no way is the software to
+*    be considered error or bug free. You assume all responsibility for
+*    any damages or lost data that may result from any errors or bugs in
+*    the software.
+*
+*    IN NO EVENT WILL VISION++ BE LIABLE TO YOU FOR ANY GENERAL, SPECIAL,
+*    INDIRECT, CONSEQUENTIAL, INCIDENTAL OR OTHER DAMAGES ARISING OUT OF
+*    THIS LICENSE.
+*
+*    In no case shall Wouter Charle's liability exceed the purchase price for
+*    the software or services.
+*
+***************************************************************************/
+
+#ifndef _SWITCH_OBSERVERREGISTRY
+#define _SWITCH_OBSERVERREGISTRY
+
+// project includes
+
+// switch includes
+#include <Switch_Base/Switch_CompilerConfiguration.h>
+#include <Switch_Base/Switch_Types.h>
+
+// third party includes
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+
+namespace Switch
+{
+  // forward declarations
+  class ObserverRegistryBase;
+
+  /*!
+    \brief Connection of an observer to an observer registry.
+
+    Destroying the connection does not disconnect the observer.
+   */
+  class ObserverConnection
+  {
+  public:
+
+    /*!
+      \brief Default constructor, creates a connection that is not connected.
+     */
+    ObserverConnection ();
+    /*!
+      \brief Constructor.
+
+      \param [in] i_registry  The registry the observer is connected to.
+      \param [in] i_slotId    The id of the observer's slot in the registry.
+     */
+    ObserverConnection (const std::weak_ptr <ObserverRegistryBase>& i_registry, const uint64_t& i_slotId);
+    /*!
+      \brief Destructor.
+     */
+    ~ObserverConnection ();
+
+    // using default copy constructor and assignment operator
+    ObserverConnection (const ObserverConnection& i_other) = default;
+    ObserverConnection& operator= (const ObserverConnection& i_other) = default;
+
+    /*!
+      \brief Disconnects the observer.
+
+      When called outside of an emission, the observer is no longer called by any
+      thread once the call returns.
+
+      \note Must not be called while holding a lock the observer takes.
+     */
+    void Disconnect ();
+    /*!
+      \brief Checks if the observer is connected.
+
+      \return True if the observer is connected, false otherwise.
+     */
+    bool IsConnected () const;
+
+  private:
+
+    std::weak_ptr <ObserverRegistryBase>  m_registry;   ///< The registry the observer is connected to.
+    uint64_t                              m_slotId;     ///< The id of the observer's slot in the registry.
+  };
+
+  /*!
+    \brief Read-copy-update synchronization shared by all observer registries.
+
+    Emitting threads announce themselves in one of two reader counters, selected
+    by the current epoch. A writer publishes a new slot list and then flips the
+    epoch twice, waiting for the readers of each counter to leave, before freeing
+    the old list. Emitting takes two atomic increments and neither locks nor
+    allocates.
+   */
+  class ObserverRegistryBase
+  {
+  public:
+
+    /*!
+      \brief Default constructor.
+     */
+    ObserverRegistryBase ();
+    /*!
+      \brief Destructor.
+     */
+    virtual ~ObserverRegistryBase ();
+
+    // copy constructor and assignment operator are disabled
+    ObserverRegistryBase (const ObserverRegistryBase& i_other) = delete;
+    ObserverRegistryBase& operator= (const ObserverRegistryBase& i_other) = delete;
+
+    /*!
+      \brief Disconnects the observer of a slot.
+
+      \param [in] i_slotId The id of the slot.
+     */
+    virtual void Disconnect (const uint64_t& i_slotId) = 0;
+    /*!
+      \brief Checks if a slot is connected.
+
+      \param [in] i_slotId The id of the slot.
+
+      \return True if the slot is connected, false otherwise.
+     */
+    virtual bool IsConnected (const uint64_t& i_slotId) const = 0;
+
+  protected:
+
+    /*!
+      \brief Guards the slot list read by an emitting thread.
+     */
+    class ReadGuard
+    {
+    public:
+
+      explicit ReadGuard (const ObserverRegistryBase& i_registry);
+      ~ReadGuard ();
+
+      ReadGuard (const ReadGuard& i_other) = delete;
+      ReadGuard& operator= (const ReadGuard& i_other) = delete;
+
+    private:
+
+      const ObserverRegistryBase& mr_registry;
+      uint32_t                    m_readerIndex;
+    };
+
+    /*!
+      \brief Waits until no thread reads a slot list that was replaced.
+
+      \return True if the replaced slot lists may be freed, false if called from an emission of this registry on this thread.
+
+      \note The writer mutex must be locked.
+     */
+    bool _Synchronize ();
+
+    std::mutex  m_writerMutex;  ///< Serializes connecting and disconnecting.
+    uint64_t    m_nextSlotId;   ///< The id of the next connected slot.
+
+  private:
+
+    mutable std::atomic <uint32_t>  m_epoch;          ///< Selects the reader counter used by new readers.
+    mutable std::atomic <uint32_t>  m_nrReaders [2];  ///< The number of emitting threads per epoch.
+
+    static thread_local std::vector <const ObserverRegistryBase*> s_emittingRegistries;  ///< The registries emitting on this thread, the innermost emission last.
+  };
+
+  /*!
+    \brief Registry of observers called on every emission.
+
+    Replaces boost::signals2 on the update path. Connecting and disconnecting copy
+    the slot list, emitting reads the current list without locking nor allocating.
+    Emissions from several threads may run concurrently.
+
+    \note Observers are called in the order they were connected.
+   */
+  template <typename... Args>
+  class ObserverRegistry
+  {
+  public:
+
+    typedef std::function <void (Args...)> Slot;
+
+    /*!
+      \brief Default constructor.
+     */
+    ObserverRegistry ();
+    /*!
+      \brief Destructor.
+
+      \note No emission may be in progress.
+     */
+    ~ObserverRegistry ();
+
+    // copy constructor and assignment operator are disabled
+    ObserverRegistry (const ObserverRegistry& i_other) = delete;
+    ObserverRegistry& operator= (const ObserverRegistry& i_other) = delete;
+
+    /*!
+      \brief Connects an observer.
+
+      \param [in] i_slot The observer.
+
+      \return The connection of the observer.
+     */
+    Switch::ObserverConnection Connect (const Slot& i_slot);
+    /*!
+      \brief Calls all connected observers.
+
+      \param [in] i_args The arguments passed to the observers.
+     */
+    void Emit (Args... i_args) const;
+    /*!
+      \brief Checks if no observers are connected.
+
+      \return True if no observers are connected, false otherwise.
+     */
+    bool IsEmpty () const;
+
+  private:
+
+    /*!
+      \brief Shared state of the registry, outlives the registry while a connection disconnects.
+     */
+    class Core : public ObserverRegistryBase
+    {
+    public:
+
+      class Entry
+      {
+      public:
+        uint64_t  m_slotId;   ///< The id of the slot.
+        Slot      m_slot;     ///< The observer.
+      };
+
+      typedef std::vector <Entry> SlotList;
+
+      Core ();
+      virtual ~Core ();
+
+      uint64_t Connect (const Slot& i_slot);
+      void Emit (Args... i_args) const;
+      bool IsEmpty () const;
+
+      virtual void Disconnect (const uint64_t& i_slotId);
+      virtual bool IsConnected (const uint64_t& i_slotId) const;
+
+    private:
+
+      /*!
+        \brief Publishes a new slot list and frees the replaced one once no thread reads it.
+
+        \note The writer mutex must be locked.
+       */
+      void _Publish (const SlotList* i_pSlots);
+
+      std::atomic <const SlotList*> m_pSlots;         ///< The current slot list.
+      std::atomic <uint32_t>        m_nrSlots;        ///< The number of slots in the current list.
+      std::vector <const SlotList*> m_retiredSlots;   ///< Replaced slot lists that may still be read.
+    };
+
+    std::shared_ptr <Core> m_pCore;
+  };
+}
+
+template <typename... Args>
+Switch::ObserverRegistry <Args...>::ObserverRegistry ()
+: m_pCore (new Core ())
+{
+}
+
+template <typename... Args>
+Switch::ObserverRegistry <Args...>::~ObserverRegistry ()
+{
+}
+
+template <typename... Args>
+Switch::ObserverConnection Switch::ObserverRegistry <Args...>::Connect (const Slot& i_slot)
+{
+  uint64_t slotId = m_pCore->Connect (i_slot);
+  return Switch::ObserverConnection (m_pCore, slotId);
+}
+
+template <typename... Args>
+void Switch::ObserverRegistry <Args...>::Emit (Args... i_args) const
+{
+  m_pCore->Emit (i_args...);
+}
+
+template <typename... Args>
+bool Switch::ObserverRegistry <Args...>::IsEmpty () const
+{
+  return m_pCore->IsEmpty ();
+}
+
+template <typename... Args>
+Switch::ObserverRegistry <Args...>::Core::Core ()
+: m_pSlots (new SlotList ()),
+  m_nrSlots (0)
+{
+}
+
+template <typename... Args>
+Switch::ObserverRegistry <Args...>::Core::~Core ()
+{
+  delete m_pSlots.load ();
+
+  typename std::vector <const SlotList*>::iterator itSlots;
+  for (itSlots = m_retiredSlots.begin (); m_retiredSlots.end () != itSlots; ++itSlots)
+  {
+    delete *itSlots;
+  }
+}
+
+template <typename... Args>
+uint64_t Switch::ObserverRegistry <Args...>::Core::Connect (const Slot& i_slot)
+{
+  std::unique_lock <std::mutex> writerLock (m_writerMutex);
+
+  SlotList* pSlots = new SlotList (*m_pSlots.load ());
+  pSlots->push_back (Entry ());
+  pSlots->back ().m_slotId = m_nextSlotId++;
+  pSlots->back ().m_slot   = i_slot;
+
+  uint64_t slotId = pSlots->back ().m_slotId;
+  _Publish (pSlots);
+
+  return slotId;
+}
+
+template <typename... Args>
+void Switch::ObserverRegistry <Args...>::Core::Disconnect (const uint64_t& i_slotId)
+{
+  std::unique_lock <std::mutex> writerLock (m_writerMutex);
+
+  const SlotList& slots = *m_pSlots.load ();
+  SlotList* pSlots = new SlotList ();
+  pSlots->reserve (slots.size ());
+
+  typename SlotList::const_iterator itEntry;
+  for (itEntry = slots.begin (); slots.end () != itEntry; ++itEntry)
+  {
+    if (i_slotId != itEntry->m_slotId)
+    {
+      pSlots->push_back (*itEntry);
+    }
+  }
+
+  if (slots.size () == pSlots->size ())
+  {
+    // not connected
+    delete pSlots;
+    return;
+  }
+
+  _Publish (pSlots);
+}
+
+template <typename... Args>
+bool Switch::ObserverRegistry <Args...>::Core::IsConnected (const uint64_t& i_slotId) const
+{
+  ReadGuard readGuard (*this);
+
+  const SlotList& slots = *m_pSlots.load ();
+  typename SlotList::const_iterator itEntry;
+  for (itEntry = slots.begin (); slots.end () != itEntry; ++itEntry)
+  {
+    if (i_slotId == itEntry->m_slotId)
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+template <typename... Args>
+void Switch::ObserverRegistry <Args...>::Core::Emit (Args... i_args) const
+{
+  ReadGuard readGuard (*this);
+
+  const SlotList& slots = *m_pSlots.load ();
+  typename SlotList::const_iterator itEntry;
+  for (itEntry = slots.begin (); slots.end () != itEntry; ++itEntry)
+  {
+    itEntry->m_slot (i_args...);
+  }
+}
+
+template <typename... Args>
+bool Switch::ObserverRegistry <Args...>::Core::IsEmpty () const
+{
+  return (0 == m_nrSlots.load ());
+}
+
+template <typename... Args>
+void Switch::ObserverRegistry <Args...>::Core::_Publish (const SlotList* i_pSlots)
+{
+  const SlotList* pReplacedSlots = m_pSlots.exchange (i_pSlots);
+  m_nrSlots.store (static_cast <uint32_t> (i_pSlots->size ()));
+  m_retiredSlots.push_back (pReplacedSlots);
+
+  // free the replaced lists, unless this thread is reading one of them
+  if (_Synchronize ())
+  {
+    typename std::vector <const SlotList*>::iterator itSlots;
+    for (itSlots = m_retiredSlots.begin (); m_retiredSlots.end () != itSlots; ++itSlots)
+    {
+      delete *itSlots;
+    }
+    m_retiredSlots.clear ();
+  }
+}
+
+#endif // _SWITCH_OBSERVERREGISTRY
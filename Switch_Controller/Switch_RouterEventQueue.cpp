@@ -0,0 +1,194 @@
+/*?*************************************************************************
+*                           Switch_RouterEventQueue.cpp
+*                           -----------------------
+*    copyright            : (C) 2014 by Wouter Charle
+*    email                : wouter.charle@gmail.com
+*
+*    DISCLAIMER OF DAMAGES
+*    ---------------------
+*    Wouter Charle has made every effort possible to ensure that the software
+*    is free of any bugs or errors, however in no way is the software to
+*    be considered error or bug free. You assume all responsibility for
+*    any damages or lost data that may result from any errors or bugs in
+*    the software.
+*
+*    IN NO EVENT WILL VISION++ BE LIABLE TO YOU FOR ANY GENERAL, SPECIAL,
+*    INDIRECT, CONSEQUENTIAL, INCIDENTAL OR OTHER DAMAGES ARISING OUT OF
+*    THIS LICENSE.
+*
+*    In no case shall Wouter Charle's liability exceed the purchase price for
+*    the software or services.
+*
+***************************************************************************/
+
+#include "Switch_RouterEventQueue.h"
+
+// switch includes
+#include <Switch_Base/Switch_Debug.h>
+
+// third-party includes
+#include <cstring>
+
+
+// the position arithmetic relies on wrapping the 32 bit positions onto the slots
+static_assert (0 == (CONTROLLER_ROUTER_EVENT_QUEUE_SIZE & (CONTROLLER_ROUTER_EVENT_QUEUE_SIZE - 1)), "router event queue size must be a power of two");
+
+
+/*!
+  \brief Default constructor
+ */
+Switch::RouterEvent::RouterEvent ()
+: m_type          (RE_NEW_NODE_DISCOVERED),
+  m_deviceAddress (0x0),
+  m_flag          (false)
+{
+  memset (&m_deviceInfo, 0, sizeof (m_deviceInfo));
+}
+
+/*!
+  \brief Destructor
+ */
+Switch::RouterEvent::~RouterEvent ()
+{
+}
+
+/*!
+  \brief Default constructor
+ */
+Switch::RouterEventQueue::RouterEventQueue ()
+: m_enqueuePosition (0),
+  m_dequeuePosition (0),
+  m_nrWaitingProducers (0)
+{
+  // mark all slots as free for the first round of positions
+  for (uint32_t i=0; i<CONTROLLER_ROUTER_EVENT_QUEUE_SIZE; ++i)
+  {
+    m_slots [i].m_sequence.store (i, std::memory_order_relaxed);
+  }
+}
+
+/*!
+  \brief Destructor
+ */
+Switch::RouterEventQueue::~RouterEventQueue ()
+{
+}
+
+/*!
+  \brief Pushes an event at the end of the queue.
+
+  \param [in] i_event The event to push.
+
+  \return True if the event was queued, false if the queue is full.
+ */
+bool Switch::RouterEventQueue::Push (const Switch::RouterEvent& i_event)
+{
+  Slot* pSlot = 0x0;
+  uint32_t position = m_enqueuePosition.load (std::memory_order_relaxed);
+
+  // claim a position
+  while (true)
+  {
+    pSlot = &m_slots [position & (CONTROLLER_ROUTER_EVENT_QUEUE_SIZE - 1)];
+    uint32_t sequence = pSlot->m_sequence.load (std::memory_order_acquire);
+    int32_t difference = static_cast <int32_t> (sequence - position);
+
+    if (0 == difference)
+    {
+      // the slot is free, try to claim it
+      if (m_enqueuePosition.compare_exchange_weak (position, position + 1, std::memory_order_relaxed))
+      {
+        break;
+      }
+      // note: on failure, position holds the current enqueue position
+    }
+    else if (0 > difference)
+    {
+      // the slot still holds an event of the previous round => queue is full
+      return false;
+    }
+    else
+    {
+      // another producer claimed the position, reload
+      position = m_enqueuePosition.load (std::memory_order_relaxed);
+    }
+  }
+
+  // fill the slot and publish it to the consumer
+  pSlot->m_event = i_event;
+  pSlot->m_sequence.store (position + 1, std::memory_order_release);
+
+  return true;
+}
+
+/*!
+  \brief Pushes an event at the end of the queue, waiting for room if the queue is full.
+
+  \param [in] i_event   The event to push.
+  \param [in] i_timeout The maximum time to wait for the consumer to pop an event.
+
+  \return True if the event was queued, false if the queue stayed full.
+ */
+bool Switch::RouterEventQueue::Push (const Switch::RouterEvent& i_event, const std::chrono::microseconds& i_timeout)
+{
+  if (Push (i_event))
+  {
+    return true;
+  }
+
+  // note: the producer is counted before it retries, a pop after the failed retry signals the condition
+  std::unique_lock <std::mutex> spaceLock (m_spaceMutex);
+  m_nrWaitingProducers.fetch_add (1);
+  bool pushed = m_spaceCondition.wait_for (spaceLock, i_timeout, [this, &i_event] () { return Push (i_event); });
+  m_nrWaitingProducers.fetch_sub (1);
+
+  return pushed;
+}
+
+/*!
+  \brief Pops the oldest event from the queue.
+
+  \param [out] o_event The popped event.
+
+  \return True if an event was popped, false if the queue is empty.
+ */
+bool Switch::RouterEventQueue::Pop (Switch::RouterEvent& o_event)
+{
+  Slot& slot = m_slots [m_dequeuePosition & (CONTROLLER_ROUTER_EVENT_QUEUE_SIZE - 1)];
+  uint32_t sequence = slot.m_sequence.load (std::memory_order_acquire);
+
+  // check if the slot has been published
+  if (static_cast <int32_t> (sequence - (m_dequeuePosition + 1)) < 0)
+  {
+    return false;
+  }
+
+  // read the event and release the slot for the next round
+  o_event = slot.m_event;
+  slot.m_sequence.store (m_dequeuePosition + CONTROLLER_ROUTER_EVENT_QUEUE_SIZE, std::memory_order_release);
+  ++m_dequeuePosition;
+
+  // wake up the producers waiting for room
+  // note: the fence orders releasing the slot before reading the number of waiting producers
+  std::atomic_thread_fence (std::memory_order_seq_cst);
+  if (0 != m_nrWaitingProducers.load (std::memory_order_relaxed))
+  {
+    std::unique_lock <std::mutex> spaceLock (m_spaceMutex);
+    m_spaceCondition.notify_all ();
+  }
+
+  return true;
+}
+
+/*!
+  \brief Checks if the queue is empty.
+
+  \return True if no published events are available, false otherwise.
+ */
+bool Switch::RouterEventQueue::IsEmpty () const
+{
+  const Slot& slot = m_slots [m_dequeuePosition & (CONTROLLER_ROUTER_EVENT_QUEUE_SIZE - 1)];
+  uint32_t sequence = slot.m_sequence.load (std::memory_order_acquire);
+
+  return (static_cast <int32_t> (sequence - (m_dequeuePosition + 1)) < 0);
+}
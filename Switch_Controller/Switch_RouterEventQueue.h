@@ -0,0 +1,172 @@
+/*?*************************************************************************
+*                           Switch_RouterEventQueue.h
+*                           -----------------------
+*    copyright            : (C) 2014 by Wouter Charle
+*    email                : wouter.charle@gmail.com
+*
+*    DISCLAIMER OF DAMAGES
+*    ---------------------
+*    Wouter Charle has made every effort possible to ensure that the software
+*    is free of any bugs or errors, however in no way is the software to
+*    be considered error or bug free. You assume all responsibility for
+*    any damages or lost data that may result from any errors or bugs in
+*    the software.
+*
+*    IN NO EVENT WILL VISION++ BE LIABLE TO YOU FOR ANY GENERAL, SPECIAL,
+*    INDIRECT, CONSEQUENTIAL, INCIDENTAL OR OTHER DAMAGES ARISING OUT OF
+*    THIS LICENSE.
+*
+*    In no case shall Wouter Charle's liability exceed the purchase price for
+*    the software or services.
+*
+***************************************************************************/
+
+#ifndef _SWITCH_ROUTEREVENTQUEUE
+#define _SWITCH_ROUTEREVENTQUEUE
+
+// project includes
+#include "Switch_ControllerConfiguration.h"
+
+// switch includes
+#include <Switch_Base/Switch_CompilerConfiguration.h>
+#include <Switch_Base/Switch_Types.h>
+#include <Switch_Network/Switch_DataPayload.h>
+#include <Switch_Device/Switch_DataContainer.h>
+
+// third party includes
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <list>
+
+
+namespace Switch
+{
+  /*!
+    \brief Event posted by the router to the controller.
+
+    Tagged container for the arguments of all router event handler callbacks. The
+    controller thread posts the events, and its own work on a device, to the worker
+    owning the device as well.
+   */
+  class RouterEvent
+  {
+  public:
+
+    enum eType
+    {
+      RE_NEW_NODE_DISCOVERED    = 0,
+      RE_NODE_CONNECTION_UPDATE = 1,
+      RE_NODE_DATA_RECEIVED     = 2,
+      RE_NODE_DATA_TRANSMITTED  = 3,
+      RE_SET_DEVICE_VALUES      = 4,  ///< Posted by the controller thread to set the elements in the device.
+      RE_RECONCILE_DEVICE       = 5   ///< Posted by the controller thread to retransmit the desired values of the device.
+    };
+
+    /*!
+      \brief Default constructor.
+     */
+    RouterEvent ();
+    /*!
+      \brief Destructor.
+     */
+    ~RouterEvent ();
+
+    // using default copy constructor and assignment operator
+    RouterEvent (const RouterEvent& i_other) = default;
+    RouterEvent& operator= (const RouterEvent& i_other) = default;
+
+    // members
+    eType                       m_type;           ///< The type of the event.
+    switch_device_address_type  m_deviceAddress;  ///< The device address of the node the event is related to.
+    Switch::DeviceInfo          m_deviceInfo;     ///< Information about the device. Only valid for RE_NEW_NODE_DISCOVERED.
+    bool                        m_flag;           ///< Connection state for RE_NODE_CONNECTION_UPDATE, transmission result for RE_NODE_DATA_TRANSMITTED.
+    Switch::DataPayload         m_dataPayload;    ///< The received data. Only valid for RE_NODE_DATA_RECEIVED.
+    std::list <Switch::DataContainer::Element> m_elements;  ///< The elements to set. Only valid for RE_SET_DEVICE_VALUES, empty otherwise.
+    std::list <uint32_t>                       m_sceneIds;  ///< The scenes waiting for the device to confirm the elements. Only valid for RE_SET_DEVICE_VALUES, empty otherwise.
+  };
+
+  /*!
+    \brief Bounded multi-producer / single-consumer queue of router events.
+
+    All slots are allocated up front, pushing and popping never allocates nor locks.
+    Every slot carries a sequence number which tells producers and the consumer
+    whether the slot is free or holds a published event. Producers may wait for
+    room in a full queue, only then the consumer locks to wake them up.
+
+    \note Push may be called from any thread, Pop only from one consumer thread.
+   */
+  class RouterEventQueue
+  {
+  public:
+
+    /*!
+      \brief Default constructor.
+     */
+    RouterEventQueue ();
+    /*!
+      \brief Destructor.
+     */
+    ~RouterEventQueue ();
+
+    // copy constructor and assignment operator are disabled
+    RouterEventQueue (const RouterEventQueue& i_other) = delete;
+    RouterEventQueue& operator= (const RouterEventQueue& i_other) = delete;
+
+    /*!
+      \brief Pushes an event at the end of the queue.
+
+      \param [in] i_event The event to push.
+
+      \return True if the event was queued, false if the queue is full.
+     */
+    bool Push (const RouterEvent& i_event);
+    /*!
+      \brief Pushes an event at the end of the queue, waiting for room if the queue is full.
+
+      \param [in] i_event   The event to push.
+      \param [in] i_timeout The maximum time to wait for the consumer to pop an event.
+
+      \return True if the event was queued, false if the queue stayed full.
+     */
+    bool Push (const RouterEvent& i_event, const std::chrono::microseconds& i_timeout);
+    /*!
+      \brief Pops the oldest event from the queue.
+
+      \param [out] o_event The popped event.
+
+      \return True if an event was popped, false if the queue is empty.
+     */
+    bool Pop (RouterEvent& o_event);
+    /*!
+      \brief Checks if the queue is empty.
+
+      \return True if no published events are available, false otherwise.
+
+      \note Only reliable when called from the consumer thread.
+     */
+    bool IsEmpty () const;
+
+  private:
+
+    /*!
+      \brief Queue slot.
+     */
+    class Slot
+    {
+    public:
+      std::atomic <uint32_t>  m_sequence; ///< Sequence number of the slot. Equals the enqueue position when free, the position + 1 when published.
+      RouterEvent             m_event;    ///< The event stored in the slot.
+    };
+
+    Slot                    m_slots [CONTROLLER_ROUTER_EVENT_QUEUE_SIZE]; ///< Pre-allocated queue slots.
+    std::atomic <uint32_t>  m_enqueuePosition;                            ///< Next position to be claimed by a producer.
+    uint32_t                m_dequeuePosition;                            ///< Next position to be read by the consumer.
+    std::atomic <uint32_t>  m_nrWaitingProducers;                         ///< The number of producers waiting for room.
+    std::mutex              m_spaceMutex;                                 ///< Guards the producers waiting for room.
+    std::condition_variable m_spaceCondition;                             ///< Signals the waiting producers that an event was popped.
+  };
+}
+
+#endif // _SWITCH_ROUTEREVENTQUEUE
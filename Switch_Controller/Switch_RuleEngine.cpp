@@ -0,0 +1,305 @@
+/*?*************************************************************************
+*                           Switch_RuleEngine.cpp
+*                           -----------------------
+*    copyright            : (C) 2014 by Wouter Charle
+*    email                : wouter.charle@gmail.com
+*
+*    DISCLAIMER OF DAMAGES
+*    ---------------------
+*    Wouter Charle has made every effort possible to ensure that the software
+*    is free of any bugs or errors, however in no way is the software to
+*    be considered error or bug free. You assume all responsibility for
+*    any damages or lost data that may result from any errors or bugs in
+*    the software.
+*
+*    IN NO EVENT WILL VISION++ BE LIABLE TO YOU FOR ANY GENERAL, SPECIAL,
+*    INDIRECT, CONSEQUENTIAL, INCIDENTAL OR OTHER DAMAGES ARISING OUT OF
+*    THIS LICENSE.
+*
+*    In no case shall Wouter Charle's liability exceed the purchase price for
+*    the software or services.
+*
+***************************************************************************/
+
+#include "Switch_RuleEngine.h"
+
+// switch includes
+#include <Switch_Base/Switch_Debug.h>
+
+// third-party includes
+#include <json/json.h>
+#include <stdexcept>
+
+
+namespace
+{
+  // string representations of the rule conditions, indexed by Switch::Rule::eCondition
+  const char* s_conditionNames [] = { "changed", "==", "!=", "<", "<=", ">", ">=" };
+  const uint32_t s_nrConditions = sizeof (s_conditionNames) / sizeof (s_conditionNames [0]);
+}
+
+/*!
+  \brief Default constructor.
+ */
+Switch::Rule::Rule ()
+: m_name            ("N.A."),
+  m_deviceAddress   (0x0),
+  m_elementAddress  (0),
+  m_condition       (RC_CHANGED),
+  m_operand         (0)
+{
+}
+
+/*!
+  \brief Destructor.
+ */
+Switch::Rule::~Rule ()
+{
+}
+
+/*!
+  \brief Evaluates the rule's condition.
+
+  \param [in] i_value The new value of the rule's input element.
+
+  \return True if the condition is satisfied, false otherwise.
+ */
+bool Switch::Rule::Evaluate (const int32_t& i_value) const
+{
+  switch (m_condition)
+  {
+    case RC_CHANGED:
+      return true;
+    case RC_EQUAL:
+      return (i_value == m_operand);
+    case RC_NOT_EQUAL:
+      return (i_value != m_operand);
+    case RC_LESS:
+      return (i_value < m_operand);
+    case RC_LESS_EQUAL:
+      return (i_value <= m_operand);
+    case RC_GREATER:
+      return (i_value > m_operand);
+    case RC_GREATER_EQUAL:
+      return (i_value >= m_operand);
+    default:
+      SWITCH_ASSERT (false);
+      return false;
+  }
+}
+
+/*!
+  \brief Serializes the object to a JSON value.
+
+  \param [out] o_root Root value of the object as JSON.
+ */
+void Switch::Rule::Serialize (Json::Value& o_root) const
+{
+  o_root ["name"]           = m_name;
+  o_root ["deviceId"]       = m_deviceAddress;
+  o_root ["address"]        = m_elementAddress;
+  o_root ["condition"]      = s_conditionNames [m_condition];
+  o_root ["operand"]        = m_operand;
+
+  // serialize the actions
+  Json::Value actionArray (Json::arrayValue);
+  std::list <Action>::const_iterator itAction;
+  for (itAction = m_actions.begin (); m_actions.end () != itAction; ++itAction)
+  {
+    Json::Value actionValue;
+    actionValue ["deviceId"] = itAction->m_deviceAddress;
+
+    Json::Value elementArray (Json::arrayValue);
+    std::list <Switch::DataContainer::Element>::const_iterator itElement;
+    for (itElement = itAction->m_elements.begin (); itAction->m_elements.end () != itElement; ++itElement)
+    {
+      Json::Value elementValue;
+      elementValue ["address"]      = itElement->m_address;
+      elementValue ["magicNumber"]  = itElement->m_magicNumber;
+      elementValue ["value"]        = itElement->m_value;
+      elementArray.append (elementValue);
+    }
+    actionValue ["values"] = elementArray;
+
+    actionArray.append (actionValue);
+  }
+  o_root ["actions"] = actionArray;
+
+# ifdef SWITCH_SERIALIZE_WITH_COMMENTS
+  // add comments
+  o_root ["name"].      setComment ("// The name of the rule.", Json::commentAfterOnSameLine);
+  o_root ["deviceId"].  setComment ("// The device of the input element.", Json::commentAfterOnSameLine);
+  o_root ["address"].   setComment ("// The address of the input element.", Json::commentAfterOnSameLine);
+  o_root ["condition"]. setComment ("// One of changed, ==, !=, <, <=, >, >=.", Json::commentAfterOnSameLine);
+  o_root ["operand"].   setComment ("// The operand of the condition.", Json::commentAfterOnSameLine);
+  o_root ["actions"].   setComment ("// Array of values to set in devices when the rule fires.", Json::commentAfterOnSameLine);
+# endif
+}
+
+/*!
+  \brief De-serializes the object from a JSON value.
+
+  \param [in] i_root Root value of the object as JSON.
+ */
+void Switch::Rule::Deserialize (const Json::Value& i_root)
+{
+  // de-serialize members
+  m_name            = i_root ["name"].    asString ();
+  m_deviceAddress   = i_root ["deviceId"].asUInt ();
+  m_elementAddress  = i_root ["address"]. asUInt ();
+  m_operand         = i_root ["operand"]. asInt ();
+
+  // de-serialize the condition
+  std::string condition = i_root ["condition"].asString ();
+  uint32_t conditionIndex = 0;
+  while ((conditionIndex < s_nrConditions) && (condition != s_conditionNames [conditionIndex]))
+  {
+    ++conditionIndex;
+  }
+  SWITCH_ASSERT_THROW (conditionIndex < s_nrConditions, std::runtime_error ("unknown rule condition"));
+  m_condition = static_cast <eCondition> (conditionIndex);
+
+  // de-serialize the actions
+  m_actions.clear ();
+  const Json::Value& actionArray = i_root ["actions"];
+  for (size_t i=0; i<actionArray.size (); ++i)
+  {
+    const Json::Value& actionValue = actionArray [static_cast <Json::ArrayIndex> (i)];
+    m_actions.push_back (Action ());
+    Action& action = m_actions.back ();
+    action.m_deviceAddress = actionValue ["deviceId"].asUInt ();
+
+    const Json::Value& elementArray = actionValue ["values"];
+    for (size_t j=0; j<elementArray.size (); ++j)
+    {
+      const Json::Value& elementValue = elementArray [static_cast <Json::ArrayIndex> (j)];
+      Switch::DataContainer::Element element;
+      element.m_address     = elementValue ["address"].     asUInt ();
+      element.m_magicNumber = elementValue ["magicNumber"]. asUInt ();
+      element.m_value       = elementValue ["value"].       asInt ();
+      action.m_elements.push_back (element);
+    }
+  }
+}
+
+/*!
+  \brief Default constructor.
+ */
+Switch::RuleSet::RuleSet ()
+{
+}
+
+/*!
+  \brief Destructor.
+ */
+Switch::RuleSet::~RuleSet ()
+{
+}
+
+/*!
+  \brief Serializes the object to a JSON value.
+
+  \param [out] o_root Root value of the object as JSON.
+ */
+void Switch::RuleSet::Serialize (Json::Value& o_root) const
+{
+  Json::Value ruleArray (Json::arrayValue);
+  std::list <Rule>::const_iterator itRule;
+  for (itRule = m_rules.begin (); m_rules.end () != itRule; ++itRule)
+  {
+    Json::Value ruleValue;
+    itRule->Serialize (ruleValue);
+    ruleArray.append (ruleValue);
+  }
+  o_root ["rules"] = ruleArray;
+}
+
+/*!
+  \brief De-serializes the object from a JSON value.
+
+  \param [in] i_root Root value of the object as JSON.
+ */
+void Switch::RuleSet::Deserialize (const Json::Value& i_root)
+{
+  m_rules.clear ();
+  const Json::Value& ruleArray = i_root ["rules"];
+  for (size_t i=0; i<ruleArray.size (); ++i)
+  {
+    m_rules.push_back (Rule ());
+    m_rules.back ().Deserialize (ruleArray [static_cast <Json::ArrayIndex> (i)]);
+  }
+}
+
+/*!
+  \brief Default constructor.
+ */
+Switch::RuleEngine::RuleEngine ()
+{
+}
+
+/*!
+  \brief Destructor.
+ */
+Switch::RuleEngine::~RuleEngine ()
+{
+}
+
+void Switch::RuleEngine::SetRules (const Switch::RuleSet& i_ruleSet)
+{
+  m_rules.assign (i_ruleSet.m_rules.begin (), i_ruleSet.m_rules.end ());
+
+  // compile the index on the rule inputs
+  m_ruleIndex.clear ();
+  for (uint32_t i=0; i<m_rules.size (); ++i)
+  {
+    m_ruleIndex [_Key (m_rules [i].m_deviceAddress, m_rules [i].m_elementAddress)].push_back (i);
+  }
+}
+
+bool Switch::RuleEngine::IsEmpty () const
+{
+  return m_rules.empty ();
+}
+
+void Switch::RuleEngine::Evaluate (std::list <Switch::Rule::Action>& o_actions, const switch_device_address_type& i_deviceAddress, const std::list <Switch::DataContainer::Element>& i_changedElements) const
+{
+  if (m_ruleIndex.empty ())
+  {
+    return;
+  }
+
+  std::list <Switch::DataContainer::Element>::const_iterator itElement;
+  for (itElement = i_changedElements.begin (); i_changedElements.end () != itElement; ++itElement)
+  {
+    // get the rules with this element as input
+    std::unordered_map <rule_key_type, std::vector <uint32_t>>::const_iterator itIndex = m_ruleIndex.find (_Key (i_deviceAddress, itElement->m_address));
+    if (m_ruleIndex.end () == itIndex)
+    {
+      continue;
+    }
+
+    // evaluate the rules
+    const std::vector <uint32_t>& ruleIndices = itIndex->second;
+    for (uint32_t i=0; i<ruleIndices.size (); ++i)
+    {
+      const Switch::Rule& rule = m_rules [ruleIndices [i]];
+      if (rule.Evaluate (itElement->m_value))
+      {
+        o_actions.insert (o_actions.end (), rule.m_actions.begin (), rule.m_actions.end ());
+      }
+    }
+  }
+}
+
+/*!
+  \brief Computes the index key of a rule input.
+
+  \param [in] i_deviceAddress   The device of the input element.
+  \param [in] i_elementAddress  The address of the input element.
+
+  \return The index key.
+ */
+Switch::RuleEngine::rule_key_type Switch::RuleEngine::_Key (const switch_device_address_type& i_deviceAddress, const uint32_t& i_elementAddress)
+{
+  return (static_cast <rule_key_type> (i_deviceAddress) << 32) | static_cast <rule_key_type> (i_elementAddress);
+}
@@ -0,0 +1,213 @@
+/*?*************************************************************************
+*                           Switch_RuleEngine.h
+*                           -----------------------
+*    copyright            : (C) 2014 by Wouter Charle
+*    email                : wouter.charle@gmail.com
+*
+*    DISCLAIMER OF DAMAGES
+*    ---------------------
+*    Wouter Charle has made every effort possible to ensure that the software
+*    is free of any bugs or errors, however in no way is the software to
+*    be considered error or bug free. You assume all responsibility for
+*    any damages or lost data that may result from any errors or bugs in
+*    the software.
+*
+*    IN NO EVENT WILL VISION++ BE LIABLE TO YOU FOR ANY GENERAL, SPECIAL,
+*    INDIRECT, CONSEQUENTIAL, INCIDENTAL OR OTHER DAMAGES ARISING OUT OF
+*    THIS LICENSE.
+*
+*    In no case shall Wouter Charle's liability exceed the purchase price for
+*    the software or services.
+*
+***************************************************************************/
+
+#ifndef _SWITCH_RULEENGINE
+#define _SWITCH_RULEENGINE
+
+// project includes
+
+// switch includes
+#include <Switch_Base/Switch_CompilerConfiguration.h>
+#include <Switch_Base/Switch_Types.h>
+#include <Switch_Device/Switch_DataContainer.h>
+#include <Switch_Serialization/Switch_JsonSerializableInterface.h>
+
+// third party includes
+#include <string>
+#include <list>
+#include <vector>
+#include <unordered_map>
+
+
+namespace Switch
+{
+  /*!
+    \brief Automation rule.
+
+    When the value of an element of a device changes and satisfies the rule's
+    condition, the rule's actions set elements in other devices.
+   */
+  class Rule : public Switch::JsonSerializableInterface
+  {
+  public:
+
+    enum eCondition
+    {
+      RC_CHANGED        = 0,  ///< Any change of the value.
+      RC_EQUAL          = 1,
+      RC_NOT_EQUAL      = 2,
+      RC_LESS           = 3,
+      RC_LESS_EQUAL     = 4,
+      RC_GREATER        = 5,
+      RC_GREATER_EQUAL  = 6
+    };
+
+    /*!
+      \brief Elements to set in a device when the rule fires.
+     */
+    class Action
+    {
+    public:
+      switch_device_address_type                  m_deviceAddress;  ///< The device in which to set the elements.
+      std::list <Switch::DataContainer::Element>  m_elements;       ///< The elements to set.
+    };
+
+    /*!
+      \brief Default constructor.
+     */
+    Rule ();
+    /*!
+      \brief Destructor.
+     */
+    virtual ~Rule ();
+
+    // using default copy constructor and assignment operator
+    Rule (const Rule& i_other) = default;
+    Rule& operator= (const Rule& i_other) = default;
+
+    /*!
+      \brief Evaluates the rule's condition.
+
+      \param [in] i_value The new value of the rule's input element.
+
+      \return True if the condition is satisfied, false otherwise.
+     */
+    bool Evaluate (const int32_t& i_value) const;
+
+    /*!
+      \brief Serializes the object to a JSON value.
+
+      \param [out] o_root Root value of the object as JSON.
+     */
+    virtual void Serialize   (Json::Value& o_root) const;
+    /*!
+      \brief De-serializes the object from a JSON value.
+
+      \param [in] i_root Root value of the object as JSON.
+     */
+    virtual void Deserialize (const Json::Value& i_root);
+
+    // members
+    std::string                 m_name;           ///< Name of the rule.
+    switch_device_address_type  m_deviceAddress;  ///< The device of the input element.
+    uint32_t                    m_elementAddress; ///< The address of the input element.
+    eCondition                  m_condition;      ///< The condition on the input element's value.
+    int32_t                     m_operand;        ///< The operand of the condition. Not used for RC_CHANGED.
+    std::list <Action>          m_actions;        ///< The actions to execute when the rule fires.
+  };
+
+  /*!
+    \brief Set of automation rules, as stored in a rules file.
+   */
+  class RuleSet : public Switch::JsonSerializableInterface
+  {
+  public:
+
+    /*!
+      \brief Default constructor.
+     */
+    RuleSet ();
+    /*!
+      \brief Destructor.
+     */
+    virtual ~RuleSet ();
+
+    // using default copy constructor and assignment operator
+    RuleSet (const RuleSet& i_other) = default;
+    RuleSet& operator= (const RuleSet& i_other) = default;
+
+    /*!
+      \brief Serializes the object to a JSON value.
+
+      \param [out] o_root Root value of the object as JSON.
+     */
+    virtual void Serialize   (Json::Value& o_root) const;
+    /*!
+      \brief De-serializes the object from a JSON value.
+
+      \param [in] i_root Root value of the object as JSON.
+     */
+    virtual void Deserialize (const Json::Value& i_root);
+
+    // members
+    std::list <Rule> m_rules;  ///< The rules in the set.
+  };
+
+  /*!
+    \brief Evaluates automation rules on changed device data.
+
+    The rules are compiled into an index on their input (device, element address),
+    such that only the rules of which an input changed are evaluated.
+
+    \note Evaluate is thread-safe as long as the rules are not changed concurrently.
+   */
+  class RuleEngine
+  {
+  public:
+
+    /*!
+      \brief Default constructor.
+     */
+    RuleEngine ();
+    /*!
+      \brief Destructor.
+     */
+    ~RuleEngine ();
+
+    // copy constructor and assignment operator are disabled
+    RuleEngine (const RuleEngine& i_other) = delete;
+    RuleEngine& operator= (const RuleEngine& i_other) = delete;
+
+    /*!
+      \brief Replaces the rules and compiles the index.
+
+      \param [in] i_ruleSet The new rules.
+     */
+    void SetRules (const RuleSet& i_ruleSet);
+    /*!
+      \brief Checks if rules are defined.
+
+      \return True if no rules are defined, false otherwise.
+     */
+    bool IsEmpty () const;
+    /*!
+      \brief Evaluates the rules triggered by changed elements of a device.
+
+      \param [out] o_actions        The actions of all rules that fired, appended in rule order.
+      \param [in]  i_deviceAddress  The device of which the elements changed.
+      \param [in]  i_changedElements The changed elements.
+     */
+    void Evaluate (std::list <Rule::Action>& o_actions, const switch_device_address_type& i_deviceAddress, const std::list <Switch::DataContainer::Element>& i_changedElements) const;
+
+  private:
+
+    typedef uint64_t rule_key_type;  ///< Device address in the high, element address in the low 32 bits.
+
+    static rule_key_type _Key (const switch_device_address_type& i_deviceAddress, const uint32_t& i_elementAddress);
+
+    std::vector <Rule>                                            m_rules;      ///< All rules.
+    std::unordered_map <rule_key_type, std::vector <uint32_t>>    m_ruleIndex;  ///< Maps rule inputs onto the indices of the rules.
+  };
+}
+
+#endif // _SWITCH_RULEENGINE
@@ -0,0 +1,426 @@
+/*?*************************************************************************
+*                           Switch_Scheduler.cpp
+*                           -----------------------
+*    copyright            : (C) 2014 by Wouter Charle
+*    email                : wouter.charle@gmail.com
+*
+*    DISCLAIMER OF DAMAGES
+*    ---------------------
+*    Wouter Charle has made every effort possible to ensure that the software
+*    is free of any bugs or errors, however in no way is the software to
+*    be considered error or bug free. You assume all responsibility for
+*    any damages or lost data that may result from any errors or bugs in
+*    the software.
+*
+*    IN NO EVENT WILL VISION++ BE LIABLE TO YOU FOR ANY GENERAL, SPECIAL,
+*    INDIRECT, CONSEQUENTIAL, INCIDENTAL OR OTHER DAMAGES ARISING OUT OF
+*    THIS LICENSE.
+*
+*    In no case shall Wouter Charle's liability exceed the purchase price for
+*    the software or services.
+*
+***************************************************************************/
+
+#include "Switch_Scheduler.h"
+
+// switch includes
+#include <Switch_Base/Switch_Debug.h>
+
+// third-party includes
+#include <json/json.h>
+#include <stdexcept>
+#include <limits>
+#include <algorithm>
+
+
+namespace
+{
+  // string representations of the schedule types, indexed by Switch::Schedule::eType
+  const char* s_typeNames [] = { "oneShot", "recurring", "offAfterOn" };
+  const uint32_t s_nrTypes = sizeof (s_typeNames) / sizeof (s_typeNames [0]);
+}
+
+/*!
+  \brief Default constructor.
+ */
+Switch::Schedule::Schedule ()
+: m_name            ("N.A."),
+  m_type            (ST_ONE_SHOT),
+  m_deviceAddress   (0x0),
+  m_time            (0),
+  m_periodSeconds   (0),
+  m_elementAddress  (0)
+{
+}
+
+/*!
+  \brief Destructor.
+ */
+Switch::Schedule::~Schedule ()
+{
+}
+
+bool Switch::Schedule::IsValid () const
+{
+  if (m_elements.empty ())
+  {
+    return false;
+  }
+
+  switch (m_type)
+  {
+    case ST_ONE_SHOT:
+      return true;
+    case ST_RECURRING:
+    case ST_OFF_AFTER_ON:
+      return (0 < m_periodSeconds);
+    default:
+      return false;
+  }
+}
+
+/*!
+  \brief Serializes the object to a JSON value.
+
+  \param [out] o_root Root value of the object as JSON.
+ */
+void Switch::Schedule::Serialize (Json::Value& o_root) const
+{
+  o_root ["name"]           = m_name;
+  o_root ["type"]           = s_typeNames [m_type];
+  o_root ["deviceId"]       = m_deviceAddress;
+  o_root ["time"]           = static_cast <Json::UInt64> (m_time);
+  o_root ["period"]         = m_periodSeconds;
+  o_root ["address"]        = m_elementAddress;
+
+  // serialize the elements to set
+  Json::Value elementArray (Json::arrayValue);
+  std::list <Switch::DataContainer::Element>::const_iterator itElement;
+  for (itElement = m_elements.begin (); m_elements.end () != itElement; ++itElement)
+  {
+    Json::Value elementValue;
+    elementValue ["address"]      = itElement->m_address;
+    elementValue ["magicNumber"]  = itElement->m_magicNumber;
+    elementValue ["value"]        = itElement->m_value;
+    elementArray.append (elementValue);
+  }
+  o_root ["values"] = elementArray;
+
+# ifdef SWITCH_SERIALIZE_WITH_COMMENTS
+  // add comments
+  o_root ["name"].    setComment ("// The name of the schedule.", Json::commentAfterOnSameLine);
+  o_root ["type"].    setComment ("// One of oneShot, recurring, offAfterOn.", Json::commentAfterOnSameLine);
+  o_root ["deviceId"].setComment ("// The device in which to set the values.", Json::commentAfterOnSameLine);
+  o_root ["time"].    setComment ("// The first time the schedule fires, in seconds since the epoch.", Json::commentAfterOnSameLine);
+  o_root ["period"].  setComment ("// The period of a recurring schedule, the delay after the last on of an offAfterOn schedule, in seconds.", Json::commentAfterOnSameLine);
+  o_root ["address"]. setComment ("// The address of the element watched by an offAfterOn schedule.", Json::commentAfterOnSameLine);
+  o_root ["values"].  setComment ("// Array of values to set when the schedule fires.", Json::commentAfterOnSameLine);
+# endif
+}
+
+/*!
+  \brief De-serializes the object from a JSON value.
+
+  \param [in] i_root Root value of the object as JSON.
+ */
+void Switch::Schedule::Deserialize (const Json::Value& i_root)
+{
+  // de-serialize members
+  m_name            = i_root ["name"].    asString ();
+  m_deviceAddress   = i_root ["deviceId"].asUInt ();
+  m_time            = i_root ["time"].    asUInt64 ();
+  m_periodSeconds   = i_root ["period"].  asUInt ();
+  m_elementAddress  = i_root ["address"]. asUInt ();
+
+  // de-serialize the type
+  std::string type = i_root ["type"].asString ();
+  uint32_t typeIndex = 0;
+  while ((typeIndex < s_nrTypes) && (type != s_typeNames [typeIndex]))
+  {
+    ++typeIndex;
+  }
+  SWITCH_ASSERT_THROW (typeIndex < s_nrTypes, std::runtime_error ("unknown schedule type"));
+  m_type = static_cast <eType> (typeIndex);
+
+  // de-serialize the elements to set
+  m_elements.clear ();
+  const Json::Value& elementArray = i_root ["values"];
+  for (size_t i=0; i<elementArray.size (); ++i)
+  {
+    const Json::Value& elementValue = elementArray [static_cast <Json::ArrayIndex> (i)];
+    Switch::DataContainer::Element element;
+    element.m_address     = elementValue ["address"].     asUInt ();
+    element.m_magicNumber = elementValue ["magicNumber"]. asUInt ();
+    element.m_value       = elementValue ["value"].       asInt ();
+    m_elements.push_back (element);
+  }
+}
+
+/*!
+  \brief Default constructor.
+ */
+Switch::Scheduler::Scheduler ()
+: m_epoch (std::chrono::steady_clock::now ())
+{
+}
+
+/*!
+  \brief Destructor.
+ */
+Switch::Scheduler::~Scheduler ()
+{
+}
+
+void Switch::Scheduler::SetSchedules (const ScheduleMap& i_schedules)
+{
+  std::unique_lock <std::mutex> lock (m_mutex);
+
+  // restart the wheel
+  m_entries.clear ();
+  m_watchIndex.clear ();
+  m_epoch = std::chrono::steady_clock::now ();
+  m_timerWheel.Reset (0);
+
+  // add and arm all schedules
+  ScheduleMap::const_iterator itSchedule;
+  for (itSchedule = i_schedules.begin (); i_schedules.end () != itSchedule; ++itSchedule)
+  {
+    if (!itSchedule->second.IsValid ())
+    {
+      SWITCH_DEBUG_MSG_1 ("invalid schedule %u ignored ... ", itSchedule->first);
+      continue;
+    }
+    _Add (itSchedule->first, itSchedule->second);
+  }
+}
+
+void Switch::Scheduler::AddSchedule (const uint32_t& i_scheduleId, const Schedule& i_schedule)
+{
+  SWITCH_ASSERT_THROW (i_schedule.IsValid (), std::runtime_error ("invalid schedule"));
+
+  std::unique_lock <std::mutex> lock (m_mutex);
+
+  SWITCH_ASSERT_THROW (m_entries.end () == m_entries.find (i_scheduleId), std::runtime_error ("schedule already added"));
+  _Add (i_scheduleId, i_schedule);
+}
+
+bool Switch::Scheduler::RemoveSchedule (const uint32_t& i_scheduleId)
+{
+  std::unique_lock <std::mutex> lock (m_mutex);
+
+  std::unordered_map <uint32_t, Entry>::iterator itEntry = m_entries.find (i_scheduleId);
+  if (m_entries.end () == itEntry)
+  {
+    return false;
+  }
+
+  // cancel the timer and remove the schedule from the watch index
+  _Disarm (itEntry->second);
+  const Schedule& schedule = itEntry->second.m_schedule;
+  if (Schedule::ST_OFF_AFTER_ON == schedule.m_type)
+  {
+    std::vector <uint32_t>& watchers = m_watchIndex [_Key (schedule.m_deviceAddress, schedule.m_elementAddress)];
+    watchers.erase (std::remove (watchers.begin (), watchers.end (), i_scheduleId), watchers.end ());
+    if (watchers.empty ())
+    {
+      m_watchIndex.erase (_Key (schedule.m_deviceAddress, schedule.m_elementAddress));
+    }
+  }
+
+  m_entries.erase (itEntry);
+  return true;
+}
+
+void Switch::Scheduler::GetSchedules (ScheduleMap& o_schedules) const
+{
+  std::unique_lock <std::mutex> lock (m_mutex);
+
+  o_schedules.clear ();
+  std::unordered_map <uint32_t, Entry>::const_iterator itEntry;
+  for (itEntry = m_entries.begin (); m_entries.end () != itEntry; ++itEntry)
+  {
+    o_schedules.insert (std::make_pair (itEntry->first, itEntry->second.m_schedule));
+  }
+}
+
+void Switch::Scheduler::HandleChangedElements (const switch_device_address_type& i_deviceAddress, const std::list <Switch::DataContainer::Element>& i_changedElements)
+{
+  std::unique_lock <std::mutex> lock (m_mutex);
+
+  if (m_watchIndex.empty ())
+  {
+    return;
+  }
+
+  std::list <Switch::DataContainer::Element>::const_iterator itElement;
+  for (itElement = i_changedElements.begin (); i_changedElements.end () != itElement; ++itElement)
+  {
+    std::unordered_map <element_key_type, std::vector <uint32_t>>::const_iterator itWatchers = m_watchIndex.find (_Key (i_deviceAddress, itElement->m_address));
+    if (m_watchIndex.end () == itWatchers)
+    {
+      continue;
+    }
+
+    const std::vector <uint32_t>& watchers = itWatchers->second;
+    for (uint32_t i=0; i<watchers.size (); ++i)
+    {
+      Entry& entry = m_entries [watchers [i]];
+
+      // restart the delay when switched on, cancel when switched off
+      _Disarm (entry);
+      if (0 != itElement->m_value)
+      {
+        uint64_t delayMicros = static_cast <uint64_t> (entry.m_schedule.m_periodSeconds) * 1000000;
+        entry.m_timer = m_timerWheel.Add (_GetTickAfter (delayMicros), watchers [i]);
+      }
+    }
+  }
+}
+
+void Switch::Scheduler::Advance (std::list <Rule::Action>& o_actions, std::list <uint32_t>& o_finishedScheduleIds)
+{
+  std::unique_lock <std::mutex> lock (m_mutex);
+
+  std::vector <uint32_t> expiredScheduleIds;
+  m_timerWheel.Advance (expiredScheduleIds, _GetTick (std::chrono::steady_clock::now ()));
+
+  std::vector <uint32_t>::const_iterator itScheduleId;
+  for (itScheduleId = expiredScheduleIds.begin (); expiredScheduleIds.end () != itScheduleId; ++itScheduleId)
+  {
+    std::unordered_map <uint32_t, Entry>::iterator itEntry = m_entries.find (*itScheduleId);
+    SWITCH_ASSERT (m_entries.end () != itEntry);
+    if (m_entries.end () == itEntry)
+    {
+      continue;
+    }
+    Entry& entry = itEntry->second;
+    entry.m_timer = TimerWheel::INVALID_TIMER_HANDLE;
+
+    // collect the action
+    o_actions.push_back (Rule::Action ());
+    o_actions.back ().m_deviceAddress = entry.m_schedule.m_deviceAddress;
+    o_actions.back ().m_elements      = entry.m_schedule.m_elements;
+
+    // re-arm recurring schedules, drop one-shot schedules
+    // note: off after on schedules are re-armed by the next on
+    switch (entry.m_schedule.m_type)
+    {
+      case Schedule::ST_ONE_SHOT:
+        o_finishedScheduleIds.push_back (*itScheduleId);
+        m_entries.erase (itEntry);
+        break;
+      case Schedule::ST_RECURRING:
+        _Arm (*itScheduleId, entry);
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+uint32_t Switch::Scheduler::GetDelayMicros () const
+{
+  std::unique_lock <std::mutex> lock (m_mutex);
+
+  uint64_t nextTick = m_timerWheel.GetNextTick ();
+  if (std::numeric_limits <uint64_t>::max () == nextTick)
+  {
+    return std::numeric_limits <uint32_t>::max ();
+  }
+
+  std::chrono::steady_clock::time_point nextTime = m_epoch + std::chrono::microseconds (nextTick*CONTROLLER_TIMER_WHEEL_TICK_MICROS);
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now ();
+  if (nextTime <= now)
+  {
+    return 0;
+  }
+
+  uint64_t delayMicros = std::chrono::duration_cast <std::chrono::microseconds> (nextTime - now).count ();
+  return static_cast <uint32_t> (std::min (delayMicros, static_cast <uint64_t> (std::numeric_limits <uint32_t>::max ())));
+}
+
+Switch::Scheduler::element_key_type Switch::Scheduler::_Key (const switch_device_address_type& i_deviceAddress, const uint32_t& i_elementAddress)
+{
+  return (static_cast <element_key_type> (i_deviceAddress) << 32) | i_elementAddress;
+}
+
+/*!
+  \brief Adds a schedule and arms it.
+
+  \note Requires m_mutex to be locked.
+ */
+void Switch::Scheduler::_Add (const uint32_t& i_scheduleId, const Schedule& i_schedule)
+{
+  Entry& entry = m_entries [i_scheduleId];
+  entry.m_schedule  = i_schedule;
+  entry.m_timer     = TimerWheel::INVALID_TIMER_HANDLE;
+
+  if (Schedule::ST_OFF_AFTER_ON == i_schedule.m_type)
+  {
+    m_watchIndex [_Key (i_schedule.m_deviceAddress, i_schedule.m_elementAddress)].push_back (i_scheduleId);
+  }
+
+  _Arm (i_scheduleId, entry);
+}
+
+/*!
+  \brief Arms the timer of a schedule for its next occurrence.
+
+  One-shot schedules of which the time passed fire on the next advance.
+  Off after on schedules are only armed by changed elements.
+
+  \note Requires m_mutex to be locked.
+ */
+void Switch::Scheduler::_Arm (const uint32_t& i_scheduleId, Entry& io_entry)
+{
+  const Schedule& schedule = io_entry.m_schedule;
+  if (Schedule::ST_OFF_AFTER_ON == schedule.m_type)
+  {
+    return;
+  }
+
+  // get the next occurrence in seconds since the epoch
+  uint64_t nowMicros = std::chrono::duration_cast <std::chrono::microseconds> (std::chrono::system_clock::now ().time_since_epoch ()).count ();
+  uint64_t nowSeconds = nowMicros / 1000000;
+  uint64_t nextSeconds = schedule.m_time;
+  if ((Schedule::ST_RECURRING == schedule.m_type) && (nextSeconds <= nowSeconds))
+  {
+    nextSeconds += ((nowSeconds - nextSeconds) / schedule.m_periodSeconds + 1) * schedule.m_periodSeconds;
+  }
+
+  uint64_t nextMicros = nextSeconds * 1000000;
+  uint64_t delayMicros = (nowMicros < nextMicros) ? (nextMicros - nowMicros) : 0;
+  io_entry.m_timer = m_timerWheel.Add (_GetTickAfter (delayMicros), i_scheduleId);
+}
+
+/*!
+  \brief Cancels the timer of a schedule.
+
+  \note Requires m_mutex to be locked.
+ */
+void Switch::Scheduler::_Disarm (Entry& io_entry)
+{
+  if (TimerWheel::INVALID_TIMER_HANDLE != io_entry.m_timer)
+  {
+    m_timerWheel.Remove (io_entry.m_timer);
+    io_entry.m_timer = TimerWheel::INVALID_TIMER_HANDLE;
+  }
+}
+
+uint64_t Switch::Scheduler::_GetTick (const std::chrono::steady_clock::time_point& i_time) const
+{
+  return std::chrono::duration_cast <std::chrono::microseconds> (i_time - m_epoch).count () / CONTROLLER_TIMER_WHEEL_TICK_MICROS;
+}
+
+/*!
+  \brief Gets the first tick at which a delay starting now has elapsed.
+
+  Rounds up, such that a schedule never fires before its time.
+
+  \param [in] i_delayMicros The delay in microseconds.
+ */
+uint64_t Switch::Scheduler::_GetTickAfter (const uint64_t& i_delayMicros) const
+{
+  uint64_t elapsedMicros = std::chrono::duration_cast <std::chrono::microseconds> (std::chrono::steady_clock::now () - m_epoch).count ();
+  return (elapsedMicros + i_delayMicros + CONTROLLER_TIMER_WHEEL_TICK_MICROS - 1) / CONTROLLER_TIMER_WHEEL_TICK_MICROS;
+}
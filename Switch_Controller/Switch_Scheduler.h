@@ -0,0 +1,212 @@
+/*?*************************************************************************
+*                           Switch_Scheduler.h
+*                           -----------------------
+*    copyright            : (C) 2014 by Wouter Charle
+*    email                : wouter.charle@gmail.com
+*
+*    DISCLAIMER OF DAMAGES
+*    ---------------------
+*    Wouter Charle has made every effort possible to ensure that the software
+*    is free of any bugs or errors, however in no way is the software to
+*    be considered error or bug free. You assume all responsibility for
+*    any damages or lost data that may result from any errors or bugs in
+*    the software.
+*
+*    IN NO EVENT WILL VISION++ BE LIABLE TO YOU FOR ANY GENERAL, SPECIAL,
+*    INDIRECT, CONSEQUENTIAL, INCIDENTAL OR OTHER DAMAGES ARISING OUT OF
+*    THIS LICENSE.
+*
+*    In no case shall Wouter Charle's liability exceed the purchase price for
+*    the software or services.
+*
+***************************************************************************/
+
+#ifndef _SWITCH_SCHEDULER
+#define _SWITCH_SCHEDULER
+
+// project includes
+#include "Switch_TimerWheel.h"
+#include "Switch_RuleEngine.h"
+
+// switch includes
+#include <Switch_Base/Switch_CompilerConfiguration.h>
+#include <Switch_Base/Switch_Types.h>
+#include <Switch_Device/Switch_DataContainer.h>
+#include <Switch_Serialization/Switch_JsonSerializableInterface.h>
+
+// third party includes
+#include <string>
+#include <list>
+#include <map>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <chrono>
+
+
+namespace Switch
+{
+  /*!
+    \brief Timed action setting elements in a device.
+   */
+  class Schedule : public Switch::JsonSerializableInterface
+  {
+  public:
+
+    enum eType
+    {
+      ST_ONE_SHOT     = 0,  ///< Fires once at the given time.
+      ST_RECURRING    = 1,  ///< Fires at the given time and every period thereafter.
+      ST_OFF_AFTER_ON = 2   ///< Fires a period after the watched element was last set to a non-zero value.
+    };
+
+    /*!
+      \brief Default constructor.
+     */
+    Schedule ();
+    /*!
+      \brief Destructor.
+     */
+    virtual ~Schedule ();
+
+    // using default copy constructor and assignment operator
+    Schedule (const Schedule& i_other) = default;
+    Schedule& operator= (const Schedule& i_other) = default;
+
+    /*!
+      \brief Checks if the schedule's properties are consistent.
+
+      \return True if the schedule can be armed, false otherwise.
+     */
+    bool IsValid () const;
+
+    /*!
+      \brief Serializes the object to a JSON value.
+
+      \param [out] o_root Root value of the object as JSON.
+     */
+    virtual void Serialize   (Json::Value& o_root) const;
+    /*!
+      \brief De-serializes the object from a JSON value.
+
+      \param [in] i_root Root value of the object as JSON.
+     */
+    virtual void Deserialize (const Json::Value& i_root);
+
+    // members
+    std::string                                 m_name;           ///< Name of the schedule.
+    eType                                       m_type;           ///< The type of the schedule.
+    switch_device_address_type                  m_deviceAddress;  ///< The device in which to set the elements.
+    uint64_t                                    m_time;           ///< The first time the schedule fires, in seconds since the epoch. Not used for ST_OFF_AFTER_ON.
+    uint32_t                                    m_periodSeconds;  ///< The period of ST_RECURRING, the delay after the last on of ST_OFF_AFTER_ON.
+    uint32_t                                    m_elementAddress; ///< The address of the element watched by ST_OFF_AFTER_ON.
+    std::list <Switch::DataContainer::Element>  m_elements;       ///< The elements to set when the schedule fires.
+  };
+
+  /*!
+    \brief Arms schedules on a timer wheel and collects the actions of those that fire.
+
+    The wheel is advanced by the owner's thread, no thread of its own is used.
+    Schedules of type ST_OFF_AFTER_ON are indexed on their watched element, such
+    that changed device data only touches the schedules watching it.
+
+    \note All methods are thread-safe.
+   */
+  class Scheduler
+  {
+  public:
+
+    typedef std::map <uint32_t, Schedule> ScheduleMap;
+
+    /*!
+      \brief Default constructor.
+     */
+    Scheduler ();
+    /*!
+      \brief Destructor.
+     */
+    ~Scheduler ();
+
+    // copy constructor and assignment operator are disabled
+    Scheduler (const Scheduler& i_other) = delete;
+    Scheduler& operator= (const Scheduler& i_other) = delete;
+
+    /*!
+      \brief Replaces all schedules and arms them.
+
+      \param [in] i_schedules The schedules, mapped by id.
+     */
+    void SetSchedules (const ScheduleMap& i_schedules);
+    /*!
+      \brief Adds a schedule and arms it.
+
+      \param [in] i_scheduleId  The id of the schedule.
+      \param [in] i_schedule    The schedule.
+     */
+    void AddSchedule (const uint32_t& i_scheduleId, const Schedule& i_schedule);
+    /*!
+      \brief Removes a schedule.
+
+      \param [in] i_scheduleId The id of the schedule.
+
+      \return True if the schedule was removed, false if it does not exist.
+     */
+    bool RemoveSchedule (const uint32_t& i_scheduleId);
+    /*!
+      \brief Gets all schedules.
+
+      \param [out] o_schedules The schedules, mapped by id.
+     */
+    void GetSchedules (ScheduleMap& o_schedules) const;
+    /*!
+      \brief Re-arms or cancels the ST_OFF_AFTER_ON schedules watching changed elements.
+
+      \param [in] i_deviceAddress   The device of which the elements changed.
+      \param [in] i_changedElements The changed elements.
+     */
+    void HandleChangedElements (const switch_device_address_type& i_deviceAddress, const std::list <Switch::DataContainer::Element>& i_changedElements);
+    /*!
+      \brief Advances the timer wheel up to now and collects the actions of the schedules that fired.
+
+      \param [out] o_actions              The actions of the schedules that fired.
+      \param [out] o_finishedScheduleIds  The ids of the one-shot schedules that fired and were removed.
+     */
+    void Advance (std::list <Rule::Action>& o_actions, std::list <uint32_t>& o_finishedScheduleIds);
+    /*!
+      \brief Gets the time until the wheel must be advanced.
+
+      \return The time in microseconds, or the maximum value if no schedules are armed.
+     */
+    uint32_t GetDelayMicros () const;
+
+  private:
+
+    typedef uint64_t element_key_type;  ///< Device address in the high, element address in the low 32 bits.
+
+    /*!
+      \brief Schedule and the handle of its timer.
+     */
+    class Entry
+    {
+    public:
+      Schedule                        m_schedule; ///< The schedule.
+      TimerWheel::timer_handle_type   m_timer;    ///< The handle of the armed timer, INVALID_TIMER_HANDLE if not armed.
+    };
+
+    static element_key_type _Key (const switch_device_address_type& i_deviceAddress, const uint32_t& i_elementAddress);
+
+    void      _Add    (const uint32_t& i_scheduleId, const Schedule& i_schedule);
+    void      _Arm    (const uint32_t& i_scheduleId, Entry& io_entry);
+    void      _Disarm (Entry& io_entry);
+    uint64_t  _GetTick (const std::chrono::steady_clock::time_point& i_time) const;
+    uint64_t  _GetTickAfter (const uint64_t& i_delayMicros) const;
+
+    mutable std::mutex                                                m_mutex;        ///< Protects all members.
+    std::chrono::steady_clock::time_point                             m_epoch;        ///< The time of tick zero.
+    TimerWheel                                                        m_timerWheel;   ///< Timers of the armed schedules, the payload is the schedule id.
+    std::unordered_map <uint32_t, Entry>                              m_entries;      ///< All schedules, mapped by id.
+    std::unordered_map <element_key_type, std::vector <uint32_t>>     m_watchIndex;   ///< Maps watched elements onto the ids of the ST_OFF_AFTER_ON schedules.
+  };
+}
+
+#endif // _SWITCH_SCHEDULER
@@ -0,0 +1,360 @@
+/*?*************************************************************************
+*                           Switch_TimerWheel.cpp
+*                           -----------------------
+*    copyright            : (C) 2014 by Wouter Charle
+*    email                : wouter.charle@gmail.com
+*
+*    DISCLAIMER OF DAMAGES
+*    ---------------------
+*    Wouter Charle has made every effort possible to ensure that the software
+*    is free of any bugs or errors, however in no way is the software to
+*    be considered error or bug free. You assume all responsibility for
+*    any damages or lost data that may result from any errors or bugs in
+*    the software.
+*
+*    IN NO EVENT WILL VISION++ BE LIABLE TO YOU FOR ANY GENERAL, SPECIAL,
+*    INDIRECT, CONSEQUENTIAL, INCIDENTAL OR OTHER DAMAGES ARISING OUT OF
+*    THIS LICENSE.
+*
+*    In no case shall Wouter Charle's liability exceed the purchase price for
+*    the software or services.
+*
+***************************************************************************/
+
+#include "Switch_TimerWheel.h"
+
+// switch includes
+#include <Switch_Base/Switch_Debug.h>
+
+// third-party includes
+#include <limits>
+#include <algorithm>
+
+
+// static members
+const Switch::TimerWheel::timer_handle_type Switch::TimerWheel::INVALID_TIMER_HANDLE;
+const uint32_t Switch::TimerWheel::NO_NODE;
+const uint32_t Switch::TimerWheel::NO_SLOT;
+const uint32_t Switch::TimerWheel::NR_SLOTS;
+const uint32_t Switch::TimerWheel::NR_WORDS_PER_LEVEL;
+
+/*!
+  \brief Default constructor.
+ */
+Switch::TimerWheel::TimerWheel ()
+{
+  Reset (0);
+}
+
+/*!
+  \brief Destructor.
+ */
+Switch::TimerWheel::~TimerWheel ()
+{
+}
+
+void Switch::TimerWheel::Reset (const uint64_t& i_tick)
+{
+  m_nodes.clear ();
+  m_freeNode = NO_NODE;
+  for (uint32_t i=0; i<CONTROLLER_TIMER_WHEEL_NR_LEVELS*NR_SLOTS; ++i)
+  {
+    m_slots [i] = NO_NODE;
+  }
+  for (uint32_t i=0; i<CONTROLLER_TIMER_WHEEL_NR_LEVELS*NR_WORDS_PER_LEVEL; ++i)
+  {
+    m_occupied [i] = 0;
+  }
+  m_currentTick = i_tick;
+  m_size = 0;
+}
+
+Switch::TimerWheel::timer_handle_type Switch::TimerWheel::Add (const uint64_t& i_expiryTick, const uint32_t& i_payload)
+{
+  // get a free node
+  uint32_t nodeIndex = m_freeNode;
+  if (NO_NODE != nodeIndex)
+  {
+    m_freeNode = m_nodes [nodeIndex].m_next;
+  }
+  else
+  {
+    nodeIndex = static_cast <uint32_t> (m_nodes.size ());
+    m_nodes.push_back (Node ());
+    m_nodes.back ().m_generation = 1;
+  }
+
+  // initialize the node and insert it in its slot
+  Node& node = m_nodes [nodeIndex];
+  node.m_expiryTick = std::max (i_expiryTick, m_currentTick + 1);
+  node.m_payload    = i_payload;
+  _Insert (nodeIndex);
+  ++m_size;
+
+  return (static_cast <timer_handle_type> (node.m_generation) << 32) | nodeIndex;
+}
+
+bool Switch::TimerWheel::Remove (const timer_handle_type& i_handle)
+{
+  uint32_t nodeIndex  = static_cast <uint32_t> (i_handle & 0xFFFFFFFF);
+  uint32_t generation = static_cast <uint32_t> (i_handle >> 32);
+
+  // verify the handle refers to a pending timer
+  if (m_nodes.size () <= nodeIndex)
+  {
+    return false;
+  }
+  Node& node = m_nodes [nodeIndex];
+  if ((generation != node.m_generation) || (NO_SLOT == node.m_slot))
+  {
+    return false;
+  }
+
+  // unlink the node and return it to the free list
+  _Unlink (nodeIndex);
+  ++node.m_generation;
+  node.m_slot = NO_SLOT;
+  node.m_next = m_freeNode;
+  m_freeNode  = nodeIndex;
+  --m_size;
+
+  return true;
+}
+
+void Switch::TimerWheel::Advance (std::vector <uint32_t>& o_payloads, const uint64_t& i_tick)
+{
+  while (m_currentTick < i_tick)
+  {
+    // skip all ticks on which no slot needs to be handled
+    uint64_t nextTick = GetNextTick ();
+    if (i_tick < nextTick)
+    {
+      m_currentTick = i_tick;
+      break;
+    }
+    m_currentTick = nextTick;
+
+    // cascade the higher levels when the lower levels made a full turn
+    for (uint32_t level=1; level<CONTROLLER_TIMER_WHEEL_NR_LEVELS; ++level)
+    {
+      uint64_t lowerLevelsMask = (static_cast <uint64_t> (1) << (CONTROLLER_TIMER_WHEEL_NR_SLOT_BITS*level)) - 1;
+      if (0 != (m_currentTick & lowerLevelsMask))
+      {
+        break;
+      }
+      _Cascade (level);
+    }
+
+    // expire the timers of the current slot
+    _Expire (o_payloads);
+  }
+}
+
+uint64_t Switch::TimerWheel::GetNextTick () const
+{
+  if (0 == m_size)
+  {
+    return std::numeric_limits <uint64_t>::max ();
+  }
+
+  // the next tick on which an occupied slot of any level is handled
+  uint64_t nextTick = std::numeric_limits <uint64_t>::max ();
+  for (uint32_t level=0; level<CONTROLLER_TIMER_WHEEL_NR_LEVELS; ++level)
+  {
+    uint64_t levelTick = m_currentTick >> (CONTROLLER_TIMER_WHEEL_NR_SLOT_BITS*level);
+    uint64_t turnBegin = levelTick & ~static_cast <uint64_t> (NR_SLOTS - 1);
+    uint32_t currentSlot = static_cast <uint32_t> (levelTick - turnBegin);
+
+    // search the remainder of the current turn, then the next turn
+    uint32_t slot = _FindOccupiedSlot (level, currentSlot + 1);
+    if (NR_SLOTS > slot)
+    {
+      levelTick = turnBegin + slot;
+    }
+    else
+    {
+      slot = _FindOccupiedSlot (level, 0);
+      if (NR_SLOTS <= slot)
+      {
+        continue;
+      }
+      levelTick = turnBegin + NR_SLOTS + slot;
+    }
+
+    nextTick = std::min (nextTick, levelTick << (CONTROLLER_TIMER_WHEEL_NR_SLOT_BITS*level));
+  }
+
+  return nextTick;
+}
+
+uint64_t Switch::TimerWheel::GetCurrentTick () const
+{
+  return m_currentTick;
+}
+
+uint32_t Switch::TimerWheel::GetSize () const
+{
+  return m_size;
+}
+
+/*!
+  \brief Inserts a node in the slot of the lowest level spanning its expiry.
+
+  Timers cascaded on their expiry tick land in the current slot of the lowest
+  level, which is expired right after cascading. Expiries beyond the span of
+  the wheel are placed in the last slot of the highest level, and re-inserted
+  when that slot reaches the lowest level.
+
+  \param [in] i_nodeIndex The index of the node to insert.
+ */
+void Switch::TimerWheel::_Insert (const uint32_t& i_nodeIndex)
+{
+  Node& node = m_nodes [i_nodeIndex];
+  SWITCH_ASSERT (m_currentTick <= node.m_expiryTick);
+
+  // select the level
+  uint64_t delta = node.m_expiryTick - m_currentTick;
+  uint64_t placementTick = node.m_expiryTick;
+  uint32_t level = 0;
+  while ((CONTROLLER_TIMER_WHEEL_NR_LEVELS - 1 > level) && ((static_cast <uint64_t> (1) << (CONTROLLER_TIMER_WHEEL_NR_SLOT_BITS*(level + 1))) <= delta))
+  {
+    ++level;
+  }
+  uint64_t wheelSpan = static_cast <uint64_t> (1) << (CONTROLLER_TIMER_WHEEL_NR_SLOT_BITS*CONTROLLER_TIMER_WHEEL_NR_LEVELS);
+  if (wheelSpan <= delta)
+  {
+    placementTick = m_currentTick + wheelSpan - 1;
+  }
+
+  // link the node at the head of the slot
+  uint32_t slot = level*NR_SLOTS + static_cast <uint32_t> ((placementTick >> (CONTROLLER_TIMER_WHEEL_NR_SLOT_BITS*level)) & (NR_SLOTS - 1));
+  node.m_slot     = slot;
+  node.m_previous = NO_NODE;
+  node.m_next     = m_slots [slot];
+  if (NO_NODE != node.m_next)
+  {
+    m_nodes [node.m_next].m_previous = i_nodeIndex;
+  }
+  m_slots [slot] = i_nodeIndex;
+  m_occupied [slot/64] |= (static_cast <uint64_t> (1) << (slot%64));
+}
+
+/*!
+  \brief Unlinks a node from the list of its slot.
+
+  \param [in] i_nodeIndex The index of the node to unlink.
+ */
+void Switch::TimerWheel::_Unlink (const uint32_t& i_nodeIndex)
+{
+  Node& node = m_nodes [i_nodeIndex];
+
+  if (NO_NODE != node.m_previous)
+  {
+    m_nodes [node.m_previous].m_next = node.m_next;
+  }
+  else
+  {
+    m_slots [node.m_slot] = node.m_next;
+    if (NO_NODE == node.m_next)
+    {
+      m_occupied [node.m_slot/64] &= ~(static_cast <uint64_t> (1) << (node.m_slot%64));
+    }
+  }
+  if (NO_NODE != node.m_next)
+  {
+    m_nodes [node.m_next].m_previous = node.m_previous;
+  }
+}
+
+/*!
+  \brief Moves the timers of the current slot of a level to the lower levels.
+
+  \param [in] i_level The level to cascade.
+ */
+void Switch::TimerWheel::_Cascade (const uint32_t& i_level)
+{
+  uint32_t slot = i_level*NR_SLOTS + static_cast <uint32_t> ((m_currentTick >> (CONTROLLER_TIMER_WHEEL_NR_SLOT_BITS*i_level)) & (NR_SLOTS - 1));
+
+  // detach the list of the slot
+  uint32_t nodeIndex = m_slots [slot];
+  m_slots [slot] = NO_NODE;
+  m_occupied [slot/64] &= ~(static_cast <uint64_t> (1) << (slot%64));
+
+  // re-insert all nodes
+  while (NO_NODE != nodeIndex)
+  {
+    uint32_t nextNodeIndex = m_nodes [nodeIndex].m_next;
+    _Insert (nodeIndex);
+    nodeIndex = nextNodeIndex;
+  }
+}
+
+/*!
+  \brief Expires the timers of the current slot of the lowest level.
+
+  \param [out] o_payloads The payloads of the expired timers.
+ */
+void Switch::TimerWheel::_Expire (std::vector <uint32_t>& o_payloads)
+{
+  uint32_t slot = static_cast <uint32_t> (m_currentTick & (NR_SLOTS - 1));
+
+  // detach the list of the slot
+  uint32_t nodeIndex = m_slots [slot];
+  m_slots [slot] = NO_NODE;
+  m_occupied [slot/64] &= ~(static_cast <uint64_t> (1) << (slot%64));
+
+  while (NO_NODE != nodeIndex)
+  {
+    Node& node = m_nodes [nodeIndex];
+    uint32_t nextNodeIndex = node.m_next;
+
+    if (m_currentTick < node.m_expiryTick)
+    {
+      // expiry beyond the span of the wheel, re-arm
+      _Insert (nodeIndex);
+    }
+    else
+    {
+      // return the node to the free list
+      o_payloads.push_back (node.m_payload);
+      ++node.m_generation;
+      node.m_slot = NO_SLOT;
+      node.m_next = m_freeNode;
+      m_freeNode  = nodeIndex;
+      --m_size;
+    }
+
+    nodeIndex = nextNodeIndex;
+  }
+}
+
+/*!
+  \brief Finds the first occupied slot of a level.
+
+  \param [in] i_level     The level to search.
+  \param [in] i_fromSlot  The index of the slot from which to search.
+
+  \return The index of the slot within the level, or NR_SLOTS if none of the slots are occupied.
+ */
+uint32_t Switch::TimerWheel::_FindOccupiedSlot (const uint32_t& i_level, const uint32_t& i_fromSlot) const
+{
+  if (NR_SLOTS <= i_fromSlot)
+  {
+    return NR_SLOTS;
+  }
+
+  // mask the slots before the first slot to search
+  uint32_t wordIndex = i_fromSlot/64;
+  uint64_t word = m_occupied [i_level*NR_WORDS_PER_LEVEL + wordIndex] & (~static_cast <uint64_t> (0) << (i_fromSlot%64));
+  while (0 == word)
+  {
+    ++wordIndex;
+    if (NR_WORDS_PER_LEVEL <= wordIndex)
+    {
+      return NR_SLOTS;
+    }
+    word = m_occupied [i_level*NR_WORDS_PER_LEVEL + wordIndex];
+  }
+
+  return wordIndex*64 + static_cast <uint32_t> (__builtin_ctzll (word));
+}
@@ -0,0 +1,164 @@
+/*?*************************************************************************
+*                           Switch_TimerWheel.h
+*                           -----------------------
+*    copyright            : (C) 2014 by Wouter Charle
+*    email                : wouter.charle@gmail.com
+*
+*    DISCLAIMER OF DAMAGES
+*    ---------------------
+*    Wouter Charle has made every effort possible to ensure that the software
+*    is free of any bugs or errors, however in no way is the software to
+*    be considered error or bug free. You assume all responsibility for
+*    any damages or lost data that may result from any errors or bugs in
+*    the software.
+*
+*    IN NO EVENT WILL VISION++ BE LIABLE TO YOU FOR ANY GENERAL, SPECIAL,
+*    INDIRECT, CONSEQUENTIAL, INCIDENTAL OR OTHER DAMAGES ARISING OUT OF
+*    THIS LICENSE.
+*
+*    In no case shall Wouter Charle's liability exceed the purchase price for
+*    the software or services.
+*
+***************************************************************************/
+
+#ifndef _SWITCH_TIMERWHEEL
+#define _SWITCH_TIMERWHEEL
+
+// project includes
+#include "Switch_ControllerConfiguration.h"
+
+// switch includes
+#include <Switch_Base/Switch_CompilerConfiguration.h>
+#include <Switch_Base/Switch_Types.h>
+
+// third party includes
+#include <vector>
+
+
+namespace Switch
+{
+  /*!
+    \brief Hierarchical timer wheel.
+
+    Time is counted in ticks. Every level of the wheel holds
+    CONTROLLER_TIMER_WHEEL_NR_SLOTS slots, a slot of level n spans
+    NR_SLOTS^n ticks. A timer is kept in the slot of the lowest level
+    that spans its expiry and cascades down one level every time the
+    level below has made a full turn.
+
+    Adding, removing and expiring a timer are O(1): timers are nodes of
+    intrusive lists in one pre-allocated pool and the occupied slots are
+    tracked in bitmaps.
+
+    \note The timer wheel is not thread-safe.
+   */
+  class TimerWheel
+  {
+  public:
+
+    typedef uint64_t timer_handle_type;   ///< Generation in the high, node index in the low 32 bits.
+
+    static const timer_handle_type INVALID_TIMER_HANDLE = 0;
+
+    /*!
+      \brief Default constructor.
+     */
+    TimerWheel ();
+    /*!
+      \brief Destructor.
+     */
+    ~TimerWheel ();
+
+    // copy constructor and assignment operator are disabled
+    TimerWheel (const TimerWheel& i_other) = delete;
+    TimerWheel& operator= (const TimerWheel& i_other) = delete;
+
+    /*!
+      \brief Removes all timers and sets the current tick.
+
+      \param [in] i_tick The new current tick.
+     */
+    void Reset (const uint64_t& i_tick);
+    /*!
+      \brief Adds a timer.
+
+      \param [in] i_expiryTick  The tick at which the timer expires. Timers expiring in the past expire on the next tick.
+      \param [in] i_payload     Value returned when the timer expires.
+
+      \return The handle of the timer.
+     */
+    timer_handle_type Add (const uint64_t& i_expiryTick, const uint32_t& i_payload);
+    /*!
+      \brief Removes a timer.
+
+      \param [in] i_handle The handle of the timer.
+
+      \return True if the timer was removed, false if it already expired or was removed before.
+     */
+    bool Remove (const timer_handle_type& i_handle);
+    /*!
+      \brief Advances the wheel up to a tick and collects the expired timers.
+
+      \param [out] o_payloads The payloads of the expired timers, appended in order of expiry.
+      \param [in]  i_tick     The tick up to which to advance.
+     */
+    void Advance (std::vector <uint32_t>& o_payloads, const uint64_t& i_tick);
+    /*!
+      \brief Gets the next tick at which the wheel must be advanced.
+
+      \return The tick, or the maximum value if no timers are pending.
+
+      \note Timers may not expire on that tick, the wheel may only need to cascade.
+            Ticks on which no slot needs to be handled are skipped by Advance.
+     */
+    uint64_t GetNextTick () const;
+    /*!
+      \brief Gets the current tick.
+
+      \return The tick up to which the wheel was advanced.
+     */
+    uint64_t GetCurrentTick () const;
+    /*!
+      \brief Gets the number of pending timers.
+
+      \return The number of pending timers.
+     */
+    uint32_t GetSize () const;
+
+  private:
+
+    /*!
+      \brief Timer node, linked in the list of a slot or in the free list.
+     */
+    class Node
+    {
+    public:
+      uint64_t  m_expiryTick; ///< The tick at which the timer expires.
+      uint32_t  m_payload;    ///< Value returned when the timer expires.
+      uint32_t  m_generation; ///< Incremented on every reuse of the node, invalidates old handles.
+      uint32_t  m_slot;       ///< Index of the slot holding the node over all levels, or NO_SLOT if the node is free.
+      uint32_t  m_previous;   ///< Index of the previous node in the list.
+      uint32_t  m_next;       ///< Index of the next node in the list.
+    };
+
+    static const uint32_t NO_NODE = 0xFFFFFFFF;
+    static const uint32_t NO_SLOT = 0xFFFFFFFF;
+    static const uint32_t NR_SLOTS = CONTROLLER_TIMER_WHEEL_NR_SLOTS;
+    static const uint32_t NR_WORDS_PER_LEVEL = CONTROLLER_TIMER_WHEEL_NR_SLOTS / 64;
+
+    void      _Insert     (const uint32_t& i_nodeIndex);
+    void      _Unlink     (const uint32_t& i_nodeIndex);
+    void      _Cascade    (const uint32_t& i_level);
+    void      _Expire     (std::vector <uint32_t>& o_payloads);
+    uint32_t  _FindOccupiedSlot (const uint32_t& i_level, const uint32_t& i_fromSlot) const;
+
+    std::vector <Node>  m_nodes;                                                                    ///< Pool of all nodes.
+    uint32_t            m_freeNode;                                                                 ///< Head of the list of free nodes.
+    uint32_t            m_slots [CONTROLLER_TIMER_WHEEL_NR_LEVELS * CONTROLLER_TIMER_WHEEL_NR_SLOTS]; ///< Heads of the lists of the slots.
+    uint64_t            m_occupied [CONTROLLER_TIMER_WHEEL_NR_LEVELS * NR_WORDS_PER_LEVEL];         ///< Bitmaps of the slots holding timers.
+    uint64_t            m_currentTick;                                                              ///< The tick up to which the wheel was advanced.
+    uint32_t            m_size;                                                                     ///< The number of pending timers.
+  };
+}
+
+#endif // _SWITCH_TIMERWHEEL
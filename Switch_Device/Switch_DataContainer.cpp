@@ -28,6 +28,7 @@
 
 // third-party includes
 #include <json/json.h>
+#include <algorithm>
 
 
 /*!
@@ -66,6 +67,7 @@ Switch::DataContainer::DataFormat::~DataFormat ()
  */
 Switch::DataContainer::DataFormat::DataFormat (const Switch::DataContainer::DataFormat& i_other)
 {
+  // note: the layout is compiled again when used, the copy may be changed before
   m_name              = i_other.m_name;
   m_description       = i_other.m_description;
   m_nestedAdapters    = i_other.m_nestedAdapters;
@@ -87,6 +89,10 @@ Switch::DataContainer::DataFormat& Switch::DataContainer::DataFormat::operator=
     m_description       = i_other.m_description;
     m_nestedAdapters    = i_other.m_nestedAdapters;
     m_nestedContainers  = i_other.m_nestedContainers;
+
+    // forget the layout of the previous format
+    std::unique_lock <std::mutex> layoutLock (m_layoutMutex);
+    m_pLayout.reset ();
   }
 
   return *this;
@@ -238,59 +244,152 @@ void Switch::DataContainer::DataFormat::Deserialize (const Json::Value& i_root)
     m_nestedContainers.push_back (dataFormat);
     m_nestedContainers.back ().Deserialize (containerValue);
   }
+
+  // forget the layout of the previous format
+  std::unique_lock <std::mutex> layoutLock (m_layoutMutex);
+  m_pLayout.reset ();
 }
 
 /*!
-  \brief Constructor
+  \brief Gets the flat layout of the elements, compiled on the first call.
 
-  \param [in] i_dataFormat The data format of the data adapter
+  \return The layout, shared by the containers of this data format.
+
+  \note The data format must not change once containers were made with it.
  */
-Switch::DataContainer::DataContainer (const Switch::DataContainer::DataFormat& i_dataFormat)
-: mr_dataFormat   (i_dataFormat),
-  m_ownsData      (true),
-  m_pData         (0x0),
-  m_startAddress  (0)
+std::shared_ptr <const Switch::DataContainer::Layout> Switch::DataContainer::DataFormat::GetLayout () const
 {
-  try
+  std::unique_lock <std::mutex> layoutLock (m_layoutMutex);
+
+  if (0x0 == m_pLayout.get ())
   {
-    // compute the total data size
-    uint32_t totalByteSize = (mr_dataFormat.GetTotalBitSize () + 7) / 8;
+    m_pLayout = std::make_shared <Switch::DataContainer::Layout> (*this);
+  }
 
-    // allocate data
-    m_pData = new uint8_t [totalByteSize];
+  return m_pLayout;
+}
+
+const uint32_t Switch::DataContainer::Layout::s_noField;
+
+/*!
+  \brief Compiles the layout of a data format.
+
+  \param [in] i_dataFormat The data format.
+ */
+Switch::DataContainer::Layout::Layout (const Switch::DataContainer::DataFormat& i_dataFormat)
+: m_contentSize ((i_dataFormat.GetTotalBitSize () + 7) / 8),
+  m_bufferSize  (0)
+{
+  // flatten the nested adapters and containers
+  _AddFields (i_dataFormat, 0, 0);
+
+  // the fields of malformed formats may end beyond the content
+  m_bufferSize = m_contentSize;
+  std::vector <Field>::const_iterator itField;
+  for (itField = m_fields.begin (); m_fields.end () != itField; ++itField)
+  {
+    m_bufferSize = std::max (m_bufferSize, itField->m_byteOffset + itField->m_nrBytes);
+  }
 
-    // create new data adapters and nested data containers
-    _GenerateNestedObjectsFromDataFormat ();
+  // index the fields on their address
+  if (!m_fields.empty ())
+  {
+    m_fieldIndices.assign (m_fields.back ().m_address + 1, s_noField);
   }
-  catch (...)
+  for (uint32_t index=0; index<m_fields.size (); ++index)
   {
-    // cleanup
-    m_nestedDataAdapters.clear ();
-    m_nestedDataContainers.clear ();
+    // note: a field without bits shares its address with the next, the first one is kept
+    uint32_t& fieldIndex = m_fieldIndices [m_fields [index].m_address];
+    if (s_noField == fieldIndex)
+    {
+      fieldIndex = index;
+    }
+  }
+}
 
-    delete [] m_pData;
-    m_pData = 0x0;
+/*!
+  \brief Adds the fields of the adapters of a data format and its nested formats.
+
+  The positions follow those of the nested data adapters and containers: the data of a container
+  starts at the byte of its first adapter's bit offset, the nested containers follow its adapters.
 
-    // rethrow
-    throw;
+  \param [in] i_dataFormat   The data format.
+  \param [in] i_byteOffset   Index of the first byte of the data format in the data buffer.
+  \param [in] i_startAddress Address of the first element of the data format.
+ */
+void Switch::DataContainer::Layout::_AddFields (const Switch::DataContainer::DataFormat& i_dataFormat, const uint32_t& i_byteOffset, const uint32_t& i_startAddress)
+{
+  // initialization of helper variables
+  uint32_t totalBits = 0;
+  uint32_t bitOffset = 0;
+  if (!i_dataFormat.m_nestedAdapters.empty ())
+  {
+    bitOffset = i_dataFormat.m_nestedAdapters.begin ()->m_bitOffset;
+  }
+
+  // iterate over all nested data adapters
+  std::list <Switch::DataAdapter::DataFormat>::const_iterator adapterIterator;
+  for (adapterIterator=i_dataFormat.m_nestedAdapters.begin (); i_dataFormat.m_nestedAdapters.end ()!=adapterIterator; ++adapterIterator)
+  {
+    const Switch::DataAdapter::DataFormat& adapterDataFormat = *adapterIterator;
+    SWITCH_ASSERT (32 >= adapterDataFormat.m_bitOffset + adapterDataFormat.m_bitSize);
+
+    // note: the bits of the element are read from a 32 bit word starting at its first byte
+    const uint32_t bitSize  = std::min <uint32_t> (32, adapterDataFormat.m_bitSize);
+    const uint32_t endBit   = std::min <uint32_t> (32, adapterDataFormat.m_bitOffset + bitSize);
+
+    Field field;
+    field.m_address     = i_startAddress + totalBits;
+    field.m_magicNumber = adapterDataFormat.ComputeMagicNumber (field.m_address);
+    field.m_byteOffset  = i_byteOffset + (totalBits + bitOffset) / 8;
+    field.m_nrBytes     = (endBit + 7) / 8;
+    field.m_shift       = 32 - endBit;
+    field.m_mask        = static_cast <uint32_t> (((static_cast <uint64_t> (1) << bitSize) - 1) << field.m_shift);
+    field.m_minValue    = adapterDataFormat.m_minValue;
+    field.m_maxValue    = adapterDataFormat.m_maxValue;
+    m_fields.push_back (field);
+
+    totalBits += adapterDataFormat.m_bitSize;
+  }
+
+  // iterate over all nested data containers
+  std::list <Switch::DataContainer::DataFormat>::const_iterator containerIterator;
+  for (containerIterator=i_dataFormat.m_nestedContainers.begin (); i_dataFormat.m_nestedContainers.end ()!=containerIterator; ++containerIterator)
+  {
+    _AddFields (*containerIterator, i_byteOffset + (totalBits + bitOffset) / 8, i_startAddress + totalBits);
+    totalBits += containerIterator->GetTotalBitSize ();
   }
 }
 
+/*!
+  \brief Finds the field of an element.
+
+  \param [in] i_address The address of the element.
+
+  \return The index of the field, s_noField if no element has the address.
+ */
+uint32_t Switch::DataContainer::Layout::FindField (const uint32_t& i_address) const
+{
+  if (m_fieldIndices.size () <= i_address)
+  {
+    return s_noField;
+  }
+
+  return m_fieldIndices [i_address];
+}
+
 /*!
   \brief Constructor
 
-  \param [in] i_pData         Access to the underlying data buffer, shared with this data adapter
-  \param [in] i_startAddress  Address of the first element of the container.
-  \param [in] i_dataFormat    The data format of the data adapter
+  \param [in] i_dataFormat The data format of the data adapter
  */
-Switch::DataContainer::DataContainer (uint8_t* i_pData, const uint32_t& i_startAddress, const DataFormat& i_dataFormat)
+Switch::DataContainer::DataContainer (const Switch::DataContainer::DataFormat& i_dataFormat)
 : mr_dataFormat   (i_dataFormat),
-  m_ownsData      (false),
-  m_pData         (i_pData),
-  m_startAddress  (i_startAddress)
+  m_pLayout       (i_dataFormat.GetLayout ()),
+  m_pData         (0x0)
 {
-  // create new data adapters and nested data containers
-  _GenerateNestedObjectsFromDataFormat ();
+  // allocate the data
+  m_pData = new uint8_t [m_pLayout->m_bufferSize];
 }
 
 /*!
@@ -298,14 +397,8 @@ Switch::DataContainer::DataContainer (uint8_t* i_pData, const uint32_t& i_startA
  */
 Switch::DataContainer::~DataContainer ()
 {
-  m_nestedDataAdapters.clear ();
-  m_nestedDataContainers.clear ();
-
-  if (m_ownsData)
-  {
-    delete [] m_pData;
-    m_pData = 0x0;
-  }
+  delete [] m_pData;
+  m_pData = 0x0;
 }
 
 /*!
@@ -315,45 +408,12 @@ Switch::DataContainer::~DataContainer ()
  */
 Switch::DataContainer::DataContainer (const DataContainer& i_other)
 : mr_dataFormat   (i_other.mr_dataFormat),
-  m_ownsData      (false),
-  m_pData         (0x0),
-  m_startAddress  (0)
+  m_pLayout       (i_other.m_pLayout),
+  m_pData         (0x0)
 {
-  try
-  {
-    if (i_other.m_ownsData)
-    {
-      // compute the total data size and allocate data
-      m_ownsData              = true;
-      uint32_t totalByteSize  = (mr_dataFormat.GetTotalBitSize () + 7) / 8;
-      m_pData                 = new uint8_t [totalByteSize];
-      memcpy (m_pData, i_other.m_pData, totalByteSize);
-    }
-    else
-    {
-      m_ownsData      = false;
-      m_pData         = i_other.m_pData;
-      m_startAddress  = i_other.m_startAddress;
-    }
-
-    // create new data adapters and nested data containers
-    _GenerateNestedObjectsFromDataFormat ();
-  }
-  catch (...)
-  {
-    // cleanup
-    m_nestedDataAdapters.clear ();
-    m_nestedDataContainers.clear ();
-
-    if (m_ownsData)
-    {
-      delete [] m_pData;
-      m_pData = 0x0;
-    }
-
-    // rethrow
-    throw;
-  }
+  // copy the data, the layout is shared
+  m_pData = new uint8_t [m_pLayout->m_bufferSize];
+  memcpy (m_pData, i_other.m_pData, m_pLayout->m_bufferSize);
 }
 
 /*!
@@ -370,97 +430,15 @@ Switch::DataContainer& Switch::DataContainer::operator= (const DataContainer& i_
   if (this != &i_other)
   {
     SWITCH_ASSERT (mr_dataFormat == i_other.mr_dataFormat);
+    SWITCH_ASSERT_RETURN_1 (m_pLayout->m_bufferSize == i_other.m_pLayout->m_bufferSize, *this);
 
-    // cleanup
-    m_nestedDataAdapters.clear ();
-    m_nestedDataContainers.clear ();
-
-    if (m_ownsData)
-    {
-      delete m_pData;
-      m_pData = 0x0;
-      m_ownsData = false;
-    }
-
-    try
-    {
-      if (i_other.m_ownsData)
-      {
-        // compute the total data size and allocate data
-        m_ownsData = true;
-        uint32_t totalByteSize = (mr_dataFormat.GetTotalBitSize () + 7) / 8;
-        m_pData = new uint8_t [totalByteSize];
-        memcpy (m_pData, i_other.m_pData, totalByteSize);
-        m_startAddress = 0x0;
-      }
-      else
-      {
-        m_ownsData = false;
-        m_pData         = i_other.m_pData;
-        m_startAddress  = i_other.m_startAddress;
-      }
-
-      // create new data adapters and nested data containers
-      _GenerateNestedObjectsFromDataFormat ();
-    }
-    catch (...)
-    {
-      // cleanup
-      m_nestedDataAdapters.clear ();
-      m_nestedDataContainers.clear ();
-
-      if (m_ownsData)
-      {
-        delete [] m_pData;
-        m_pData = 0x0;
-      }
-
-      // rethrow
-      throw;
-    }
+    // copy the data, equal formats have equal layouts
+    memcpy (m_pData, i_other.m_pData, m_pLayout->m_bufferSize);
   }
 
   return *this;
 }
 
-/*!
-  \brief Parses the data format and generates nested objects.
-
-  \note If the nested object lists are non-empty, they are cleared first.
- */
-void Switch::DataContainer::_GenerateNestedObjectsFromDataFormat ()
-{
-  SWITCH_ASSERT_RETURN_0 (0x0 != m_pData);
-
-  // clear the nested object lists
-  m_nestedDataAdapters.clear ();
-  m_nestedDataContainers.clear ();
-
-  // initialization of helper variables
-  uint32_t totalBits = 0;
-  uint32_t bitOffset = 0;
-  if (!mr_dataFormat.m_nestedAdapters.empty ())
-  {
-    bitOffset = mr_dataFormat.m_nestedAdapters.begin ()->m_bitOffset;
-  }
-
-  // iterate over all nested data adapters
-  std::list <Switch::DataAdapter::DataFormat>::const_iterator adapterIterator;
-  for (adapterIterator=mr_dataFormat.m_nestedAdapters.begin (); mr_dataFormat.m_nestedAdapters.end ()!=adapterIterator; ++adapterIterator)
-  {
-    m_nestedDataAdapters.push_back (Switch::DataAdapter (&m_pData [(totalBits + bitOffset)/8], *adapterIterator));
-    totalBits += adapterIterator->m_bitSize;
-  }
-
-  // iterate over all nested data containers
-  std::list <Switch::DataContainer::DataFormat>::const_iterator containerIterator;
-  for (containerIterator=mr_dataFormat.m_nestedContainers.begin (); mr_dataFormat.m_nestedContainers.end ()!=containerIterator; ++containerIterator)
-  {
-    m_nestedDataContainers.push_back (Switch::DataContainer (&m_pData [(totalBits + bitOffset)/8], m_startAddress + totalBits, *containerIterator));
-    totalBits += containerIterator->GetTotalBitSize ();
-  }
-}
-
 /*!
   \brief Gets the data format.
 
@@ -477,99 +455,46 @@ const Switch::DataContainer::DataFormat& Switch::DataContainer::GetDataFormat ()
   \param [in,out] io_changedElements List of elements whose value has changed.
   \param [in] i_elements List of elements for which to set the value.
 
-  \note The list must be sorted on element address.
-
   \return True if the value of one or more elements has changed.
  */
 bool Switch::DataContainer::SetElements (std::list <Switch::DataContainer::Element>& io_changedElements, const std::list <Switch::DataContainer::Element>& i_elements)
 {
-  // ensure that the list of elements is non-empty
-  if (0 == i_elements.size ())
-  {
-    return false;
-  }
-
-  // prepare to iterator over the elements
-  bool adapterValueChanged;
+  const Layout& layout = *m_pLayout;
   bool valueChanged = false;
-  std::list <Switch::DataContainer::Element>::const_iterator elementIterator = i_elements.begin ();
-
-  // iterate over all nested adapters
-  uint32_t currentAddress = m_startAddress;
-  std::list <Switch::DataAdapter>::iterator adapterIterator;
-  for (adapterIterator=m_nestedDataAdapters.begin ();
-       (m_nestedDataAdapters.end () !=adapterIterator) && (i_elements.end ()!=elementIterator);
-       ++adapterIterator)
+
+  // look up the field of each element
+  std::list <Switch::DataContainer::Element>::const_iterator elementIterator;
+  for (elementIterator=i_elements.begin (); i_elements.end ()!=elementIterator; ++elementIterator)
   {
-    // ensure that the element's address is beyond the address of the current element
-    SWITCH_ASSERT (currentAddress <= elementIterator->m_address);
-    if (elementIterator->m_address < currentAddress)
+    uint32_t fieldIndex = layout.FindField (elementIterator->m_address);
+    if (Layout::s_noField == fieldIndex)
     {
-      break;
+      SWITCH_DEBUG_MSG_1 ("unknown element address %u\n", elementIterator->m_address);
+      continue;
     }
+    const Layout::Field& field = layout.m_fields [fieldIndex];
 
-    // check if the element address maches the current address
-    if (elementIterator->m_address == currentAddress)
+    if (elementIterator->m_magicNumber != field.m_magicNumber)
     {
-      if (elementIterator->m_magicNumber != adapterIterator->GetDataFormat ().ComputeMagicNumber (elementIterator->m_address))
-      {
-        SWITCH_DEBUG_MSG_0 ("invalid magic number\n");
-        continue;
-      }
-
-      // set the value in the data adapter
-      adapterValueChanged = adapterIterator->SetDataValue (elementIterator->m_value);
-      if (adapterValueChanged)
-      {
-        io_changedElements.push_back (*elementIterator);
-      }
-      valueChanged |= adapterValueChanged;
-      ++elementIterator;
+      SWITCH_DEBUG_MSG_0 ("invalid magic number\n");
+      continue;
     }
 
-    // update to the next adapter address
-    currentAddress += adapterIterator->GetDataFormat ().m_bitSize;
-  }
-
-  // stop if all elements have been handled
-  if (i_elements.end ()==elementIterator)
-  {
-    return valueChanged;
-  }
-
-  // iterate over all nested containers
-  std::list <Switch::DataContainer>::iterator containerIterator;
-  uint32_t addressUpperBoundary;
-  for (containerIterator=m_nestedDataContainers.begin ();
-       (m_nestedDataContainers.end () !=containerIterator) && (i_elements.end ()!=elementIterator);
-       ++containerIterator)
-  {
-    // ensure that the element's address is beyond the address of the current container
-    SWITCH_ASSERT (m_startAddress <= elementIterator->m_address);
-    if (elementIterator->m_address < currentAddress)
+    // validate the value
+    if ((elementIterator->m_value < field.m_minValue) || (elementIterator->m_value > field.m_maxValue))
     {
-      break;
+      SWITCH_DEBUG_MSG_2 ("new value for element %u not valid %d\n\r", elementIterator->m_address, elementIterator->m_value);
+      continue;
     }
 
-    // get address boundaries of the current container
-    addressUpperBoundary = currentAddress + containerIterator->GetDataFormat ().GetTotalBitSize ();
-
-    // check if the element belongs to the current container
-    if (elementIterator->m_address<addressUpperBoundary)
+    // set the value in the data
+    uint32_t fieldValue = static_cast <uint32_t> (static_cast <int64_t> (elementIterator->m_value) - field.m_minValue);
+    if (fieldValue != _ReadField (field, m_pData))
     {
-      // create a new list of all elements belonging to the current container
-      std::list <Switch::DataContainer::Element> containerElements;
-      for (; (i_elements.end ()!=elementIterator) && (elementIterator->m_address<addressUpperBoundary); ++elementIterator)
-      {
-        containerElements.push_back (*elementIterator);
-      }
-
-      // set the elements in the current container
-      valueChanged |= containerIterator->SetElements (io_changedElements, containerElements);
+      _WriteField (field, fieldValue);
+      io_changedElements.push_back (*elementIterator);
+      valueChanged = true;
     }
-
-    // update to the next container address
-    currentAddress = addressUpperBoundary;
   }
 
   // return if the value of the data in this container changed
@@ -583,31 +508,15 @@ bool Switch::DataContainer::SetElements (std::list <Switch::DataContainer::Eleme
  */
 void Switch::DataContainer::GetElements (std::list <Switch::DataContainer::Element>& io_elements) const
 {
-  // iterate over all nested adapters
-  uint32_t currentAddress = m_startAddress;
-  std::list <Switch::DataAdapter>::const_iterator adapterIterator;
-  for (adapterIterator=m_nestedDataAdapters.begin (); m_nestedDataAdapters.end () !=adapterIterator; ++adapterIterator)
+  // translate each field to an element
+  std::vector <Layout::Field>::const_iterator fieldIterator;
+  for (fieldIterator=m_pLayout->m_fields.begin (); m_pLayout->m_fields.end ()!=fieldIterator; ++fieldIterator)
   {
-    // get the data format of the current adapter
-    const Switch::DataAdapter::DataFormat& adapterDataFormat = adapterIterator->GetDataFormat ();
-
-    // translate the adapter to an element
-    Element adapterElement;
-    adapterElement.m_address      = currentAddress;
-    adapterElement.m_magicNumber  = adapterDataFormat.ComputeMagicNumber (currentAddress);
-    adapterIterator->GetDataValue (adapterElement.m_value);
-    io_elements.push_back (adapterElement);
-
-    // update the address for the next element
-    currentAddress += adapterDataFormat.m_bitSize;
-  }
-
-  // iterate over all nested containers
-  std::list <Switch::DataContainer>::const_iterator containerIterator;
-  for (containerIterator=m_nestedDataContainers.begin (); m_nestedDataContainers.end () !=containerIterator; ++containerIterator)
-  {
-    // let the current container add its elements
-    containerIterator->GetElements (io_elements);
+    Element element;
+    element.m_address     = fieldIterator->m_address;
+    element.m_magicNumber = fieldIterator->m_magicNumber;
+    element.m_value       = static_cast <int32_t> (static_cast <int64_t> (_ReadField (*fieldIterator, m_pData)) + fieldIterator->m_minValue);
+    io_elements.push_back (element);
   }
 }
 
@@ -621,44 +530,37 @@ void Switch::DataContainer::GetElements (std::list <Switch::DataContainer::Eleme
  */
 bool Switch::DataContainer::SetContent (std::list <Element>& io_changedElements, const uint8_t* const i_pData)
 {
-  // initialization of helper variables
-  uint32_t totalBits = 0;
-  if (!mr_dataFormat.m_nestedAdapters.empty ())
-  {
-    totalBits = mr_dataFormat.m_nestedAdapters.begin ()->m_bitOffset;
-  }
-  bool adapterDataChanged;
+  SWITCH_ASSERT_RETURN_1 (0x0 != i_pData, false);
+
   bool dataChanged = false;
 
-  // iterate over all nested data adapters
-  std::list <Switch::DataAdapter>::iterator adapterIterator;
-  for (adapterIterator=m_nestedDataAdapters.begin (); m_nestedDataAdapters.end ()!=adapterIterator; ++adapterIterator)
+  // copy the valid values of the fields
+  std::vector <Layout::Field>::const_iterator fieldIterator;
+  for (fieldIterator=m_pLayout->m_fields.begin (); m_pLayout->m_fields.end ()!=fieldIterator; ++fieldIterator)
   {
-    const Switch::DataAdapter::DataFormat& adapterDataFormat = adapterIterator->GetDataFormat ();
+    const Layout::Field& field = *fieldIterator;
 
-    adapterDataChanged = adapterIterator->SetDataValue (&i_pData [totalBits/8]);
-    if (adapterDataChanged)
+    // validate the value
+    uint32_t fieldValue = _ReadField (field, i_pData);
+    int64_t value = static_cast <int64_t> (fieldValue) + field.m_minValue;
+    if (value > field.m_maxValue)
     {
-      // add an element for the adapter to the list of changed elements
-      Element adapterElement;
-      adapterElement.m_address      = m_startAddress - m_startAddress%8  + totalBits;
-      adapterElement.m_magicNumber  = adapterDataFormat.ComputeMagicNumber (adapterElement.m_address);
-      adapterIterator->GetDataValue (adapterElement.m_value);
-      io_changedElements.push_back (adapterElement);
-
-      // note: the address of the element is computed against the beginning of the up-most parent of the container
-      //       while i_pData starts on the same byte as this data container
+      SWITCH_DEBUG_MSG_2 ("new value for element %u not valid %d\n\r", field.m_address, static_cast <int32_t> (value));
+      continue;
     }
-    dataChanged |= adapterDataChanged;
-    totalBits += adapterDataFormat.m_bitSize;
-  }
 
-  // iterate over all nested data containers
-  std::list <Switch::DataContainer>::iterator containerIterator;
-  for (containerIterator=m_nestedDataContainers.begin (); m_nestedDataContainers.end ()!=containerIterator; ++containerIterator)
-  {
-    dataChanged |= containerIterator->SetContent (io_changedElements, &i_pData [totalBits/8]);
-    totalBits += containerIterator->GetDataFormat ().GetTotalBitSize ();
+    if (fieldValue != _ReadField (field, m_pData))
+    {
+      _WriteField (field, fieldValue);
+
+      // add an element for the field to the list of changed elements
+      Element element;
+      element.m_address     = field.m_address;
+      element.m_magicNumber = field.m_magicNumber;
+      element.m_value       = static_cast <int32_t> (value);
+      io_changedElements.push_back (element);
+      dataChanged = true;
+    }
   }
 
   return dataChanged;
@@ -668,21 +570,44 @@ bool Switch::DataContainer::SetContent (std::list <Element>& io_changedElements,
   \brief Gets the content of the container.
 
   \param [in] o_pData Data buffer that must be filled with the content of the container.
-
-  \note Can only be called on the data container that owns its own data buffer.
  */
 void Switch::DataContainer::GetContent (uint8_t* const o_pData) const
 {
-  // ensure that the method is called on the container owning the data
-  SWITCH_ASSERT (m_ownsData);
-  if (!m_ownsData)
+  // copy the data buffer
+  memcpy (o_pData, m_pData, m_pLayout->m_contentSize);
+}
+
+/*!
+  \brief Reads the value of an element from a data buffer.
+
+  \return The value, unscaled, with 0 for the minimum value.
+ */
+uint32_t Switch::DataContainer::_ReadField (const Layout::Field& i_field, const uint8_t* const i_pData)
+{
+  // gather the bytes of the element into a big-endian word
+  uint32_t word = 0;
+  for (uint32_t byte=0; byte<i_field.m_nrBytes; ++byte)
   {
-    return;
+    word |= static_cast <uint32_t> (i_pData [i_field.m_byteOffset + byte]) << (24 - 8*byte);
   }
 
-  // get the total size in bits
-  uint32_t totalBitSize = mr_dataFormat.GetTotalBitSize ();
+  return (word & i_field.m_mask) >> i_field.m_shift;
+}
 
-  // copy the data buffer
-  memcpy (o_pData, m_pData, static_cast <uint32_t> ((totalBitSize + 7)/8));
+/*!
+  \brief Writes the value of an element into the data buffer.
+
+  \param [in] i_field       The field of the element.
+  \param [in] i_fieldValue  The value, unscaled, with 0 for the minimum value.
+ */
+void Switch::DataContainer::_WriteField (const Layout::Field& i_field, const uint32_t& i_fieldValue)
+{
+  // write the bits of the element, leaving the bits of its neighbours
+  uint32_t word = (i_fieldValue << i_field.m_shift) & i_field.m_mask;
+  for (uint32_t byte=0; byte<i_field.m_nrBytes; ++byte)
+  {
+    uint8_t& data = m_pData [i_field.m_byteOffset + byte];
+    const uint8_t byteMask = static_cast <uint8_t> (i_field.m_mask >> (24 - 8*byte));
+    data = static_cast <uint8_t> ((data & ~byteMask) | ((word >> (24 - 8*byte)) & byteMask));
+  }
 }
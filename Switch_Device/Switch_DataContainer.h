@@ -34,6 +34,9 @@
 // third party includes
 #include <string>
 #include <list>
+#include <vector>
+#include <memory>
+#include <mutex>
 
 namespace Switch
 {
@@ -41,6 +44,8 @@ namespace Switch
   {
   public:
 
+    class Layout;
+
     class DataFormat : public Switch::JsonSerializableInterface
     {
     public:
@@ -101,6 +106,15 @@ namespace Switch
        */
       uint32_t GetTotalBitSize () const;
 
+      /*!
+        \brief Gets the flat layout of the elements, compiled on the first call.
+
+        \return The layout, shared by the containers of this data format.
+
+        \note The data format must not change once containers were made with it.
+       */
+      std::shared_ptr <const Layout> GetLayout () const;
+
       /*!
         \brief Serializes the object to a JSON value.
 
@@ -120,6 +134,66 @@ namespace Switch
 
       std::list <Switch::DataAdapter::DataFormat> m_nestedAdapters; ///< List of data formats of data adapters contained by this container.
       std::list <DataFormat> m_nestedContainers;                    ///< List of data formats of nested data containers.
+
+    private:
+
+      mutable std::mutex                      m_layoutMutex;  ///< Protects the compilation of the layout.
+      mutable std::shared_ptr <const Layout>  m_pLayout;      ///< The compiled layout, 0x0 until first used. Not copied.
+    };
+
+    /*!
+      \brief Flat layout of the elements of a data format.
+
+      The nested adapters and containers of a data format are compiled into one array of
+      fields, ordered by address, from which the elements are read and written directly.
+     */
+    class Layout
+    {
+    public:
+
+      /*!
+        \brief Position and limits of an element in the data buffer.
+       */
+      class Field
+      {
+      public:
+
+        uint32_t  m_address;      ///< The address of the element in bits.
+        uint32_t  m_magicNumber;  ///< Magic number for element adress verification.
+        uint32_t  m_byteOffset;   ///< Index of the first byte of the element in the data buffer.
+        uint32_t  m_nrBytes;      ///< Number of bytes spanned by the element, 1 to 4.
+        uint32_t  m_shift;        ///< Right shift of the element in the big-endian word read from its first byte.
+        uint32_t  m_mask;         ///< Mask of the element in the big-endian word read from its first byte.
+        int32_t   m_minValue;     ///< The minimum value, stored as 0.
+        int32_t   m_maxValue;     ///< The maximum value.
+      };
+
+      static const uint32_t s_noField = 0xFFFFFFFF; ///< Index of addresses without field.
+
+      /*!
+        \brief Compiles the layout of a data format.
+
+        \param [in] i_dataFormat The data format.
+       */
+      explicit Layout (const DataFormat& i_dataFormat);
+
+      /*!
+        \brief Finds the field of an element.
+
+        \param [in] i_address The address of the element.
+
+        \return The index of the field, s_noField if no element has the address.
+       */
+      uint32_t FindField (const uint32_t& i_address) const;
+
+      std::vector <Field>     m_fields;         ///< The fields, ordered by address.
+      std::vector <uint32_t>  m_fieldIndices;   ///< The index of the field at each address, s_noField for addresses without element.
+      uint32_t                m_contentSize;    ///< The size of the content in bytes.
+      uint32_t                m_bufferSize;     ///< The size of the data buffer in bytes, covering the content and all fields.
+
+    private:
+
+      void _AddFields (const DataFormat& i_dataFormat, const uint32_t& i_byteOffset, const uint32_t& i_startAddress);
     };
 
     /*!
@@ -176,8 +250,6 @@ namespace Switch
       \param [in,out] io_changedElements List of elements whose value has changed.
       \param [in] i_elements List of elements for which to set the value.
 
-      \note The list must be sorted on element address.
-
       \return True if the value of one or more elements has changed.
      */
     bool SetElements (std::list <Element>& io_changedElements, const std::list <Element>& i_elements);
@@ -209,28 +281,22 @@ namespace Switch
   protected:
 
     /*!
-      \brief Constructor
+      \brief Reads the value of an element from a data buffer.
 
-      \param [in] i_pData         Access to the underlying data buffer, shared with this data adapter.
-      \param [in] i_startAddress  Address of the first element of the container.
-      \param [in] i_dataFormat    The data format of the data adapter.
+      \return The value, unscaled, with 0 for the minimum value.
      */
-    explicit DataContainer (uint8_t* i_pData, const uint32_t& i_startAddress, const DataFormat& i_dataFormat);
-
+    static uint32_t _ReadField (const Layout::Field& i_field, const uint8_t* const i_pData);
     /*!
-      \brief Parses the data format and generates nested objects.
+      \brief Writes the value of an element into the data buffer.
 
-      \note The nested object lists must be empty.
+      \param [in] i_field       The field of the element.
+      \param [in] i_fieldValue  The value, unscaled, with 0 for the minimum value.
      */
-    void _GenerateNestedObjectsFromDataFormat ();
-
-    const DataFormat& mr_dataFormat;  ///< Const reference to the dataformat of the container.
-    bool              m_ownsData;     ///< Flags if this data container owns the data or not.
-    uint8_t*          m_pData;        ///< Pointer to the underlying data array. The first byte contains the first nested adapter in the container.
-    uint32_t          m_startAddress; ///< Address in bits of the first nested adapter in this container. Unique for all elements in a nested container structure.
+    void _WriteField (const Layout::Field& i_field, const uint32_t& i_fieldValue);
 
-    std::list <Switch::DataAdapter>   m_nestedDataAdapters;   ///< List of nested data adapters in this container.
-    std::list <Switch::DataContainer> m_nestedDataContainers; ///< List of nested data containers in this container.
+    const DataFormat&               mr_dataFormat;  ///< Const reference to the dataformat of the container.
+    std::shared_ptr <const Layout>  m_pLayout;      ///< The layout of the data format.
+    uint8_t*                        m_pData;        ///< Pointer to the underlying data array. The first byte contains the first nested adapter in the container.
   };
 }
 
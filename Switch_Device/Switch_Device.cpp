@@ -191,8 +191,10 @@ void Switch::Device::Description::Deserialize (const Json::Value& i_root)
  */
 Switch::Device::Device (const switch_device_address_type& i_deviceAddress)
 : m_address         (i_deviceAddress),
+  m_connected       (false),
   m_pDescription    (0x0),
-  m_pDataContainer  (0x0)
+  m_pDataContainer  (0x0),
+  m_pReportedDataContainer (0x0)
 {
 }
 
@@ -204,6 +206,8 @@ Switch::Device::~Device ()
   // cleanup data
   delete m_pDataContainer;
   m_pDataContainer = 0x0;
+  delete m_pReportedDataContainer;
+  m_pReportedDataContainer = 0x0;
 
   // forget the device description
   m_pDescription = 0x0;
@@ -216,8 +220,10 @@ Switch::Device::~Device ()
  */
 Switch::Device::Device (const Device& i_other)
 : m_address (i_other.m_address),
+  m_connected (i_other.m_connected),
   m_pDescription (i_other.m_pDescription),
-  m_pDataContainer (0x0)
+  m_pDataContainer (0x0),
+  m_pReportedDataContainer (0x0)
 {
   try
   {
@@ -226,12 +232,19 @@ Switch::Device::Device (const Device& i_other)
       const Switch::DataContainer& otherContainer = *i_other.m_pDataContainer;
       m_pDataContainer = new Switch::DataContainer (otherContainer);
     }
+    if (0x0 != i_other.m_pReportedDataContainer)
+    {
+      const Switch::DataContainer& otherContainer = *i_other.m_pReportedDataContainer;
+      m_pReportedDataContainer = new Switch::DataContainer (otherContainer);
+    }
   }
   catch (...)
   {
     // cleanup data
     delete m_pDataContainer;
     m_pDataContainer = 0x0;
+    delete m_pReportedDataContainer;
+    m_pReportedDataContainer = 0x0;
 
     // forget the device description
     m_pDescription = 0x0;
@@ -258,6 +271,7 @@ Switch::Device& Switch::Device::operator= (const Device& i_other)
     try
     {
       m_pDescription  = i_other.m_pDescription;
+      m_connected     = i_other.m_connected;
 
       if (0x0 == i_other.m_pDataContainer)
       {
@@ -278,12 +292,34 @@ Switch::Device& Switch::Device::operator= (const Device& i_other)
           thisContainer = otherContainer;
         }
       }
+
+      if (0x0 == i_other.m_pReportedDataContainer)
+      {
+        delete m_pReportedDataContainer;
+        m_pReportedDataContainer = 0x0;
+      }
+      else
+      {
+        const Switch::DataContainer& otherContainer = *i_other.m_pReportedDataContainer;
+
+        if (0x0 == m_pReportedDataContainer)
+        {
+          m_pReportedDataContainer = new Switch::DataContainer (otherContainer);
+        }
+        else
+        {
+          Switch::DataContainer& thisContainer = *m_pReportedDataContainer;
+          thisContainer = otherContainer;
+        }
+      }
     }
     catch (...)
     {
       // cleanup data
       delete m_pDataContainer;
       m_pDataContainer = 0x0;
+      delete m_pReportedDataContainer;
+      m_pReportedDataContainer = 0x0;
 
       // forget the device description
       m_pDescription = 0x0;
@@ -321,14 +357,17 @@ void Switch::Device::SetDescription (const Switch::Device::Description& i_device
     // store device description
     m_pDescription = &i_deviceDescription;
 
-    // allocate a new data container
+    // allocate new data containers for the desired and the reported state
     m_pDataContainer = new Switch::DataContainer (i_deviceDescription.m_dataFormat);
+    m_pReportedDataContainer = new Switch::DataContainer (i_deviceDescription.m_dataFormat);
   }
   catch (...)
   {
     // cleanup data
     delete m_pDataContainer;
     m_pDataContainer = 0x0;
+    delete m_pReportedDataContainer;
+    m_pReportedDataContainer = 0x0;
 
     // forget the device description
     m_pDescription = 0x0;
@@ -429,3 +468,77 @@ Switch::DataContainer& Switch::Device::GetDataContainer ()
   // return refernce
   return *m_pDataContainer;
 }
+
+/*!
+  \brief Gets a const reference to the device's reported data container.
+
+  \return Const reference to the device's reported data container.
+
+  \throw std::runtime_error if the device description was not set.
+
+  \see SetDescription
+ */
+const Switch::DataContainer& Switch::Device::GetReportedDataContainer () const
+{
+  // ensure the the device description is set
+  SWITCH_ASSERT_THROW (0x0 != m_pDescription, std::runtime_error ("device description not set"));
+  SWITCH_ASSERT_THROW (0x0 != m_pReportedDataContainer, std::runtime_error ("device description set, but reported data container not allocated"));
+  if (0x0 == m_pDescription)
+  {
+    throw std::runtime_error ("device description not set");
+  }
+
+  // return reference
+  return *m_pReportedDataContainer;
+}
+
+/*!
+  \brief Gets a reference to the device's reported data container.
+
+  \return Reference to the device's reported data container.
+
+  \throw std::runtime_error if the device description was not set.
+
+  \see SetDescription
+ */
+Switch::DataContainer& Switch::Device::GetReportedDataContainer ()
+{
+  // ensure the the device description is set
+  SWITCH_ASSERT_THROW (0x0 != m_pDescription, std::runtime_error ("device description not set"));
+  SWITCH_ASSERT_THROW (0x0 != m_pReportedDataContainer, std::runtime_error ("device description set, but reported data container not allocated"));
+  if (0x0 == m_pDescription)
+  {
+    throw std::runtime_error ("device description not set");
+  }
+
+  // return reference
+  return *m_pReportedDataContainer;
+}
+
+/*!
+  \brief Checks if the desired state equals the reported state.
+
+  \return True if the device reported all desired values, false otherwise.
+
+  \throw std::runtime_error if the device description was not set.
+ */
+bool Switch::Device::IsInSync () const
+{
+  std::list <Switch::DataContainer::Element> desiredElements;
+  std::list <Switch::DataContainer::Element> reportedElements;
+  GetDataContainer ().GetElements (desiredElements);
+  GetReportedDataContainer ().GetElements (reportedElements);
+
+  // note: both containers share the data format, the elements are listed in the same order
+  std::list <Switch::DataContainer::Element>::const_iterator itDesired = desiredElements.begin ();
+  std::list <Switch::DataContainer::Element>::const_iterator itReported = reportedElements.begin ();
+  for (; (desiredElements.end () != itDesired) && (reportedElements.end () != itReported); ++itDesired, ++itReported)
+  {
+    if (itDesired->m_value != itReported->m_value)
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
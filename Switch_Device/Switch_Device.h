@@ -210,6 +210,47 @@ namespace Switch
      */
     Switch::DataContainer& GetDataContainer ();
 
+    /*!
+      \brief Gets a const reference to the device's reported data container.
+
+      The data container returned by GetDataContainer holds the desired state of
+      the device, the reported data container holds the state last confirmed by
+      the device itself.
+
+      \return Const reference to the device's reported data container.
+
+      \note The device's description must be set.
+
+      \throw std::runtime_error if the device description was not set.
+
+      \see SetDescription
+     */
+    const Switch::DataContainer& GetReportedDataContainer () const;
+
+    /*!
+      \brief Gets a reference to the device's reported data container.
+
+      \return Reference to the device's reported data container.
+
+      \note The device's description must be set.
+
+      \throw std::runtime_error if the device description was not set.
+
+      \see SetDescription
+     */
+    Switch::DataContainer& GetReportedDataContainer ();
+
+    /*!
+      \brief Checks if the desired state equals the reported state.
+
+      \return True if the device reported all desired values, false otherwise.
+
+      \note The device's description must be set.
+
+      \throw std::runtime_error if the device description was not set.
+     */
+    bool IsInSync () const;
+
   protected:
 
   private:
@@ -217,7 +258,8 @@ namespace Switch
     const switch_device_address_type  m_address;        ///< The unique address of this device.
     bool                              m_connected;      ///< Flags if the node is connected (true) or not (false).
     Description const*                m_pDescription;   ///< Pointer to the device's description.
-    Switch::DataContainer*            m_pDataContainer; ///< Pointer to the data container for this device.
+    Switch::DataContainer*            m_pDataContainer; ///< Pointer to the data container for this device. Holds the desired state.
+    Switch::DataContainer*            m_pReportedDataContainer; ///< Pointer to the data container holding the state reported by the device.
   };
 }
 
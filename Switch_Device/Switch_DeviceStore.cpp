@@ -129,6 +129,7 @@ void Switch::DeviceStore::_GetParameters (Switch::ParameterizedObject::Parameter
   \brief Default constructor
  */
 Switch::DeviceStore::DeviceStore ()
+: m_version (0)
 {
   _SetupParameterContainer ();
 
@@ -141,6 +142,7 @@ Switch::DeviceStore::DeviceStore ()
   \brief Constructor
  */
 Switch::DeviceStore::DeviceStore (const Switch::DeviceStore::Parameters& i_parameters)
+: m_version (0)
 {
   _SetupParameterContainer ();
 
@@ -197,6 +199,7 @@ void Switch::DeviceStore::AddDevice (const switch_device_address_type& i_deviceA
   // create the device and add it to the map of unidentified devices
   Switch::Device device (i_deviceAddress);
   m_unidentifiedDeviceMap.insert (std::make_pair (i_deviceAddress, device));
+  ++m_version;
 
   SWITCH_DEBUG_MSG_0 ("success!\n\r");
 }
@@ -254,6 +257,7 @@ Switch::Device& Switch::DeviceStore::SetDeviceType (const switch_device_address_
   // move the device from the unidentified devices map to the real devices map
   std::pair <std::map <switch_device_address_type, Switch::Device>::iterator, bool> result = m_deviceMap.insert (*itDevice);
   m_unidentifiedDeviceMap.erase (itDevice);
+  ++m_version;
 
   // return a reference to the device
   SWITCH_DEBUG_MSG_0 ("success!\n\r");
@@ -284,6 +288,88 @@ Switch::DeviceStore::DeviceMap& Switch::DeviceStore::GetUnidentfiedDevices ()
   return m_unidentifiedDeviceMap;
 }
 
+/*!
+  \brief Gets the version of the devices in the store.
+
+  The version changes whenever devices are added, identified or (re)loaded, and
+  allows users to cache information derived from the devices.
+
+  \return The version.
+ */
+uint64_t Switch::DeviceStore::GetVersion () const
+{
+  return m_version.load ();
+}
+
+/*!
+  \brief Adds a schedule to the store.
+
+  \param [in] i_definition The serialized definition of the schedule.
+
+  \return The id of the schedule.
+ */
+uint32_t Switch::DeviceStore::AddSchedule (const std::string& i_definition)
+{
+  SWITCH_DEBUG_MSG_0 ("Switch::DeviceStore::AddSchedule ... ");
+
+  std::lock_guard <std::mutex> operationsLock (m_operationsMutex);
+
+  if (OS_STOPPED == m_objectState)
+  {
+    throw std::runtime_error ("object must be READY or STARTED to add schedule");
+  }
+
+  // add the schedule to the database
+  uint32_t scheduleId = _WriteDatabaseSchedule (i_definition);
+
+  // map the definition to the id
+  m_scheduleMap [scheduleId] = i_definition;
+
+  SWITCH_DEBUG_MSG_0 ("success!\n\r");
+  return scheduleId;
+}
+
+/*!
+  \brief Removes a schedule from the store.
+
+  \param [in] i_scheduleId The id of the schedule.
+ */
+void Switch::DeviceStore::RemoveSchedule (const uint32_t& i_scheduleId)
+{
+  SWITCH_DEBUG_MSG_0 ("Switch::DeviceStore::RemoveSchedule ... ");
+
+  std::lock_guard <std::mutex> operationsLock (m_operationsMutex);
+
+  if (OS_STOPPED == m_objectState)
+  {
+    throw std::runtime_error ("object must be READY or STARTED to remove schedule");
+  }
+
+  ScheduleMap::iterator itSchedule = m_scheduleMap.find (i_scheduleId);
+  if (m_scheduleMap.end () == itSchedule)
+  {
+    throw std::runtime_error ("schedule not added");
+  }
+
+  // remove the schedule from the database
+  _DeleteDatabaseSchedule (i_scheduleId);
+  m_scheduleMap.erase (itSchedule);
+
+  SWITCH_DEBUG_MSG_0 ("success!\n\r");
+}
+
+Switch::DeviceStore::ScheduleMap& Switch::DeviceStore::GetSchedules ()
+{
+  std::lock_guard <std::mutex> operationsLock (m_operationsMutex);
+
+  if (OS_STOPPED == m_objectState)
+  {
+    throw std::runtime_error ("object must be READY or STARTED to get schedules");
+  }
+
+  return m_scheduleMap;
+}
+
 void Switch::DeviceStore::_Prepare ()
 {
   SWITCH_DEBUG_MSG_0 ("Preparing Switch::DeviceStore ... ");
@@ -319,6 +405,10 @@ void Switch::DeviceStore::_Prepare ()
 
     // load all known devices
     _ReadDatabaseDevices ();
+    ++m_version;
+
+    // load all schedules
+    _ReadDatabaseSchedules ();
   }
   catch (...)
   {
@@ -363,11 +453,16 @@ void Switch::DeviceStore::_Stop ()
   SWITCH_DEBUG_MSG_0 ("clearing devices ... ");
   m_unidentifiedDeviceMap.clear ();
   m_deviceMap.clear ();
+  ++m_version;
 
   // clear all product descriptions
   SWITCH_DEBUG_MSG_0 ("clearing products ... ");
   m_productDescriptionMap.clear ();
 
+  // clear all schedules
+  SWITCH_DEBUG_MSG_0 ("clearing schedules ... ");
+  m_scheduleMap.clear ();
+
   // close the connection to the database
   SWITCH_DEBUG_MSG_0 ("closing database connection ... ");
   sqlite3_close (m_pDatabaseConnection);
@@ -426,6 +521,23 @@ void Switch::DeviceStore::_UpdateDatabaseLayout ()
       snprintf (buffer, 128, "Can't update database layout': %s\n", errorMessage);
       throw std::system_error (result, std::generic_category (), buffer);
     }
+
+    // schedules table
+    result = sqlite3_exec
+    (
+      m_pDatabaseConnection,
+      "CREATE TABLE IF NOT EXISTS schedules (id INTEGER PRIMARY KEY AUTOINCREMENT, definition TEXT NOT NULL);",
+      0x0,
+      0x0,
+      &errorMessage
+    );
+
+    if (SQLITE_OK != result)
+    {
+      char buffer [128];
+      snprintf (buffer, 128, "Can't update database layout': %s\n", errorMessage);
+      throw std::system_error (result, std::generic_category (), buffer);
+    }
   }
   catch (...)
   {
@@ -838,6 +950,160 @@ int Switch::DeviceStore::_OnDatabaseDeviceRead (const int& i_nrColumns, char con
   return SQLITE_OK;
 }
 
+uint32_t Switch::DeviceStore::_WriteDatabaseSchedule (const std::string& i_definition)
+{
+  SWITCH_DEBUG_MSG_0 ("write database schedule ... ");
+
+  int result;
+  char stringBuffer [128];
+  sqlite3_stmt* pStatementInsert = 0x0;
+
+  try
+  {
+    // prepare insert statement
+    // note: the definition is bound as parameter, such that it needs no escaping
+    result = sqlite3_prepare_v2
+    (
+      m_pDatabaseConnection,
+      "INSERT INTO schedules (definition) VALUES (?);",
+      -1,
+      &pStatementInsert,
+      0x0
+    );
+    if (SQLITE_OK != result)
+    {
+      snprintf (stringBuffer, 128, "Can't prepare statement: %s\n", sqlite3_errmsg (m_pDatabaseConnection));
+      throw std::system_error (result, std::generic_category (), stringBuffer);
+    }
+
+    result = sqlite3_bind_text (pStatementInsert, 1, i_definition.c_str (), -1, SQLITE_TRANSIENT);
+    if (SQLITE_OK != result)
+    {
+      snprintf (stringBuffer, 128, "Can't bind statement: %s\n", sqlite3_errmsg (m_pDatabaseConnection));
+      throw std::system_error (result, std::generic_category (), stringBuffer);
+    }
+
+    // execute statement
+    result = sqlite3_step (pStatementInsert);
+    if (SQLITE_DONE != result)
+    {
+      snprintf (stringBuffer, 128, "Can't write schedule to database: %s\n", sqlite3_errmsg (m_pDatabaseConnection));
+      throw std::system_error (result, std::generic_category (), stringBuffer);
+    }
+
+    // cleanup
+    sqlite3_finalize (pStatementInsert);
+    pStatementInsert = 0x0;
+
+    // return the primary key of the last insertion
+    return static_cast <uint32_t> (sqlite3_last_insert_rowid (m_pDatabaseConnection));
+  }
+  catch (...)
+  {
+    // cleanup
+    sqlite3_finalize (pStatementInsert);
+    pStatementInsert = 0x0;
+
+    // forward
+    throw;
+  }
+}
+
+void Switch::DeviceStore::_DeleteDatabaseSchedule (const uint32_t& i_scheduleId)
+{
+  SWITCH_DEBUG_MSG_0 ("delete database schedule ... ");
+
+  int result;
+  char stringBuffer [128];
+  char* errorMessage = 0x0;
+
+  try
+  {
+    // create statement
+    snprintf (stringBuffer, 128, "DELETE FROM schedules WHERE id=%u;", i_scheduleId);
+
+    // schedules table
+    result = sqlite3_exec
+    (
+      m_pDatabaseConnection,
+      stringBuffer,
+      0x0,
+      0x0,
+      &errorMessage
+    );
+
+    if (SQLITE_OK != result)
+    {
+      snprintf (stringBuffer, 128, "Can't delete schedule from database: %s\n", errorMessage);
+      throw std::system_error (result, std::generic_category (), stringBuffer);
+    }
+  }
+  catch (...)
+  {
+    // cleanup
+    sqlite3_free (errorMessage);
+    errorMessage = 0x0;
+
+    // forward
+    throw;
+  }
+}
+
+void Switch::DeviceStore::_ReadDatabaseSchedules ()
+{
+  SWITCH_DEBUG_MSG_0 ("read database schedules ... ");
+
+  int result;
+  char stringBuffer [128];
+  sqlite3_stmt* pStatementSelect = 0x0;
+
+  m_scheduleMap.clear ();
+
+  try
+  {
+    // prepare select statement
+    result = sqlite3_prepare_v2
+    (
+      m_pDatabaseConnection,
+      "SELECT id, definition FROM schedules;",
+      -1,
+      &pStatementSelect,
+      0x0
+    );
+    if (SQLITE_OK != result)
+    {
+      snprintf (stringBuffer, 128, "Can't prepare statement: %s\n", sqlite3_errmsg (m_pDatabaseConnection));
+      throw std::system_error (result, std::generic_category (), stringBuffer);
+    }
+
+    // map the definitions to their ids
+    while (SQLITE_ROW == (result = sqlite3_step (pStatementSelect)))
+    {
+      uint32_t scheduleId = static_cast <uint32_t> (sqlite3_column_int64 (pStatementSelect, 0));
+      const unsigned char* pDefinition = sqlite3_column_text (pStatementSelect, 1);
+      m_scheduleMap [scheduleId] = (0x0 != pDefinition) ? reinterpret_cast <const char*> (pDefinition) : "";
+    }
+    if (SQLITE_DONE != result)
+    {
+      snprintf (stringBuffer, 128, "Can't read schedules from database: %s\n", sqlite3_errmsg (m_pDatabaseConnection));
+      throw std::system_error (result, std::generic_category (), stringBuffer);
+    }
+
+    // cleanup
+    sqlite3_finalize (pStatementSelect);
+    pStatementSelect = 0x0;
+  }
+  catch (...)
+  {
+    // cleanup
+    sqlite3_finalize (pStatementSelect);
+    pStatementSelect = 0x0;
+
+    // forward
+    throw;
+  }
+}
+
 void Switch::DeviceStore::_LoadProductDescription (Switch::Device::Description& o_description, const switch_brand_id_type& i_brandId, const switch_product_id_type& i_productId, const switch_product_version_type& i_version)
 {
   SWITCH_DEBUG_MSG_0 ("load product description ... ");
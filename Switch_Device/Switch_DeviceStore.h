@@ -33,6 +33,7 @@
 
 // third party includes
 #include <map>
+#include <atomic>
 
 // forward declarations
 class sqlite3;
@@ -52,6 +53,7 @@ namespace Switch
   public:
 
     typedef std::map <switch_device_address_type, Switch::Device> DeviceMap;
+    typedef std::map <uint32_t, std::string> ScheduleMap;   ///< Maps schedule ids onto their serialized definitions.
 
     /*!
       \brief Parameters container class
@@ -91,6 +93,11 @@ namespace Switch
     Switch::Device& SetDeviceType (const switch_device_address_type& i_deviceAddress, const switch_brand_id_type& i_brandId, const switch_product_id_type& i_productId, const switch_product_version_type& i_version);
     DeviceMap&      GetDevices    ();
     DeviceMap&      GetUnidentfiedDevices ();
+    uint64_t        GetVersion    () const;
+
+    uint32_t        AddSchedule     (const std::string& i_definition);
+    void            RemoveSchedule  (const uint32_t& i_scheduleId);
+    ScheduleMap&    GetSchedules    ();
 
   protected:
 
@@ -115,6 +122,9 @@ namespace Switch
     int       _OnDatabaseProductRead      (const int& i_nrColumns, char const* const* i_ppRowValues, char const* const* i_ppColumnNames);
     void      _ReadDatabaseDevices        ();
     int       _OnDatabaseDeviceRead       (const int& i_nrColumns, char const* const* i_ppRowValues, char const* const* i_ppColumnNames);
+    uint32_t  _WriteDatabaseSchedule      (const std::string& i_definition);
+    void      _DeleteDatabaseSchedule     (const uint32_t& i_scheduleId);
+    void      _ReadDatabaseSchedules      ();
     // > product description files
     void      _LoadProductDescription (Switch::Device::Description& o_description, const switch_brand_id_type& i_brandId, const switch_product_id_type& i_productId, const switch_product_version_type& i_version);
 
@@ -125,6 +135,8 @@ namespace Switch
     DeviceMap                                         m_unidentifiedDeviceMap;  ///< Map of all devices whose type is still unknown (maps address to device object).
     DeviceMap                                         m_deviceMap;              ///< Map of all devices (maps address to device object).
     std::map <uint64_t, Switch::Device::Description>  m_productDescriptionMap;  ///< Map of all known product descriptions (database key to description).
+    ScheduleMap                                       m_scheduleMap;            ///< Map of all schedules (maps id to serialized definition).
+    std::atomic <uint64_t>                            m_version;                ///< Incremented whenever devices are added, identified or (re)loaded.
 
     // parameters
     std::string m_databaseName;             ///< Name of the database to use as device store backend.
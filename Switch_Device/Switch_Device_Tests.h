@@ -212,6 +212,24 @@ void Switch::DeviceTests::TestDataContainer ()
   container.GetContent (reinterpret_cast <uint8_t*> (&content));
   SWITCH_ASSERT (content == 0x165F);
 
+  // the layout is compiled once and shared by the containers of the data format
+  std::shared_ptr <const Switch::DataContainer::Layout> pLayout = containerDataFormat.GetLayout ();
+  SWITCH_ASSERT (pLayout == containerDataFormat.GetLayout ());
+  SWITCH_ASSERT (4 == pLayout->m_fields.size ());
+  SWITCH_ASSERT (12 == pLayout->m_fields.back ().m_address);
+  SWITCH_ASSERT (Switch::DataContainer::Layout::s_noField == pLayout->FindField (1));
+
+  // elements are found by address, in any order
+  containerElements.clear ();
+  container.GetElements (containerElements);
+  containerElements.reverse ();
+  Switch::DataContainer otherContainer (containerDataFormat);
+  otherContainer.SetElements (changedElements, containerElements);
+  changedElements.clear ();
+  uint16_t otherContent;
+  otherContainer.GetContent (reinterpret_cast <uint8_t*> (&otherContent));
+  SWITCH_ASSERT (content == otherContent);
+
   std::cout << "<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<" << std::endl;
 
 #endif
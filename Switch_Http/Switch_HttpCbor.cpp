@@ -0,0 +1,403 @@
+/*?*************************************************************************
+*                           Switch_HttpCbor.cpp
+*                           -----------------------
+*    copyright            : (C) 2013 by Wouter Charle
+*    email                : wouter.charle@gmail.com
+*
+***************************************************************************/
+
+#include "Switch_HttpCbor.h"
+
+// project includes
+#include "Switch_HttpConfiguration.h"
+
+// third-party includes
+#include <map>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+  // major types
+  const uint8_t MT_UNSIGNED_INTEGER = 0;
+  const uint8_t MT_NEGATIVE_INTEGER = 1;
+  const uint8_t MT_BYTE_STRING      = 2;
+  const uint8_t MT_TEXT_STRING      = 3;
+  const uint8_t MT_ARRAY            = 4;
+  const uint8_t MT_MAP              = 5;
+  const uint8_t MT_TAG              = 6;
+  const uint8_t MT_SIMPLE           = 7;
+
+  // simple values and floats, including the major type
+  const uint8_t SV_FALSE      = 0xf4;
+  const uint8_t SV_TRUE       = 0xf5;
+  const uint8_t SV_NULL       = 0xf6;
+  const uint8_t SV_UNDEFINED  = 0xf7;
+  const uint8_t SV_HALF       = 0xf9;
+  const uint8_t SV_SINGLE     = 0xfa;
+  const uint8_t SV_DOUBLE     = 0xfb;
+
+  /*
+    Names of the interface fields, keyed by their position
+    => append only, clients decode keys with the same dictionary
+   */
+  const char* const g_keyDictionary [] =
+  {
+    "address", "magicNumber", "value", "deviceId", "values", "result", "index", "event", "data",
+    "connection", "online", "devices", "deviceValues", "deviceDetails", "productInfo", "connectionInfo",
+    "dataFormat", "brandId", "brandName", "productId", "productType", "productVersion", "name",
+    "description", "minValue", "maxValue", "results", "jsonrpc", "id", "method", "params", "error",
+    "code", "message", "clientId", "group", "retryAfter", "queuedCommands", "drainTime",
+    "nextCursor", "token", "version",
+    "snapshot"
+  };
+  const uint32_t g_keyDictionarySize = sizeof (g_keyDictionary) / sizeof (g_keyDictionary [0]);
+
+  void _EncodeHead (std::string& o_bytes, const uint8_t& i_majorType, const uint64_t& i_argument)
+  {
+    const uint8_t majorType = i_majorType << 5;
+    if (24 > i_argument)
+    {
+      o_bytes.push_back (static_cast <char> (majorType | i_argument));
+      return;
+    }
+
+    uint8_t nrBytes = 8;
+    uint8_t additionalInformation = 27;
+    if (0xff >= i_argument)
+    {
+      nrBytes = 1;
+      additionalInformation = 24;
+    }
+    else if (0xffff >= i_argument)
+    {
+      nrBytes = 2;
+      additionalInformation = 25;
+    }
+    else if (0xffffffff >= i_argument)
+    {
+      nrBytes = 4;
+      additionalInformation = 26;
+    }
+
+    o_bytes.push_back (static_cast <char> (majorType | additionalInformation));
+    for (int32_t shift=8*(nrBytes-1); 0<=shift; shift-=8)
+    {
+      o_bytes.push_back (static_cast <char> ((i_argument >> shift) & 0xff));
+    }
+  }
+
+  void _EncodeNumber (std::string& o_bytes, const double& i_number)
+  {
+    // note: numbers without fraction are sent as integers, as in the json text
+    if ((std::floor (i_number) == i_number) && (9.2e18 > std::fabs (i_number)))
+    {
+      const int64_t integer = static_cast <int64_t> (i_number);
+      if (0 <= integer)
+      {
+        _EncodeHead (o_bytes, MT_UNSIGNED_INTEGER, static_cast <uint64_t> (integer));
+      }
+      else
+      {
+        _EncodeHead (o_bytes, MT_NEGATIVE_INTEGER, static_cast <uint64_t> (-1 - integer));
+      }
+      return;
+    }
+
+    const float single = static_cast <float> (i_number);
+    if (static_cast <double> (single) == i_number)
+    {
+      uint32_t bits;
+      std::memcpy (&bits, &single, sizeof (bits));
+      o_bytes.push_back (static_cast <char> (SV_SINGLE));
+      for (int32_t shift=24; 0<=shift; shift-=8)
+      {
+        o_bytes.push_back (static_cast <char> ((bits >> shift) & 0xff));
+      }
+    }
+    else
+    {
+      uint64_t bits;
+      std::memcpy (&bits, &i_number, sizeof (bits));
+      o_bytes.push_back (static_cast <char> (SV_DOUBLE));
+      for (int32_t shift=56; 0<=shift; shift-=8)
+      {
+        o_bytes.push_back (static_cast <char> ((bits >> shift) & 0xff));
+      }
+    }
+  }
+
+  void _EncodeText (std::string& o_bytes, const std::string& i_text)
+  {
+    _EncodeHead (o_bytes, MT_TEXT_STRING, i_text.size ());
+    o_bytes.append (i_text);
+  }
+
+  std::map <std::string, uint32_t> _CreateKeyNumbers ()
+  {
+    std::map <std::string, uint32_t> keyNumbers;
+    for (uint32_t i=0; i<g_keyDictionarySize; ++i)
+    {
+      keyNumbers [g_keyDictionary [i]] = i;
+    }
+    return keyNumbers;
+  }
+
+  void _EncodeKey (std::string& o_bytes, const std::string& i_key)
+  {
+    static const std::map <std::string, uint32_t> s_keyNumbers = _CreateKeyNumbers ();
+
+    std::map <std::string, uint32_t>::const_iterator itKeyNumber = s_keyNumbers.find (i_key);
+    if (s_keyNumbers.end () != itKeyNumber)
+    {
+      _EncodeHead (o_bytes, MT_UNSIGNED_INTEGER, itKeyNumber->second);
+    }
+    else
+    {
+      _EncodeText (o_bytes, i_key);
+    }
+  }
+
+  bool _DecodeHead (uint8_t& o_majorType, uint64_t& o_argument, uint8_t& o_additionalInformation, char const*& io_pBegin, char const* i_pEnd)
+  {
+    if (i_pEnd == io_pBegin)
+    {
+      return false;
+    }
+
+    const uint8_t initialByte = static_cast <uint8_t> (*io_pBegin);
+    ++io_pBegin;
+    o_majorType = initialByte >> 5;
+    o_additionalInformation = initialByte & 0x1f;
+    if (24 > o_additionalInformation)
+    {
+      o_argument = o_additionalInformation;
+      return true;
+    }
+    if (27 < o_additionalInformation)
+    {
+      // note: indefinite lengths and reserved values are not supported
+      return false;
+    }
+
+    const size_t nrBytes = static_cast <size_t> (1) << (o_additionalInformation - 24);
+    if (static_cast <size_t> (i_pEnd - io_pBegin) < nrBytes)
+    {
+      return false;
+    }
+    o_argument = 0;
+    for (size_t i=0; i<nrBytes; ++i, ++io_pBegin)
+    {
+      o_argument = (o_argument << 8) | static_cast <uint8_t> (*io_pBegin);
+    }
+    return true;
+  }
+
+  bool _DecodeValue (cppcms::json::value& o_value, char const*& io_pBegin, char const* i_pEnd, const uint32_t& i_depth);
+
+  bool _DecodeText (std::string& o_text, char const*& io_pBegin, char const* i_pEnd, const uint64_t& i_length)
+  {
+    if (static_cast <uint64_t> (i_pEnd - io_pBegin) < i_length)
+    {
+      return false;
+    }
+    o_text.assign (io_pBegin, static_cast <size_t> (i_length));
+    io_pBegin += i_length;
+    return true;
+  }
+
+  bool _DecodeKey (std::string& o_key, char const*& io_pBegin, char const* i_pEnd)
+  {
+    uint8_t majorType, additionalInformation;
+    uint64_t argument;
+    if (!_DecodeHead (majorType, argument, additionalInformation, io_pBegin, i_pEnd))
+    {
+      return false;
+    }
+
+    if (MT_UNSIGNED_INTEGER == majorType)
+    {
+      if (g_keyDictionarySize <= argument)
+      {
+        return false;
+      }
+      o_key = g_keyDictionary [argument];
+      return true;
+    }
+
+    return (MT_TEXT_STRING == majorType) && _DecodeText (o_key, io_pBegin, i_pEnd, argument);
+  }
+
+  bool _DecodeValue (cppcms::json::value& o_value, char const*& io_pBegin, char const* i_pEnd, const uint32_t& i_depth)
+  {
+    if (HTTP_CBOR_MAX_NESTING < i_depth)
+    {
+      return false;
+    }
+
+    uint8_t majorType, additionalInformation;
+    uint64_t argument;
+    if (!_DecodeHead (majorType, argument, additionalInformation, io_pBegin, i_pEnd))
+    {
+      return false;
+    }
+
+    switch (majorType)
+    {
+      case MT_UNSIGNED_INTEGER:
+        o_value.number (static_cast <double> (argument));
+        return true;
+      case MT_NEGATIVE_INTEGER:
+        o_value.number (-1.0 - static_cast <double> (argument));
+        return true;
+      case MT_TEXT_STRING:
+      {
+        std::string text;
+        if (!_DecodeText (text, io_pBegin, i_pEnd, argument))
+        {
+          return false;
+        }
+        o_value.str (text);
+        return true;
+      }
+      case MT_ARRAY:
+      {
+        // note: every item takes at least one byte, this bounds the allocation
+        if (static_cast <uint64_t> (i_pEnd - io_pBegin) < argument)
+        {
+          return false;
+        }
+        o_value = cppcms::json::array ();
+        cppcms::json::array& items = o_value.array ();
+        items.resize (static_cast <size_t> (argument));
+        for (cppcms::json::array::iterator itItem = items.begin (); items.end () != itItem; ++itItem)
+        {
+          if (!_DecodeValue (*itItem, io_pBegin, i_pEnd, i_depth + 1))
+          {
+            return false;
+          }
+        }
+        return true;
+      }
+      case MT_MAP:
+      {
+        // note: every member takes at least two bytes, this bounds the loop
+        if (static_cast <uint64_t> (i_pEnd - io_pBegin) / 2 < argument)
+        {
+          return false;
+        }
+        o_value = cppcms::json::object ();
+        cppcms::json::object& members = o_value.object ();
+        for (uint64_t i=0; i<argument; ++i)
+        {
+          std::string key;
+          if (!_DecodeKey (key, io_pBegin, i_pEnd) || !_DecodeValue (members [key], io_pBegin, i_pEnd, i_depth + 1))
+          {
+            return false;
+          }
+        }
+        return true;
+      }
+      case MT_SIMPLE:
+      {
+        const uint8_t initialByte = static_cast <uint8_t> ((MT_SIMPLE << 5) | additionalInformation);
+        if (SV_FALSE == initialByte)
+        {
+          o_value.boolean (false);
+        }
+        else if (SV_TRUE == initialByte)
+        {
+          o_value.boolean (true);
+        }
+        else if (SV_NULL == initialByte)
+        {
+          o_value.null ();
+        }
+        else if (SV_UNDEFINED == initialByte)
+        {
+          o_value = cppcms::json::value ();
+        }
+        else if (SV_HALF == initialByte)
+        {
+          const int32_t exponent = (argument >> 10) & 0x1f;
+          const double  mantissa = static_cast <double> (argument & 0x3ff);
+          double number = (0 == exponent) ? std::ldexp (mantissa, -24) :
+                          (31 == exponent) ? ((0.0 == mantissa) ? HUGE_VAL : NAN) :
+                          std::ldexp (mantissa + 1024.0, exponent - 25);
+          o_value.number ((argument & 0x8000) ? -number : number);
+        }
+        else if (SV_SINGLE == initialByte)
+        {
+          const uint32_t bits = static_cast <uint32_t> (argument);
+          float single;
+          std::memcpy (&single, &bits, sizeof (single));
+          o_value.number (single);
+        }
+        else if (SV_DOUBLE == initialByte)
+        {
+          double number;
+          std::memcpy (&number, &argument, sizeof (number));
+          o_value.number (number);
+        }
+        else
+        {
+          return false;
+        }
+        return true;
+      }
+      case MT_BYTE_STRING:
+      case MT_TAG:
+      default:
+        // note: json has no byte strings, tags are not used by the interface
+        return false;
+    }
+  }
+}
+
+void Switch::Cbor::Encode (std::string& o_bytes, const cppcms::json::value& i_value)
+{
+  switch (i_value.type ())
+  {
+    case cppcms::json::is_undefined:
+      o_bytes.push_back (static_cast <char> (SV_UNDEFINED));
+      break;
+    case cppcms::json::is_null:
+      o_bytes.push_back (static_cast <char> (SV_NULL));
+      break;
+    case cppcms::json::is_boolean:
+      o_bytes.push_back (static_cast <char> (i_value.boolean () ? SV_TRUE : SV_FALSE));
+      break;
+    case cppcms::json::is_number:
+      _EncodeNumber (o_bytes, i_value.number ());
+      break;
+    case cppcms::json::is_string:
+      _EncodeText (o_bytes, i_value.str ());
+      break;
+    case cppcms::json::is_array:
+    {
+      const cppcms::json::array& items = i_value.array ();
+      _EncodeHead (o_bytes, MT_ARRAY, items.size ());
+      for (cppcms::json::array::const_iterator itItem = items.begin (); items.end () != itItem; ++itItem)
+      {
+        Encode (o_bytes, *itItem);
+      }
+      break;
+    }
+    case cppcms::json::is_object:
+    {
+      const cppcms::json::object& members = i_value.object ();
+      _EncodeHead (o_bytes, MT_MAP, members.size ());
+      for (cppcms::json::object::const_iterator itMember = members.begin (); members.end () != itMember; ++itMember)
+      {
+        _EncodeKey (o_bytes, std::string (itMember->first.begin (), itMember->first.end ()));
+        Encode (o_bytes, itMember->second);
+      }
+      break;
+    }
+  }
+}
+
+bool Switch::Cbor::Decode (cppcms::json::value& o_value, char const*& io_pBegin, char const* i_pEnd)
+{
+  return _DecodeValue (o_value, io_pBegin, i_pEnd, 0);
+}
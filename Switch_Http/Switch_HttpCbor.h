@@ -0,0 +1,55 @@
+/*?*************************************************************************
+*                           Switch_HttpCbor.h
+*                           -----------------------
+*    copyright            : (C) 2013 by Wouter Charle
+*    email                : wouter.charle@gmail.com
+*
+***************************************************************************/
+
+#ifndef _SWITCH_HTTPCBOR
+#define _SWITCH_HTTPCBOR
+
+// Switch includes
+#include <Switch_Base/Switch_CompilerConfiguration.h>
+
+// third-party includes
+#include <cppcms/json.h>
+#include <string>
+
+
+namespace Switch
+{
+  /*!
+    \brief Binary encoding of the json values exchanged by the http interface (RFC 7049, CBOR).
+
+    The encoding carries the same values as the json text:
+    - numbers without fraction are encoded as integers, other numbers as floats,
+    - object members named after a field of the interface are keyed by the field's
+      number in a fixed dictionary, other members by their name.
+   */
+  namespace Cbor
+  {
+    /*!
+      \brief Encodes a json value.
+
+      \param [out] o_bytes The encoded value, appended to the string.
+      \param [in]  i_value The value to encode.
+     */
+    void Encode (std::string& o_bytes, const cppcms::json::value& i_value);
+    /*!
+      \brief Decodes one value.
+
+      Only definite length items, text strings and the simple values false, true,
+      null and undefined are accepted.
+
+      \param [out]    o_value  The decoded value.
+      \param [in,out] io_pBegin Start of the encoded data, moved past the decoded value.
+      \param [in]     i_pEnd   End of the encoded data.
+
+      \return True if a valid value was decoded, false otherwise.
+     */
+    bool Decode (cppcms::json::value& o_value, char const*& io_pBegin, char const* i_pEnd);
+  }
+}
+
+#endif // _SWITCH_HTTPCBOR
@@ -0,0 +1,180 @@
+/*?*************************************************************************
+*                           Switch_HttpClientRegistry.cpp
+*                           -----------------------
+*    copyright            : (C) 2013 by Wouter Charle
+*    email                : wouter.charle@gmail.com
+*
+***************************************************************************/
+
+#include "Switch_HttpClientRegistry.h"
+
+// third-party includes
+#include <random>
+
+
+namespace
+{
+  const char g_hexDigits [] = "0123456789abcdef";
+
+  uint64_t RotateLeft (const uint64_t& i_value, const int& i_nrBits)
+  {
+    return (i_value << i_nrBits) | (i_value >> (64 - i_nrBits));
+  }
+
+  void SipRound (uint64_t& io_v0, uint64_t& io_v1, uint64_t& io_v2, uint64_t& io_v3)
+  {
+    io_v0 += io_v1; io_v1 = RotateLeft (io_v1, 13); io_v1 ^= io_v0; io_v0 = RotateLeft (io_v0, 32);
+    io_v2 += io_v3; io_v3 = RotateLeft (io_v3, 16); io_v3 ^= io_v2;
+    io_v0 += io_v3; io_v3 = RotateLeft (io_v3, 21); io_v3 ^= io_v0;
+    io_v2 += io_v1; io_v1 = RotateLeft (io_v1, 17); io_v1 ^= io_v2; io_v2 = RotateLeft (io_v2, 32);
+  }
+
+  /*!
+    \brief Hashes a single 64 bit word with SipHash-2-4.
+   */
+  uint64_t SipHash (const uint64_t i_key [2], const uint64_t& i_word)
+  {
+    uint64_t v0 = i_key [0] ^ 0x736f6d6570736575ULL;
+    uint64_t v1 = i_key [1] ^ 0x646f72616e646f6dULL;
+    uint64_t v2 = i_key [0] ^ 0x6c7967656e657261ULL;
+    uint64_t v3 = i_key [1] ^ 0x7465646279746573ULL;
+
+    // the word, then the final block holding the message length of 8 bytes
+    const uint64_t blocks [2] = {i_word, uint64_t (8) << 56};
+    for (int block=0; block<2; ++block)
+    {
+      v3 ^= blocks [block];
+      SipRound (v0, v1, v2, v3);
+      SipRound (v0, v1, v2, v3);
+      v0 ^= blocks [block];
+    }
+
+    v2 ^= 0xff;
+    for (int round=0; round<4; ++round)
+    {
+      SipRound (v0, v1, v2, v3);
+    }
+    return v0 ^ v1 ^ v2 ^ v3;
+  }
+
+  void AppendHex (std::string& io_text, const uint64_t& i_value)
+  {
+    for (int shift=60; shift>=0; shift-=4)
+    {
+      io_text += g_hexDigits [(i_value >> shift) & 0xf];
+    }
+  }
+}
+
+Switch::HttpClientRegistry::HttpClientRegistry ()
+: m_nextClientId (0)
+{
+  std::random_device randomDevice;
+  for (int word=0; word<2; ++word)
+  {
+    m_key [word] = (uint64_t (randomDevice ()) << 32) | randomDevice ();
+  }
+}
+
+Switch::HttpClientRegistry::client_id_type Switch::HttpClientRegistry::Register (std::string& o_token, const clock_type::time_point& i_now)
+{
+  const client_id_type clientId = m_nextClientId;
+  ++m_nextClientId;
+
+  m_lastActiveTimes [clientId] = i_now;
+  _Sign (o_token, clientId);
+
+  return clientId;
+}
+
+bool Switch::HttpClientRegistry::Validate (client_id_type& o_clientId, const std::string& i_token, const clock_type::time_point& i_now)
+{
+  if (s_tokenSize != i_token.size ())
+  {
+    return false;
+  }
+
+  // read the client id
+  uint64_t clientId = 0;
+  for (size_t index=0; index<s_tokenSize/2; ++index)
+  {
+    const char digit = i_token [index];
+    uint64_t value;
+    if (('0' <= digit) && ('9' >= digit))
+    {
+      value = static_cast <uint64_t> (digit - '0');
+    }
+    else if (('a' <= digit) && ('f' >= digit))
+    {
+      value = static_cast <uint64_t> (digit - 'a' + 10);
+    }
+    else
+    {
+      return false;
+    }
+    clientId = (clientId << 4) | value;
+  }
+
+  // check the hash, comparing every character to not reveal where a forged hash differs
+  const uint64_t hash = SipHash (m_key, clientId);
+  char difference = 0;
+  for (size_t index=s_tokenSize/2; index<s_tokenSize; ++index)
+  {
+    difference |= g_hexDigits [(hash >> (4 * (s_tokenSize - 1 - index))) & 0xf] ^ i_token [index];
+  }
+  if (0 != difference)
+  {
+    return false;
+  }
+
+  // check if the client is still registered
+  std::unordered_map <client_id_type, clock_type::time_point>::iterator itClient = m_lastActiveTimes.find (static_cast <client_id_type> (clientId));
+  if (m_lastActiveTimes.end () == itClient)
+  {
+    return false;
+  }
+  itClient->second = i_now;
+  o_clientId = itClient->first;
+
+  return true;
+}
+
+void Switch::HttpClientRegistry::Touch (const client_id_type& i_clientId, const clock_type::time_point& i_now)
+{
+  std::unordered_map <client_id_type, clock_type::time_point>::iterator itClient = m_lastActiveTimes.find (i_clientId);
+  if (m_lastActiveTimes.end () != itClient)
+  {
+    itClient->second = i_now;
+  }
+}
+
+void Switch::HttpClientRegistry::RemoveIdleClients (std::vector <client_id_type>& o_clientIds, const clock_type::time_point& i_idleSince)
+{
+  o_clientIds.clear ();
+  std::unordered_map <client_id_type, clock_type::time_point>::iterator itClient = m_lastActiveTimes.begin ();
+  while (m_lastActiveTimes.end () != itClient)
+  {
+    if (i_idleSince > itClient->second)
+    {
+      o_clientIds.push_back (itClient->first);
+      itClient = m_lastActiveTimes.erase (itClient);
+    }
+    else
+    {
+      ++itClient;
+    }
+  }
+}
+
+size_t Switch::HttpClientRegistry::GetNrClients () const
+{
+  return m_lastActiveTimes.size ();
+}
+
+void Switch::HttpClientRegistry::_Sign (std::string& o_token, const client_id_type& i_clientId) const
+{
+  o_token.clear ();
+  o_token.reserve (s_tokenSize);
+  AppendHex (o_token, static_cast <uint64_t> (i_clientId));
+  AppendHex (o_token, SipHash (m_key, static_cast <uint64_t> (i_clientId)));
+}
@@ -0,0 +1,87 @@
+/*?*************************************************************************
+*                           Switch_HttpClientRegistry.h
+*                           -----------------------
+*    copyright            : (C) 2013 by Wouter Charle
+*    email                : wouter.charle@gmail.com
+*
+***************************************************************************/
+
+#ifndef _SWITCH_HTTPCLIENTREGISTRY
+#define _SWITCH_HTTPCLIENTREGISTRY
+
+// Switch includes
+#include <Switch_Base/Switch_CompilerConfiguration.h>
+
+// third-party includes
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+
+namespace Switch
+{
+  /*!
+    \brief The registered clients of the http interface and their bearer tokens.
+
+    A token carries the id of its client and a keyed hash of it, signed with a key
+    drawn when the registry is made. Validating a token checks the hash and looks up
+    the client, without the session store. Clients idle for too long are dropped,
+    their tokens are refused from then on.
+
+    \note Not thread-safe, the interface guards the registry with its client registry mutex.
+   */
+  class HttpClientRegistry
+  {
+  public:
+
+    typedef size_t client_id_type;                ///< Type of client identifiers, as in the http interface.
+    typedef std::chrono::steady_clock clock_type;
+
+    static const size_t s_tokenSize = 32;         ///< The number of characters of a token, the hexadecimal client id and hash.
+
+    HttpClientRegistry ();
+
+    /*!
+      \brief Registers a new client.
+
+      \param [out] o_token The token of the client.
+      \param [in]  i_now   The current time, the client is idle from then on.
+
+      \return The id of the client.
+     */
+    client_id_type Register (std::string& o_token, const clock_type::time_point& i_now);
+    /*!
+      \brief Validates a token and marks its client as active.
+
+      \param [out] o_clientId The id of the client, if the token is valid.
+      \param [in]  i_token    The token.
+      \param [in]  i_now      The current time.
+
+      \return True if the token is signed by the registry and its client is registered.
+     */
+    bool Validate (client_id_type& o_clientId, const std::string& i_token, const clock_type::time_point& i_now);
+    /*!
+      \brief Marks a client as active, e.g. while it holds a connection open.
+     */
+    void Touch (const client_id_type& i_clientId, const clock_type::time_point& i_now);
+    /*!
+      \brief Removes the clients which were not active since a time.
+
+      \param [out] o_clientIds The ids of the removed clients.
+      \param [in]  i_idleSince The time from which inactive clients are removed.
+     */
+    void RemoveIdleClients (std::vector <client_id_type>& o_clientIds, const clock_type::time_point& i_idleSince);
+    size_t GetNrClients () const;
+
+  private:
+
+    void _Sign (std::string& o_token, const client_id_type& i_clientId) const;
+
+    uint64_t        m_key [2];      ///< The key of the token hashes.
+    client_id_type  m_nextClientId;
+    std::unordered_map <client_id_type, clock_type::time_point> m_lastActiveTimes;  ///< The time each client was last active, mapped to from the client ids.
+  };
+}
+
+#endif // _SWITCH_HTTPCLIENTREGISTRY
@@ -0,0 +1,756 @@
+/*?*************************************************************************
+*                           Switch_HttpCodec.cpp
+*                           -----------------------
+*    copyright            : (C) 2013 by Wouter Charle
+*    email                : wouter.charle@gmail.com
+*
+***************************************************************************/
+
+#include "Switch_HttpCodec.h"
+
+// third-party includes
+#include <cmath>
+#include <cstdlib>
+
+namespace
+{
+  bool _IsWhiteSpace (const char& i_character)
+  {
+    return (' ' == i_character) || ('\t' == i_character) || ('\n' == i_character) || ('\r' == i_character);
+  }
+
+  bool _IsDigit (const char& i_character)
+  {
+    return ('0' <= i_character) && ('9' >= i_character);
+  }
+
+  /*!
+    \brief Reads the four hexadecimal digits of a \\u escape.
+   */
+  bool _ReadHex4 (uint32_t& o_code, const char* i_pDigits)
+  {
+    o_code = 0;
+    for (uint32_t i=0; i<4; ++i)
+    {
+      const char digit = i_pDigits [i];
+      o_code <<= 4;
+      if (_IsDigit (digit))
+      {
+        o_code |= static_cast <uint32_t> (digit - '0');
+      }
+      else if (('a' <= digit) && ('f' >= digit))
+      {
+        o_code |= static_cast <uint32_t> (digit - 'a' + 10);
+      }
+      else if (('A' <= digit) && ('F' >= digit))
+      {
+        o_code |= static_cast <uint32_t> (digit - 'A' + 10);
+      }
+      else
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  char* _EncodeUtf8 (char* o_pOut, const uint32_t& i_code)
+  {
+    if (0x80 > i_code)
+    {
+      *o_pOut++ = static_cast <char> (i_code);
+    }
+    else if (0x800 > i_code)
+    {
+      *o_pOut++ = static_cast <char> (0xc0 | (i_code >> 6));
+      *o_pOut++ = static_cast <char> (0x80 | (i_code & 0x3f));
+    }
+    else if (0x10000 > i_code)
+    {
+      *o_pOut++ = static_cast <char> (0xe0 | (i_code >> 12));
+      *o_pOut++ = static_cast <char> (0x80 | ((i_code >> 6) & 0x3f));
+      *o_pOut++ = static_cast <char> (0x80 | (i_code & 0x3f));
+    }
+    else
+    {
+      *o_pOut++ = static_cast <char> (0xf0 | (i_code >> 18));
+      *o_pOut++ = static_cast <char> (0x80 | ((i_code >> 12) & 0x3f));
+      *o_pOut++ = static_cast <char> (0x80 | ((i_code >> 6) & 0x3f));
+      *o_pOut++ = static_cast <char> (0x80 | (i_code & 0x3f));
+    }
+    return o_pOut;
+  }
+}
+
+Switch::Codec::Arena::Arena ()
+: m_blockIndex (0),
+  m_blockUsed (0)
+{
+}
+
+Switch::Codec::Arena::~Arena ()
+{
+  Reset ();
+  for (std::vector <char*>::iterator itBlock = m_blocks.begin (); m_blocks.end () != itBlock; ++itBlock)
+  {
+    delete [] *itBlock;
+  }
+}
+
+/*!
+  \brief Allocates memory, valid until the arena is reset.
+
+  \param [in] i_size      The size in bytes.
+  \param [in] i_alignment The alignment, a power of two.
+
+  \return The memory.
+ */
+void* Switch::Codec::Arena::Allocate (const size_t& i_size, const size_t& i_alignment)
+{
+  // note: blocks are aligned for any type
+  if (HTTP_CODEC_ARENA_BLOCK_SIZE < i_size)
+  {
+    m_largeBlocks.push_back (new char [i_size]);
+    return m_largeBlocks.back ();
+  }
+
+  size_t offset = (m_blockUsed + i_alignment - 1) & ~(i_alignment - 1);
+  if (m_blocks.empty () || (HTTP_CODEC_ARENA_BLOCK_SIZE < offset + i_size))
+  {
+    if (!m_blocks.empty ())
+    {
+      ++m_blockIndex;
+    }
+    if (m_blocks.size () == m_blockIndex)
+    {
+      m_blocks.push_back (new char [HTTP_CODEC_ARENA_BLOCK_SIZE]);
+    }
+    offset = 0;
+  }
+  m_blockUsed = offset + i_size;
+
+  return m_blocks [m_blockIndex] + offset;
+}
+
+void Switch::Codec::Arena::Reset ()
+{
+  for (std::vector <char*>::iterator itBlock = m_largeBlocks.begin (); m_largeBlocks.end () != itBlock; ++itBlock)
+  {
+    delete [] *itBlock;
+  }
+  m_largeBlocks.clear ();
+  m_blockIndex = 0;
+  m_blockUsed  = 0;
+}
+
+Switch::Codec::DeviceValues::DeviceValues ()
+: m_deviceId (0)
+{
+}
+
+Switch::Codec::Reader::Reader (const char* i_pBegin, const char* i_pEnd, Arena& io_arena)
+: m_pPosition (i_pBegin),
+  m_pEnd (i_pEnd),
+  mr_arena (io_arena),
+  m_depth (0),
+  m_first (false),
+  m_failed (false)
+{
+}
+
+Switch::Codec::Arena& Switch::Codec::Reader::GetArena () const
+{
+  return mr_arena;
+}
+
+bool Switch::Codec::Reader::HasFailed () const
+{
+  return m_failed;
+}
+
+bool Switch::Codec::Reader::IsAtEnd ()
+{
+  _SkipWhiteSpace ();
+  return !m_failed && (m_pEnd == m_pPosition);
+}
+
+bool Switch::Codec::Reader::BeginObject ()
+{
+  _SkipWhiteSpace ();
+  if (m_failed || (m_pEnd == m_pPosition) || ('{' != *m_pPosition) || (HTTP_CODEC_MAX_NESTING <= m_depth))
+  {
+    return _Fail ();
+  }
+  ++m_pPosition;
+  ++m_depth;
+  m_first = true;
+  return true;
+}
+
+bool Switch::Codec::Reader::NextMember (const char*& o_pName, size_t& o_nameSize)
+{
+  _SkipWhiteSpace ();
+  if (m_failed || (m_pEnd == m_pPosition))
+  {
+    return _Fail ();
+  }
+
+  // note: the object of a member that was read has had a member, no flag per level is needed
+  if ('}' == *m_pPosition)
+  {
+    ++m_pPosition;
+    --m_depth;
+    m_first = false;
+    return false;
+  }
+  if (!m_first)
+  {
+    if (',' != *m_pPosition)
+    {
+      return _Fail ();
+    }
+    ++m_pPosition;
+  }
+  m_first = false;
+
+  if (!ReadString (o_pName, o_nameSize))
+  {
+    return false;
+  }
+  _SkipWhiteSpace ();
+  if ((m_pEnd == m_pPosition) || (':' != *m_pPosition))
+  {
+    return _Fail ();
+  }
+  ++m_pPosition;
+  return true;
+}
+
+bool Switch::Codec::Reader::BeginArray ()
+{
+  _SkipWhiteSpace ();
+  if (m_failed || (m_pEnd == m_pPosition) || ('[' != *m_pPosition) || (HTTP_CODEC_MAX_NESTING <= m_depth))
+  {
+    return _Fail ();
+  }
+  ++m_pPosition;
+  ++m_depth;
+  m_first = true;
+  return true;
+}
+
+bool Switch::Codec::Reader::NextElement ()
+{
+  _SkipWhiteSpace ();
+  if (m_failed || (m_pEnd == m_pPosition))
+  {
+    return _Fail ();
+  }
+
+  if (']' == *m_pPosition)
+  {
+    ++m_pPosition;
+    --m_depth;
+    m_first = false;
+    return false;
+  }
+  if (!m_first)
+  {
+    if (',' != *m_pPosition)
+    {
+      return _Fail ();
+    }
+    ++m_pPosition;
+  }
+  m_first = false;
+  return true;
+}
+
+/*!
+  \brief Reads a number without fraction, numbers with an integral fraction or exponent included.
+ */
+bool Switch::Codec::Reader::ReadInteger (int64_t& o_value)
+{
+  _SkipWhiteSpace ();
+  const char* pBegin = m_pPosition;
+  if (!_SkipNumber ())
+  {
+    return false;
+  }
+
+  // the common case: digits only
+  const char* pDigit = pBegin;
+  bool negative = ('-' == *pDigit);
+  if (negative)
+  {
+    ++pDigit;
+  }
+  if ((m_pPosition - pDigit) <= 18)
+  {
+    uint64_t value = 0;
+    for (; (m_pPosition != pDigit) && _IsDigit (*pDigit); ++pDigit)
+    {
+      value = 10 * value + static_cast <uint64_t> (*pDigit - '0');
+    }
+    if (m_pPosition == pDigit)
+    {
+      o_value = negative ? -static_cast <int64_t> (value) : static_cast <int64_t> (value);
+      return true;
+    }
+  }
+
+  // note: numbers are short, a longer one is no integer in range anyway
+  char number [32];
+  const size_t size = static_cast <size_t> (m_pPosition - pBegin);
+  if (sizeof (number) <= size)
+  {
+    return _Fail ();
+  }
+  memcpy (number, pBegin, size);
+  number [size] = '\0';
+  double value = strtod (number, 0x0);
+  if ((std::floor (value) != value) || (-9.2e18 > value) || (9.2e18 < value))
+  {
+    return _Fail ();
+  }
+  o_value = static_cast <int64_t> (value);
+  return true;
+}
+
+bool Switch::Codec::Reader::ReadBool (bool& o_value)
+{
+  _SkipWhiteSpace ();
+  if (!m_failed && (m_pEnd != m_pPosition) && ('t' == *m_pPosition))
+  {
+    o_value = true;
+    return _SkipLiteral ("true");
+  }
+  o_value = false;
+  return _SkipLiteral ("false");
+}
+
+bool Switch::Codec::Reader::ReadString (const char*& o_pString, size_t& o_size)
+{
+  _SkipWhiteSpace ();
+  if (m_failed || (m_pEnd == m_pPosition) || ('"' != *m_pPosition))
+  {
+    return _Fail ();
+  }
+  const char* pBegin = ++m_pPosition;
+
+  // find the end of the string
+  bool escaped = false;
+  for (; (m_pEnd != m_pPosition) && ('"' != *m_pPosition); ++m_pPosition)
+  {
+    if (0x20 > static_cast <unsigned char> (*m_pPosition))
+    {
+      return _Fail ();
+    }
+    if ('\\' == *m_pPosition)
+    {
+      escaped = true;
+      if (m_pEnd == ++m_pPosition)
+      {
+        break;
+      }
+    }
+  }
+  if (m_pEnd == m_pPosition)
+  {
+    return _Fail ();
+  }
+  const char* pEnd = m_pPosition++;
+
+  if (!escaped)
+  {
+    o_pString = pBegin;
+    o_size    = static_cast <size_t> (pEnd - pBegin);
+    return true;
+  }
+
+  // unescape into the arena, the text never grows
+  char* pString = static_cast <char*> (mr_arena.Allocate (static_cast <size_t> (pEnd - pBegin), 1));
+  char* pOut = pString;
+  for (const char* pIn = pBegin; pEnd != pIn; ++pIn)
+  {
+    if ('\\' != *pIn)
+    {
+      *pOut++ = *pIn;
+      continue;
+    }
+
+    switch (*++pIn)
+    {
+      case '"':  *pOut++ = '"';  break;
+      case '\\': *pOut++ = '\\'; break;
+      case '/':  *pOut++ = '/';  break;
+      case 'b':  *pOut++ = '\b'; break;
+      case 'f':  *pOut++ = '\f'; break;
+      case 'n':  *pOut++ = '\n'; break;
+      case 'r':  *pOut++ = '\r'; break;
+      case 't':  *pOut++ = '\t'; break;
+      case 'u':
+      {
+        uint32_t code;
+        if ((4 > pEnd - pIn - 1) || !_ReadHex4 (code, pIn + 1))
+        {
+          return _Fail ();
+        }
+        pIn += 4;
+
+        // note: characters outside the basic plane are escaped as surrogate pairs
+        uint32_t lowSurrogate;
+        if ((0xd800 <= code) && (0xdbff >= code) && (6 <= pEnd - pIn - 1) && ('\\' == pIn [1]) && ('u' == pIn [2]) &&
+            _ReadHex4 (lowSurrogate, pIn + 3) && (0xdc00 <= lowSurrogate) && (0xdfff >= lowSurrogate))
+        {
+          code = 0x10000 + ((code - 0xd800) << 10) + (lowSurrogate - 0xdc00);
+          pIn += 6;
+        }
+        pOut = _EncodeUtf8 (pOut, code);
+        break;
+      }
+      default:
+        return _Fail ();
+    }
+  }
+
+  o_pString = pString;
+  o_size    = static_cast <size_t> (pOut - pString);
+  return true;
+}
+
+bool Switch::Codec::Reader::ReadNull ()
+{
+  _SkipWhiteSpace ();
+  return _SkipLiteral ("null");
+}
+
+bool Switch::Codec::Reader::Skip ()
+{
+  _SkipWhiteSpace ();
+  if (m_failed || (m_pEnd == m_pPosition))
+  {
+    return _Fail ();
+  }
+
+  switch (*m_pPosition)
+  {
+    case '{':
+    {
+      const char* pName;
+      size_t nameSize;
+      if (!BeginObject ())
+      {
+        return false;
+      }
+      while (NextMember (pName, nameSize))
+      {
+        if (!Skip ())
+        {
+          return false;
+        }
+      }
+      return !m_failed;
+    }
+    case '[':
+    {
+      if (!BeginArray ())
+      {
+        return false;
+      }
+      while (NextElement ())
+      {
+        if (!Skip ())
+        {
+          return false;
+        }
+      }
+      return !m_failed;
+    }
+    case '"':
+    {
+      const char* pString;
+      size_t size;
+      return ReadString (pString, size);
+    }
+    case 't':
+      return _SkipLiteral ("true");
+    case 'f':
+      return _SkipLiteral ("false");
+    case 'n':
+      return _SkipLiteral ("null");
+    default:
+      return _SkipNumber ();
+  }
+}
+
+bool Switch::Codec::Reader::Skip (const char*& o_pBegin, const char*& o_pEnd)
+{
+  _SkipWhiteSpace ();
+  o_pBegin = m_pPosition;
+  if (!Skip ())
+  {
+    return false;
+  }
+  o_pEnd = m_pPosition;
+  return true;
+}
+
+bool Switch::Codec::Reader::_Fail ()
+{
+  m_failed = true;
+  return false;
+}
+
+void Switch::Codec::Reader::_SkipWhiteSpace ()
+{
+  while ((m_pEnd != m_pPosition) && _IsWhiteSpace (*m_pPosition))
+  {
+    ++m_pPosition;
+  }
+}
+
+bool Switch::Codec::Reader::_SkipNumber ()
+{
+  if (m_failed)
+  {
+    return false;
+  }
+
+  // -?digits(.digits)?([eE][+-]?digits)?
+  const char* pPosition = m_pPosition;
+  if ((m_pEnd != pPosition) && ('-' == *pPosition))
+  {
+    ++pPosition;
+  }
+  const char* pDigits = pPosition;
+  while ((m_pEnd != pPosition) && _IsDigit (*pPosition))
+  {
+    ++pPosition;
+  }
+  if (pDigits == pPosition)
+  {
+    return _Fail ();
+  }
+  if ((m_pEnd != pPosition) && ('.' == *pPosition))
+  {
+    pDigits = ++pPosition;
+    while ((m_pEnd != pPosition) && _IsDigit (*pPosition))
+    {
+      ++pPosition;
+    }
+    if (pDigits == pPosition)
+    {
+      return _Fail ();
+    }
+  }
+  if ((m_pEnd != pPosition) && (('e' == *pPosition) || ('E' == *pPosition)))
+  {
+    ++pPosition;
+    if ((m_pEnd != pPosition) && (('+' == *pPosition) || ('-' == *pPosition)))
+    {
+      ++pPosition;
+    }
+    pDigits = pPosition;
+    while ((m_pEnd != pPosition) && _IsDigit (*pPosition))
+    {
+      ++pPosition;
+    }
+    if (pDigits == pPosition)
+    {
+      return _Fail ();
+    }
+  }
+
+  m_pPosition = pPosition;
+  return true;
+}
+
+bool Switch::Codec::Reader::_SkipLiteral (const char* i_pLiteral)
+{
+  const size_t size = strlen (i_pLiteral);
+  if (m_failed || (static_cast <size_t> (m_pEnd - m_pPosition) < size) || (0 != memcmp (m_pPosition, i_pLiteral, size)))
+  {
+    return _Fail ();
+  }
+  m_pPosition += size;
+  return true;
+}
+
+Switch::Codec::Writer::Writer (std::ostream& io_stream)
+: mr_stream (io_stream),
+  m_bufferUsed (0),
+  m_first (false)
+{
+}
+
+Switch::Codec::Writer::~Writer ()
+{
+  Flush ();
+}
+
+void Switch::Codec::Writer::BeginObject ()
+{
+  _Put ('{');
+  m_first = true;
+}
+
+void Switch::Codec::Writer::EndObject ()
+{
+  _Put ('}');
+  m_first = false;
+}
+
+void Switch::Codec::Writer::Name (const char* i_pName)
+{
+  if (!m_first)
+  {
+    _Put (',');
+  }
+  m_first = false;
+  WriteString (i_pName, strlen (i_pName));
+  _Put (':');
+}
+
+void Switch::Codec::Writer::BeginArray ()
+{
+  _Put ('[');
+  m_first = true;
+}
+
+void Switch::Codec::Writer::EndArray ()
+{
+  _Put (']');
+  m_first = false;
+}
+
+void Switch::Codec::Writer::NextElement ()
+{
+  if (!m_first)
+  {
+    _Put (',');
+  }
+  m_first = false;
+}
+
+void Switch::Codec::Writer::WriteUnsigned (const uint64_t& i_value)
+{
+  char digits [20];
+  char* pDigit = digits + sizeof (digits);
+  uint64_t value = i_value;
+  do
+  {
+    *--pDigit = static_cast <char> ('0' + (value % 10));
+    value /= 10;
+  }
+  while (0 != value);
+  WriteRaw (pDigit, static_cast <size_t> (digits + sizeof (digits) - pDigit));
+}
+
+void Switch::Codec::Writer::WriteSigned (const int64_t& i_value)
+{
+  if (0 > i_value)
+  {
+    _Put ('-');
+    WriteUnsigned (0 - static_cast <uint64_t> (i_value));
+  }
+  else
+  {
+    WriteUnsigned (static_cast <uint64_t> (i_value));
+  }
+}
+
+void Switch::Codec::Writer::WriteBool (const bool& i_value)
+{
+  if (i_value)
+  {
+    WriteRaw ("true", 4);
+  }
+  else
+  {
+    WriteRaw ("false", 5);
+  }
+}
+
+void Switch::Codec::Writer::WriteString (const char* i_pString, const size_t& i_size)
+{
+  static const char hexDigits [] = "0123456789abcdef";
+
+  _Put ('"');
+  const char* pEnd = i_pString + i_size;
+  const char* pRun = i_pString;
+  for (const char* pCharacter = i_pString; pEnd != pCharacter; ++pCharacter)
+  {
+    const unsigned char character = static_cast <unsigned char> (*pCharacter);
+    if (('"' != character) && ('\\' != character) && (0x20 <= character))
+    {
+      continue;
+    }
+
+    // write the characters that need no escape at once
+    WriteRaw (pRun, static_cast <size_t> (pCharacter - pRun));
+    pRun = pCharacter + 1;
+    _Put ('\\');
+    switch (character)
+    {
+      case '"':  _Put ('"');  break;
+      case '\\': _Put ('\\'); break;
+      case '\b': _Put ('b');  break;
+      case '\f': _Put ('f');  break;
+      case '\n': _Put ('n');  break;
+      case '\r': _Put ('r');  break;
+      case '\t': _Put ('t');  break;
+      default:
+        WriteRaw ("u00", 3);
+        _Put (hexDigits [character >> 4]);
+        _Put (hexDigits [character & 0xf]);
+        break;
+    }
+  }
+  WriteRaw (pRun, static_cast <size_t> (pEnd - pRun));
+  _Put ('"');
+}
+
+void Switch::Codec::Writer::WriteNull ()
+{
+  WriteRaw ("null", 4);
+}
+
+void Switch::Codec::Writer::WriteRaw (const char* i_pText, const size_t& i_size)
+{
+  if (sizeof (m_buffer) - m_bufferUsed < i_size)
+  {
+    Flush ();
+    if (sizeof (m_buffer) < i_size)
+    {
+      mr_stream.write (i_pText, static_cast <std::streamsize> (i_size));
+      return;
+    }
+  }
+  memcpy (m_buffer + m_bufferUsed, i_pText, i_size);
+  m_bufferUsed += i_size;
+}
+
+void Switch::Codec::Writer::WriteJson (const cppcms::json::value& i_value)
+{
+  Flush ();
+  i_value.save (mr_stream, cppcms::json::compact);
+}
+
+void Switch::Codec::Writer::Flush ()
+{
+  if (0 != m_bufferUsed)
+  {
+    mr_stream.write (m_buffer, static_cast <std::streamsize> (m_bufferUsed));
+    m_bufferUsed = 0;
+  }
+}
+
+void Switch::Codec::Writer::_Put (const char& i_character)
+{
+  if (sizeof (m_buffer) == m_bufferUsed)
+  {
+    Flush ();
+  }
+  m_buffer [m_bufferUsed++] = i_character;
+}
@@ -0,0 +1,813 @@
+/*?*************************************************************************
+*                           Switch_HttpCodec.h
+*                           -----------------------
+*    copyright            : (C) 2013 by Wouter Charle
+*    email                : wouter.charle@gmail.com
+*
+***************************************************************************/
+
+#ifndef _SWITCH_HTTPCODEC
+#define _SWITCH_HTTPCODEC
+
+// project includes
+#include "Switch_HttpConfiguration.h"
+#include "Switch_HttpInterfaceTraits.h"
+
+// Switch includes
+#include <Switch_Base/Switch_CompilerConfiguration.h>
+#include <Switch_API/Switch_InterfaceTypes.h>
+
+// third-party includes
+#include <cppcms/json.h>
+#include <map>
+#include <list>
+#include <string>
+#include <vector>
+#include <memory>
+#include <ostream>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+
+namespace Switch
+{
+  /*!
+    \brief Json codecs of the interface types, generated from the list of their fields.
+
+    The fields of a type are listed once, in a Fields specialization; reading and writing
+    the type are generated from that list. Requests are parsed from the raw body straight
+    into the values, without building a json::value, their arrays going to vectors allocated
+    from a per-request arena. Responses are written to the output stream as they are produced.
+   */
+  namespace Codec
+  {
+    /*!
+      \brief Monotonic memory of one request.
+
+      Allocations are released all at once by Reset. The blocks are kept for the next
+      request, which allocates nothing once the arena has grown to the size of the requests.
+     */
+    class Arena
+    {
+    public:
+
+      Arena ();
+      ~Arena ();
+
+      // copy constructor and assignment operator disabled, the allocations point into the blocks
+      Arena (const Arena& i_other) = delete;
+      Arena& operator= (const Arena& i_other) = delete;
+
+      void* Allocate (const size_t& i_size, const size_t& i_alignment);
+      /*!
+        \brief Releases all allocations.
+       */
+      void Reset ();
+
+    private:
+
+      std::vector <char*> m_blocks;       ///< The blocks of HTTP_CODEC_ARENA_BLOCK_SIZE bytes.
+      std::vector <char*> m_largeBlocks;  ///< The blocks of allocations larger than a block, freed on reset.
+      size_t              m_blockIndex;   ///< The block allocated from.
+      size_t              m_blockUsed;    ///< The number of bytes used of the block allocated from.
+    };
+
+    /*!
+      \brief Allocator of containers in an arena.
+
+      Default constructed allocators use the heap, so that members of the values read
+      can be default constructed. Readers move an arena allocator into them.
+     */
+    template <typename T>
+    class ArenaAllocator
+    {
+    public:
+
+      typedef T               value_type;
+      typedef std::true_type  propagate_on_container_copy_assignment;
+      typedef std::true_type  propagate_on_container_move_assignment;
+      typedef std::true_type  propagate_on_container_swap;
+
+      ArenaAllocator ()
+      : m_pArena (0x0)
+      {
+      }
+
+      explicit ArenaAllocator (Arena& io_arena)
+      : m_pArena (&io_arena)
+      {
+      }
+
+      template <typename U>
+      ArenaAllocator (const ArenaAllocator <U>& i_other)
+      : m_pArena (i_other.m_pArena)
+      {
+      }
+
+      T* allocate (size_t i_nrElements)
+      {
+        if (0x0 == m_pArena)
+        {
+          return static_cast <T*> (::operator new (i_nrElements * sizeof (T)));
+        }
+        return static_cast <T*> (m_pArena->Allocate (i_nrElements * sizeof (T), alignof (T)));
+      }
+
+      void deallocate (T* i_pElements, size_t i_nrElements)
+      {
+        // note: arena memory is released when the arena is reset
+        if (0x0 == m_pArena)
+        {
+          ::operator delete (i_pElements);
+        }
+      }
+
+      Arena* m_pArena;  ///< The arena allocated from, 0x0 for the heap.
+    };
+
+    template <typename T, typename U>
+    bool operator== (const ArenaAllocator <T>& i_first, const ArenaAllocator <U>& i_second)
+    {
+      return i_first.m_pArena == i_second.m_pArena;
+    }
+
+    template <typename T, typename U>
+    bool operator!= (const ArenaAllocator <T>& i_first, const ArenaAllocator <U>& i_second)
+    {
+      return i_first.m_pArena != i_second.m_pArena;
+    }
+
+    template <typename T>
+    using ArenaVector = std::vector <T, ArenaAllocator <T>>;
+
+    /*!
+      \brief Pull parser of json text.
+
+      Strings without escapes are returned in place, others are unescaped into the arena.
+      Any syntax error makes the reader fail, after which all reads return false.
+     */
+    class Reader
+    {
+    public:
+
+      Reader (const char* i_pBegin, const char* i_pEnd, Arena& io_arena);
+
+      Arena& GetArena () const;
+      bool HasFailed () const;
+      /*!
+        \return True if only white space is left.
+       */
+      bool IsAtEnd ();
+
+      bool BeginObject ();
+      /*!
+        \brief Reads the name of the next member of an object.
+
+        \return True if a member follows, false at the end of the object or on failure.
+       */
+      bool NextMember (const char*& o_pName, size_t& o_nameSize);
+      bool BeginArray ();
+      /*!
+        \return True if an element follows, false at the end of the array or on failure.
+       */
+      bool NextElement ();
+
+      bool ReadInteger (int64_t& o_value);
+      bool ReadBool    (bool& o_value);
+      bool ReadString  (const char*& o_pString, size_t& o_size);
+      bool ReadNull    ();
+      bool Skip        ();
+      /*!
+        \brief Skips a value, returning its text.
+       */
+      bool Skip        (const char*& o_pBegin, const char*& o_pEnd);
+
+    private:
+
+      bool _Fail ();
+      void _SkipWhiteSpace ();
+      bool _SkipNumber ();
+      bool _SkipLiteral (const char* i_pLiteral);
+
+      const char* m_pPosition;
+      const char* m_pEnd;
+      Arena&      mr_arena;
+      uint32_t    m_depth;    ///< The number of arrays and objects entered.
+      bool        m_first;    ///< Flags if the next member or element is the first of its object or array.
+      bool        m_failed;
+    };
+
+    /*!
+      \brief Writer of json text to a stream, through a buffer.
+     */
+    class Writer
+    {
+    public:
+
+      explicit Writer (std::ostream& io_stream);
+      ~Writer ();
+
+      void BeginObject ();
+      void EndObject ();
+      /*!
+        \brief Writes the name of the next member of an object.
+       */
+      void Name (const char* i_pName);
+      void BeginArray ();
+      void EndArray ();
+      /*!
+        \brief Separates the next element of an array from the previous one.
+       */
+      void NextElement ();
+
+      void WriteUnsigned (const uint64_t& i_value);
+      void WriteSigned   (const int64_t& i_value);
+      void WriteBool     (const bool& i_value);
+      void WriteString   (const char* i_pString, const size_t& i_size);
+      void WriteNull     ();
+      /*!
+        \brief Writes json text as it is.
+       */
+      void WriteRaw      (const char* i_pText, const size_t& i_size);
+      void WriteJson     (const cppcms::json::value& i_value);
+      void Flush ();
+
+    private:
+
+      void _Put (const char& i_character);
+
+      std::ostream& mr_stream;
+      char          m_buffer [HTTP_CODEC_WRITE_BUFFER_SIZE];
+      size_t        m_bufferUsed;
+      bool          m_first;    ///< Flags if the next member or element is the first of its object or array.
+    };
+
+    /*!
+      \brief The fields of a type, specialized for every type read or written as a json object.
+
+      Specializations define
+      \code
+      template <typename V, typename T> static void Visit (V& io_visitor, T& io_object);
+      \endcode
+      calling io_visitor (name, member) for every field, and io_visitor (name, member, false)
+      for fields that may be missing from the objects read.
+     */
+    template <typename T>
+    struct Fields;
+
+    /*!
+      \brief Reading and writing a type, through its fields for objects.
+     */
+    template <typename T>
+    struct Traits
+    {
+      static bool Read  (Reader& io_reader, T& o_value);
+      static void Write (Writer& io_writer, const T& i_value);
+    };
+
+    /*!
+      \brief The values of one device in a SetMultipleDeviceValues call.
+     */
+    class DeviceValues
+    {
+    public:
+
+      DeviceValues ();
+
+      Switch::Interface::Device::Id                       m_deviceId;
+      ArenaVector <Switch::Interface::Device::Value>      m_values;
+    };
+
+    /*!
+      \brief Reads the elements of an array, one value per element.
+
+      \return True if the array has exactly one element per value and all were read, false otherwise.
+     */
+    template <typename... T>
+    bool ReadTuple (Reader& io_reader, T&... o_values);
+    template <typename T>
+    bool Read (Reader& io_reader, T& o_value)
+    {
+      return Traits <T>::Read (io_reader, o_value);
+    }
+    template <typename T>
+    void Write (Writer& io_writer, const T& i_value)
+    {
+      Traits <T>::Write (io_writer, i_value);
+    }
+  }
+}
+
+// fields of the interface types
+namespace Switch
+{
+  namespace Codec
+  {
+    template <>
+    struct Fields <Switch::Interface::Device::Product>
+    {
+      template <typename V, typename T>
+      static void Visit (V& io_visitor, T& io_product)
+      {
+        io_visitor ("brandId",        io_product.m_brandId);
+        io_visitor ("brandName",      io_product.m_brandName);
+        io_visitor ("productId",      io_product.m_productId);
+        io_visitor ("productType",    io_product.m_productType);
+        io_visitor ("productVersion", io_product.m_productVersion);
+      }
+    };
+
+    template <>
+    struct Fields <Switch::Interface::Device::Value::DataFormat>
+    {
+      template <typename V, typename T>
+      static void Visit (V& io_visitor, T& io_dataFormat)
+      {
+        io_visitor ("address",      io_dataFormat.m_address);
+        io_visitor ("magicNumber",  io_dataFormat.m_magicNumber);
+        io_visitor ("name",         io_dataFormat.m_name);
+        io_visitor ("description",  io_dataFormat.m_description);
+        io_visitor ("group",        io_dataFormat.m_group, false);
+        io_visitor ("minValue",     io_dataFormat.m_minValue);
+        io_visitor ("maxValue",     io_dataFormat.m_maxValue);
+      }
+    };
+
+    template <>
+    struct Fields <Switch::Interface::Device::Value>
+    {
+      template <typename V, typename T>
+      static void Visit (V& io_visitor, T& io_value)
+      {
+        io_visitor ("address",      io_value.m_address);
+        io_visitor ("magicNumber",  io_value.m_magicNumber);
+        io_visitor ("value",        io_value.m_value);
+      }
+    };
+
+    template <>
+    struct Fields <Switch::Interface::Device::DataFormat>
+    {
+      template <typename V, typename T>
+      static void Visit (V& io_visitor, T& io_dataFormat)
+      {
+        io_visitor ("values", io_dataFormat.m_values);
+      }
+    };
+
+    template <>
+    struct Fields <Switch::Interface::Device::Connection>
+    {
+      template <typename V, typename T>
+      static void Visit (V& io_visitor, T& io_connection)
+      {
+        io_visitor ("online", io_connection.m_online);
+      }
+    };
+
+    template <>
+    struct Fields <Switch::Interface::Device::Summary>
+    {
+      template <typename V, typename T>
+      static void Visit (V& io_visitor, T& io_summary)
+      {
+        io_visitor ("deviceId",     io_summary.m_deviceId);
+        io_visitor ("productInfo",  io_summary.m_productInfo);
+        io_visitor ("online",       io_summary.m_online);
+      }
+    };
+
+    template <>
+    struct Fields <Switch::Interface::Device>
+    {
+      template <typename V, typename T>
+      static void Visit (V& io_visitor, T& io_device)
+      {
+        io_visitor ("deviceId",       io_device.m_deviceId);
+        io_visitor ("productInfo",    io_device.m_productInfo);
+        io_visitor ("connectionInfo", io_device.m_connectionInfo);
+        io_visitor ("dataFormat",     io_device.m_dataFormat);
+      }
+    };
+
+    template <>
+    struct Fields <DeviceValues>
+    {
+      template <typename V, typename T>
+      static void Visit (V& io_visitor, T& io_deviceValues)
+      {
+        io_visitor ("deviceId", io_deviceValues.m_deviceId);
+        io_visitor ("values",   io_deviceValues.m_values);
+      }
+    };
+  }
+}
+
+// reading and writing
+namespace Switch
+{
+  namespace Codec
+  {
+    /*!
+      \brief Reads the field named as the member being read, if any.
+     */
+    class FieldReader
+    {
+    public:
+
+      FieldReader (Reader& io_reader, const char* i_pName, const size_t& i_nameSize)
+      : mr_reader (io_reader),
+        m_pName (i_pName),
+        m_nameSize (i_nameSize),
+        m_nrFields (0),
+        m_field (0),
+        m_matched (false),
+        m_read (false)
+      {
+      }
+
+      template <typename M>
+      void operator() (const char* i_pField, M& o_member, const bool& i_required = true)
+      {
+        if (!m_matched && (0 == strncmp (i_pField, m_pName, m_nameSize)) && ('\0' == i_pField [m_nameSize]))
+        {
+          m_matched = true;
+          m_field   = m_nrFields;
+          m_read    = Traits <M>::Read (mr_reader, o_member);
+        }
+        ++m_nrFields;
+      }
+
+      Reader&     mr_reader;
+      const char* m_pName;
+      size_t      m_nameSize;
+      uint32_t    m_nrFields;
+      uint32_t    m_field;    ///< The position of the field read in the list of fields.
+      bool        m_matched;
+      bool        m_read;
+    };
+
+    /*!
+      \brief Collects the fields an object must have.
+     */
+    class RequiredFields
+    {
+    public:
+
+      RequiredFields ()
+      : m_nrFields (0),
+        m_mask (0)
+      {
+      }
+
+      template <typename M>
+      void operator() (const char* i_pField, const M& i_member, const bool& i_required = true)
+      {
+        if (i_required)
+        {
+          m_mask |= (static_cast <uint64_t> (1) << m_nrFields);
+        }
+        ++m_nrFields;
+      }
+
+      uint32_t m_nrFields;
+      uint64_t m_mask;      ///< Bit f set if field f is required.
+    };
+
+    /*!
+      \brief Writes every field as a member.
+     */
+    class FieldWriter
+    {
+    public:
+
+      explicit FieldWriter (Writer& io_writer)
+      : mr_writer (io_writer)
+      {
+      }
+
+      template <typename M>
+      void operator() (const char* i_pField, const M& i_member, const bool& i_required = true)
+      {
+        mr_writer.Name (i_pField);
+        Traits <M>::Write (mr_writer, i_member);
+      }
+
+      Writer& mr_writer;
+    };
+
+    template <typename T>
+    bool Traits <T>::Read (Reader& io_reader, T& o_value)
+    {
+      if (!io_reader.BeginObject ())
+      {
+        return false;
+      }
+
+      // read the members named after fields, skip the others
+      uint64_t readFields = 0;
+      const char* pName;
+      size_t nameSize;
+      while (io_reader.NextMember (pName, nameSize))
+      {
+        FieldReader fieldReader (io_reader, pName, nameSize);
+        Fields <T>::Visit (fieldReader, o_value);
+        if (!fieldReader.m_matched)
+        {
+          if (!io_reader.Skip ())
+          {
+            return false;
+          }
+        }
+        else if (!fieldReader.m_read)
+        {
+          return false;
+        }
+        else
+        {
+          readFields |= (static_cast <uint64_t> (1) << fieldReader.m_field);
+        }
+      }
+      if (io_reader.HasFailed ())
+      {
+        return false;
+      }
+
+      RequiredFields requiredFields;
+      Fields <T>::Visit (requiredFields, static_cast <const T&> (o_value));
+      return (requiredFields.m_mask == (readFields & requiredFields.m_mask));
+    }
+
+    template <typename T>
+    void Traits <T>::Write (Writer& io_writer, const T& i_value)
+    {
+      FieldWriter fieldWriter (io_writer);
+      io_writer.BeginObject ();
+      Fields <T>::Visit (fieldWriter, i_value);
+      io_writer.EndObject ();
+    }
+
+    /*!
+      \brief Unsigned numbers, negative numbers are rejected.
+     */
+    template <>
+    struct Traits <uint32_t>
+    {
+      static bool Read (Reader& io_reader, uint32_t& o_value)
+      {
+        int64_t value;
+        if (!io_reader.ReadInteger (value) || (0 > value) || (UINT32_MAX < value))
+        {
+          return false;
+        }
+        o_value = static_cast <uint32_t> (value);
+        return true;
+      }
+
+      static void Write (Writer& io_writer, const uint32_t& i_value)
+      {
+        io_writer.WriteUnsigned (i_value);
+      }
+    };
+
+    template <>
+    struct Traits <int32_t>
+    {
+      static bool Read (Reader& io_reader, int32_t& o_value)
+      {
+        int64_t value;
+        if (!io_reader.ReadInteger (value) || (INT32_MIN > value) || (INT32_MAX < value))
+        {
+          return false;
+        }
+        o_value = static_cast <int32_t> (value);
+        return true;
+      }
+
+      static void Write (Writer& io_writer, const int32_t& i_value)
+      {
+        io_writer.WriteSigned (i_value);
+      }
+    };
+
+    template <>
+    struct Traits <uint64_t>
+    {
+      static bool Read (Reader& io_reader, uint64_t& o_value)
+      {
+        int64_t value;
+        if (!io_reader.ReadInteger (value) || (0 > value))
+        {
+          return false;
+        }
+        o_value = static_cast <uint64_t> (value);
+        return true;
+      }
+
+      static void Write (Writer& io_writer, const uint64_t& i_value)
+      {
+        io_writer.WriteUnsigned (i_value);
+      }
+    };
+
+    template <>
+    struct Traits <bool>
+    {
+      static bool Read (Reader& io_reader, bool& o_value)
+      {
+        return io_reader.ReadBool (o_value);
+      }
+
+      static void Write (Writer& io_writer, const bool& i_value)
+      {
+        io_writer.WriteBool (i_value);
+      }
+    };
+
+    template <>
+    struct Traits <std::string>
+    {
+      static bool Read (Reader& io_reader, std::string& o_value)
+      {
+        const char* pString;
+        size_t size;
+        if (!io_reader.ReadString (pString, size))
+        {
+          return false;
+        }
+        o_value.assign (pString, size);
+        return true;
+      }
+
+      static void Write (Writer& io_writer, const std::string& i_value)
+      {
+        io_writer.WriteString (i_value.data (), i_value.size ());
+      }
+    };
+
+    template <>
+    struct Traits <Switch::Interface::eCallResult>
+    {
+      static bool Read (Reader& io_reader, Switch::Interface::eCallResult& o_value)
+      {
+        // note: unknown results are read as CR_INVALID, as by the json traits
+        int64_t value;
+        if (!io_reader.ReadInteger (value))
+        {
+          return false;
+        }
+        cppcms::json::value number;
+        number.number (static_cast <double> (value));
+        o_value = number.get_value <Switch::Interface::eCallResult> ();
+        return true;
+      }
+
+      static void Write (Writer& io_writer, const Switch::Interface::eCallResult& i_value)
+      {
+        io_writer.WriteSigned (static_cast <int64_t> (i_value));
+      }
+    };
+
+    /*!
+      \brief Reads an array, appending its elements to a sequence container.
+     */
+    template <typename S>
+    bool ReadSequence (Reader& io_reader, S& o_values)
+    {
+      if (!io_reader.BeginArray ())
+      {
+        return false;
+      }
+      while (io_reader.NextElement ())
+      {
+        o_values.emplace_back ();
+        if (!Traits <typename S::value_type>::Read (io_reader, o_values.back ()))
+        {
+          return false;
+        }
+      }
+      return !io_reader.HasFailed ();
+    }
+
+    template <typename S>
+    void WriteSequence (Writer& io_writer, const S& i_values)
+    {
+      io_writer.BeginArray ();
+      for (typename S::const_iterator itValue = i_values.begin (); i_values.end () != itValue; ++itValue)
+      {
+        io_writer.NextElement ();
+        Traits <typename S::value_type>::Write (io_writer, *itValue);
+      }
+      io_writer.EndArray ();
+    }
+
+    template <typename T, typename A>
+    struct Traits <std::vector <T, A>>
+    {
+      static bool Read (Reader& io_reader, std::vector <T, A>& o_values)
+      {
+        return ReadSequence (io_reader, o_values);
+      }
+
+      static void Write (Writer& io_writer, const std::vector <T, A>& i_values)
+      {
+        WriteSequence (io_writer, i_values);
+      }
+    };
+
+    template <typename T>
+    struct Traits <ArenaVector <T>>
+    {
+      static bool Read (Reader& io_reader, ArenaVector <T>& o_values)
+      {
+        // note: default constructed members use the heap, they are moved into the arena
+        if (0x0 == o_values.get_allocator ().m_pArena)
+        {
+          o_values = ArenaVector <T> (ArenaAllocator <T> (io_reader.GetArena ()));
+        }
+        if (0 == o_values.capacity ())
+        {
+          o_values.reserve (HTTP_CODEC_INITIAL_CAPACITY);
+        }
+        return ReadSequence (io_reader, o_values);
+      }
+
+      static void Write (Writer& io_writer, const ArenaVector <T>& i_values)
+      {
+        WriteSequence (io_writer, i_values);
+      }
+    };
+
+    template <typename T>
+    struct Traits <std::list <T>>
+    {
+      static bool Read (Reader& io_reader, std::list <T>& o_values)
+      {
+        return ReadSequence (io_reader, o_values);
+      }
+
+      static void Write (Writer& io_writer, const std::list <T>& i_values)
+      {
+        WriteSequence (io_writer, i_values);
+      }
+    };
+
+    /*!
+      \brief Maps from device ids, written as arrays of objects with the device id and the mapped member.
+     */
+    template <typename T>
+    void WriteDeviceMap (Writer& io_writer, const std::map <Switch::Interface::Device::Id, T>& i_map, const char* i_pMember)
+    {
+      io_writer.BeginArray ();
+      for (typename std::map <Switch::Interface::Device::Id, T>::const_iterator itMap = i_map.begin (); i_map.end () != itMap; ++itMap)
+      {
+        io_writer.NextElement ();
+        io_writer.BeginObject ();
+        io_writer.Name ("deviceId");
+        io_writer.WriteUnsigned (itMap->first);
+        io_writer.Name (i_pMember);
+        Traits <T>::Write (io_writer, itMap->second);
+        io_writer.EndObject ();
+      }
+      io_writer.EndArray ();
+    }
+
+    template <>
+    struct Traits <std::map <Switch::Interface::Device::Id, Switch::Interface::eCallResult>>
+    {
+      static void Write (Writer& io_writer, const std::map <Switch::Interface::Device::Id, Switch::Interface::eCallResult>& i_map)
+      {
+        WriteDeviceMap (io_writer, i_map, "result");
+      }
+    };
+
+    template <>
+    struct Traits <std::map <Switch::Interface::Device::Id, std::list <Switch::Interface::Device::Value>>>
+    {
+      static void Write (Writer& io_writer, const std::map <Switch::Interface::Device::Id, std::list <Switch::Interface::Device::Value>>& i_map)
+      {
+        WriteDeviceMap (io_writer, i_map, "values");
+      }
+    };
+
+    inline bool _ReadTupleElements (Reader& io_reader)
+    {
+      return !io_reader.NextElement () && !io_reader.HasFailed ();
+    }
+
+    template <typename T, typename... R>
+    bool _ReadTupleElements (Reader& io_reader, T& o_value, R&... o_values)
+    {
+      return io_reader.NextElement () && Traits <T>::Read (io_reader, o_value) && _ReadTupleElements (io_reader, o_values...);
+    }
+
+    template <typename... T>
+    bool ReadTuple (Reader& io_reader, T&... o_values)
+    {
+      return io_reader.BeginArray () && _ReadTupleElements (io_reader, o_values...);
+    }
+  }
+}
+
+#endif // _SWITCH_HTTPCODEC
@@ -0,0 +1,89 @@
+/*?*************************************************************************
+*                           Switch_HttpConfiguration.h
+*                           -----------------------
+*    copyright            : (C) 2013 by Wouter Charle
+*    email                : wouter.charle@gmail.com
+*
+***************************************************************************/
+
+#ifndef _SWITCH_HTTPCONFIGURATION
+#define _SWITCH_HTTPCONFIGURATION
+
+/*
+  The number of device updates kept per device for clients resuming their updates
+  => A client that missed more updates of a device has to resynchronize
+ */
+#define HTTP_DEVICE_CHANGE_LOG_SIZE 64
+
+/*
+  The maximum nesting depth of arrays and maps in binary (CBOR) requests
+  => Deeper requests are rejected, which bounds the recursion of the decoder
+ */
+#define HTTP_CBOR_MAX_NESTING 32
+
+/*
+  The maximum number of events waiting to be written to a device update stream
+  => A client whose stream falls further behind gets its updates coalesced, as after SetDeviceUpdateInterval
+ */
+#define HTTP_MAX_PENDING_STREAM_EVENTS 256
+
+/*
+  The interval, in milliseconds, between the coalesced updates of a client whose stream fell behind
+  => Applies until the client sets an interval itself
+ */
+#define HTTP_BACKLOGGED_STREAM_UPDATE_INTERVAL_MS 1000
+
+/*
+  The longest interval, in milliseconds, a client can ask to be left between two device updates sent to it
+  => Longer intervals are rejected, the updates of a client are coalesced for at most this long
+ */
+#define HTTP_MAX_DEVICE_UPDATE_INTERVAL_MS 60000
+
+/*
+  The size in bytes of the blocks of the per-request arena of the json codecs
+  => Requests up to this size are decoded without allocating once the arena has its first block
+ */
+#define HTTP_CODEC_ARENA_BLOCK_SIZE 16384
+
+/*
+  The number of elements reserved for an array read by the json codecs
+  => Arrays grow by doubling from there, the memory left behind is only reclaimed with the arena
+ */
+#define HTTP_CODEC_INITIAL_CAPACITY 16
+
+/*
+  The size in bytes of the buffer between the json writer and the response stream
+ */
+#define HTTP_CODEC_WRITE_BUFFER_SIZE 4096
+
+/*
+  The maximum nesting depth of arrays and objects in requests read by the json codecs
+  => Deeper requests are rejected, which bounds the recursion of the reader
+ */
+#define HTTP_CODEC_MAX_NESTING 32
+
+/*
+  The maximum number of devices in a page of EnumerateDevicePage and GET /Devices
+  => Bounds the response built for a single call, larger limits are rejected
+ */
+#define HTTP_MAX_DEVICE_PAGE_SIZE 1000
+
+/*
+  The maximum number of devices in a snapshot of GetMultipleDeviceValues and GetDeviceGroupValues
+  => Bounds the time the device store is locked for a single call, larger snapshots are rejected
+ */
+#define HTTP_MAX_SNAPSHOT_SIZE 1000
+
+/*
+  The time in seconds after which a client without calls or open connections is removed
+  => Its subscriptions and update state are dropped and its token is refused until it registers again
+ */
+#define HTTP_CLIENT_IDLE_TIMEOUT_S 900
+
+/*
+  The interval in seconds between the checks for idle clients
+  => Clients are removed up to this long after their idle timeout
+ */
+#define HTTP_IDLE_CLIENTS_CHECK_INTERVAL_S 60
+
+#endif // _SWITCH_HTTPCONFIGURATION
@@ -13,6 +13,9 @@
 #include <Switch_Base/Switch_Debug.h>
 
 // third-party includes
+#include <algorithm>
+#include <vector>
+#include <limits>
 
 // other declarations
 namespace args = std::placeholders;
@@ -21,28 +24,83 @@ namespace args = std::placeholders;
 /*!
   \brief
  */
-Switch::HttpInterface::HttpInterface (cppcms::service& i_service, Switch::FunctionalInterface& i_controller)
-: HttpInterfaceBase (i_service),
-  mr_controller (i_controller)
+Switch::HttpInterface::HttpInterface (cppcms::service& i_service, Switch::FunctionalInterface& i_controller, std::shared_ptr <SharedState> i_pSharedState)
+: HttpInterfaceBase (i_service, i_pSharedState),
+  mr_controller (i_controller),
+  m_pInterfaceState (i_pSharedState)
 {
-  // connect to controller callbacks
-  mr_controller.ConnectToDeviceConnectionUpdateSignal (std::bind (&Switch::HttpInterface::_OnControllerDeviceConnectionUpdateSignal, this, args::_1, args::_2));
-  mr_controller.ConnectToDeviceDataUpdateSignal (std::bind (&Switch::HttpInterface::_OnControllerDeviceDataUpdateSignal, this, args::_1, args::_2));
+  _Connect ();
 }
 
 /*!
   \brief
  */
-Switch::HttpInterface::HttpInterface (cppcms::service& i_service, Switch::FunctionalFacade i_controllerFacade)
-: HttpInterfaceBase (i_service),
-  mr_controller (i_controllerFacade.Get ())
+Switch::HttpInterface::HttpInterface (cppcms::service& i_service, Switch::FunctionalFacade i_controllerFacade, std::shared_ptr <SharedState> i_pSharedState)
+: HttpInterfaceBase (i_service, i_pSharedState),
+  mr_controller (i_controllerFacade.Get ()),
+  m_pInterfaceState (i_pSharedState)
 {
-  // connect to controller callbacks
-  mr_controller.ConnectToDeviceConnectionUpdateSignal (std::bind (&Switch::HttpInterface::_OnControllerDeviceConnectionUpdateSignal, this, args::_1, args::_2));
-  mr_controller.ConnectToDeviceDataUpdateSignal (std::bind (&Switch::HttpInterface::_OnControllerDeviceDataUpdateSignal, this, args::_1, args::_2));
+  _Connect ();
 }
 
 Switch::HttpInterface::~HttpInterface ()
+{
+  // hand the controller callbacks over to the other instances
+  std::unique_lock <std::mutex> instancesLock (m_pInterfaceState->m_instancesMutex);
+  m_pInterfaceState->m_instances.remove (this);
+}
+
+/*!
+  \brief Registers the instance with the shared state, connecting the state to the controller callbacks once.
+ */
+void Switch::HttpInterface::_Connect ()
+{
+  std::unique_lock <std::mutex> instancesLock (m_pInterfaceState->m_instancesMutex);
+  m_pInterfaceState->m_instances.push_back (this);
+
+  // connect to controller callbacks
+  if (!m_pInterfaceState->m_deviceConnectionUpdateConnection.IsConnected ())
+  {
+    m_pInterfaceState->m_deviceConnectionUpdateConnection = mr_controller.ConnectToDeviceConnectionUpdateSignal (std::bind (&Switch::HttpInterface::SharedState::_OnControllerDeviceConnectionUpdateSignal, m_pInterfaceState.get (), args::_1, args::_2));
+    m_pInterfaceState->m_deviceDataUpdateConnection = mr_controller.ConnectToDeviceDataUpdateSignal (std::bind (&Switch::HttpInterface::SharedState::_OnControllerDeviceDataUpdateSignal, m_pInterfaceState.get (), args::_1, args::_2));
+  }
+}
+
+Switch::HttpInterface::SharedState::SharedState ()
+: m_productTypeSubscriptions (false),
+  m_productTypesVersion (std::numeric_limits <uint64_t>::max ()),
+  m_elementGroupFilters (false),
+  m_elementGroupsVersion (std::numeric_limits <uint64_t>::max ())
+{
+}
+
+Switch::HttpInterface::SharedState::~SharedState ()
+{
+  // stop receiving controller callbacks before the buffers are destroyed
+  m_deviceConnectionUpdateConnection.Disconnect ();
+  m_deviceDataUpdateConnection.Disconnect ();
+}
+
+void Switch::HttpInterface::SharedState::_OnControllerDeviceConnectionUpdateSignal (const uint32_t& i_deviceId, const Switch::Interface::Device::Connection& i_connection)
+{
+  std::unique_lock <std::mutex> instancesLock (m_instancesMutex);
+  if (!m_instances.empty ())
+  {
+    m_instances.front ()->_OnControllerDeviceConnectionUpdateSignal (i_deviceId, i_connection);
+  }
+}
+
+void Switch::HttpInterface::SharedState::_OnControllerDeviceDataUpdateSignal (const uint32_t& i_deviceId, const std::list <Switch::Interface::Device::Value>& i_values)
+{
+  std::unique_lock <std::mutex> instancesLock (m_instancesMutex);
+  if (!m_instances.empty ())
+  {
+    m_instances.front ()->_OnControllerDeviceDataUpdateSignal (i_deviceId, i_values);
+  }
+}
+
+Switch::HttpInterface::DeviceChangeLog::DeviceChangeLog ()
+: m_trimmedIndex (0)
 {
 }
 
@@ -56,149 +114,626 @@ Switch::Interface::eCallResult Switch::HttpInterface::_EnumerateDevices (std::li
   return mr_controller.EnumerateDevices (o_deviceInfo);
 }
 
+Switch::Interface::eCallResult Switch::HttpInterface::_VisitDevices (uint32_t& o_nextDeviceId, const device_summary_visitor_type& i_visitor, const Switch::Interface::Device::Id& i_firstDeviceId, const uint32_t& i_maxNrDevices)
+{
+  return mr_controller.VisitDevices (o_nextDeviceId, i_visitor, i_firstDeviceId, i_maxNrDevices);
+}
+
 Switch::Interface::eCallResult Switch::HttpInterface::_GetDeviceDetails (Switch::Interface::Device& o_deviceDetails, const uint32_t& i_deviceId)
 {
   return mr_controller.GetDeviceDetails (o_deviceDetails, i_deviceId);
 }
 
+Switch::Interface::eCallResult Switch::HttpInterface::_GetDeviceCatalogVersion (uint64_t& o_version)
+{
+  return mr_controller.GetDeviceCatalogVersion (o_version);
+}
+
 Switch::Interface::eCallResult Switch::HttpInterface::_GetDeviceValues (std::list <Switch::Interface::Device::Value>& o_values, const uint32_t& i_deviceId)
 {
   return mr_controller.GetDeviceValues (o_values, i_deviceId);
 }
 
+Switch::Interface::eCallResult Switch::HttpInterface::_GetMultipleDeviceValues (std::map <Switch::Interface::Device::Id, std::list <Switch::Interface::Device::Value>>& o_values, const std::set <Switch::Interface::Device::Id>& i_deviceIds)
+{
+  return mr_controller.GetMultipleDeviceValues (o_values, i_deviceIds);
+}
+
+Switch::Interface::eCallResult Switch::HttpInterface::_GetDeviceReportedValues (std::list <Switch::Interface::Device::Value>& o_values, const uint32_t& i_deviceId)
+{
+  return mr_controller.GetDeviceReportedValues (o_values, i_deviceId);
+}
+
 Switch::Interface::eCallResult Switch::HttpInterface::_SetDeviceValues (const uint32_t& i_deviceId, const std::list <Switch::Interface::Device::Value>& i_values)
 {
   return mr_controller.SetDeviceValues (i_deviceId, i_values);
 }
 
-Switch::Interface::eCallResult Switch::HttpInterface::_SubscribeToDeviceUpdates (const client_id_type& i_clientId, const uint32_t& i_deviceId)
+Switch::Interface::eCallResult Switch::HttpInterface::_SetMultipleDeviceValues (std::map <uint32_t, Switch::Interface::eCallResult>& o_results, uint32_t& o_sceneId, const std::map <uint32_t, std::list <Switch::Interface::Device::Value>>& i_values)
+{
+  return mr_controller.SetMultipleDeviceValues (o_results, o_sceneId, i_values);
+}
+
+Switch::Interface::eCallResult Switch::HttpInterface::_GetSceneResults (std::map <uint32_t, Switch::Interface::eCallResult>& o_results, const uint32_t& i_sceneId)
+{
+  return mr_controller.GetSceneResults (o_results, i_sceneId);
+}
+
+Switch::Interface::eCallResult Switch::HttpInterface::_GetCommandBacklog (uint32_t& o_nrQueuedCommands, uint32_t& o_drainTimeMicros)
+{
+  return mr_controller.GetCommandBacklog (o_nrQueuedCommands, o_drainTimeMicros);
+}
+
+Switch::Interface::eCallResult Switch::HttpInterface::_GetChangesSince (uint64_t& o_version, std::list <Switch::Interface::Device::Summary>& o_devices, std::map <Switch::Interface::Device::Id, std::list <Switch::Interface::Device::Value>>& o_values, const uint64_t& i_version)
+{
+  return mr_controller.GetChangesSince (o_version, o_devices, o_values, i_version);
+}
+
+Switch::Interface::eCallResult Switch::HttpInterface::_SubscribeToDeviceUpdates (const client_id_type& i_clientId, const SubscriptionTopic& i_topic)
 {
-  std::unique_lock <std::mutex> deviceUpdateBufferLock (m_deviceUpdateBufferMutex);
+  // the devices of a product type are only known once the product types are read
+  if (SubscriptionTopic::ST_PRODUCT_TYPE == i_topic.m_kind)
+  {
+    m_pInterfaceState->m_productTypeSubscriptions = true;
+    _UpdateDeviceProductTypes ();
+  }
+
+  // the elements of a group are only known from the device's data format
+  ElementFilter elementFilter (i_topic.m_elementFilter);
+  if (!elementFilter.m_group.empty ())
+  {
+    Switch::Interface::Device deviceDetails;
+    Switch::Interface::eCallResult callResult = mr_controller.GetDeviceDetails (deviceDetails, i_topic.m_deviceId);
+    if (Switch::Interface::CR_OK != callResult)
+    {
+      return callResult;
+    }
+    _ResolveElementGroup (elementFilter.m_addresses, deviceDetails.m_dataFormat, elementFilter.m_group);
+  }
 
-  // link listener id to device id
-  std::pair <std::set <client_id_type>::iterator, bool> insertionResult;
-  insertionResult = m_listenerIdsPerDevice [i_deviceId].insert (i_clientId);
+  std::unique_lock <std::mutex> deviceUpdateBufferLock (m_pInterfaceState->m_deviceUpdateBufferMutex);
 
-  if (!insertionResult.second)
+  bool subscribed = m_pInterfaceState->m_subscriptionIndex.Subscribe (i_clientId, i_topic);
+  m_pInterfaceState->m_productTypeSubscriptions = m_pInterfaceState->m_subscriptionIndex.HasProductTypeSubscriptions ();
+
+  // note: subscribing to a device again replaces its element filter
+  bool filterChanged = (SubscriptionTopic::ST_DEVICE == i_topic.m_kind) && _SetElementFilter (i_clientId, i_topic.m_deviceId, elementFilter);
+  if (!subscribed && !filterChanged)
   {
     return Switch::Interface::CR_CLIENT_ALREADY_SUBSCRIBED;
   }
 
-  // now also link the device id to the listener
-  m_deviceIdsPerListener [i_clientId].insert (i_deviceId);
+  // updates issued before are not available to the listener when resuming
+  m_pInterfaceState->m_subscriptionStartIndices [i_clientId] = _GetLastUpdateIndex ();
 
   return Switch::Interface::CR_OK;
 }
 
-Switch::Interface::eCallResult Switch::HttpInterface::_UnsubscribeFromDeviceUpdates (const client_id_type& i_listenerId, const uint32_t& i_deviceId)
+Switch::Interface::eCallResult Switch::HttpInterface::_UnsubscribeFromDeviceUpdates (const client_id_type& i_listenerId, const SubscriptionTopic& i_topic)
 {
-  std::unique_lock <std::mutex> deviceUpdateBufferLock (m_deviceUpdateBufferMutex);
-
-  std::set <client_id_type>& listenerIds = m_listenerIdsPerDevice [i_deviceId];
-  size_t nrErased = listenerIds.erase (i_listenerId);
+  std::unique_lock <std::mutex> deviceUpdateBufferLock (m_pInterfaceState->m_deviceUpdateBufferMutex);
 
-  // check if there are still other listeners for updates of the device
-  if (0 == nrErased)
+  bool unsubscribed = m_pInterfaceState->m_subscriptionIndex.Unsubscribe (i_listenerId, i_topic);
+  m_pInterfaceState->m_productTypeSubscriptions = m_pInterfaceState->m_subscriptionIndex.HasProductTypeSubscriptions ();
+  if (!unsubscribed)
   {
     return Switch::Interface::CR_CLIENT_NOT_SUBSCRIBED;
   }
 
-  // erase the device id from the listener's device ids
-  std::map <client_id_type, std::set <uint32_t>>::iterator itListenerDeviceIds = m_deviceIdsPerListener.find (i_listenerId);
-  SWITCH_ASSERT (m_deviceIdsPerListener.end () != itListenerDeviceIds);
-
-  std::set <uint32_t>& listenerDeviceIds = itListenerDeviceIds->second;
-  listenerDeviceIds.erase (i_deviceId);
-  if (listenerDeviceIds.empty ())
+  if (SubscriptionTopic::ST_DEVICE == i_topic.m_kind)
   {
-    // the listener is not listening to any device's updates anymore
-    m_deviceIdsPerListener.erase (itListenerDeviceIds);
+    _SetElementFilter (i_listenerId, i_topic.m_deviceId, ElementFilter ());
   }
 
-  if (listenerIds.empty ())
+  if (!m_pInterfaceState->m_subscriptionIndex.HasSubscriptions (i_listenerId))
   {
-    // clear the update buffers for the device
-    m_deviceConnectionUpdateBuffer.erase (i_deviceId);
-    m_deviceDataUpdateBuffer.erase (i_deviceId);
+    // the listener is not listening to any device's updates anymore
+    m_pInterfaceState->m_subscriptionStartIndices.erase (i_listenerId);
   }
 
+  // clear the update buffers of the devices without listeners
+  _PruneDeviceUpdateBuffers ();
+
   // return the result
   return Switch::Interface::CR_OK;
 }
 
-void Switch::HttpInterface::_SendBufferedUpdatesToListener (const client_id_type& i_listenerId)
+Switch::Interface::eCallResult Switch::HttpInterface::_DefineDeviceGroup (const std::string& i_group, const std::set <uint32_t>& i_deviceIds)
 {
-  std::unique_lock <std::mutex> deviceUpdateBufferLock (m_deviceUpdateBufferMutex);
+  std::unique_lock <std::mutex> deviceUpdateBufferLock (m_pInterfaceState->m_deviceUpdateBufferMutex);
 
-  std::set <client_id_type> listenerIds;
-  listenerIds.insert (i_listenerId);
+  m_pInterfaceState->m_subscriptionIndex.DefineDeviceGroup (i_group, i_deviceIds);
+  _PruneDeviceUpdateBuffers ();
 
-  const std::set <uint32_t>& listenerDeviceIds = m_deviceIdsPerListener [i_listenerId];
-  std::set <uint32_t>::const_iterator itListenerDeviceIds;
-  for (itListenerDeviceIds=listenerDeviceIds.begin (); listenerDeviceIds.end ()!=itListenerDeviceIds; ++itListenerDeviceIds)
-  {
-    const uint32_t& listenerDeviceId = *itListenerDeviceIds;
+  return Switch::Interface::CR_OK;
+}
 
-    // check if there was a connection update
-    std::map <uint32_t, DeviceConnectionUpdate>::iterator itConnectionUpdate = m_deviceConnectionUpdateBuffer.find (listenerDeviceId);
-    if (m_deviceConnectionUpdateBuffer.end () != itConnectionUpdate)
-    {
-      const DeviceConnectionUpdate& connectionUpdate = itConnectionUpdate->second;
+void Switch::HttpInterface::_GetDeviceGroup (std::set <uint32_t>& o_deviceIds, const std::string& i_group)
+{
+  std::unique_lock <std::mutex> deviceUpdateBufferLock (m_pInterfaceState->m_deviceUpdateBufferMutex);
+
+  m_pInterfaceState->m_subscriptionIndex.GetDeviceGroup (o_deviceIds, i_group);
+}
 
-      // send the device connection update
-      _OnDeviceUpdate (listenerIds, connectionUpdate);
+/*!
+  \brief Drops the subscriptions and element filters of a removed client.
+
+  \param [in] i_listenerId The id of the client.
+ */
+void Switch::HttpInterface::_RemoveClient (const client_id_type& i_listenerId)
+{
+  std::unique_lock <std::mutex> deviceUpdateBufferLock (m_pInterfaceState->m_deviceUpdateBufferMutex);
+
+  m_pInterfaceState->m_subscriptionIndex.RemoveClient (i_listenerId);
+  m_pInterfaceState->m_productTypeSubscriptions = m_pInterfaceState->m_subscriptionIndex.HasProductTypeSubscriptions ();
+  m_pInterfaceState->m_subscriptionStartIndices.erase (i_listenerId);
+
+  std::vector <uint32_t> filteredDeviceIds;
+  std::map <uint32_t, std::map <client_id_type, ElementFilter>>::const_iterator itDeviceFilters;
+  for (itDeviceFilters=m_pInterfaceState->m_elementFilters.begin (); m_pInterfaceState->m_elementFilters.end ()!=itDeviceFilters; ++itDeviceFilters)
+  {
+    if (itDeviceFilters->second.end () != itDeviceFilters->second.find (i_listenerId))
+    {
+      filteredDeviceIds.push_back (itDeviceFilters->first);
     }
+  }
+  for (std::vector <uint32_t>::const_iterator itDeviceId=filteredDeviceIds.begin (); filteredDeviceIds.end ()!=itDeviceId; ++itDeviceId)
+  {
+    _SetElementFilter (i_listenerId, *itDeviceId, ElementFilter ());
+  }
+
+  // clear the update buffers of the devices without listeners
+  _PruneDeviceUpdateBuffers ();
+}
+
+void Switch::HttpInterface::_SendBufferedUpdatesToListener (const client_id_type& i_listenerId, const uint64_t& i_cursor)
+{
+  std::unique_lock <std::mutex> deviceUpdateBufferLock (m_pInterfaceState->m_deviceUpdateBufferMutex);
+
+  // a resuming listener gets the updates it missed instead of the latest state
+  if (0 != i_cursor)
+  {
+    _SendMissedUpdatesToListener (i_listenerId, i_cursor);
+    return;
+  }
 
-    // check if there was a data update
-    std::map <uint32_t, DeviceDataUpdate>::iterator itDataUpdate = m_deviceDataUpdateBuffer.find (listenerDeviceId);
-    if (m_deviceDataUpdateBuffer.end () != itDataUpdate)
+  client_ids_type listenerIds (1, i_listenerId);
+
+  // send the buffered connection updates of the listener's devices, serialized on the first replay
+  std::map <uint32_t, DeviceConnectionUpdate>::iterator itConnectionUpdate;
+  for (itConnectionUpdate=m_pInterfaceState->m_deviceConnectionUpdateBuffer.begin (); m_pInterfaceState->m_deviceConnectionUpdateBuffer.end ()!=itConnectionUpdate; ++itConnectionUpdate)
+  {
+    if (m_pInterfaceState->m_subscriptionIndex.Matches (i_listenerId, itConnectionUpdate->first))
     {
-      const DeviceDataUpdate& dataUpdate = itDataUpdate->second;
+      _OnDeviceUpdate (listenerIds, itConnectionUpdate->second);
+    }
+  }
 
-      // send the device data update
-      _OnDeviceUpdate (listenerIds, dataUpdate);
+  // send the buffered data updates of the listener's devices, serialized on the first replay
+  std::map <uint32_t, DeviceDataUpdate>::iterator itDataUpdate;
+  for (itDataUpdate=m_pInterfaceState->m_deviceDataUpdateBuffer.begin (); m_pInterfaceState->m_deviceDataUpdateBuffer.end ()!=itDataUpdate; ++itDataUpdate)
+  {
+    if (m_pInterfaceState->m_subscriptionIndex.Matches (i_listenerId, itDataUpdate->first))
+    {
+      _OnFilteredDeviceUpdate (listenerIds, itDataUpdate->second);
     }
   }
 }
 
 void Switch::HttpInterface::_OnControllerDeviceConnectionUpdateSignal (const uint32_t& i_deviceId, const Switch::Interface::Device::Connection& i_connection)
 {
-  std::unique_lock <std::mutex> deviceUpdateBufferLock (m_deviceUpdateBufferMutex);
+  _UpdateDeviceProductTypes ();
 
-  const std::set <client_id_type>& listenerIds = m_listenerIdsPerDevice [i_deviceId];
-  SWITCH_DEBUG_MSG_1 ("_OnControllerDeviceConnectionUpdateSignal => %u clients listening\n", listenerIds.size ());
-  if (!listenerIds.empty ())
+  std::unique_lock <std::mutex> deviceUpdateBufferLock (m_pInterfaceState->m_deviceUpdateBufferMutex);
+
+  m_pInterfaceState->m_subscriptionIndex.Resolve (m_pInterfaceState->m_recipientIds, i_deviceId);
+  SWITCH_DEBUG_MSG_1 ("_OnControllerDeviceConnectionUpdateSignal => %u clients listening\n", m_pInterfaceState->m_recipientIds.size ());
+  if (!m_pInterfaceState->m_recipientIds.empty ())
   {
     // create the device update
     DeviceConnectionUpdate connectionUpdate;
+    connectionUpdate.m_index      = _GenerateUpdateIndex ();
     connectionUpdate.m_deviceId   = i_deviceId;
     connectionUpdate.m_connection = i_connection;
 
-    // buffer the update
-    m_deviceConnectionUpdateBuffer [i_deviceId] = connectionUpdate;
+    // forward and log the update
+    _OnDeviceUpdate (m_pInterfaceState->m_recipientIds, connectionUpdate);
+    _LogDeviceUpdate (i_deviceId, connectionUpdate.m_index, connectionUpdate.m_pMessage);
 
-    // forward the update
-    _OnDeviceUpdate (listenerIds, connectionUpdate);
+    // buffer the update, sharing its serialized message
+    m_pInterfaceState->m_deviceConnectionUpdateBuffer [i_deviceId] = connectionUpdate;
   }
 }
 
 void Switch::HttpInterface::_OnControllerDeviceDataUpdateSignal (const uint32_t& i_deviceId, const std::list <Switch::Interface::Device::Value>& i_values)
 {
-  std::unique_lock <std::mutex> deviceUpdateBufferLock (m_deviceUpdateBufferMutex);
+  _UpdateDeviceProductTypes ();
+  _UpdateElementGroupFilters ();
+
+  std::unique_lock <std::mutex> deviceUpdateBufferLock (m_pInterfaceState->m_deviceUpdateBufferMutex);
 
-  const std::set <client_id_type>& listenerIds = m_listenerIdsPerDevice [i_deviceId];
-  SWITCH_DEBUG_MSG_1 ("_OnControllerDeviceDataUpdateSignal => %u clients listening\n", listenerIds.size ());
-  if (!listenerIds.empty ())
+  m_pInterfaceState->m_subscriptionIndex.Resolve (m_pInterfaceState->m_recipientIds, i_deviceId);
+  SWITCH_DEBUG_MSG_1 ("_OnControllerDeviceDataUpdateSignal => %u clients listening\n", m_pInterfaceState->m_recipientIds.size ());
+  if (!m_pInterfaceState->m_recipientIds.empty ())
   {
     // create the device update
     DeviceDataUpdate dataUpdate;
+    dataUpdate.m_index      = _GenerateUpdateIndex ();
     dataUpdate.m_deviceId   = i_deviceId;
     dataUpdate.m_dataValues = i_values;
 
-    // buffer the update
-    m_deviceDataUpdateBuffer [i_deviceId] = dataUpdate;
+    // forward and log the update
+    _OnFilteredDeviceUpdate (m_pInterfaceState->m_recipientIds, dataUpdate);
+    _LogDeviceUpdate (i_deviceId, dataUpdate.m_index, dataUpdate.m_pMessage);
+
+    // buffer the update, the serialized message is shared unless the update is merged into a buffered one
+    m_pInterfaceState->m_deviceDataUpdateBuffer [i_deviceId] = dataUpdate;
+  }
+}
+
+/*!
+  \brief Appends an update to the change log of its device.
+
+  The log of a device is started with its first update sent to listeners. The oldest
+  updates are dropped when the log exceeds HTTP_DEVICE_CHANGE_LOG_SIZE.
+
+  \param [in] i_deviceId The id of the device the update is related to.
+  \param [in] i_index    The index of the update.
+  \param [in] i_pMessage The serialized update.
+
+  \note Must be called with the device update buffer mutex locked.
+ */
+void Switch::HttpInterface::_LogDeviceUpdate (const uint32_t& i_deviceId, const uint64_t& i_index, const device_update_message_type& i_pMessage)
+{
+  // note: the updates of the device issued before had no listeners, none of the current listeners missed them
+  DeviceChangeLog& changeLog = m_pInterfaceState->m_deviceChangeLogs [i_deviceId];
+  changeLog.m_entries.push_back (std::make_pair (i_index, i_pMessage));
+  while (HTTP_DEVICE_CHANGE_LOG_SIZE < changeLog.m_entries.size ())
+  {
+    changeLog.m_trimmedIndex = changeLog.m_entries.front ().first;
+    changeLog.m_entries.pop_front ();
+  }
+}
+
+/*!
+  \brief Sends the updates a resuming listener missed, in the order they were issued.
+
+  If the updates after the cursor are no longer logged for any of the listener's devices,
+  the listener subscribed after the cursor, or the cursor was not issued yet, a
+  "resyncRequired" event is sent instead.
+
+  \param [in] i_listenerId The id of the listener.
+  \param [in] i_cursor     The index of the last update the listener received.
+
+  \note Must be called with the device update buffer mutex locked.
+ */
+void Switch::HttpInterface::_SendMissedUpdatesToListener (const client_id_type& i_listenerId, const uint64_t& i_cursor)
+{
+  client_ids_type listenerIds (1, i_listenerId);
+
+  // note: cursors of a previous run are below the first index, the updates missed since are unknown
+  std::map <client_id_type, uint64_t>::const_iterator itStartIndex = m_pInterfaceState->m_subscriptionStartIndices.find (i_listenerId);
+  bool resyncRequired = (_GetLastUpdateIndex () < i_cursor) || (i_cursor < _GetFirstUpdateIndex () - 1) || ((m_pInterfaceState->m_subscriptionStartIndices.end () != itStartIndex) && (i_cursor < itStartIndex->second));
+  std::vector <std::pair <uint64_t, std::pair <uint32_t, device_update_message_type>>> missedUpdates;
+
+  std::map <uint32_t, DeviceChangeLog>::const_iterator itChangeLog;
+  for (itChangeLog=m_pInterfaceState->m_deviceChangeLogs.begin (); (m_pInterfaceState->m_deviceChangeLogs.end ()!=itChangeLog) && !resyncRequired; ++itChangeLog)
+  {
+    const uint32_t& deviceId = itChangeLog->first;
+    if (!m_pInterfaceState->m_subscriptionIndex.Matches (i_listenerId, deviceId))
+    {
+      continue;
+    }
+
+    const DeviceChangeLog& changeLog = itChangeLog->second;
+    if (i_cursor < changeLog.m_trimmedIndex)
+    {
+      // some of the missed updates were dropped
+      resyncRequired = true;
+      break;
+    }
+
+    // collect the updates after the cursor
+    std::deque <std::pair <uint64_t, device_update_message_type>>::const_reverse_iterator itEntries;
+    for (itEntries=changeLog.m_entries.rbegin (); (changeLog.m_entries.rend ()!=itEntries) && (i_cursor<itEntries->first); ++itEntries)
+    {
+      missedUpdates.push_back (std::make_pair (itEntries->first, std::make_pair (deviceId, itEntries->second)));
+    }
+  }
+
+  if (resyncRequired)
+  {
+    _HandleDeviceUpdate (listenerIds, 0, _CreateResyncRequiredMessage ());
+    return;
+  }
+
+  // send the missed updates of all devices in the order they were issued
+  std::sort (missedUpdates.begin (), missedUpdates.end ());
+  std::vector <std::pair <uint64_t, std::pair <uint32_t, device_update_message_type>>>::const_iterator itMissedUpdates;
+  for (itMissedUpdates=missedUpdates.begin (); missedUpdates.end ()!=itMissedUpdates; ++itMissedUpdates)
+  {
+    const uint32_t& deviceId = itMissedUpdates->second.first;
+    const device_update_message_type& pMessage = itMissedUpdates->second.second;
+    if (DeviceUpdateMessage::UE_DATA_UPDATE == pMessage->m_event)
+    {
+      // filter the logged values as the live updates
+      DeviceDataUpdate dataUpdate;
+      dataUpdate.m_index      = pMessage->m_index;
+      dataUpdate.m_deviceId   = deviceId;
+      dataUpdate.m_dataValues = pMessage->m_dataValues;
+      dataUpdate.m_pMessage   = pMessage;
+      _OnFilteredDeviceUpdate (listenerIds, dataUpdate);
+      continue;
+    }
+    _HandleDeviceUpdate (listenerIds, deviceId, pMessage);
+  }
+}
+
+/*!
+  \brief Clears the buffered updates and change logs of the devices no listener is subscribed to anymore.
+
+  \note Must be called with the device update buffer mutex locked.
+ */
+void Switch::HttpInterface::_PruneDeviceUpdateBuffers ()
+{
+  std::map <uint32_t, DeviceChangeLog>::iterator itChangeLog = m_pInterfaceState->m_deviceChangeLogs.begin ();
+  while (m_pInterfaceState->m_deviceChangeLogs.end () != itChangeLog)
+  {
+    const uint32_t deviceId = itChangeLog->first;
+    m_pInterfaceState->m_subscriptionIndex.Resolve (m_pInterfaceState->m_recipientIds, deviceId);
+    if (m_pInterfaceState->m_recipientIds.empty ())
+    {
+      m_pInterfaceState->m_deviceConnectionUpdateBuffer.erase (deviceId);
+      m_pInterfaceState->m_deviceDataUpdateBuffer.erase (deviceId);
+      m_pInterfaceState->m_deviceChangeLogs.erase (itChangeLog++);
+    }
+    else
+    {
+      ++itChangeLog;
+    }
+  }
+}
+
+/*!
+  \brief Reads the product types of the devices into the subscription index when the device catalog changed.
+
+  Only done while listeners are subscribed to product types.
+ */
+void Switch::HttpInterface::_UpdateDeviceProductTypes ()
+{
+  if (!m_pInterfaceState->m_productTypeSubscriptions)
+  {
+    return;
+  }
+
+  uint64_t version = 0;
+  if ((Switch::Interface::CR_OK != mr_controller.GetDeviceCatalogVersion (version)) || (version == m_pInterfaceState->m_productTypesVersion))
+  {
+    return;
+  }
+
+  // note: the controller is called without holding the buffer mutex
+  std::list <Switch::Interface::Device::Summary> devices;
+  if (Switch::Interface::CR_OK != mr_controller.EnumerateDevices (devices))
+  {
+    return;
+  }
+
+  std::unique_lock <std::mutex> deviceUpdateBufferLock (m_pInterfaceState->m_deviceUpdateBufferMutex);
+  std::list <Switch::Interface::Device::Summary>::const_iterator itDevice;
+  for (itDevice=devices.begin (); devices.end ()!=itDevice; ++itDevice)
+  {
+    m_pInterfaceState->m_subscriptionIndex.SetDeviceProductType (itDevice->m_deviceId, itDevice->m_productInfo.m_productType);
+  }
+  m_pInterfaceState->m_productTypesVersion = version;
+}
+
+/*!
+  \brief Sends a data update to its listeners, with only the values of their elements to the listeners filtering elements.
+
+  Listeners with the same filter share the filtered message, listeners whose elements did not
+  change get nothing. The complete update is serialized all the same, to be logged and buffered.
+
+  \param [in]     i_listenerIds The ids of the listeners.
+  \param [in,out] io_update     The update, its message is set.
+
+  \note Must be called with the device update buffer mutex locked.
+ */
+void Switch::HttpInterface::_OnFilteredDeviceUpdate (const client_ids_type& i_listenerIds, DeviceDataUpdate& io_update)
+{
+  std::map <uint32_t, std::map <client_id_type, ElementFilter>>::const_iterator itDeviceFilters = m_pInterfaceState->m_elementFilters.find (io_update.m_deviceId);
+  if (m_pInterfaceState->m_elementFilters.end () == itDeviceFilters)
+  {
+    _OnDeviceUpdate (i_listenerIds, io_update);
+    return;
+  }
+
+  // group the listeners by filter
+  client_ids_type unfilteredIds;
+  std::vector <std::pair <const ElementFilter*, client_ids_type>> filteredIds;
+  for (client_ids_type::const_iterator itListenerId=i_listenerIds.begin (); i_listenerIds.end ()!=itListenerId; ++itListenerId)
+  {
+    std::map <client_id_type, ElementFilter>::const_iterator itFilter = itDeviceFilters->second.find (*itListenerId);
+    if (itDeviceFilters->second.end () == itFilter)
+    {
+      unfilteredIds.push_back (*itListenerId);
+      continue;
+    }
+
+    std::vector <std::pair <const ElementFilter*, client_ids_type>>::iterator itFilteredIds;
+    for (itFilteredIds=filteredIds.begin (); filteredIds.end ()!=itFilteredIds; ++itFilteredIds)
+    {
+      if (itFilteredIds->first->m_addresses == itFilter->second.m_addresses)
+      {
+        break;
+      }
+    }
+    if (filteredIds.end () == itFilteredIds)
+    {
+      itFilteredIds = filteredIds.insert (filteredIds.end (), std::make_pair (&itFilter->second, client_ids_type ()));
+    }
+    itFilteredIds->second.push_back (*itListenerId);
+  }
+
+  if (!unfilteredIds.empty ())
+  {
+    _OnDeviceUpdate (unfilteredIds, io_update);
+  }
+
+  // filter the values before serializing them
+  std::vector <std::pair <const ElementFilter*, client_ids_type>>::const_iterator itFilteredIds;
+  for (itFilteredIds=filteredIds.begin (); filteredIds.end ()!=itFilteredIds; ++itFilteredIds)
+  {
+    DeviceDataUpdate filteredUpdate;
+    filteredUpdate.m_index    = io_update.m_index;
+    filteredUpdate.m_deviceId = io_update.m_deviceId;
+    itFilteredIds->first->Apply (filteredUpdate.m_dataValues, io_update.m_dataValues);
+    if (!filteredUpdate.m_dataValues.empty ())
+    {
+      _OnDeviceUpdate (itFilteredIds->second, filteredUpdate);
+    }
+  }
+
+  if (!io_update.m_pMessage)
+  {
+    io_update.m_pMessage = std::make_shared <const DeviceUpdateMessage> (io_update);
+  }
+}
+
+/*!
+  \brief Sets the element filter of a listener on a device, an inactive filter removes it.
+
+  \return True if the filter changed.
 
-    // forward the update
-    _OnDeviceUpdate (listenerIds, dataUpdate);
+  \note Must be called with the device update buffer mutex locked.
+ */
+bool Switch::HttpInterface::_SetElementFilter (const client_id_type& i_listenerId, const uint32_t& i_deviceId, const ElementFilter& i_filter)
+{
+  bool changed = false;
+  if (i_filter.IsActive ())
+  {
+    ElementFilter& filter = m_pInterfaceState->m_elementFilters [i_deviceId][i_listenerId];
+    changed = !(filter == i_filter);
+    filter  = i_filter;
+  }
+  else
+  {
+    std::map <uint32_t, std::map <client_id_type, ElementFilter>>::iterator itDeviceFilters = m_pInterfaceState->m_elementFilters.find (i_deviceId);
+    if (m_pInterfaceState->m_elementFilters.end () == itDeviceFilters)
+    {
+      return false;
+    }
+    changed = (0 != itDeviceFilters->second.erase (i_listenerId));
+    if (itDeviceFilters->second.empty ())
+    {
+      m_pInterfaceState->m_elementFilters.erase (itDeviceFilters);
+    }
+  }
+
+  // note: group filters are resolved again when the device catalog changes
+  bool elementGroupFilters = false;
+  std::map <uint32_t, std::map <client_id_type, ElementFilter>>::const_iterator itDeviceFilters;
+  for (itDeviceFilters=m_pInterfaceState->m_elementFilters.begin (); (m_pInterfaceState->m_elementFilters.end ()!=itDeviceFilters) && !elementGroupFilters; ++itDeviceFilters)
+  {
+    std::map <client_id_type, ElementFilter>::const_iterator itFilter;
+    for (itFilter=itDeviceFilters->second.begin (); (itDeviceFilters->second.end ()!=itFilter) && !elementGroupFilters; ++itFilter)
+    {
+      elementGroupFilters = !itFilter->second.m_group.empty ();
+    }
+  }
+  m_pInterfaceState->m_elementGroupFilters = elementGroupFilters;
+
+  return changed;
+}
+
+/*!
+  \brief Collects the addresses of the elements of a group.
+
+  \param [out] o_addresses  The addresses of the elements in the group.
+  \param [in]  i_dataFormat The data format of the device.
+  \param [in]  i_group      The group.
+ */
+void Switch::HttpInterface::_ResolveElementGroup (std::set <uint32_t>& o_addresses, const Switch::Interface::Device::DataFormat& i_dataFormat, const std::string& i_group) const
+{
+  o_addresses.clear ();
+  std::list <Switch::Interface::Device::Value::DataFormat>::const_iterator itValues;
+  for (itValues=i_dataFormat.m_values.begin (); i_dataFormat.m_values.end ()!=itValues; ++itValues)
+  {
+    if (i_group == (*itValues).m_group)
+    {
+      o_addresses.insert ((*itValues).m_address);
+    }
+  }
+}
+
+/*!
+  \brief Resolves the element groups of the filters again when the device catalog changed.
+
+  Only done while listeners filter elements by group.
+ */
+void Switch::HttpInterface::_UpdateElementGroupFilters ()
+{
+  if (!m_pInterfaceState->m_elementGroupFilters)
+  {
+    return;
+  }
+
+  uint64_t version = 0;
+  if ((Switch::Interface::CR_OK != mr_controller.GetDeviceCatalogVersion (version)) || (version == m_pInterfaceState->m_elementGroupsVersion))
+  {
+    return;
+  }
+
+  // collect the devices with group filters
+  std::map <uint32_t, Switch::Interface::Device> devices;
+  {
+    std::unique_lock <std::mutex> deviceUpdateBufferLock (m_pInterfaceState->m_deviceUpdateBufferMutex);
+    std::map <uint32_t, std::map <client_id_type, ElementFilter>>::const_iterator itDeviceFilters;
+    for (itDeviceFilters=m_pInterfaceState->m_elementFilters.begin (); m_pInterfaceState->m_elementFilters.end ()!=itDeviceFilters; ++itDeviceFilters)
+    {
+      std::map <client_id_type, ElementFilter>::const_iterator itFilter;
+      for (itFilter=itDeviceFilters->second.begin (); itDeviceFilters->second.end ()!=itFilter; ++itFilter)
+      {
+        if (!itFilter->second.m_group.empty ())
+        {
+          devices [itDeviceFilters->first];
+          break;
+        }
+      }
+    }
+  }
+
+  // note: the controller is called without holding the buffer mutex
+  std::map <uint32_t, Switch::Interface::Device>::iterator itDevice = devices.begin ();
+  while (devices.end () != itDevice)
+  {
+    if (Switch::Interface::CR_OK != mr_controller.GetDeviceDetails (itDevice->second, itDevice->first))
+    {
+      devices.erase (itDevice++);
+    }
+    else
+    {
+      ++itDevice;
+    }
+  }
+
+  std::unique_lock <std::mutex> deviceUpdateBufferLock (m_pInterfaceState->m_deviceUpdateBufferMutex);
+  for (itDevice=devices.begin (); devices.end ()!=itDevice; ++itDevice)
+  {
+    std::map <uint32_t, std::map <client_id_type, ElementFilter>>::iterator itDeviceFilters = m_pInterfaceState->m_elementFilters.find (itDevice->first);
+    if (m_pInterfaceState->m_elementFilters.end () == itDeviceFilters)
+    {
+      continue;
+    }
+
+    std::map <client_id_type, ElementFilter>::iterator itFilter;
+    for (itFilter=itDeviceFilters->second.begin (); itDeviceFilters->second.end ()!=itFilter; ++itFilter)
+    {
+      if (!itFilter->second.m_group.empty ())
+      {
+        _ResolveElementGroup (itFilter->second.m_addresses, itDevice->second.m_dataFormat, itFilter->second.m_group);
+      }
+    }
   }
+  m_pInterfaceState->m_elementGroupsVersion = version;
 }
@@ -11,6 +11,7 @@
 
 // project includes
 #include "Switch_HttpInterfaceBase.h"
+#include "Switch_HttpConfiguration.h"
 
 // Switch includes
 #include <Switch_Base/Switch_CompilerConfiguration.h>
@@ -18,6 +19,10 @@
 
 // third-party includes
 #include <set>
+#include <list>
+#include <deque>
+#include <memory>
+#include <utility>
 
 namespace Switch
 {
@@ -31,9 +36,11 @@ namespace Switch
   {
   public:
 
+    class SharedState;
+
     // constructor and destructor
-    explicit HttpInterface (cppcms::service& i_service, FunctionalInterface& i_controller);
-    explicit HttpInterface (cppcms::service& i_service, FunctionalFacade i_controllerFacade);
+    explicit HttpInterface (cppcms::service& i_service, FunctionalInterface& i_controller, std::shared_ptr <SharedState> i_pSharedState);
+    explicit HttpInterface (cppcms::service& i_service, FunctionalFacade i_controllerFacade, std::shared_ptr <SharedState> i_pSharedState);
     virtual ~HttpInterface ();
 
     // copy constructor and assignment operator disabled
@@ -45,15 +52,26 @@ namespace Switch
     // system methods
     virtual Switch::Interface::eCallResult _AddDevice         (const Switch::Interface::Device::Id& i_deviceId);
     virtual Switch::Interface::eCallResult _EnumerateDevices  (std::list <Switch::Interface::Device::Summary>& o_deviceInfo);
+    virtual Switch::Interface::eCallResult _VisitDevices      (uint32_t& o_nextDeviceId, const device_summary_visitor_type& i_visitor, const Switch::Interface::Device::Id& i_firstDeviceId, const uint32_t& i_maxNrDevices);
     virtual Switch::Interface::eCallResult _GetDeviceDetails  (Switch::Interface::Device& o_deviceDetails, const Switch::Interface::Device::Id& i_deviceId);
+    virtual Switch::Interface::eCallResult _GetDeviceCatalogVersion (uint64_t& o_version);
     virtual Switch::Interface::eCallResult _GetDeviceValues   (std::list <Switch::Interface::Device::Value>& o_values, const Switch::Interface::Device::Id& i_deviceId);
+    virtual Switch::Interface::eCallResult _GetMultipleDeviceValues (std::map <Switch::Interface::Device::Id, std::list <Switch::Interface::Device::Value>>& o_values, const std::set <Switch::Interface::Device::Id>& i_deviceIds);
+    virtual Switch::Interface::eCallResult _GetDeviceReportedValues (std::list <Switch::Interface::Device::Value>& o_values, const Switch::Interface::Device::Id& i_deviceId);
     virtual Switch::Interface::eCallResult _SetDeviceValues   (const Switch::Interface::Device::Id& i_deviceId, const std::list <Switch::Interface::Device::Value>& i_values);
+    virtual Switch::Interface::eCallResult _SetMultipleDeviceValues (std::map <Switch::Interface::Device::Id, Switch::Interface::eCallResult>& o_results, uint32_t& o_sceneId, const std::map <Switch::Interface::Device::Id, std::list <Switch::Interface::Device::Value>>& i_values);
+    virtual Switch::Interface::eCallResult _GetSceneResults   (std::map <Switch::Interface::Device::Id, Switch::Interface::eCallResult>& o_results, const uint32_t& i_sceneId);
+    virtual Switch::Interface::eCallResult _GetCommandBacklog (uint32_t& o_nrQueuedCommands, uint32_t& o_drainTimeMicros);
+    virtual Switch::Interface::eCallResult _GetChangesSince   (uint64_t& o_version, std::list <Switch::Interface::Device::Summary>& o_devices, std::map <Switch::Interface::Device::Id, std::list <Switch::Interface::Device::Value>>& o_values, const uint64_t& i_version);
     //virtual Switch::Interface::eCallResult _SetDeviceProperties (const uint32_t& i_deviceId, const Switch_Device::Properties& i_deviceProperties);
 
     // subscription methods
-    virtual Switch::Interface::eCallResult _SubscribeToDeviceUpdates      (const client_id_type& i_listenerId, const Switch::Interface::Device::Id& i_deviceId);
-    virtual Switch::Interface::eCallResult _UnsubscribeFromDeviceUpdates  (const client_id_type& i_listenerId, const Switch::Interface::Device::Id& i_deviceId);
-    void _SendBufferedUpdatesToListener (const client_id_type& i_listenerId);
+    virtual Switch::Interface::eCallResult _SubscribeToDeviceUpdates      (const client_id_type& i_listenerId, const SubscriptionTopic& i_topic);
+    virtual Switch::Interface::eCallResult _UnsubscribeFromDeviceUpdates  (const client_id_type& i_listenerId, const SubscriptionTopic& i_topic);
+    virtual Switch::Interface::eCallResult _DefineDeviceGroup (const std::string& i_group, const std::set <Switch::Interface::Device::Id>& i_deviceIds);
+    virtual void _GetDeviceGroup (std::set <Switch::Interface::Device::Id>& o_deviceIds, const std::string& i_group);
+    void _SendBufferedUpdatesToListener (const client_id_type& i_listenerId, const uint64_t& i_cursor);
+    void _RemoveClient (const client_id_type& i_listenerId);
 
     // slots for controller signal
     void _OnControllerDeviceConnectionUpdateSignal (const Switch::Interface::Device::Id& i_deviceId, const Switch::Interface::Device::Connection& i_connection);
@@ -61,13 +79,71 @@ namespace Switch
 
   private:
 
+    /*!
+      \brief The latest updates of a device, kept for clients resuming their updates.
+     */
+    class DeviceChangeLog
+    {
+    public:
+
+      DeviceChangeLog ();
+
+      std::deque <std::pair <uint64_t, device_update_message_type>> m_entries;       ///< The serialized updates mapped to from their index, oldest first.
+      uint64_t                                                      m_trimmedIndex;  ///< Index of the latest update no longer in the log.
+    };
+
+    void _LogDeviceUpdate (const Switch::Interface::Device::Id& i_deviceId, const uint64_t& i_index, const device_update_message_type& i_pMessage);
+    void _SendMissedUpdatesToListener (const client_id_type& i_listenerId, const uint64_t& i_cursor);
+    void _PruneDeviceUpdateBuffers ();
+    void _UpdateDeviceProductTypes ();
+    void _OnFilteredDeviceUpdate (const client_ids_type& i_listenerIds, DeviceDataUpdate& io_update);
+    bool _SetElementFilter (const client_id_type& i_listenerId, const Switch::Interface::Device::Id& i_deviceId, const ElementFilter& i_filter);
+    void _ResolveElementGroup (std::set <uint32_t>& o_addresses, const Switch::Interface::Device::DataFormat& i_dataFormat, const std::string& i_group) const;
+    void _UpdateElementGroupFilters ();
+
+    void _Connect ();
+
     FunctionalInterface& mr_controller;
+    std::shared_ptr <SharedState> m_pInterfaceState;  ///< The subscriptions and update buffers, shared with the other instances of the interface.
+  };
+
+  /*!
+    \brief The subscriptions and update buffers of the interface, shared by all instances.
+
+    The controller's updates are handled by one of the instances only, so every
+    update is issued once, whichever instance the listeners subscribed through.
+   */
+  class HttpInterface::SharedState : public HttpInterfaceBase::SharedState
+  {
+  public:
+
+    SharedState ();
+    virtual ~SharedState ();
+
+  private:
+
+    friend class HttpInterface;
+
+    void _OnControllerDeviceConnectionUpdateSignal (const Switch::Interface::Device::Id& i_deviceId, const Switch::Interface::Device::Connection& i_connection);
+    void _OnControllerDeviceDataUpdateSignal (const Switch::Interface::Device::Id& i_deviceId, const std::list <Switch::Interface::Device::Value>& i_values);
 
-    std::map <client_id_type, std::set <Switch::Interface::Device::Id>> m_deviceIdsPerListener;  ///< maps the id of a listeners subscribed to updates of specific devices to those device's ids
-    std::map <Switch::Interface::Device::Id, std::set <client_id_type>> m_listenerIdsPerDevice;  ///< maps the id's of listeners subscribed to updates of a specific device on that device's id
+    Switch::ObserverConnection m_deviceConnectionUpdateConnection;  ///< connection to the controller's device connection updates
+    Switch::ObserverConnection m_deviceDataUpdateConnection;        ///< connection to the controller's device data updates
+    std::list <HttpInterface*> m_instances;     ///< The instances sharing the state, the first one handles the controller's updates.
+    std::mutex                 m_instancesMutex;  ///< Protects m_instances and the connections, held while an instance handles an update.
+
+    HttpSubscriptionIndex m_subscriptionIndex;  ///< The subscriptions of all listeners, to devices, groups, product types or all devices.
+    std::map <client_id_type, uint64_t> m_subscriptionStartIndices;  ///< Index of the last update issued before the latest subscription of a listener, mapped to from the listener ids.
+    client_ids_type       m_recipientIds;       ///< The listeners of the update being handled.
+    std::atomic <bool>    m_productTypeSubscriptions; ///< Flags if listeners subscribed to product types, which needs the product types of the devices.
+    std::atomic <uint64_t> m_productTypesVersion;     ///< The device catalog version the product types in the subscription index were read from.
+    std::map <Switch::Interface::Device::Id, std::map <client_id_type, ElementFilter>> m_elementFilters;  ///< The element filters of the listeners, mapped to from the device ids and the listener ids.
+    std::atomic <bool>    m_elementGroupFilters;      ///< Flags if listeners filter elements by group, which needs the data formats of the devices.
+    std::atomic <uint64_t> m_elementGroupsVersion;    ///< The device catalog version the element groups of the filters were resolved at.
     std::map <Switch::Interface::Device::Id, DeviceConnectionUpdate>  m_deviceConnectionUpdateBuffer;
     std::map <Switch::Interface::Device::Id, DeviceDataUpdate>        m_deviceDataUpdateBuffer;
-    mutable std::mutex m_deviceUpdateBufferMutex;
+    std::map <Switch::Interface::Device::Id, DeviceChangeLog>         m_deviceChangeLogs;  ///< The change log of every device with listeners.
+    std::mutex m_deviceUpdateBufferMutex;
   };
 }
 
@@ -13,6 +13,8 @@
 
 // project includes
 #include "Switch_HttpInterfaceTraits.h"
+#include "Switch_HttpCbor.h"
+#include "Switch_HttpConfiguration.h"
 
 // third-party includes
 #include <cppcms/http_response.h>
@@ -21,28 +23,63 @@
 #include <cppcms/url_mapper.h>
 #include <cppcms/session_interface.h>
 #include <cppcms/http_request.h>
+#include <cppcms/service.h>
+#include <sstream>
+#include <cctype>
+#include <chrono>
+#include <algorithm>
 
 // other declarations
 namespace args = std::placeholders;
 
 
-Switch::HttpInterfaceBase::HttpInterfaceBase (cppcms::service& i_service)
-: cppcms::rpc::json_rpc_server (i_service)
+Switch::HttpInterfaceBase::HttpInterfaceBase (cppcms::service& i_service, const std::shared_ptr <SharedState>& i_pSharedState)
+: cppcms::rpc::json_rpc_server (i_service),
+  m_pBatchCallResult (0x0),
+  m_pCodecWriter (0x0),
+  m_pSharedState (i_pSharedState)
 {
   // bind all rpc calls to methods
   //bind ("Help", cppcms::rpc::json_method (&Switch::HttpInterfaceBase::Help,  this), method_role);
 
-  bind ("Register",         cppcms::rpc::json_method (&Switch::HttpInterfaceBase::Register,          this), method_role);
-  bind ("AddDevice",        cppcms::rpc::json_method (&Switch::HttpInterfaceBase::AddDevice,         this), method_role);
-  bind ("EnumerateDevices", cppcms::rpc::json_method (&Switch::HttpInterfaceBase::EnumerateDevices,  this), method_role);
-  bind ("GetDeviceDetails", cppcms::rpc::json_method (&Switch::HttpInterfaceBase::GetDeviceDetails,  this), method_role);
-  bind ("GetDeviceValues",  cppcms::rpc::json_method (&Switch::HttpInterfaceBase::GetDeviceValues,   this), method_role);
-  bind ("SetDeviceValues",  cppcms::rpc::json_method (&Switch::HttpInterfaceBase::SetDeviceValues,   this), method_role);
+  _Bind ("Register",         cppcms::rpc::json_method (&Switch::HttpInterfaceBase::Register,          this), method_role);
+  _Bind ("AddDevice",        cppcms::rpc::json_method (&Switch::HttpInterfaceBase::AddDevice,         this), method_role);
+  _Bind ("EnumerateDevices", cppcms::rpc::json_method (&Switch::HttpInterfaceBase::EnumerateDevices,  this), method_role);
+  _Bind ("EnumerateDevicePage", cppcms::rpc::json_method (&Switch::HttpInterfaceBase::EnumerateDevicePage, this), method_role);
+  _Bind ("GetDeviceDetails", cppcms::rpc::json_method (&Switch::HttpInterfaceBase::GetDeviceDetails,  this), method_role);
+  _Bind ("GetDeviceValues",  cppcms::rpc::json_method (&Switch::HttpInterfaceBase::GetDeviceValues,   this), method_role);
+  _Bind ("GetMultipleDeviceValues", cppcms::rpc::json_method (&Switch::HttpInterfaceBase::GetMultipleDeviceValues, this), method_role);
+  _Bind ("GetDeviceGroupValues", cppcms::rpc::json_method (&Switch::HttpInterfaceBase::GetDeviceGroupValues, this), method_role);
+  _Bind ("GetDeviceReportedValues", cppcms::rpc::json_method (&Switch::HttpInterfaceBase::GetDeviceReportedValues, this), method_role);
+  _Bind ("SetDeviceValues",  cppcms::rpc::json_method (&Switch::HttpInterfaceBase::SetDeviceValues,   this), method_role);
+  _Bind ("SetMultipleDeviceValues", cppcms::rpc::json_method (&Switch::HttpInterfaceBase::SetMultipleDeviceValues, this), method_role);
+  _Bind ("GetSceneResults",  cppcms::rpc::json_method (&Switch::HttpInterfaceBase::GetSceneResults,   this), method_role);
+  _Bind ("GetCommandBacklog", cppcms::rpc::json_method (&Switch::HttpInterfaceBase::GetCommandBacklog, this), method_role);
+  _Bind ("GetChangesSince",  cppcms::rpc::json_method (&Switch::HttpInterfaceBase::GetChangesSince,   this), method_role);
   //bind ("SetDeviceProperties",          cppcms::rpc::json_method (&Switch::HttpInterfaceBase::SetDeviceProperties,           this), method_role);
 
-  bind ("SubscribeToDeviceUpdates", 	  cppcms::rpc::json_method (&Switch::HttpInterfaceBase::SubscribeToDeviceUpdates,      this), method_role);
-  bind ("UnsubscribeFromDeviceUpdates", cppcms::rpc::json_method (&Switch::HttpInterfaceBase::UnsubscribeFromDeviceUpdates,  this), method_role);
-  bind ("ListenToDeviceUpdates", 	      cppcms::rpc::json_method (&Switch::HttpInterfaceBase::ListenToDeviceUpdates,         this), method_role);
+  _Bind ("SubscribeToDeviceUpdates", 	  cppcms::rpc::json_method (&Switch::HttpInterfaceBase::SubscribeToDeviceUpdates,      this), method_role);
+  _Bind ("UnsubscribeFromDeviceUpdates", cppcms::rpc::json_method (&Switch::HttpInterfaceBase::UnsubscribeFromDeviceUpdates,  this), method_role);
+  _Bind ("SubscribeToDeviceElementUpdates",      cppcms::rpc::json_method (&Switch::HttpInterfaceBase::SubscribeToDeviceElementUpdates,      this), method_role);
+  _Bind ("SubscribeToDeviceElementGroupUpdates", cppcms::rpc::json_method (&Switch::HttpInterfaceBase::SubscribeToDeviceElementGroupUpdates, this), method_role);
+  _Bind ("SubscribeToDeviceGroupUpdates",     cppcms::rpc::json_method (&Switch::HttpInterfaceBase::SubscribeToDeviceGroupUpdates,     this), method_role);
+  _Bind ("UnsubscribeFromDeviceGroupUpdates", cppcms::rpc::json_method (&Switch::HttpInterfaceBase::UnsubscribeFromDeviceGroupUpdates, this), method_role);
+  _Bind ("SubscribeToProductTypeUpdates",     cppcms::rpc::json_method (&Switch::HttpInterfaceBase::SubscribeToProductTypeUpdates,     this), method_role);
+  _Bind ("UnsubscribeFromProductTypeUpdates", cppcms::rpc::json_method (&Switch::HttpInterfaceBase::UnsubscribeFromProductTypeUpdates, this), method_role);
+  _Bind ("SubscribeToAllDeviceUpdates",       cppcms::rpc::json_method (&Switch::HttpInterfaceBase::SubscribeToAllDeviceUpdates,       this), method_role);
+  _Bind ("UnsubscribeFromAllDeviceUpdates",   cppcms::rpc::json_method (&Switch::HttpInterfaceBase::UnsubscribeFromAllDeviceUpdates,   this), method_role);
+  _Bind ("DefineDeviceGroup",                 cppcms::rpc::json_method (&Switch::HttpInterfaceBase::DefineDeviceGroup,                 this), method_role);
+  _Bind ("ListenToDeviceUpdates", 	      cppcms::rpc::json_method (&Switch::HttpInterfaceBase::ListenToDeviceUpdates,         this), method_role);
+  _Bind ("SetDeviceUpdateInterval",           cppcms::rpc::json_method (&Switch::HttpInterfaceBase::SetDeviceUpdateInterval,           this), method_role);
+
+  // read the calls carrying or returning many values straight from the request body
+  _BindCodec ("EnumerateDevicePage",      &Switch::HttpInterfaceBase::_DecodeEnumerateDevicePage);
+  _BindCodec ("GetDeviceValues",          &Switch::HttpInterfaceBase::_DecodeGetDeviceValues);
+  _BindCodec ("GetMultipleDeviceValues",  &Switch::HttpInterfaceBase::_DecodeGetMultipleDeviceValues);
+  _BindCodec ("GetDeviceGroupValues",     &Switch::HttpInterfaceBase::_DecodeGetDeviceGroupValues);
+  _BindCodec ("GetChangesSince",          &Switch::HttpInterfaceBase::_DecodeGetChangesSince);
+  _BindCodec ("SetDeviceValues",          &Switch::HttpInterfaceBase::_DecodeSetDeviceValues);
+  _BindCodec ("SetMultipleDeviceValues",  &Switch::HttpInterfaceBase::_DecodeSetMultipleDeviceValues);
 
   dispatcher().assign ("/Help", &Switch::HttpInterfaceBase::Help, this);
   mapper().assign ("Help, /Help");
@@ -50,6 +87,15 @@ Switch::HttpInterfaceBase::HttpInterfaceBase (cppcms::service& i_service)
   dispatcher().assign ("/About", &Switch::HttpInterfaceBase::About, this);
   mapper().assign ("About, /About");
 
+  dispatcher().assign ("/DeviceUpdates", &Switch::HttpInterfaceBase::StreamDeviceUpdates, this);
+  mapper().assign ("DeviceUpdates, /DeviceUpdates");
+
+  dispatcher().assign ("/Devices", &Switch::HttpInterfaceBase::ServeDevices, this);
+  mapper().assign ("Devices, /Devices");
+
+  dispatcher().assign ("/Devices/(\\d+)", &Switch::HttpInterfaceBase::ServeDevice, this, 1);
+  mapper().assign ("Device, /Devices/{1}");
+
   /*dispatcher().assign ("", &Switch::HttpInterfaceBase::About, this);
   mapper().assign ("");*/
 
@@ -61,6 +107,17 @@ Switch::HttpInterfaceBase::~HttpInterfaceBase ()
 {
 }
 
+Switch::HttpInterfaceBase::SharedState::SharedState ()
+: m_nextIdleClientsRemoval (HttpClientRegistry::clock_type::now ()),
+  m_firstUpdateIndex (static_cast <uint64_t> (std::chrono::duration_cast <std::chrono::microseconds> (std::chrono::system_clock::now ().time_since_epoch ()).count ())),
+  m_nextUpdateIndex (m_firstUpdateIndex)
+{
+}
+
+Switch::HttpInterfaceBase::SharedState::~SharedState ()
+{
+}
+
 void Switch::HttpInterfaceBase::main (std::string i_string)
 {
   SWITCH_DEBUG_MSG_2 ("RPC called from %s: %s\n", request ().getenv ("HTTP_ORIGIN").c_str (), i_string.c_str ());
@@ -68,7 +125,8 @@ void Switch::HttpInterfaceBase::main (std::string i_string)
   // handle CORS (Cross Origin Resource Sharing)
   response ().set_header ("Access-Control-Allow-Origin", request ().getenv ("HTTP_ORIGIN"));
   response ().set_header ("Access-Control-Allow-Credentials", "true");
-  response ().set_header ("Access-Control-Allow-Headers", "Content-Type");
+  response ().set_header ("Access-Control-Allow-Headers", "Authorization, Content-Type, If-None-Match");
+  response ().set_header ("Access-Control-Expose-Headers", "ETag");
   if ("OPTIONS" == request ().request_method ())
   {
     // this was a pure options query
@@ -76,9 +134,28 @@ void Switch::HttpInterfaceBase::main (std::string i_string)
   }
   else if ("GET" == request ().request_method ())
   {
-    // this is a long polling call
+    // this is a long polling call or a device update stream
     SWITCH_DEBUG_MSG_0 ("GET\n");
   }
+
+  // dispatch the urls that are no rpc calls
+  if (!i_string.empty () && dispatcher ().dispatch (i_string))
+  {
+    return;
+  }
+
+  // dispatch JSON-RPC 2.0 batches and binary calls to the bound methods
+  if (_IsBatch () || _IsCborRequest () || (_AcceptsCbor () && ("POST" == request ().request_method ())))
+  {
+    _HandleBatch ();
+    return;
+  }
+
+  // read single calls of methods with a codec without building json values
+  if (_HandleCodecCall ())
+  {
+    return;
+  }
   cppcms::rpc::json_rpc_server::main (i_string);
 }
 
@@ -94,6 +171,89 @@ void Switch::HttpInterfaceBase::Help ()
   printf ("Help called\n");
   response().set_html_header ();
   response().out() << "<h1>This is the switch system interface help</h1>\n";
+  response().out() << "<h2>Clients</h2>\n";
+  response().out() << "<p>Register returns the \"token\" of the client. Send it in an Authorization: Bearer &lt;token&gt; "
+                      "header, or as the token query parameter where headers can not be set, e.g. GET /DeviceUpdates?token=... "
+                      "The token is kept in the session cookie as well, clients sending neither are identified by their cookie. "
+                      "Clients without calls or open connections for " << HTTP_CLIENT_IDLE_TIMEOUT_S << " seconds are removed "
+                      "with their subscriptions; their calls then fail with \"client not registered\" until they register again.</p>\n";
+  response().out() << "<h2>Batches</h2>\n";
+  response().out() << "<p>Several calls can be sent in one request as a JSON-RPC 2.0 batch: a JSON array of "
+                      "{\"jsonrpc\": \"2.0\", \"method\": ..., \"params\": [...], \"id\": ...} objects. "
+                      "The calls are executed in order and answered with one array holding a "
+                      "{\"jsonrpc\": \"2.0\", \"result\" or \"error\": ..., \"id\": ...} object per call. "
+                      "Calls without an id are notifications and are not answered. "
+                      "ListenToDeviceUpdates can not be called in a batch.</p>\n";
+  response().out() << "<h2>Subscriptions</h2>\n";
+  response().out() << "<p>Besides single devices, clients can subscribe to the updates of a device group "
+                      "(SubscribeToDeviceGroupUpdates), of all devices of a product type (SubscribeToProductTypeUpdates) "
+                      "or of all devices (SubscribeToAllDeviceUpdates). Groups are shared by all clients and defined with "
+                      "DefineDeviceGroup (group, [deviceId, ...]), an empty list removes the group. An update is sent once "
+                      "to a client, however many of its subscriptions include the device.</p>\n";
+  response().out() << "<p>SubscribeToDeviceElementUpdates (deviceId, [address, ...]) and SubscribeToDeviceElementGroupUpdates "
+                      "(deviceId, group) subscribe to some elements of a device only, given by their address or by the group "
+                      "in the device's data format. Data updates of the device then only carry the values of these elements "
+                      "and are not sent when none of them changed, however the client subscribed to the device. Subscribing "
+                      "to the device again replaces the filter, SubscribeToDeviceUpdates removes it.</p>\n";
+  response().out() << "<h2>Resuming updates</h2>\n";
+  response().out() << "<p>Every device update carries a global, increasing \"index\", which keeps increasing across restarts "
+                      "of the server. ListenToDeviceUpdates takes the index of the last update received and sends all later updates "
+                      "of the subscribed devices, or a \"resyncRequired\" event when they are no longer available, as after a restart. "
+                      "Pass 0 to receive the latest state instead. "
+                      "The /DeviceUpdates stream takes the index as its \"cursor\" query parameter, or else from the Last-Event-ID "
+                      "header: the id of its events is the index of their update, such that a reconnecting EventSource resumes "
+                      "where it left off.</p>\n";
+  response().out() << "<h2>Update rate</h2>\n";
+  response().out() << "<p>SetDeviceUpdateInterval (milliseconds) sets the minimum interval between the device updates sent "
+                      "to a client, both long-polled and streamed. The updates issued meanwhile are coalesced: the client "
+                      "gets one connection update and one data update per device, with the latest connection and the latest "
+                      "value of every element, carrying the index of the latest update merged. Pass 0 to receive every update "
+                      "as it is issued. A client whose /DeviceUpdates stream falls too far behind is given an interval of "
+                      << HTTP_BACKLOGGED_STREAM_UPDATE_INTERVAL_MS << " milliseconds, unless it set one.</p>\n";
+  response().out() << "<h2>Scenes</h2>\n";
+  response().out() << "<p>SetMultipleDeviceValues ([{\"deviceId\": deviceId, \"values\": [values]}, ...]) sets the values of "
+                      "several devices, transmitted to them as one batch. The \"deviceResults\" tell per device if its values "
+                      "were accepted (0) or the device is unknown; they do not tell if the device applied the values, which "
+                      "happens later. An accepted scene returns a \"sceneId\". GetSceneResults (sceneId) returns the "
+                      "\"deviceResults\" of the scene as the devices confirm their values: 9 (pending) until a device "
+                      "confirmed them, 0 once it did, 10 (not confirmed) if the controller gave up retransmitting them. "
+                      "Only the most recent scenes are kept, a forgotten scene returns result -1.</p>\n";
+  response().out() << "<h2>Backpressure</h2>\n";
+  response().out() << "<p>SetDeviceValues and SetMultipleDeviceValues are rejected with result 8 (busy) while the commands "
+                      "queued for the devices exceed the controller's limits, the values of a scene being rejected as a whole. "
+                      "Outside of batches the response then has status 503 and a Retry-After header; the result also carries "
+                      "\"retryAfter\", the milliseconds after which to retry. Values for a device with queued commands are "
+                      "merged into them and always accepted. GetCommandBacklog returns the \"queuedCommands\" and their "
+                      "estimated \"drainTime\" in milliseconds.</p>\n";
+  response().out() << "<h2>Caching</h2>\n";
+  response().out() << "<p>The results of EnumerateDevices and GetDeviceDetails are also available as GET /Devices and "
+                      "GET /Devices/&lt;deviceId&gt;. Both carry an ETag which changes when devices are added or identified, or "
+                      "when their connection state changes. Send it back in If-None-Match to get a 304 Not Modified while "
+                      "the result is unchanged.</p>\n";
+  response().out() << "<h2>Paging</h2>\n";
+  response().out() << "<p>EnumerateDevicePage (cursor, limit) returns at most limit devices, up to " << HTTP_MAX_DEVICE_PAGE_SIZE << ", "
+                      "starting at the cursor. Pass 0 for the first page and the returned \"nextCursor\" for the next; it is 0 "
+                      "after the last page. GET /Devices?cursor=&lt;cursor&gt;&amp;limit=&lt;limit&gt; returns the same pages. "
+                      "Pages are written while the devices are visited and are not cached.</p>\n";
+  response().out() << "<h2>Snapshots</h2>\n";
+  response().out() << "<p>GetMultipleDeviceValues (deviceIds) and GetDeviceGroupValues (group) read the desired values of up "
+                      "to " << HTTP_MAX_SNAPSHOT_SIZE << " devices at once, consistent with each other. The \"snapshot\" "
+                      "holds an array per device: its id followed by the address, magic number and value of each element. "
+                      "Unknown devices are left out.</p>\n";
+  response().out() << "<h2>Delta synchronization</h2>\n";
+  response().out() << "<p>GetChangesSince (version) returns the \"devices\" added, identified or reconnected and the changed "
+                      "\"deviceValues\" since a version, with the \"version\" to pass on the next call. Only the elements changed "
+                      "are returned. Pass 0, or a version from before the controller started, to get all devices and values.</p>\n";
+  response().out() << "<h2>Binary encoding</h2>\n";
+  response().out() << "<p>Calls, single or batched, may be sent as CBOR (RFC 7049) with content type application/cbor. "
+                      "Responses and long-polled device updates are CBOR if the request accepts application/cbor. The "
+                      "values are those of the json text; numbers without fraction are integers and object members named "
+                      "after interface fields are keyed by their number in the field dictionary: address 0, magicNumber 1, "
+                      "value 2, deviceId 3, values 4, result 5, index 6, event 7, data 8, connection 9, online 10, devices 11, "
+                      "deviceValues 12, deviceDetails 13, productInfo 14, connectionInfo 15, dataFormat 16, brandId 17, "
+                      "brandName 18, productId 19, productType 20, productVersion 21, name 22, description 23, minValue 24, "
+                      "maxValue 25, results 26, jsonrpc 27, id 28, method 29, params 30, error 31, code 32, message 33, "
+                      "clientId 34, group 35, retryAfter 36, queuedCommands 37, drainTime 38, nextCursor 39, token 40, version 41, snapshot 42. The /DeviceUpdates stream is always json text.</p>\n";
 }
 
 void Switch::HttpInterfaceBase::Register ()
@@ -104,28 +264,27 @@ void Switch::HttpInterfaceBase::Register ()
 
     // 1. Validate the arguments
 
-    // 2. Register the client
-    client_id_type clientId;
-    if (!session ().is_set ("clientId"))
-    {
-      // generate new client id and set in the session
-      _GenerateClientId (clientId);
-      session ().set ("clientId", clientId);
-    }
-    else
+    // 2. Register the client, a registered client keeps its token
+    client_id_type clientId = 0;
+    std::string token = _GetClientToken ();
+    if (!_GetClientId (clientId))
     {
-      // load the listener id from the session
-      clientId = session ().get <client_id_type> ("clientId");
+      // note: the token is kept in the session as well, for clients identified by their cookie
+      std::unique_lock <std::mutex> clientRegistryLock (m_pSharedState->m_clientRegistryMutex);
+      clientId = m_pSharedState->m_clientRegistry.Register (token, HttpClientRegistry::clock_type::now ());
+      clientRegistryLock.unlock ();
+      session ().set ("token", token);
     }
 
     // 3. Send response
     cppcms::json::value result;
     result.set ("result", Switch::Interface::CR_OK);
-    cppcms::rpc::json_rpc_server::return_result (result);
+    result.set ("token", token);
+    _ReturnResult (result);
   }
   catch (...)
   {
-    cppcms::rpc::json_rpc_server::return_error ("error");
+    _ReturnError ("error");
   }
 }
 
@@ -134,9 +293,9 @@ void Switch::HttpInterfaceBase::AddDevice (const uint32_t& i_deviceId)
   try
   {
     // 0. Validate the call
-    if (!session ().is_set ("clientId"))
+    if (!_IsClientRegistered ())
     {
-      cppcms::rpc::json_rpc_server::return_error ("client not registered");
+      _ReturnError ("client not registered");
     }
 
     // 1. Validate the arguments
@@ -147,11 +306,11 @@ void Switch::HttpInterfaceBase::AddDevice (const uint32_t& i_deviceId)
     // 3. Send response
     cppcms::json::value result;
     result.set ("result", callResult);
-    cppcms::rpc::json_rpc_server::return_result (result);
+    _ReturnResult (result);
   }
   catch (...)
   {
-    cppcms::rpc::json_rpc_server::return_error ("error");
+    _ReturnError ("error");
   }
 }
 
@@ -160,26 +319,86 @@ void Switch::HttpInterfaceBase::EnumerateDevices ()
   try
   {
     // 0. Validate the call
-    if (!session ().is_set ("clientId"))
+    if (!_IsClientRegistered ())
+    {
+      _ReturnError ("client not registered");
+    }
+
+    // 1. Validate the arguments
+
+    // 2. Call the framework, unless the response is cached
+    cached_response_type pResponse = _GetDevicesResponse ();
+
+    // 3. Send response
+    if (0x0 == m_pBatchCallResult)
+    {
+      response ().set_header ("ETag", pResponse->m_etag);
+    }
+    _ReturnResult (pResponse->m_result);
+  }
+  catch (...)
+  {
+    _ReturnError ("error");
+  }
+}
+
+/*!
+  \brief Returns a page of the devices, starting at a cursor returned by the previous page.
+
+  Within a codec call the page is written to the response while the devices are visited,
+  batched and binary calls build it as a json value.
+
+  \param [in] i_cursor The cursor of the page, 0 for the first page.
+  \param [in] i_limit  The maximum number of devices in the page.
+ */
+void Switch::HttpInterfaceBase::EnumerateDevicePage (const uint32_t& i_cursor, const uint32_t& i_limit)
+{
+  try
+  {
+    // 0. Validate the call
+    if (!_IsClientRegistered ())
     {
-      cppcms::rpc::json_rpc_server::return_error ("client not registered");
+      _ReturnError ("client not registered");
+      return;
     }
 
     // 1. Validate the arguments
+    if ((0 == i_limit) || (HTTP_MAX_DEVICE_PAGE_SIZE < i_limit))
+    {
+      _ReturnError ("invalid limit");
+      return;
+    }
 
     // 2. Call the framework
-    std::list <Switch::Interface::Device::Summary> outDevices;
-    Switch::Interface::eCallResult callResult = _EnumerateDevices (outDevices);
+    cppcms::json::value devices;
+    cppcms::json::array& deviceArray = devices.array ();
+    uint32_t nextCursor = 0;
+    Switch::Interface::eCallResult callResult = _VisitDevices
+    (
+      nextCursor,
+      [&deviceArray] (const Switch::Interface::Device::Summary& i_summary)
+      {
+        deviceArray.push_back (cppcms::json::value ());
+        deviceArray.back ().set_value (i_summary);
+      },
+      i_cursor,
+      i_limit
+    );
 
     // 3. Send response
     cppcms::json::value result;
     result.set ("result", callResult);
-    result.set ("devices", outDevices);
-    cppcms::rpc::json_rpc_server::return_result (result);
+    result.set ("devices", devices);
+    result.set ("nextCursor", nextCursor);
+    _ReturnResult (result);
+  }
+  catch (std::exception& i_exception)
+  {
+    _ReturnError (i_exception.what ());
   }
   catch (...)
   {
-    cppcms::rpc::json_rpc_server::return_error ("error");
+    _ReturnError ("error");
   }
 }
 
@@ -188,54 +407,161 @@ void Switch::HttpInterfaceBase::GetDeviceDetails (const uint32_t& i_deviceId)
   try
   {
     // 0. Validate the call
-    if (!session ().is_set ("clientId"))
+    if (!_IsClientRegistered ())
+    {
+      _ReturnError ("client not registered");
+    }
+
+    // 1. Validate the arguments
+
+    // 2. Call the framework, unless the response is cached
+    cached_response_type pResponse = _GetDeviceDetailsResponse (i_deviceId);
+
+    // 3. Send response
+    if (0x0 == m_pBatchCallResult)
+    {
+      response ().set_header ("ETag", pResponse->m_etag);
+    }
+    _ReturnResult (pResponse->m_result);
+  }
+  catch (...)
+  {
+    _ReturnError ("error");
+  }
+}
+
+void Switch::HttpInterfaceBase::GetDeviceValues (const uint32_t& i_deviceId)
+{
+  try
+  {
+    // 0. Validate the call
+    if (!_IsClientRegistered ())
     {
-      cppcms::rpc::json_rpc_server::return_error ("client not registered");
+      _ReturnError ("client not registered");
     }
 
     // 1. Validate the arguments
 
     // 2. Call the framework
-    Switch::Interface::Device outDeviceDetails;
-    Switch::Interface::eCallResult callResult = _GetDeviceDetails (outDeviceDetails, i_deviceId);
+    std::list <Switch::Interface::Device::Value> outValues;
+    Switch::Interface::eCallResult callResult = _GetDeviceValues (outValues, i_deviceId);
 
     // 3. Send response
     cppcms::json::value result;
     result.set ("result", callResult);
-    result.set ("deviceDetails", outDeviceDetails);
-    cppcms::rpc::json_rpc_server::return_result (result);
+    result.set ("deviceValues", outValues);
+    _ReturnResult (result);
   }
   catch (...)
   {
-    cppcms::rpc::json_rpc_server::return_error ("error");
+    _ReturnError ("error");
   }
 }
 
-void Switch::HttpInterfaceBase::GetDeviceValues (const uint32_t& i_deviceId)
+/*!
+  \brief Returns the desired values of several devices, read at once.
+
+  \param [in] i_deviceIds The ids of the devices.
+ */
+void Switch::HttpInterfaceBase::GetMultipleDeviceValues (const std::list <uint32_t>& i_deviceIds)
+{
+  try
+  {
+    // 0. Validate the call
+    if (!_IsClientRegistered ())
+    {
+      _ReturnError ("client not registered");
+      return;
+    }
+
+    // 1. Validate the arguments
+    std::set <uint32_t> deviceIds (i_deviceIds.begin (), i_deviceIds.end ());
+    if (HTTP_MAX_SNAPSHOT_SIZE < deviceIds.size ())
+    {
+      _ReturnError ("too many devices");
+      return;
+    }
+
+    // 2. Call the framework and 3. send response
+    cppcms::json::value result;
+    _GetDeviceValuesSnapshot (result, deviceIds);
+    _ReturnResult (result);
+  }
+  catch (std::exception& i_exception)
+  {
+    _ReturnError (i_exception.what ());
+  }
+  catch (...)
+  {
+    _ReturnError ("error");
+  }
+}
+
+/*!
+  \brief Returns the desired values of the devices of a group, read at once.
+
+  \param [in] i_group The name of the group, as defined by DefineDeviceGroup.
+ */
+void Switch::HttpInterfaceBase::GetDeviceGroupValues (const std::string& i_group)
+{
+  try
+  {
+    // 0. Validate the call
+    if (!_IsClientRegistered ())
+    {
+      _ReturnError ("client not registered");
+      return;
+    }
+
+    // 1. Validate the arguments
+    std::set <uint32_t> deviceIds;
+    _GetDeviceGroup (deviceIds, i_group);
+    if (HTTP_MAX_SNAPSHOT_SIZE < deviceIds.size ())
+    {
+      _ReturnError ("too many devices");
+      return;
+    }
+
+    // 2. Call the framework and 3. send response
+    cppcms::json::value result;
+    _GetDeviceValuesSnapshot (result, deviceIds);
+    _ReturnResult (result);
+  }
+  catch (std::exception& i_exception)
+  {
+    _ReturnError (i_exception.what ());
+  }
+  catch (...)
+  {
+    _ReturnError ("error");
+  }
+}
+
+void Switch::HttpInterfaceBase::GetDeviceReportedValues (const uint32_t& i_deviceId)
 {
   try
   {
     // 0. Validate the call
-    if (!session ().is_set ("clientId"))
+    if (!_IsClientRegistered ())
     {
-      cppcms::rpc::json_rpc_server::return_error ("client not registered");
+      _ReturnError ("client not registered");
     }
 
     // 1. Validate the arguments
 
     // 2. Call the framework
     std::list <Switch::Interface::Device::Value> outValues;
-    Switch::Interface::eCallResult callResult = _GetDeviceValues (outValues, i_deviceId);
+    Switch::Interface::eCallResult callResult = _GetDeviceReportedValues (outValues, i_deviceId);
 
     // 3. Send response
     cppcms::json::value result;
     result.set ("result", callResult);
     result.set ("deviceValues", outValues);
-    cppcms::rpc::json_rpc_server::return_result (result);
+    _ReturnResult (result);
   }
   catch (...)
   {
-    cppcms::rpc::json_rpc_server::return_error ("error");
+    _ReturnError ("error");
   }
 }
 
@@ -244,9 +570,9 @@ void Switch::HttpInterfaceBase::SetDeviceValues (const uint32_t& i_deviceId, con
   try
   {
     // 0. Validate the call
-    if (!session ().is_set ("clientId"))
+    if (!_IsClientRegistered ())
     {
-      cppcms::rpc::json_rpc_server::return_error ("client not registered");
+      _ReturnError ("client not registered");
     }
 
     // 1. Validate the arguments
@@ -257,280 +583,2263 @@ void Switch::HttpInterfaceBase::SetDeviceValues (const uint32_t& i_deviceId, con
     // 3. Send response
     cppcms::json::value result;
     result.set ("result", callResult);
-    cppcms::rpc::json_rpc_server::return_result (result);
+    if (Switch::Interface::CR_BUSY == callResult)
+    {
+      _ReturnBusy (result);
+      return;
+    }
+    _ReturnResult (result);
   }
   catch (...)
   {
-    cppcms::rpc::json_rpc_server::return_error ("error");
+    _ReturnError ("error");
   }
 }
 
-/*void Switch::HttpInterfaceBase::SetDeviceProperties (const uint32_t& i_deviceId, const Switch_Device::Properties& i_deviceProperties)
+/*!
+  \brief Sets the values of several devices at once, as a scene.
+
+  The result of every device tells if its values were accepted, not if the device
+  applied them: the values are transmitted after the call returns. The returned
+  scene id is passed to GetSceneResults to learn when the devices applied them.
+ */
+void Switch::HttpInterfaceBase::SetMultipleDeviceValues (const std::map <uint32_t, std::list <Switch::Interface::Device::Value>>& i_deviceValues)
 {
   try
   {
     // 0. Validate the call
-    if (!session ().is_set ("clientId"))
+    if (!_IsClientRegistered ())
     {
-      cppcms::rpc::json_rpc_server::return_error ("client not registered");
+      _ReturnError ("client not registered");
+      return;
     }
 
     // 1. Validate the arguments
 
     // 2. Call the framework
-    Switch::Interface::eCallResult callResult = _SetDeviceProperties (i_deviceId, i_deviceProperties);
+    std::map <uint32_t, Switch::Interface::eCallResult> outResults;
+    uint32_t sceneId = 0;
+    Switch::Interface::eCallResult callResult = _SetMultipleDeviceValues (outResults, sceneId, i_deviceValues);
 
     // 3. Send response
     cppcms::json::value result;
     result.set ("result", callResult);
-    cppcms::rpc::json_rpc_server::return_result (result);
+    result.set ("deviceResults", outResults);
+    if (Switch::Interface::CR_OK == callResult)
+    {
+      result.set ("sceneId", sceneId);
+    }
+    if (Switch::Interface::CR_BUSY == callResult)
+    {
+      _ReturnBusy (result);
+      return;
+    }
+    _ReturnResult (result);
   }
   catch (...)
   {
-    cppcms::rpc::json_rpc_server::return_error ("error");
+    _ReturnError ("error");
   }
-}*/
+}
 
-void Switch::HttpInterfaceBase::SubscribeToDeviceUpdates (const uint32_t& i_deviceId)
+/*!
+  \brief Returns the result per device of a scene set by SetMultipleDeviceValues.
+
+  \param [in] i_sceneId The scene id returned by SetMultipleDeviceValues.
+ */
+void Switch::HttpInterfaceBase::GetSceneResults (const uint32_t& i_sceneId)
 {
   try
   {
     // 0. Validate the call
-    if (!session ().is_set ("clientId"))
+    if (!_IsClientRegistered ())
     {
-      cppcms::rpc::json_rpc_server::return_error ("client not registered");
+      _ReturnError ("client not registered");
+      return;
     }
-    client_id_type clientId = session ().get <client_id_type> ("clientId");
 
     // 1. Validate the arguments
 
     // 2. Call the framework
-    Switch::Interface::eCallResult callResult = _SubscribeToDeviceUpdates (clientId, i_deviceId);
+    std::map <uint32_t, Switch::Interface::eCallResult> outResults;
+    Switch::Interface::eCallResult callResult = _GetSceneResults (outResults, i_sceneId);
 
     // 3. Send response
     cppcms::json::value result;
     result.set ("result", callResult);
-    cppcms::rpc::json_rpc_server::return_result (result);
+    if (Switch::Interface::CR_OK == callResult)
+    {
+      result.set ("deviceResults", outResults);
+    }
+    _ReturnResult (result);
   }
   catch (std::exception& i_exception)
   {
-    cppcms::rpc::json_rpc_server::return_error (i_exception.what ());
+    _ReturnError (i_exception.what ());
   }
   catch (...)
   {
-    cppcms::rpc::json_rpc_server::return_error ("error");
+    _ReturnError ("error");
   }
 }
 
-void Switch::HttpInterfaceBase::UnsubscribeFromDeviceUpdates (const uint32_t& i_deviceId)
+/*!
+  \brief Returns the number of commands queued for the devices and the estimated time to transmit them.
+ */
+void Switch::HttpInterfaceBase::GetCommandBacklog ()
 {
   try
   {
     // 0. Validate the call
-    if (!session ().is_set ("clientId"))
+    if (!_IsClientRegistered ())
     {
-      cppcms::rpc::json_rpc_server::return_error ("client not registered");
+      _ReturnError ("client not registered");
+      return;
     }
-    client_id_type clientId = session ().get <client_id_type> ("clientId");
 
     // 1. Validate the arguments
 
     // 2. Call the framework
-    Switch::Interface::eCallResult callResult = _UnsubscribeFromDeviceUpdates (clientId, i_deviceId);
+    uint32_t nrQueuedCommands = 0;
+    uint32_t drainTimeMicros  = 0;
+    Switch::Interface::eCallResult callResult = _GetCommandBacklog (nrQueuedCommands, drainTimeMicros);
 
     // 3. Send response
     cppcms::json::value result;
     result.set ("result", callResult);
-    cppcms::rpc::json_rpc_server::return_result (result);
+    if (Switch::Interface::CR_OK == callResult)
+    {
+      result.set ("queuedCommands", nrQueuedCommands);
+      result.set ("drainTime", (drainTimeMicros + 999) / 1000);
+    }
+    _ReturnResult (result);
   }
   catch (std::exception& i_exception)
   {
-    cppcms::rpc::json_rpc_server::return_error (i_exception.what ());
+    _ReturnError (i_exception.what ());
   }
   catch (...)
   {
-    cppcms::rpc::json_rpc_server::return_error ("error");
+    _ReturnError ("error");
   }
 }
 
-void Switch::HttpInterfaceBase::ListenToDeviceUpdates ()
+/*!
+  \brief Returns the devices and values changed since a version returned by a previous call.
+
+  \param [in] i_version The version of the previous call, 0 to get all devices and values.
+ */
+void Switch::HttpInterfaceBase::GetChangesSince (const uint64_t& i_version)
 {
   try
   {
     // 0. Validate the call
-    if (!session ().is_set ("clientId"))
+    if (!_IsClientRegistered ())
     {
-      cppcms::rpc::json_rpc_server::return_error ("client not registered");
+      _ReturnError ("client not registered");
       return;
     }
-    client_id_type clientId = session ().get <client_id_type> ("clientId");
 
     // 1. Validate the arguments
 
-    // 2. Append the context to the map of device update listener
-    booster::shared_ptr <cppcms::rpc::json_call> listenerCall = release_call ();
-    listenerCall->context ().response ().io_mode (cppcms::http::response::asynchronous);
-    std::pair <device_update_listeners_type::iterator, bool> insertionResult ({ m_deviceUpdateListeners.end (), false });
-    {
-      std::unique_lock <std::mutex> deviceUpdateListenersLock (m_deviceUpdateListenersMutex);
-      insertionResult = m_deviceUpdateListeners.insert ({ clientId, listenerCall });
-    }
-    // note: is access to m_deviceUpdateListeners thread-safe?
-    if (!insertionResult.second)
+    // 2. Call the framework
+    uint64_t version = 0;
+    std::list <Switch::Interface::Device::Summary> outDevices;
+    std::map <Switch::Interface::Device::Id, std::list <Switch::Interface::Device::Value>> outValues;
+    Switch::Interface::eCallResult callResult = _GetChangesSince (version, outDevices, outValues, i_version);
+
+    // 3. Send response
+    cppcms::json::value result;
+    result.set ("result", callResult);
+    if (Switch::Interface::CR_OK == callResult)
     {
-      cppcms::rpc::json_rpc_server::return_error ("error, listener with same clientId already listening");
-      return;
+      result.set ("version", version);
+      result.set ("devices", outDevices);
+      result.set ("deviceValues", outValues);
     }
-
-    // 3. Handle connection time-outs
-    listenerCall->context ().async_on_peer_reset
-    (
-      std::bind (&Switch::HttpInterfaceBase::_RemoveListenerContext, this, clientId)
-    );
-
-    // 4. Send buffered updates
-    _SendBufferedUpdatesToListener (clientId);
+    _ReturnResult (result);
   }
   catch (std::exception& i_exception)
   {
-    cppcms::rpc::json_rpc_server::return_error (i_exception.what ());
+    _ReturnError (i_exception.what ());
   }
   catch (...)
   {
-    cppcms::rpc::json_rpc_server::return_error ("error");
+    _ReturnError ("error");
   }
 }
 
-Switch::HttpInterfaceBase::DeviceConnectionUpdate::DeviceConnectionUpdate ()
+/*void Switch::HttpInterfaceBase::SetDeviceProperties (const uint32_t& i_deviceId, const Switch_Device::Properties& i_deviceProperties)
 {
-  static uint32_t nextAvailableIndex = 0;
-  m_index = nextAvailableIndex;
-  ++nextAvailableIndex;
-}
+  try
+  {
+    // 0. Validate the call
+    if (!_IsClientRegistered ())
+    {
+      _ReturnError ("client not registered");
+    }
 
-Switch::HttpInterfaceBase::DeviceDataUpdate::DeviceDataUpdate ()
+    // 1. Validate the arguments
+
+    // 2. Call the framework
+    Switch::Interface::eCallResult callResult = _SetDeviceProperties (i_deviceId, i_deviceProperties);
+
+    // 3. Send response
+    cppcms::json::value result;
+    result.set ("result", callResult);
+    _ReturnResult (result);
+  }
+  catch (...)
+  {
+    _ReturnError ("error");
+  }
+}*/
+
+void Switch::HttpInterfaceBase::SubscribeToDeviceUpdates (const uint32_t& i_deviceId)
 {
-  static uint32_t nextAvailableIndex = 0;
-  m_index = nextAvailableIndex;
-  ++nextAvailableIndex;
+  _HandleSubscriptionCall (SubscriptionTopic (SubscriptionTopic::ST_DEVICE, i_deviceId, ""), true);
 }
 
-Switch::HttpInterfaceBase::DeviceDataUpdate& Switch::HttpInterfaceBase::DeviceDataUpdate::operator= (const Switch::HttpInterfaceBase::DeviceDataUpdate& i_other)
+void Switch::HttpInterfaceBase::UnsubscribeFromDeviceUpdates (const uint32_t& i_deviceId)
 {
-  if (this != &i_other)
-  {
-    SWITCH_ASSERT (i_other.m_deviceId == m_deviceId);
+  _HandleSubscriptionCall (SubscriptionTopic (SubscriptionTopic::ST_DEVICE, i_deviceId, ""), false);
+}
 
-    m_index = i_other.m_index;
-    std::list <Switch::Interface::Device::Value>::const_iterator itOtherValues;
-    for (itOtherValues=i_other.m_dataValues.begin (); i_other.m_dataValues.end ()!=itOtherValues; ++itOtherValues)
-    {
-      const Switch::Interface::Device::Value& otherValue = *itOtherValues;
+/*!
+  \brief Subscribes the client to the updates of some elements of a device.
 
-      // find the corresponding already buffered value
-      std::list <Switch::Interface::Device::Value>::iterator itUpdateValues;
-      for (itUpdateValues=m_dataValues.begin (); m_dataValues.end ()!=itUpdateValues; ++itUpdateValues)
-      {
-        if ((*itUpdateValues).m_address == otherValue.m_address)
-        {
-          break;
-        }
-      }
-      if (m_dataValues.end () != itUpdateValues)
-      {
-        (*itUpdateValues).m_value = otherValue.m_value;
-      }
-      else
-      {
-        // this value is not yet buffered, add it to the list
-        m_dataValues.push_back (otherValue);
-      }
-    }
+  Data updates only carry the values of the elements, updates without any of them are
+  not sent. Subscribing to the device again, with or without filter, replaces the filter.
+
+  \param [in] i_deviceId  The id of the device.
+  \param [in] i_addresses The addresses of the elements.
+ */
+void Switch::HttpInterfaceBase::SubscribeToDeviceElementUpdates (const uint32_t& i_deviceId, const std::list <uint32_t>& i_addresses)
+{
+  SubscriptionTopic topic (SubscriptionTopic::ST_DEVICE, i_deviceId, "");
+  topic.m_elementFilter.m_addresses.insert (i_addresses.begin (), i_addresses.end ());
+  if (topic.m_elementFilter.m_addresses.empty ())
+  {
+    _ReturnError ("invalid addresses");
+    return;
   }
 
-  return *this;
+  _HandleSubscriptionCall (topic, true);
 }
 
-void Switch::HttpInterfaceBase::_OnDeviceUpdate (const std::set <client_id_type>& i_deviceUpdateListenerIds, const DeviceDataUpdate& i_update)
+/*!
+  \brief Subscribes the client to the updates of the elements of a device in a group, as in SubscribeToDeviceElementUpdates.
+
+  \param [in] i_deviceId     The id of the device.
+  \param [in] i_elementGroup The group of the elements, as in the device's data format.
+ */
+void Switch::HttpInterfaceBase::SubscribeToDeviceElementGroupUpdates (const uint32_t& i_deviceId, const std::string& i_elementGroup)
 {
-  // create the message
-  cppcms::json::value deviceData;
-  deviceData.set ("deviceId", i_update.m_deviceId);
-  deviceData.set ("values", i_update.m_dataValues);
-  cppcms::json::value deviceUpdate;
-  deviceUpdate.set ("index", i_update.m_index);
-  deviceUpdate.set ("event", "dataUpdate");
-  deviceUpdate.set ("data", deviceData);
+  SubscriptionTopic topic (SubscriptionTopic::ST_DEVICE, i_deviceId, "");
+  topic.m_elementFilter.m_group = i_elementGroup;
+  if (topic.m_elementFilter.m_group.empty ())
+  {
+    _ReturnError ("invalid name");
+    return;
+  }
 
-  // send the message to the handler
-  _HandleDeviceUpdate (i_deviceUpdateListenerIds, i_update.m_deviceId, deviceUpdate);
+  _HandleSubscriptionCall (topic, true);
 }
 
-void Switch::HttpInterfaceBase::_OnDeviceUpdate (const std::set <client_id_type>& i_deviceUpdateListenerIds, const DeviceConnectionUpdate& i_update)
+void Switch::HttpInterfaceBase::SubscribeToDeviceGroupUpdates (const std::string& i_group)
 {
-  // create the message
-  cppcms::json::value deviceData;
-  deviceData.set ("deviceId", i_update.m_deviceId);
-  deviceData.set ("connection", i_update.m_connection);
-  cppcms::json::value deviceUpdate;
-  deviceUpdate.set ("index", i_update.m_index);
-  deviceUpdate.set ("event", "connectionUpdate");
-  deviceUpdate.set ("data", deviceData);
-
-  // send the message to the handler
-  _HandleDeviceUpdate (i_deviceUpdateListenerIds, i_update.m_deviceId, deviceUpdate);
+  _HandleSubscriptionCall (SubscriptionTopic (SubscriptionTopic::ST_DEVICE_GROUP, 0, i_group), true);
 }
 
-void Switch::HttpInterfaceBase::_HandleDeviceUpdate (const std::set <client_id_type>& i_deviceUpdateListenerIds, const uint32_t& i_deviceId, const cppcms::json::value& i_message)
+void Switch::HttpInterfaceBase::UnsubscribeFromDeviceGroupUpdates (const std::string& i_group)
 {
-  std::unique_lock <std::mutex> deviceUpdateListenersLock (m_deviceUpdateListenersMutex);
-
-  // send the message to all listeners
-  for (std::set <client_id_type>::const_iterator itListenerId=i_deviceUpdateListenerIds.begin (); i_deviceUpdateListenerIds.end ()!=itListenerId; ++itListenerId)
-  {
-    // get the link to the listener's context
-    device_update_listeners_type::iterator itListener = m_deviceUpdateListeners.find (*itListenerId);
-    if (m_deviceUpdateListeners.end () == itListener)
-    {
-      continue;
-    }
-
-    // get the listener's context
-    booster::shared_ptr <cppcms::rpc::json_call> listenerCall = itListener->second;
-
-    // send the response to the listener
-    //listenerCall->context ().response ().set_plain_text_header ();
-    listenerCall->context ().response ().out () << i_message;
-    listenerCall->context ().async_flush_output
-    (
-      std::bind (&Switch::HttpInterfaceBase::_OnListenerAsyncFlushOutputCompleted, this, itListener->first, args::_1)
-    );
-  }
+  _HandleSubscriptionCall (SubscriptionTopic (SubscriptionTopic::ST_DEVICE_GROUP, 0, i_group), false);
 }
 
-void Switch::HttpInterfaceBase::_GenerateClientId (client_id_type& o_clientId)
+void Switch::HttpInterfaceBase::SubscribeToProductTypeUpdates (const std::string& i_productType)
 {
-  static client_id_type nextClientId = 0;
-  o_clientId = nextClientId;
-  ++nextClientId;
+  _HandleSubscriptionCall (SubscriptionTopic (SubscriptionTopic::ST_PRODUCT_TYPE, 0, i_productType), true);
 }
 
-void Switch::HttpInterfaceBase::_RemoveListenerContext (const client_id_type& i_clientId)
+void Switch::HttpInterfaceBase::UnsubscribeFromProductTypeUpdates (const std::string& i_productType)
 {
-  std::unique_lock <std::mutex> deviceUpdateListenersLock (m_deviceUpdateListenersMutex);
-  m_deviceUpdateListeners.erase (i_clientId);
+  _HandleSubscriptionCall (SubscriptionTopic (SubscriptionTopic::ST_PRODUCT_TYPE, 0, i_productType), false);
 }
 
-void Switch::HttpInterfaceBase::_OnListenerAsyncFlushOutputCompleted (const client_id_type& i_clientId, const cppcms::http::context::completion_type& i_completionType)
+void Switch::HttpInterfaceBase::SubscribeToAllDeviceUpdates ()
 {
-  if (cppcms::http::context::operation_aborted == i_completionType)
-  {
-    // note: is access to m_deviceUpdateListeners thread-safe?
-    _RemoveListenerContext (i_clientId);
-  }
+  _HandleSubscriptionCall (SubscriptionTopic (SubscriptionTopic::ST_ALL_DEVICES, 0, ""), true);
 }
 
-void Switch::HttpInterfaceBase::_Help ()
+void Switch::HttpInterfaceBase::UnsubscribeFromAllDeviceUpdates ()
 {
+  _HandleSubscriptionCall (SubscriptionTopic (SubscriptionTopic::ST_ALL_DEVICES, 0, ""), false);
 }
 
+/*!
+  \brief Defines the devices of a group, replacing its previous devices.
+
+  \param [in] i_group     The name of the group.
+  \param [in] i_deviceIds The ids of the devices in the group, an empty list removes the group.
+ */
+void Switch::HttpInterfaceBase::DefineDeviceGroup (const std::string& i_group, const std::list <uint32_t>& i_deviceIds)
+{
+  try
+  {
+    // 0. Validate the call
+    if (!_IsClientRegistered ())
+    {
+      _ReturnError ("client not registered");
+      return;
+    }
+
+    // 1. Validate the arguments
+    if (i_group.empty ())
+    {
+      _ReturnError ("invalid group name");
+      return;
+    }
+
+    // 2. Call the framework
+    std::set <uint32_t> deviceIds (i_deviceIds.begin (), i_deviceIds.end ());
+    Switch::Interface::eCallResult callResult = _DefineDeviceGroup (i_group, deviceIds);
+
+    // 3. Send response
+    cppcms::json::value result;
+    result.set ("result", callResult);
+    _ReturnResult (result);
+  }
+  catch (std::exception& i_exception)
+  {
+    _ReturnError (i_exception.what ());
+  }
+  catch (...)
+  {
+    _ReturnError ("error");
+  }
+}
+
+/*!
+  \brief Parks the call until device updates are available.
+
+  \param [in] i_cursor The index of the last update the client received, 0 to receive
+                       the latest state of the subscribed devices instead. Every update
+                       with a higher index is sent, or a "resyncRequired" event if the
+                       updates are no longer available.
+ */
+void Switch::HttpInterfaceBase::ListenToDeviceUpdates (const uint64_t& i_cursor)
+{
+  try
+  {
+    // 0. Validate the call
+    client_id_type clientId = 0;
+    if (!_GetClientId (clientId))
+    {
+      _ReturnError ("client not registered");
+      return;
+    }
+
+    // 1. Validate the arguments
+
+    // 2. Append the context to the map of device update listener
+    cppcms::http::context* pListenerContext = 0x0;
+    {
+      std::unique_lock <std::mutex> deviceUpdateListenersLock (m_pSharedState->m_deviceUpdateListenersMutex);
+      if (m_pSharedState->m_deviceUpdateListeners.end () != m_pSharedState->m_deviceUpdateListeners.find (clientId))
+      {
+        deviceUpdateListenersLock.unlock ();
+        _ReturnError ("error, listener with same clientId already listening");
+        return;
+      }
+
+      // note: calls dispatched by the interface itself, e.g. binary calls, release the context instead of the call
+      DeviceUpdateListener& listener = m_pSharedState->m_deviceUpdateListeners [clientId];
+      if (0x0 == m_pBatchCallResult)
+      {
+        listener.m_pCall = release_call ();
+      }
+      else
+      {
+        listener.m_cbor     = _AcceptsCbor ();
+        listener.m_pContext = release_context ();
+        m_pBatchCallResult->m_released = true;
+      }
+      pListenerContext = &listener.GetContext ();
+      pListenerContext->response ().io_mode (cppcms::http::response::asynchronous);
+    }
+
+    // 3. Handle connection time-outs
+    pListenerContext->async_on_peer_reset
+    (
+      std::bind (&Switch::HttpInterfaceBase::_RemoveListenerContext, this, clientId)
+    );
+
+    // 4. Send buffered updates
+    _SendBufferedUpdatesToListener (clientId, i_cursor);
+  }
+  catch (std::exception& i_exception)
+  {
+    _ReturnError (i_exception.what ());
+  }
+  catch (...)
+  {
+    _ReturnError ("error");
+  }
+}
+
+/*!
+  \brief Sets the minimum interval between the device updates sent to the client.
+
+  The updates issued within the interval are coalesced and sent when it elapses.
+
+  \param [in] i_intervalMs The interval in milliseconds, 0 to send every update as it is issued.
+ */
+void Switch::HttpInterfaceBase::SetDeviceUpdateInterval (const uint32_t& i_intervalMs)
+{
+  try
+  {
+    // 0. Validate the call
+    client_id_type clientId = 0;
+    if (!_GetClientId (clientId))
+    {
+      _ReturnError ("client not registered");
+      return;
+    }
+
+    // 1. Validate the arguments
+    if (HTTP_MAX_DEVICE_UPDATE_INTERVAL_MS < i_intervalMs)
+    {
+      _ReturnError ("invalid interval");
+      return;
+    }
+
+    // 2. Set the rate limit of the client
+    {
+      std::unique_lock <std::mutex> deviceUpdateRateLimitsLock (m_pSharedState->m_deviceUpdateRateLimitsMutex);
+      if (0 == i_intervalMs)
+      {
+        // note: updates already coalesced are still sent by the scheduled flush
+        m_pSharedState->m_deviceUpdateRateLimits.erase (clientId);
+      }
+      else
+      {
+        std::shared_ptr <DeviceUpdateRateLimit>& pRateLimit = m_pSharedState->m_deviceUpdateRateLimits [clientId];
+        if (!pRateLimit)
+        {
+          pRateLimit.reset (new DeviceUpdateRateLimit ());
+        }
+        pRateLimit->m_minInterval = std::chrono::milliseconds (i_intervalMs);
+      }
+    }
+
+    // 3. Send response
+    cppcms::json::value result;
+    result.set ("result", Switch::Interface::CR_OK);
+    _ReturnResult (result);
+  }
+  catch (std::exception& i_exception)
+  {
+    _ReturnError (i_exception.what ());
+  }
+  catch (...)
+  {
+    _ReturnError ("error");
+  }
+}
+
+/*!
+  \brief Streams the updates of the subscribed devices as server-sent events.
+
+  Unlike ListenToDeviceUpdates, the response is kept open: every connection and
+  data update is written to it as an event, the id of the event being the index
+  of the update. A client opening a new stream replaces its previous stream. The
+  optional "cursor" query parameter resumes the updates as in ListenToDeviceUpdates,
+  without it the Last-Event-ID header sent by a reconnecting client does.
+ */
+void Switch::HttpInterfaceBase::StreamDeviceUpdates ()
+{
+  // handle CORS (Cross Origin Resource Sharing)
+  response ().set_header ("Access-Control-Allow-Origin", request ().getenv ("HTTP_ORIGIN"));
+  response ().set_header ("Access-Control-Allow-Credentials", "true");
+
+  // 0. Validate the call
+  client_id_type clientId = 0;
+  if (!_GetClientId (clientId))
+  {
+    response ().status (403, "client not registered");
+    return;
+  }
+
+  // 1. Keep the response open
+  response ().set_content_header ("text/event-stream");
+  response ().set_header ("Cache-Control", "no-cache");
+  std::shared_ptr <DeviceUpdateStream> pStream (new DeviceUpdateStream ());
+  pStream->m_pContext = release_context ();
+  pStream->m_pContext->response ().io_mode (cppcms::http::response::asynchronous);
+
+  // 2. Register the stream, replacing the previous stream of the client
+  std::shared_ptr <DeviceUpdateStream> pReplacedStream;
+  {
+    std::unique_lock <std::mutex> deviceUpdateStreamsLock (m_pSharedState->m_deviceUpdateStreamsMutex);
+    std::shared_ptr <DeviceUpdateStream>& pClientStream = m_pSharedState->m_deviceUpdateStreams [clientId];
+    pReplacedStream = pClientStream;
+    pClientStream = pStream;
+
+    pStream->m_flushing = true;
+    if (pReplacedStream)
+    {
+      pReplacedStream->m_closed = true;
+    }
+  }
+
+  // note: the responses are completed and written on the event loop of the service
+  if (pReplacedStream)
+  {
+    service ().post (std::bind (&cppcms::http::context::async_complete_response, pReplacedStream->m_pContext));
+  }
+
+  // 3. Handle connection resets
+  pStream->m_pContext->async_on_peer_reset
+  (
+    std::bind (&Switch::HttpInterfaceBase::_RemoveDeviceUpdateStream, this, clientId, pStream)
+  );
+
+  // note: the comment sends the headers, the client knows the stream is open
+  pStream->m_pContext->response ().out () << ": stream opened\n\n";
+  service ().post (std::bind (&Switch::HttpInterfaceBase::_FlushDeviceUpdateStream, this, clientId, pStream));
+
+  // 4. Send buffered updates, or the updates missed since the cursor of a resuming client
+  uint64_t cursor = 0;
+  std::string cursorParameter = request ().get ("cursor");
+  std::istringstream cursorStream (cursorParameter.empty () ? request ().getenv ("HTTP_LAST_EVENT_ID") : cursorParameter);
+  cursorStream >> cursor;
+  _SendBufferedUpdatesToListener (clientId, cursor);
+}
+
+/*!
+  \brief Serves the result of EnumerateDevices to GET requests, answering 304 if the client's copy is current.
+
+  Requests with a limit are served a page of the devices, as by EnumerateDevicePage.
+ */
+void Switch::HttpInterfaceBase::ServeDevices ()
+{
+  // 0. Validate the call
+  if (!_IsClientRegistered ())
+  {
+    response ().status (403, "client not registered");
+    return;
+  }
+
+  // 1. Send a page of the devices if one is asked for
+  std::string limitParameter = request ().get ("limit");
+  if (!limitParameter.empty ())
+  {
+    uint32_t cursor = 0;
+    uint32_t limit  = 0;
+    std::istringstream cursorStream (request ().get ("cursor"));
+    std::istringstream limitStream (limitParameter);
+    cursorStream >> cursor;
+    if (!(limitStream >> limit) || (0 == limit) || (HTTP_MAX_DEVICE_PAGE_SIZE < limit))
+    {
+      response ().status (400, "invalid limit");
+      return;
+    }
+
+    // note: pages are not cached, devices may be added between them
+    response ().set_content_header ("application/json");
+    Switch::Codec::Writer writer (response ().out ());
+    _WriteDevicePage (writer, cursor, limit);
+    writer.Flush ();
+    return;
+  }
+
+  // 2. Send the cached response
+  _ServeCachedResponse (_GetDevicesResponse ());
+}
+
+/*!
+  \brief Serves the result of GetDeviceDetails to GET requests, answering 304 if the client's copy is current.
+
+  \param [in] i_deviceId The id of the device, as matched in the url.
+ */
+void Switch::HttpInterfaceBase::ServeDevice (std::string i_deviceId)
+{
+  // 0. Validate the call
+  if (!_IsClientRegistered ())
+  {
+    response ().status (403, "client not registered");
+    return;
+  }
+
+  // 1. Validate the arguments
+  Switch::Interface::Device::Id deviceId = 0;
+  std::istringstream deviceIdStream (i_deviceId);
+  if (!(deviceIdStream >> deviceId))
+  {
+    response ().status (404);
+    return;
+  }
+
+  // 2. Send the cached response
+  _ServeCachedResponse (_GetDeviceDetailsResponse (deviceId));
+}
+
+Switch::HttpInterfaceBase::DeviceUpdateMessage::DeviceUpdateMessage (const cppcms::json::value& i_update)
+: m_event (UE_OTHER),
+  m_index (0),
+  m_deviceId (0),
+  m_update (i_update)
+{
+  _Serialize ();
+}
+
+Switch::HttpInterfaceBase::DeviceUpdateMessage::DeviceUpdateMessage (const DeviceConnectionUpdate& i_update)
+: m_event (UE_CONNECTION_UPDATE),
+  m_index (i_update.m_index),
+  m_deviceId (i_update.m_deviceId),
+  m_connection (i_update.m_connection)
+{
+  cppcms::json::value deviceData;
+  deviceData.set ("deviceId", m_deviceId);
+  deviceData.set ("connection", m_connection);
+  m_update.set ("index", m_index);
+  m_update.set ("event", "connectionUpdate");
+  m_update.set ("data", deviceData);
+
+  _Serialize ();
+}
+
+Switch::HttpInterfaceBase::DeviceUpdateMessage::DeviceUpdateMessage (const DeviceDataUpdate& i_update)
+: m_event (UE_DATA_UPDATE),
+  m_index (i_update.m_index),
+  m_deviceId (i_update.m_deviceId),
+  m_dataValues (i_update.m_dataValues)
+{
+  cppcms::json::value deviceData;
+  deviceData.set ("deviceId", m_deviceId);
+  deviceData.set ("values", m_dataValues);
+  m_update.set ("index", m_index);
+  m_update.set ("event", "dataUpdate");
+  m_update.set ("data", deviceData);
+
+  _Serialize ();
+}
+
+void Switch::HttpInterfaceBase::DeviceUpdateMessage::_Serialize ()
+{
+  std::ostringstream messageStream;
+  m_update.save (messageStream, cppcms::json::compact);
+  m_json = messageStream.str ();
+}
+
+const std::string& Switch::HttpInterfaceBase::DeviceUpdateMessage::GetJson () const
+{
+  return m_json;
+}
+
+/*!
+  \brief Gets the update in binary encoding, encoding it on first use.
+
+  \return The encoded update.
+ */
+const std::string& Switch::HttpInterfaceBase::DeviceUpdateMessage::GetCbor () const
+{
+  std::call_once (m_cborFlag, [this] () { Switch::Cbor::Encode (m_cbor, m_update); });
+  return m_cbor;
+}
+
+Switch::HttpInterfaceBase::DeviceUpdateListener::DeviceUpdateListener ()
+: m_cbor (false)
+{
+}
+
+cppcms::http::context& Switch::HttpInterfaceBase::DeviceUpdateListener::GetContext ()
+{
+  return m_pCall ? m_pCall->context () : *m_pContext;
+}
+
+Switch::HttpInterfaceBase::DeviceUpdateStream::DeviceUpdateStream ()
+: m_flushing (false),
+  m_closed (false)
+{
+}
+
+Switch::HttpInterfaceBase::DeviceUpdateRateLimit::PendingDeviceUpdate::PendingDeviceUpdate ()
+: m_connectionIndex (0),
+  m_dataIndex (0)
+{
+}
+
+Switch::HttpInterfaceBase::DeviceUpdateRateLimit::DeviceUpdateRateLimit ()
+: m_minInterval (0),
+  m_flushScheduled (false)
+{
+}
+
+Switch::HttpInterfaceBase::DeviceConnectionUpdate::DeviceConnectionUpdate ()
+: m_index (0),
+  m_deviceId (0)
+{
+}
+
+Switch::HttpInterfaceBase::DeviceDataUpdate::DeviceDataUpdate ()
+: m_index (0),
+  m_deviceId (0)
+{
+}
+
+Switch::HttpInterfaceBase::DeviceDataUpdate& Switch::HttpInterfaceBase::DeviceDataUpdate::operator= (const Switch::HttpInterfaceBase::DeviceDataUpdate& i_other)
+{
+  if (this != &i_other)
+  {
+    SWITCH_ASSERT (m_dataValues.empty () || (i_other.m_deviceId == m_deviceId));
+    m_deviceId = i_other.m_deviceId;
+
+    // note: an update merged into an empty one equals the other update, its message can be shared
+    m_pMessage = m_dataValues.empty () ? i_other.m_pMessage : device_update_message_type ();
+
+    m_index = i_other.m_index;
+    if (m_dataValues.empty ())
+    {
+      m_dataValues = i_other.m_dataValues;
+      return *this;
+    }
+
+    // index the buffered values by address, the latest value of every element wins
+    std::map <uint32_t, Switch::Interface::Device::Value*> bufferedValues;
+    std::list <Switch::Interface::Device::Value>::iterator itUpdateValues;
+    for (itUpdateValues=m_dataValues.begin (); m_dataValues.end ()!=itUpdateValues; ++itUpdateValues)
+    {
+      bufferedValues [(*itUpdateValues).m_address] = &(*itUpdateValues);
+    }
+
+    std::list <Switch::Interface::Device::Value>::const_iterator itOtherValues;
+    for (itOtherValues=i_other.m_dataValues.begin (); i_other.m_dataValues.end ()!=itOtherValues; ++itOtherValues)
+    {
+      const Switch::Interface::Device::Value& otherValue = *itOtherValues;
+
+      // find the corresponding already buffered value
+      std::map <uint32_t, Switch::Interface::Device::Value*>::iterator itBufferedValue = bufferedValues.find (otherValue.m_address);
+      if (bufferedValues.end () != itBufferedValue)
+      {
+        itBufferedValue->second->m_value = otherValue.m_value;
+      }
+      else
+      {
+        // this value is not yet buffered, add it to the list
+        m_dataValues.push_back (otherValue);
+        bufferedValues [otherValue.m_address] = &m_dataValues.back ();
+      }
+    }
+  }
+
+  return *this;
+}
+
+void Switch::HttpInterfaceBase::_OnDeviceUpdate (const client_ids_type& i_deviceUpdateListenerIds, DeviceDataUpdate& io_update)
+{
+  // serialize the message once, it is shared by all listeners and kept with the update for replays
+  if (!io_update.m_pMessage)
+  {
+    io_update.m_pMessage = std::make_shared <const DeviceUpdateMessage> (io_update);
+  }
+
+  // send the message to the handler
+  _HandleDeviceUpdate (i_deviceUpdateListenerIds, io_update.m_deviceId, io_update.m_pMessage);
+}
+
+void Switch::HttpInterfaceBase::_OnDeviceUpdate (const client_ids_type& i_deviceUpdateListenerIds, DeviceConnectionUpdate& io_update)
+{
+  // serialize the message once, it is shared by all listeners and kept with the update for replays
+  if (!io_update.m_pMessage)
+  {
+    io_update.m_pMessage = std::make_shared <const DeviceUpdateMessage> (io_update);
+  }
+
+  // send the message to the handler
+  _HandleDeviceUpdate (i_deviceUpdateListenerIds, io_update.m_deviceId, io_update.m_pMessage);
+}
+
+/*!
+  \brief Sends an update to its listeners, coalescing it for the rate limited listeners.
+
+  \param [in] i_deviceUpdateListenerIds The ids of the listeners.
+  \param [in] i_deviceId                The id of the device the update is related to, 0 for other events.
+  \param [in] i_pMessage                The serialized update.
+ */
+void Switch::HttpInterfaceBase::_HandleDeviceUpdate (const client_ids_type& i_deviceUpdateListenerIds, const uint32_t& i_deviceId, const device_update_message_type& i_pMessage)
+{
+  // hold back the update from the rate limited listeners within their interval
+  client_ids_type recipientIds;
+  {
+    std::unique_lock <std::mutex> deviceUpdateRateLimitsLock (m_pSharedState->m_deviceUpdateRateLimitsMutex);
+    if (m_pSharedState->m_deviceUpdateRateLimits.empty ())
+    {
+      deviceUpdateRateLimitsLock.unlock ();
+      _SendDeviceUpdate (i_deviceUpdateListenerIds, i_pMessage);
+      return;
+    }
+
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now ();
+    recipientIds.reserve (i_deviceUpdateListenerIds.size ());
+    for (client_ids_type::const_iterator itListenerId=i_deviceUpdateListenerIds.begin (); i_deviceUpdateListenerIds.end ()!=itListenerId; ++itListenerId)
+    {
+      device_update_rate_limits_type::const_iterator itRateLimit = m_pSharedState->m_deviceUpdateRateLimits.find (*itListenerId);
+      if ((m_pSharedState->m_deviceUpdateRateLimits.end () == itRateLimit) || !_CoalesceDeviceUpdate (*itListenerId, itRateLimit->second, i_pMessage, now))
+      {
+        recipientIds.push_back (*itListenerId);
+      }
+    }
+  }
+
+  _SendDeviceUpdate (recipientIds, i_pMessage);
+}
+
+/*!
+  \brief Merges an update into the pending updates of a rate limited listener.
+
+  The update is sent right away if nothing is pending and the interval since the last
+  update sent to the listener elapsed. Other events than connection and data updates,
+  i.e. "resyncRequired", supersede the pending updates and are sent right away.
+
+  \param [in] i_clientId   The id of the listener.
+  \param [in] i_pRateLimit The rate limit of the listener.
+  \param [in] i_pMessage   The serialized update.
+  \param [in] i_now        The current time.
+
+  \return True if the update was coalesced, false if it must be sent right away.
+
+  \note Must be called with the rate limits mutex locked.
+ */
+bool Switch::HttpInterfaceBase::_CoalesceDeviceUpdate (const client_id_type& i_clientId, const std::shared_ptr <DeviceUpdateRateLimit>& i_pRateLimit, const device_update_message_type& i_pMessage, const std::chrono::steady_clock::time_point& i_now)
+{
+  DeviceUpdateRateLimit& rateLimit = *i_pRateLimit;
+  if (DeviceUpdateMessage::UE_OTHER == i_pMessage->m_event)
+  {
+    rateLimit.m_pendingUpdates.clear ();
+    rateLimit.m_lastFlush = i_now;
+    return false;
+  }
+  if (!rateLimit.m_flushScheduled && (rateLimit.m_lastFlush + rateLimit.m_minInterval <= i_now))
+  {
+    rateLimit.m_lastFlush = i_now;
+    return false;
+  }
+
+  // merge the update, the latest connection and the latest value of every element win
+  DeviceUpdateRateLimit::PendingDeviceUpdate& pendingUpdate = rateLimit.m_pendingUpdates [i_pMessage->m_deviceId];
+  if (DeviceUpdateMessage::UE_CONNECTION_UPDATE == i_pMessage->m_event)
+  {
+    if (pendingUpdate.m_connectionIndex < i_pMessage->m_index)
+    {
+      pendingUpdate.m_connectionIndex = i_pMessage->m_index;
+      pendingUpdate.m_connection      = i_pMessage->m_connection;
+    }
+  }
+  else
+  {
+    pendingUpdate.m_dataIndex = std::max (pendingUpdate.m_dataIndex, i_pMessage->m_index);
+    std::list <Switch::Interface::Device::Value>::const_iterator itValues;
+    for (itValues=i_pMessage->m_dataValues.begin (); i_pMessage->m_dataValues.end ()!=itValues; ++itValues)
+    {
+      pendingUpdate.m_dataValues [(*itValues).m_address] = *itValues;
+    }
+  }
+
+  // note: the timer is armed on the event loop of the service
+  if (!rateLimit.m_flushScheduled)
+  {
+    rateLimit.m_flushScheduled = true;
+    service ().post (std::bind (&Switch::HttpInterfaceBase::_ScheduleCoalescedDeviceUpdates, this, i_clientId, i_pRateLimit));
+  }
+
+  return true;
+}
+
+void Switch::HttpInterfaceBase::_ScheduleCoalescedDeviceUpdates (const client_id_type& i_clientId, const std::shared_ptr <DeviceUpdateRateLimit>& i_pRateLimit)
+{
+  std::unique_lock <std::mutex> deviceUpdateRateLimitsLock (m_pSharedState->m_deviceUpdateRateLimitsMutex);
+  if (!i_pRateLimit->m_pTimer)
+  {
+    i_pRateLimit->m_pTimer.reset (new booster::aio::deadline_timer (service ().get_io_service ()));
+  }
+
+  const std::chrono::steady_clock::duration delay = std::max (i_pRateLimit->m_lastFlush + i_pRateLimit->m_minInterval - std::chrono::steady_clock::now (), std::chrono::steady_clock::duration (0));
+  i_pRateLimit->m_pTimer->expires_from_now (booster::ptime::milliseconds (std::chrono::duration_cast <std::chrono::milliseconds> (delay).count ()));
+  i_pRateLimit->m_pTimer->async_wait
+  (
+    std::bind (&Switch::HttpInterfaceBase::_FlushCoalescedDeviceUpdates, this, i_clientId, i_pRateLimit, args::_1)
+  );
+}
+
+/*!
+  \brief Sends the coalesced updates of a rate limited listener, in the order of their indices.
+ */
+void Switch::HttpInterfaceBase::_FlushCoalescedDeviceUpdates (const client_id_type& i_clientId, const std::shared_ptr <DeviceUpdateRateLimit>& i_pRateLimit, const booster::system::error_code& i_error)
+{
+  if (i_error)
+  {
+    return;
+  }
+
+  std::vector <std::pair <uint64_t, device_update_message_type>> messages;
+  {
+    std::unique_lock <std::mutex> deviceUpdateRateLimitsLock (m_pSharedState->m_deviceUpdateRateLimitsMutex);
+    std::map <uint32_t, DeviceUpdateRateLimit::PendingDeviceUpdate>::const_iterator itPendingUpdate;
+    for (itPendingUpdate=i_pRateLimit->m_pendingUpdates.begin (); i_pRateLimit->m_pendingUpdates.end ()!=itPendingUpdate; ++itPendingUpdate)
+    {
+      const DeviceUpdateRateLimit::PendingDeviceUpdate& pendingUpdate = itPendingUpdate->second;
+      if (0 != pendingUpdate.m_connectionIndex)
+      {
+        DeviceConnectionUpdate connectionUpdate;
+        connectionUpdate.m_index      = pendingUpdate.m_connectionIndex;
+        connectionUpdate.m_deviceId   = itPendingUpdate->first;
+        connectionUpdate.m_connection = pendingUpdate.m_connection;
+        messages.push_back (std::make_pair (connectionUpdate.m_index, std::make_shared <const DeviceUpdateMessage> (connectionUpdate)));
+      }
+      if (0 != pendingUpdate.m_dataIndex)
+      {
+        DeviceDataUpdate dataUpdate;
+        dataUpdate.m_index    = pendingUpdate.m_dataIndex;
+        dataUpdate.m_deviceId = itPendingUpdate->first;
+        std::map <uint32_t, Switch::Interface::Device::Value>::const_iterator itValues;
+        for (itValues=pendingUpdate.m_dataValues.begin (); pendingUpdate.m_dataValues.end ()!=itValues; ++itValues)
+        {
+          dataUpdate.m_dataValues.push_back (itValues->second);
+        }
+        messages.push_back (std::make_pair (dataUpdate.m_index, std::make_shared <const DeviceUpdateMessage> (dataUpdate)));
+      }
+    }
+    i_pRateLimit->m_pendingUpdates.clear ();
+    i_pRateLimit->m_flushScheduled = false;
+    i_pRateLimit->m_lastFlush      = std::chrono::steady_clock::now ();
+  }
+
+  // note: once sent, the index of the last message is a valid cursor for the client
+  std::sort (messages.begin (), messages.end ());
+  client_ids_type listenerIds (1, i_clientId);
+  std::vector <std::pair <uint64_t, device_update_message_type>>::const_iterator itMessage;
+  for (itMessage=messages.begin (); messages.end ()!=itMessage; ++itMessage)
+  {
+    _SendDeviceUpdate (listenerIds, itMessage->second);
+  }
+}
+
+/*!
+  \brief Writes an update to the parked calls and the streams of its listeners.
+ */
+void Switch::HttpInterfaceBase::_SendDeviceUpdate (const client_ids_type& i_deviceUpdateListenerIds, const device_update_message_type& i_pMessage)
+{
+  std::unique_lock <std::mutex> deviceUpdateListenersLock (m_pSharedState->m_deviceUpdateListenersMutex);
+
+  // send the message to all listeners
+  for (client_ids_type::const_iterator itListenerId=i_deviceUpdateListenerIds.begin (); i_deviceUpdateListenerIds.end ()!=itListenerId; ++itListenerId)
+  {
+    // get the link to the listener's context
+    device_update_listeners_type::iterator itListener = m_pSharedState->m_deviceUpdateListeners.find (*itListenerId);
+    if (m_pSharedState->m_deviceUpdateListeners.end () == itListener)
+    {
+      continue;
+    }
+
+    // get the listener's context
+    DeviceUpdateListener& listener = itListener->second;
+    cppcms::http::context& listenerContext = listener.GetContext ();
+
+    // send the response to the listener, in the encoding it accepts
+    //listenerContext.response ().set_plain_text_header ();
+    listenerContext.response ().out () << (listener.m_cbor ? i_pMessage->GetCbor () : i_pMessage->GetJson ());
+    listenerContext.async_flush_output
+    (
+      std::bind (&Switch::HttpInterfaceBase::_OnListenerAsyncFlushOutputCompleted, this, itListener->first, args::_1)
+    );
+  }
+  deviceUpdateListenersLock.unlock ();
+
+  // send the message to all streaming listeners
+  client_ids_type backloggedIds;
+  std::unique_lock <std::mutex> deviceUpdateStreamsLock (m_pSharedState->m_deviceUpdateStreamsMutex);
+  for (client_ids_type::const_iterator itListenerId=i_deviceUpdateListenerIds.begin (); i_deviceUpdateListenerIds.end ()!=itListenerId; ++itListenerId)
+  {
+    device_update_streams_type::iterator itStream = m_pSharedState->m_deviceUpdateStreams.find (*itListenerId);
+    if (m_pSharedState->m_deviceUpdateStreams.end () == itStream)
+    {
+      continue;
+    }
+
+    // hold back the updates from a stream too far behind, other events are always queued
+    std::shared_ptr <DeviceUpdateStream> pStream = itStream->second;
+    if ((HTTP_MAX_PENDING_STREAM_EVENTS <= pStream->m_pendingEvents.size ()) && (DeviceUpdateMessage::UE_OTHER != i_pMessage->m_event))
+    {
+      backloggedIds.push_back (*itListenerId);
+      continue;
+    }
+
+    // queue the event
+    pStream->m_pendingEvents.push_back (i_pMessage);
+
+    // note: the output is written on the event loop of the service, one flush at a time
+    if (!pStream->m_flushing)
+    {
+      pStream->m_flushing = true;
+      service ().post (std::bind (&Switch::HttpInterfaceBase::_FlushDeviceUpdateStream, this, *itListenerId, pStream));
+    }
+  }
+  deviceUpdateStreamsLock.unlock ();
+
+  if (!backloggedIds.empty ())
+  {
+    _CoalesceBackloggedStreamUpdates (backloggedIds, i_pMessage);
+  }
+}
+
+/*!
+  \brief Coalesces an update for the clients whose stream fell too far behind.
+
+  The clients without an update interval get one, so their later updates are
+  coalesced as well. The pending updates are sent once the interval elapsed, by
+  then the stream had the time to catch up.
+
+  \param [in] i_clientIds The ids of the clients.
+  \param [in] i_pMessage  The serialized update.
+ */
+void Switch::HttpInterfaceBase::_CoalesceBackloggedStreamUpdates (const client_ids_type& i_clientIds, const device_update_message_type& i_pMessage)
+{
+  std::unique_lock <std::mutex> deviceUpdateRateLimitsLock (m_pSharedState->m_deviceUpdateRateLimitsMutex);
+
+  const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now ();
+  for (client_ids_type::const_iterator itClientId=i_clientIds.begin (); i_clientIds.end ()!=itClientId; ++itClientId)
+  {
+    SWITCH_DEBUG_MSG_1 ("_CoalesceBackloggedStreamUpdates => stream of client %llu fell behind\n", (unsigned long long) *itClientId);
+
+    std::shared_ptr <DeviceUpdateRateLimit>& pRateLimit = m_pSharedState->m_deviceUpdateRateLimits [*itClientId];
+    if (!pRateLimit)
+    {
+      pRateLimit.reset (new DeviceUpdateRateLimit ());
+      pRateLimit->m_minInterval = std::chrono::milliseconds (HTTP_BACKLOGGED_STREAM_UPDATE_INTERVAL_MS);
+    }
+
+    // note: the update is held back for a full interval, rather than sent to the stream right away
+    if (!pRateLimit->m_flushScheduled)
+    {
+      pRateLimit->m_lastFlush = now;
+    }
+    _CoalesceDeviceUpdate (*itClientId, pRateLimit, i_pMessage, now);
+  }
+}
+
+void Switch::HttpInterfaceBase::_RemoveDeviceUpdateStream (const client_id_type& i_clientId, const std::shared_ptr <DeviceUpdateStream>& i_pStream)
+{
+  std::unique_lock <std::mutex> deviceUpdateStreamsLock (m_pSharedState->m_deviceUpdateStreamsMutex);
+  i_pStream->m_closed = true;
+
+  // note: the client may have opened a new stream already
+  device_update_streams_type::iterator itStream = m_pSharedState->m_deviceUpdateStreams.find (i_clientId);
+  if ((m_pSharedState->m_deviceUpdateStreams.end () != itStream) && (i_pStream == itStream->second))
+  {
+    m_pSharedState->m_deviceUpdateStreams.erase (itStream);
+  }
+}
+
+void Switch::HttpInterfaceBase::_FlushDeviceUpdateStream (const client_id_type& i_clientId, const std::shared_ptr <DeviceUpdateStream>& i_pStream)
+{
+  std::deque <device_update_message_type> events;
+  {
+    std::unique_lock <std::mutex> deviceUpdateStreamsLock (m_pSharedState->m_deviceUpdateStreamsMutex);
+    if (i_pStream->m_closed)
+    {
+      return;
+    }
+    events.swap (i_pStream->m_pendingEvents);
+  }
+
+  // write the shared messages directly
+  // note: other events have no index, the client keeps the id of the last update as its cursor
+  std::ostream& output = i_pStream->m_pContext->response ().out ();
+  std::deque <device_update_message_type>::const_iterator itEvent;
+  for (itEvent = events.begin (); events.end () != itEvent; ++itEvent)
+  {
+    if (0 != (*itEvent)->m_index)
+    {
+      output << "id: " << (*itEvent)->m_index << "\n";
+    }
+    output << "data: " << (*itEvent)->GetJson () << "\n\n";
+  }
+  i_pStream->m_pContext->async_flush_output
+  (
+    std::bind (&Switch::HttpInterfaceBase::_OnDeviceUpdateStreamAsyncFlushOutputCompleted, this, i_clientId, i_pStream, args::_1)
+  );
+}
+
+void Switch::HttpInterfaceBase::_OnDeviceUpdateStreamAsyncFlushOutputCompleted (const client_id_type& i_clientId, const std::shared_ptr <DeviceUpdateStream>& i_pStream, const cppcms::http::context::completion_type& i_completionType)
+{
+  if (cppcms::http::context::operation_aborted == i_completionType)
+  {
+    _RemoveDeviceUpdateStream (i_clientId, i_pStream);
+    return;
+  }
+
+  {
+    std::unique_lock <std::mutex> deviceUpdateStreamsLock (m_pSharedState->m_deviceUpdateStreamsMutex);
+    if (i_pStream->m_pendingEvents.empty ())
+    {
+      i_pStream->m_flushing = false;
+      return;
+    }
+  }
+
+  // write the events appended during the flush
+  _FlushDeviceUpdateStream (i_clientId, i_pStream);
+}
+
+/*!
+  \brief Gets the token of the client making the request.
+
+  The token is read from the bearer authorization header, or the token query parameter
+  for clients which can not set headers. Only without either the session is loaded.
+
+  \return The token, empty if the request has none.
+ */
+std::string Switch::HttpInterfaceBase::_GetClientToken ()
+{
+  static const std::string bearer = "Bearer ";
+  std::string authorization = request ().http_authorization ();
+  if (0 == authorization.compare (0, bearer.size (), bearer))
+  {
+    return authorization.substr (bearer.size ());
+  }
+
+  std::string token = request ().get ("token");
+  if (token.empty () && session ().is_set ("token"))
+  {
+    token = session ().get <std::string> ("token");
+  }
+
+  return token;
+}
+
+/*!
+  \brief Validates the token of the request and gets the id of its client.
+
+  Removes the idle clients every HTTP_IDLE_CLIENTS_CHECK_INTERVAL_S.
+
+  \param [out] o_clientId The id of the client.
+
+  \return True if the client is registered, false otherwise.
+ */
+bool Switch::HttpInterfaceBase::_GetClientId (client_id_type& o_clientId)
+{
+  std::string token = _GetClientToken ();
+  if (token.empty ())
+  {
+    return false;
+  }
+
+  const HttpClientRegistry::clock_type::time_point now = HttpClientRegistry::clock_type::now ();
+  std::unique_lock <std::mutex> clientRegistryLock (m_pSharedState->m_clientRegistryMutex);
+  const bool registered = m_pSharedState->m_clientRegistry.Validate (o_clientId, token, now);
+  if (now < m_pSharedState->m_nextIdleClientsRemoval)
+  {
+    return registered;
+  }
+  m_pSharedState->m_nextIdleClientsRemoval = now + std::chrono::seconds (HTTP_IDLE_CLIENTS_CHECK_INTERVAL_S);
+  clientRegistryLock.unlock ();
+
+  _RemoveIdleClients (now);
+
+  return registered;
+}
+
+bool Switch::HttpInterfaceBase::_IsClientRegistered ()
+{
+  client_id_type clientId = 0;
+  return _GetClientId (clientId);
+}
+
+/*!
+  \brief Removes the clients without calls or open connections for HTTP_CLIENT_IDLE_TIMEOUT_S, with their subscriptions.
+
+  \param [in] i_now The current time.
+ */
+void Switch::HttpInterfaceBase::_RemoveIdleClients (const HttpClientRegistry::clock_type::time_point& i_now)
+{
+  // the clients listening or streaming are active
+  client_ids_type activeClientIds;
+  {
+    std::unique_lock <std::mutex> deviceUpdateListenersLock (m_pSharedState->m_deviceUpdateListenersMutex);
+    for (device_update_listeners_type::const_iterator itListener = m_pSharedState->m_deviceUpdateListeners.begin (); m_pSharedState->m_deviceUpdateListeners.end () != itListener; ++itListener)
+    {
+      activeClientIds.push_back (itListener->first);
+    }
+  }
+  {
+    std::unique_lock <std::mutex> deviceUpdateStreamsLock (m_pSharedState->m_deviceUpdateStreamsMutex);
+    for (device_update_streams_type::const_iterator itStream = m_pSharedState->m_deviceUpdateStreams.begin (); m_pSharedState->m_deviceUpdateStreams.end () != itStream; ++itStream)
+    {
+      activeClientIds.push_back (itStream->first);
+    }
+  }
+
+  client_ids_type idleClientIds;
+  {
+    std::unique_lock <std::mutex> clientRegistryLock (m_pSharedState->m_clientRegistryMutex);
+    for (client_ids_type::const_iterator itClientId = activeClientIds.begin (); activeClientIds.end () != itClientId; ++itClientId)
+    {
+      m_pSharedState->m_clientRegistry.Touch (*itClientId, i_now);
+    }
+    m_pSharedState->m_clientRegistry.RemoveIdleClients (idleClientIds, i_now - std::chrono::seconds (HTTP_CLIENT_IDLE_TIMEOUT_S));
+  }
+
+  for (client_ids_type::const_iterator itClientId = idleClientIds.begin (); idleClientIds.end () != itClientId; ++itClientId)
+  {
+    {
+      std::unique_lock <std::mutex> deviceUpdateRateLimitsLock (m_pSharedState->m_deviceUpdateRateLimitsMutex);
+      m_pSharedState->m_deviceUpdateRateLimits.erase (*itClientId);
+    }
+    _RemoveClient (*itClientId);
+  }
+}
+
+void Switch::HttpInterfaceBase::_RemoveListenerContext (const client_id_type& i_clientId)
+{
+  std::unique_lock <std::mutex> deviceUpdateListenersLock (m_pSharedState->m_deviceUpdateListenersMutex);
+  m_pSharedState->m_deviceUpdateListeners.erase (i_clientId);
+}
+
+void Switch::HttpInterfaceBase::_OnListenerAsyncFlushOutputCompleted (const client_id_type& i_clientId, const cppcms::http::context::completion_type& i_completionType)
+{
+  if (cppcms::http::context::operation_aborted == i_completionType)
+  {
+    // note: is access to m_deviceUpdateListeners thread-safe?
+    _RemoveListenerContext (i_clientId);
+  }
+}
+
+void Switch::HttpInterfaceBase::_Help ()
+{
+}
+
+/*!
+  \brief Returns the result of the rpc call in progress.
+
+  \param [in] i_result The result.
+ */
+void Switch::HttpInterfaceBase::_ReturnResult (const cppcms::json::value& i_result)
+{
+  if (0x0 == m_pBatchCallResult)
+  {
+    cppcms::rpc::json_rpc_server::return_result (i_result);
+  }
+  else if (!m_pBatchCallResult->m_returned)
+  {
+    m_pBatchCallResult->m_returned = true;
+    m_pBatchCallResult->m_value    = i_result;
+  }
+}
+
+/*!
+  \brief Returns the result of an rpc call rejected because the controller's command queue is full.
+
+  Adds the time after which to retry, estimated from the command backlog, to the result.
+  Outside of batches the response gets status 503 and a Retry-After header.
+
+  \param [in,out] io_result The result.
+ */
+void Switch::HttpInterfaceBase::_ReturnBusy (cppcms::json::value& io_result)
+{
+  uint32_t nrQueuedCommands = 0;
+  uint32_t drainTimeMicros  = 0;
+  if (Switch::Interface::CR_OK != _GetCommandBacklog (nrQueuedCommands, drainTimeMicros))
+  {
+    drainTimeMicros = 0;
+  }
+  uint32_t retryAfterMs = std::max <uint32_t> ((drainTimeMicros + 999) / 1000, 1);
+  io_result.set ("retryAfter", retryAfterMs);
+
+  if (0x0 == m_pBatchCallResult)
+  {
+    // note: Retry-After is in whole seconds
+    response ().status (503, "busy");
+    response ().set_header ("Retry-After", std::to_string ((retryAfterMs + 999) / 1000));
+  }
+  _ReturnResult (io_result);
+}
+
+/*!
+  \brief Returns an error for the rpc call in progress.
+
+  \param [in] i_error The error.
+ */
+void Switch::HttpInterfaceBase::_ReturnError (const cppcms::json::value& i_error)
+{
+  if (0x0 == m_pBatchCallResult)
+  {
+    cppcms::rpc::json_rpc_server::return_error (i_error);
+  }
+  else if (!m_pBatchCallResult->m_returned)
+  {
+    m_pBatchCallResult->m_returned = true;
+    m_pBatchCallResult->m_failed   = true;
+    m_pBatchCallResult->m_value    = i_error;
+  }
+}
+
+/*!
+  \brief Generates the index of a new device update.
+
+  \return The index, higher than the index of all previous updates.
+ */
+uint64_t Switch::HttpInterfaceBase::_GenerateUpdateIndex ()
+{
+  return m_pSharedState->m_nextUpdateIndex.fetch_add (1);
+}
+
+/*!
+  \brief Gets the index of the latest device update.
+
+  \return The index, the first index minus one if no updates were generated yet.
+ */
+uint64_t Switch::HttpInterfaceBase::_GetLastUpdateIndex () const
+{
+  return m_pSharedState->m_nextUpdateIndex.load () - 1;
+}
+
+/*!
+  \brief Gets the index of the first device update of this run.
+
+  \return The index, higher than the indices issued by previous runs.
+ */
+uint64_t Switch::HttpInterfaceBase::_GetFirstUpdateIndex () const
+{
+  return m_pSharedState->m_firstUpdateIndex;
+}
+
+/*!
+  \brief Creates the message telling a client its missed updates are no longer available.
+
+  The client must get the values of its devices and resume from the index in the message.
+
+  \return The message.
+ */
+Switch::HttpInterfaceBase::device_update_message_type Switch::HttpInterfaceBase::_CreateResyncRequiredMessage () const
+{
+  cppcms::json::value resyncRequired;
+  resyncRequired.set ("index", _GetLastUpdateIndex ());
+  resyncRequired.set ("event", "resyncRequired");
+
+  return std::make_shared <const DeviceUpdateMessage> (resyncRequired);
+}
+
+/*!
+  \brief Subscribes the calling client to, or unsubscribes it from, the updates of a topic.
+
+  \param [in] i_topic     The devices to (un)subscribe to.
+  \param [in] i_subscribe True to subscribe, false to unsubscribe.
+ */
+void Switch::HttpInterfaceBase::_HandleSubscriptionCall (const SubscriptionTopic& i_topic, const bool& i_subscribe)
+{
+  try
+  {
+    // 0. Validate the call
+    client_id_type clientId = 0;
+    if (!_GetClientId (clientId))
+    {
+      _ReturnError ("client not registered");
+      return;
+    }
+
+    // 1. Validate the arguments
+    if (((SubscriptionTopic::ST_DEVICE_GROUP == i_topic.m_kind) || (SubscriptionTopic::ST_PRODUCT_TYPE == i_topic.m_kind)) && i_topic.m_name.empty ())
+    {
+      _ReturnError ("invalid name");
+      return;
+    }
+
+    // 2. Call the framework
+    Switch::Interface::eCallResult callResult = i_subscribe ? _SubscribeToDeviceUpdates (clientId, i_topic) : _UnsubscribeFromDeviceUpdates (clientId, i_topic);
+
+    // 3. Send response
+    cppcms::json::value result;
+    result.set ("result", callResult);
+    _ReturnResult (result);
+  }
+  catch (std::exception& i_exception)
+  {
+    _ReturnError (i_exception.what ());
+  }
+  catch (...)
+  {
+    _ReturnError ("error");
+  }
+}
+
+/*!
+  \brief Binds an rpc method, both for single calls and for batches.
+
+  \param [in] i_name   The name of the method.
+  \param [in] i_method The method.
+  \param [in] i_role   The role of the method.
+ */
+void Switch::HttpInterfaceBase::_Bind (const std::string& i_name, const cppcms::rpc::json_rpc_server::method_type& i_method, const cppcms::rpc::json_rpc_server::role_type& i_role)
+{
+  bind (i_name, i_method, i_role);
+  m_methods [i_name] = i_method;
+}
+
+/*!
+  \brief Checks if the request holds a batch: a JSON array posted instead of a call object.
+
+  \return True if the request holds a batch, false otherwise.
+ */
+bool Switch::HttpInterfaceBase::_IsBatch ()
+{
+  if ("POST" != request ().request_method ())
+  {
+    return false;
+  }
+
+  std::pair <void*, size_t> postData = request ().raw_post_data ();
+  const char* pBegin = static_cast <const char*> (postData.first);
+  const char* pEnd   = pBegin + postData.second;
+  while ((pEnd != pBegin) && isspace (static_cast <unsigned char> (*pBegin)))
+  {
+    ++pBegin;
+  }
+
+  return ((pEnd != pBegin) && ('[' == *pBegin));
+}
+
+/*!
+  \brief Checks if the request body is in binary encoding.
+
+  \return True if the content type of the request is application/cbor, false otherwise.
+ */
+bool Switch::HttpInterfaceBase::_IsCborRequest ()
+{
+  return ("POST" == request ().request_method ()) && (0 == request ().content_type ().compare (0, 16, "application/cbor"));
+}
+
+/*!
+  \brief Checks if the client accepts responses in binary encoding.
+
+  \return True if the accept header of the request lists application/cbor, false otherwise.
+ */
+bool Switch::HttpInterfaceBase::_AcceptsCbor ()
+{
+  return (std::string::npos != request ().getenv ("HTTP_ACCEPT").find ("application/cbor"));
+}
+
+/*!
+  \brief Executes a single call or the calls of a batch in order and answers them in one response.
+
+  The request body is decoded according to its content type, the response is encoded
+  according to the accept header of the request. Both are json text unless the
+  binary encoding is negotiated.
+ */
+void Switch::HttpInterfaceBase::_HandleBatch ()
+{
+  const bool cborResponse = _AcceptsCbor ();
+  response ().set_content_header (cborResponse ? "application/cbor" : "application/json");
+
+  std::pair <void*, size_t> postData = request ().raw_post_data ();
+  const char* pBegin = static_cast <const char*> (postData.first);
+  const char* pEnd   = pBegin + postData.second;
+
+  cppcms::json::value batch;
+  bool valid = _IsCborRequest () ? (Switch::Cbor::Decode (batch, pBegin, pEnd) && (pEnd == pBegin)) : batch.load (pBegin, pEnd, true);
+  const bool single = valid && (cppcms::json::is_object == batch.type ());
+  valid = valid && (single || ((cppcms::json::is_array == batch.type ()) && !batch.array ().empty ()));
+  if (!valid)
+  {
+    cppcms::json::value nullId;
+    nullId.null ();
+    cppcms::json::value errorResponse;
+    errorResponse.set ("jsonrpc", "2.0");
+    errorResponse.set ("error.code", -32600);
+    errorResponse.set ("error.message", "invalid request");
+    errorResponse.set ("id", nullId);
+    _WriteCallResponse (errorResponse, cborResponse);
+    return;
+  }
+
+  // note: a single call may release the context, nothing is written then
+  if (single)
+  {
+    cppcms::json::value callResponse;
+    if (_CallInBatch (callResponse, batch, true))
+    {
+      _WriteCallResponse (callResponse, cborResponse);
+    }
+    return;
+  }
+
+  cppcms::json::value responses = cppcms::json::array ();
+  const cppcms::json::array& calls = batch.array ();
+  for (cppcms::json::array::const_iterator itCall = calls.begin (); calls.end () != itCall; ++itCall)
+  {
+    cppcms::json::value callResponse;
+    if (_CallInBatch (callResponse, *itCall, false))
+    {
+      responses.array ().push_back (callResponse);
+    }
+  }
+
+  // note: a batch of notifications only is not answered
+  if (!responses.array ().empty ())
+  {
+    _WriteCallResponse (responses, cborResponse);
+  }
+}
+
+/*!
+  \brief Writes the response to dispatched calls.
+
+  \param [in] i_response The response.
+  \param [in] i_cbor     True to write the response in binary encoding, false to write json text.
+ */
+void Switch::HttpInterfaceBase::_WriteCallResponse (const cppcms::json::value& i_response, const bool& i_cbor)
+{
+  if (i_cbor)
+  {
+    std::string bytes;
+    Switch::Cbor::Encode (bytes, i_response);
+    response ().out ().write (bytes.data (), bytes.size ());
+  }
+  else
+  {
+    response ().out () << i_response;
+  }
+}
+
+/*!
+  \brief Executes one call of a batch, or a single dispatched call.
+
+  \param [out] o_response  The response to the call.
+  \param [in]  i_call      The call.
+  \param [in]  i_single    True if the call is not part of a batch, it may listen to device updates then.
+
+  \return True if the call must be answered, false if it is a notification or the call released the context.
+ */
+bool Switch::HttpInterfaceBase::_CallInBatch (cppcms::json::value& o_response, const cppcms::json::value& i_call, const bool& i_single)
+{
+  cppcms::json::value nullId;
+  nullId.null ();
+  o_response.set ("jsonrpc", "2.0");
+  o_response.set ("id", nullId);
+
+  // validate the call
+  if (cppcms::json::is_object != i_call.type ())
+  {
+    o_response.set ("error.code", -32600);
+    o_response.set ("error.message", "invalid request");
+    return true;
+  }
+  const cppcms::json::value& id     = i_call.find ("id");
+  const cppcms::json::value& method = i_call.find ("method");
+  const cppcms::json::value& params = i_call.find ("params");
+  bool notification = (cppcms::json::is_undefined == id.type ());
+  if (!notification)
+  {
+    o_response.set ("id", id);
+  }
+
+  if ((cppcms::json::is_string != method.type ()) ||
+      ((cppcms::json::is_undefined != params.type ()) && (cppcms::json::is_array != params.type ())))
+  {
+    o_response.set ("error.code", -32600);
+    o_response.set ("error.message", "invalid request");
+    return true;
+  }
+
+  methods_type::const_iterator itMethod = m_methods.find (method.str ());
+  if (m_methods.end () == itMethod)
+  {
+    o_response.set ("error.code", -32601);
+    o_response.set ("error.message", "method not found");
+    return !notification;
+  }
+
+  // note: listening releases the context, which can not be shared with other calls of a batch
+  if (!i_single && ("ListenToDeviceUpdates" == method.str ()))
+  {
+    o_response.set ("error.code", -32600);
+    o_response.set ("error.message", "method not allowed in a batch");
+    return !notification;
+  }
+
+  // call the method, it returns through _ReturnResult or _ReturnError
+  BatchCallResult callResult;
+  bool invalidParams = false;
+  m_pBatchCallResult = &callResult;
+  try
+  {
+    static const cppcms::json::array noParams;
+    itMethod->second ((cppcms::json::is_array == params.type ()) ? params.array () : noParams);
+  }
+  catch (...)
+  {
+    // note: the methods catch their own exceptions, the parameters did not convert to the method's arguments
+    invalidParams = true;
+  }
+  m_pBatchCallResult = 0x0;
+
+  if (invalidParams)
+  {
+    o_response.set ("error.code", -32602);
+    o_response.set ("error.message", "invalid params");
+  }
+  else if (callResult.m_released)
+  {
+    return false;
+  }
+  else if (!callResult.m_returned)
+  {
+    o_response.set ("error.code", -32603);
+    o_response.set ("error.message", "no result");
+  }
+  else if (callResult.m_failed)
+  {
+    o_response.set ("error.code", -32000);
+    o_response.set ("error.message", callResult.m_value);
+  }
+  else
+  {
+    o_response.set ("result", callResult.m_value);
+  }
+
+  return !notification;
+}
+
+/*!
+  \brief Binds the codec of an rpc method, reading its parameters from single json calls.
+
+  \param [in] i_name   The name of the method, bound with _Bind as well.
+  \param [in] i_method The method reading the parameters and calling the bound method.
+ */
+void Switch::HttpInterfaceBase::_BindCodec (const std::string& i_name, const codec_method_type& i_method)
+{
+  m_codecMethods.push_back (std::make_pair (i_name, i_method));
+}
+
+/*!
+  \brief Executes a single json call of a method with a codec.
+
+  The call is parsed from the request body without building a json value and its
+  response is written to the output stream. Calls the codecs can not handle, such as
+  notifications and calls that are no valid json, are left to the json-rpc server.
+
+  \return True if the call was executed, false otherwise.
+ */
+bool Switch::HttpInterfaceBase::_HandleCodecCall ()
+{
+  if ("POST" != request ().request_method ())
+  {
+    return false;
+  }
+
+  m_arena.Reset ();
+  std::pair <void*, size_t> postData = request ().raw_post_data ();
+  const char* pBegin = static_cast <const char*> (postData.first);
+  const char* pEnd   = pBegin + postData.second;
+
+  // find the method, the parameters and the id, in any order
+  Switch::Codec::Reader callReader (pBegin, pEnd, m_arena);
+  const char* pMethod = 0x0;
+  size_t methodSize = 0;
+  const char* pParamsBegin = 0x0;
+  const char* pParamsEnd   = 0x0;
+  const char* pIdBegin = 0x0;
+  const char* pIdEnd   = 0x0;
+  const char* pName;
+  size_t nameSize;
+  if (!callReader.BeginObject ())
+  {
+    return false;
+  }
+  while (callReader.NextMember (pName, nameSize))
+  {
+    std::string name (pName, nameSize);
+    bool read = ("method" == name) ? callReader.ReadString (pMethod, methodSize) :
+                ("params" == name) ? callReader.Skip (pParamsBegin, pParamsEnd) :
+                ("id"     == name) ? callReader.Skip (pIdBegin, pIdEnd) : callReader.Skip ();
+    if (!read)
+    {
+      return false;
+    }
+  }
+  if (!callReader.IsAtEnd () || (0x0 == pMethod) || (0x0 == pParamsBegin) || (0x0 == pIdBegin) || ('n' == *pIdBegin))
+  {
+    return false;
+  }
+
+  codec_methods_type::const_iterator itMethod;
+  for (itMethod = m_codecMethods.begin (); m_codecMethods.end () != itMethod; ++itMethod)
+  {
+    if (0 == itMethod->first.compare (0, std::string::npos, pMethod, methodSize))
+    {
+      break;
+    }
+  }
+  if (m_codecMethods.end () == itMethod)
+  {
+    return false;
+  }
+
+  // answer as the json-rpc server does
+  response ().set_content_header ("application/json");
+  Switch::Codec::Writer writer (response ().out ());
+  writer.BeginObject ();
+  writer.Name ("id");
+  writer.WriteRaw (pIdBegin, static_cast <size_t> (pIdEnd - pIdBegin));
+
+  // call the method, it returns through _ReturnResult or _ReturnError or writes its result
+  BatchCallResult callResult;
+  Switch::Codec::Reader paramsReader (pParamsBegin, pParamsEnd, m_arena);
+  m_pBatchCallResult = &callResult;
+  m_pCodecWriter     = &writer;
+  try
+  {
+    (this->*(itMethod->second)) (paramsReader);
+  }
+  catch (...)
+  {
+    _ReturnError ("invalid parameters");
+  }
+  m_pBatchCallResult = 0x0;
+  m_pCodecWriter     = 0x0;
+
+  if (!callResult.m_streamed)
+  {
+    if (!callResult.m_returned)
+    {
+      callResult.m_failed = true;
+      callResult.m_value  = "no result";
+    }
+    writer.Name ("error");
+    if (callResult.m_failed)
+    {
+      writer.WriteJson (callResult.m_value);
+    }
+    else
+    {
+      writer.WriteNull ();
+    }
+    writer.Name ("result");
+    if (callResult.m_failed)
+    {
+      writer.WriteNull ();
+    }
+    else
+    {
+      writer.WriteJson (callResult.m_value);
+    }
+  }
+  writer.EndObject ();
+  writer.Flush ();
+
+  return true;
+}
+
+/*!
+  \brief Reads the parameters of GetDeviceValues and writes the values to the response.
+ */
+void Switch::HttpInterfaceBase::_DecodeGetDeviceValues (Switch::Codec::Reader& io_params)
+{
+  // 0. Validate the call
+  if (!_IsClientRegistered ())
+  {
+    _ReturnError ("client not registered");
+    return;
+  }
+
+  // 1. Validate the arguments
+  Switch::Interface::Device::Id deviceId = 0;
+  if (!Switch::Codec::ReadTuple (io_params, deviceId))
+  {
+    _ReturnError ("invalid parameters");
+    return;
+  }
+
+  // 2. Call the framework
+  std::list <Switch::Interface::Device::Value> outValues;
+  Switch::Interface::eCallResult callResult = _GetDeviceValues (outValues, deviceId);
+
+  // 3. Send response
+  Switch::Codec::Writer& writer = *m_pCodecWriter;
+  writer.Name ("error");
+  writer.WriteNull ();
+  writer.Name ("result");
+  writer.BeginObject ();
+  writer.Name ("result");
+  Switch::Codec::Write (writer, callResult);
+  writer.Name ("deviceValues");
+  Switch::Codec::Write (writer, outValues);
+  writer.EndObject ();
+  m_pBatchCallResult->m_returned = true;
+  m_pBatchCallResult->m_streamed = true;
+}
+
+/*!
+  \brief Reads the parameters of GetMultipleDeviceValues and writes the snapshot to the response.
+ */
+void Switch::HttpInterfaceBase::_DecodeGetMultipleDeviceValues (Switch::Codec::Reader& io_params)
+{
+  // 0. Validate the call
+  if (!_IsClientRegistered ())
+  {
+    _ReturnError ("client not registered");
+    return;
+  }
+
+  // 1. Validate the arguments
+  Switch::Codec::ArenaVector <Switch::Interface::Device::Id> deviceIdList ((Switch::Codec::ArenaAllocator <Switch::Interface::Device::Id> (io_params.GetArena ())));
+  if (!Switch::Codec::ReadTuple (io_params, deviceIdList))
+  {
+    _ReturnError ("invalid parameters");
+    return;
+  }
+  std::set <Switch::Interface::Device::Id> deviceIds (deviceIdList.begin (), deviceIdList.end ());
+  if (HTTP_MAX_SNAPSHOT_SIZE < deviceIds.size ())
+  {
+    _ReturnError ("too many devices");
+    return;
+  }
+
+  // 2. Call the framework and 3. send response
+  Switch::Codec::Writer& writer = *m_pCodecWriter;
+  writer.Name ("error");
+  writer.WriteNull ();
+  writer.Name ("result");
+  _WriteDeviceValuesSnapshot (writer, deviceIds);
+  m_pBatchCallResult->m_returned = true;
+  m_pBatchCallResult->m_streamed = true;
+}
+
+/*!
+  \brief Reads the parameters of GetDeviceGroupValues and writes the snapshot to the response.
+ */
+void Switch::HttpInterfaceBase::_DecodeGetDeviceGroupValues (Switch::Codec::Reader& io_params)
+{
+  // 0. Validate the call
+  if (!_IsClientRegistered ())
+  {
+    _ReturnError ("client not registered");
+    return;
+  }
+
+  // 1. Validate the arguments
+  std::string group;
+  if (!Switch::Codec::ReadTuple (io_params, group))
+  {
+    _ReturnError ("invalid parameters");
+    return;
+  }
+  std::set <Switch::Interface::Device::Id> deviceIds;
+  _GetDeviceGroup (deviceIds, group);
+  if (HTTP_MAX_SNAPSHOT_SIZE < deviceIds.size ())
+  {
+    _ReturnError ("too many devices");
+    return;
+  }
+
+  // 2. Call the framework and 3. send response
+  Switch::Codec::Writer& writer = *m_pCodecWriter;
+  writer.Name ("error");
+  writer.WriteNull ();
+  writer.Name ("result");
+  _WriteDeviceValuesSnapshot (writer, deviceIds);
+  m_pBatchCallResult->m_returned = true;
+  m_pBatchCallResult->m_streamed = true;
+}
+
+/*!
+  \brief Reads the desired values of devices at once and sets them as a snapshot in a result.
+
+  \param [out] o_result    The result, with the call result and the snapshot.
+  \param [in]  i_deviceIds The ids of the devices.
+ */
+void Switch::HttpInterfaceBase::_GetDeviceValuesSnapshot (cppcms::json::value& o_result, const std::set <Switch::Interface::Device::Id>& i_deviceIds)
+{
+  std::map <Switch::Interface::Device::Id, std::list <Switch::Interface::Device::Value>> outValues;
+  Switch::Interface::eCallResult callResult = _GetMultipleDeviceValues (outValues, i_deviceIds);
+
+  o_result.set ("result", callResult);
+  if (Switch::Interface::CR_OK != callResult)
+  {
+    return;
+  }
+
+  // each device is a flat array of its id and the address, magic number and value of its elements
+  cppcms::json::value snapshot;
+  cppcms::json::array& deviceArray = snapshot.array ();
+  std::map <Switch::Interface::Device::Id, std::list <Switch::Interface::Device::Value>>::const_iterator itDevice;
+  for (itDevice = outValues.begin (); outValues.end () != itDevice; ++itDevice)
+  {
+    deviceArray.push_back (cppcms::json::value ());
+    cppcms::json::array& elementArray = deviceArray.back ().array ();
+    elementArray.push_back (cppcms::json::value (itDevice->first));
+    std::list <Switch::Interface::Device::Value>::const_iterator itValue;
+    for (itValue = itDevice->second.begin (); itDevice->second.end () != itValue; ++itValue)
+    {
+      elementArray.push_back (cppcms::json::value (itValue->m_address));
+      elementArray.push_back (cppcms::json::value (itValue->m_magicNumber));
+      elementArray.push_back (cppcms::json::value (itValue->m_value));
+    }
+  }
+  o_result.set ("snapshot", snapshot);
+}
+
+/*!
+  \brief Reads the desired values of devices at once and writes them as a snapshot, in the form of _GetDeviceValuesSnapshot.
+
+  \param [in,out] io_writer   The writer of the response.
+  \param [in]     i_deviceIds The ids of the devices.
+ */
+void Switch::HttpInterfaceBase::_WriteDeviceValuesSnapshot (Switch::Codec::Writer& io_writer, const std::set <Switch::Interface::Device::Id>& i_deviceIds)
+{
+  std::map <Switch::Interface::Device::Id, std::list <Switch::Interface::Device::Value>> outValues;
+  Switch::Interface::eCallResult callResult = _GetMultipleDeviceValues (outValues, i_deviceIds);
+
+  io_writer.BeginObject ();
+  io_writer.Name ("result");
+  Switch::Codec::Write (io_writer, callResult);
+  if (Switch::Interface::CR_OK == callResult)
+  {
+    io_writer.Name ("snapshot");
+    io_writer.BeginArray ();
+    std::map <Switch::Interface::Device::Id, std::list <Switch::Interface::Device::Value>>::const_iterator itDevice;
+    for (itDevice = outValues.begin (); outValues.end () != itDevice; ++itDevice)
+    {
+      io_writer.NextElement ();
+      io_writer.BeginArray ();
+      io_writer.NextElement ();
+      io_writer.WriteUnsigned (itDevice->first);
+      std::list <Switch::Interface::Device::Value>::const_iterator itValue;
+      for (itValue = itDevice->second.begin (); itDevice->second.end () != itValue; ++itValue)
+      {
+        io_writer.NextElement ();
+        io_writer.WriteUnsigned (itValue->m_address);
+        io_writer.NextElement ();
+        io_writer.WriteUnsigned (itValue->m_magicNumber);
+        io_writer.NextElement ();
+        io_writer.WriteUnsigned (itValue->m_value);
+      }
+      io_writer.EndArray ();
+    }
+    io_writer.EndArray ();
+  }
+  io_writer.EndObject ();
+}
+
+/*!
+  \brief Reads the parameters of GetChangesSince and writes the changes to the response.
+ */
+void Switch::HttpInterfaceBase::_DecodeGetChangesSince (Switch::Codec::Reader& io_params)
+{
+  // 0. Validate the call
+  if (!_IsClientRegistered ())
+  {
+    _ReturnError ("client not registered");
+    return;
+  }
+
+  // 1. Validate the arguments
+  uint64_t version = 0;
+  if (!Switch::Codec::ReadTuple (io_params, version))
+  {
+    _ReturnError ("invalid parameters");
+    return;
+  }
+
+  // 2. Call the framework
+  uint64_t outVersion = 0;
+  std::list <Switch::Interface::Device::Summary> outDevices;
+  std::map <Switch::Interface::Device::Id, std::list <Switch::Interface::Device::Value>> outValues;
+  Switch::Interface::eCallResult callResult = _GetChangesSince (outVersion, outDevices, outValues, version);
+
+  // 3. Send response
+  Switch::Codec::Writer& writer = *m_pCodecWriter;
+  writer.Name ("error");
+  writer.WriteNull ();
+  writer.Name ("result");
+  writer.BeginObject ();
+  writer.Name ("result");
+  Switch::Codec::Write (writer, callResult);
+  if (Switch::Interface::CR_OK == callResult)
+  {
+    writer.Name ("version");
+    Switch::Codec::Write (writer, outVersion);
+    writer.Name ("devices");
+    Switch::Codec::Write (writer, outDevices);
+    writer.Name ("deviceValues");
+    Switch::Codec::Write (writer, outValues);
+  }
+  writer.EndObject ();
+  m_pBatchCallResult->m_returned = true;
+  m_pBatchCallResult->m_streamed = true;
+}
+
+/*!
+  \brief Reads the parameters of EnumerateDevicePage and writes the page to the response.
+ */
+void Switch::HttpInterfaceBase::_DecodeEnumerateDevicePage (Switch::Codec::Reader& io_params)
+{
+  // 0. Validate the call
+  if (!_IsClientRegistered ())
+  {
+    _ReturnError ("client not registered");
+    return;
+  }
+
+  // 1. Validate the arguments
+  uint32_t cursor = 0;
+  uint32_t limit  = 0;
+  if (!Switch::Codec::ReadTuple (io_params, cursor, limit))
+  {
+    _ReturnError ("invalid parameters");
+    return;
+  }
+  if ((0 == limit) || (HTTP_MAX_DEVICE_PAGE_SIZE < limit))
+  {
+    _ReturnError ("invalid limit");
+    return;
+  }
+
+  // 2. Call the framework and 3. send response
+  Switch::Codec::Writer& writer = *m_pCodecWriter;
+  writer.Name ("error");
+  writer.WriteNull ();
+  writer.Name ("result");
+  _WriteDevicePage (writer, cursor, limit);
+  m_pBatchCallResult->m_returned = true;
+  m_pBatchCallResult->m_streamed = true;
+}
+
+/*!
+  \brief Writes a page of the devices, each device as it is visited in the device store.
+
+  \param [in,out] io_writer The writer of the response.
+  \param [in]     i_cursor  The cursor of the page, 0 for the first page.
+  \param [in]     i_limit   The maximum number of devices in the page.
+ */
+void Switch::HttpInterfaceBase::_WriteDevicePage (Switch::Codec::Writer& io_writer, const uint32_t& i_cursor, const uint32_t& i_limit)
+{
+  // note: the result is only known after the visit, it follows the devices
+  io_writer.BeginObject ();
+  io_writer.Name ("devices");
+  io_writer.BeginArray ();
+  uint32_t nextCursor = 0;
+  Switch::Interface::eCallResult callResult = _VisitDevices
+  (
+    nextCursor,
+    [&io_writer] (const Switch::Interface::Device::Summary& i_summary)
+    {
+      io_writer.NextElement ();
+      Switch::Codec::Write (io_writer, i_summary);
+    },
+    i_cursor,
+    i_limit
+  );
+  io_writer.EndArray ();
+  io_writer.Name ("result");
+  Switch::Codec::Write (io_writer, callResult);
+  io_writer.Name ("nextCursor");
+  Switch::Codec::Write (io_writer, nextCursor);
+  io_writer.EndObject ();
+}
+
+/*!
+  \brief Reads the parameters of SetDeviceValues into the arena and calls it.
+ */
+void Switch::HttpInterfaceBase::_DecodeSetDeviceValues (Switch::Codec::Reader& io_params)
+{
+  Switch::Interface::Device::Id deviceId = 0;
+  Switch::Codec::ArenaVector <Switch::Interface::Device::Value> values ((Switch::Codec::ArenaAllocator <Switch::Interface::Device::Value> (io_params.GetArena ())));
+  if (!Switch::Codec::ReadTuple (io_params, deviceId, values))
+  {
+    _ReturnError ("invalid parameters");
+    return;
+  }
+
+  // note: the functional interface takes lists, the values are copied once at its boundary
+  SetDeviceValues (deviceId, std::list <Switch::Interface::Device::Value> (values.begin (), values.end ()));
+}
+
+/*!
+  \brief Reads the parameters of SetMultipleDeviceValues into the arena and calls it.
+ */
+void Switch::HttpInterfaceBase::_DecodeSetMultipleDeviceValues (Switch::Codec::Reader& io_params)
+{
+  Switch::Codec::ArenaVector <Switch::Codec::DeviceValues> deviceValues ((Switch::Codec::ArenaAllocator <Switch::Codec::DeviceValues> (io_params.GetArena ())));
+  if (!Switch::Codec::ReadTuple (io_params, deviceValues))
+  {
+    _ReturnError ("invalid parameters");
+    return;
+  }
+
+  // note: values of a device listed more than once are merged, as by the json traits
+  std::map <Switch::Interface::Device::Id, std::list <Switch::Interface::Device::Value>> values;
+  Switch::Codec::ArenaVector <Switch::Codec::DeviceValues>::const_iterator itDevice;
+  for (itDevice = deviceValues.begin (); deviceValues.end () != itDevice; ++itDevice)
+  {
+    std::list <Switch::Interface::Device::Value>& valuesOfDevice = values [itDevice->m_deviceId];
+    valuesOfDevice.insert (valuesOfDevice.end (), itDevice->m_values.begin (), itDevice->m_values.end ());
+  }
+  SetMultipleDeviceValues (values);
+}
+
+Switch::HttpInterfaceBase::CachedResponse::CachedResponse ()
+: m_version (0)
+{
+}
+
+Switch::HttpInterfaceBase::BatchCallResult::BatchCallResult ()
+: m_returned (false),
+  m_failed (false),
+  m_released (false),
+  m_streamed (false)
+{
+}
+
+
+/*!
+  \brief Gets the response of EnumerateDevices, rebuilding it only if the device catalog changed.
+
+  \return The response.
+ */
+Switch::HttpInterfaceBase::cached_response_type Switch::HttpInterfaceBase::_GetDevicesResponse ()
+{
+  // note: the version is read before the response is built, a change while building only causes a rebuild
+  uint64_t version = 0;
+  bool cacheable = (Switch::Interface::CR_OK == _GetDeviceCatalogVersion (version));
+  if (cacheable)
+  {
+    std::unique_lock <std::mutex> responseCacheLock (m_responseCacheMutex);
+    if (m_pDevicesResponse && (version == m_pDevicesResponse->m_version))
+    {
+      return m_pDevicesResponse;
+    }
+  }
+
+  // build the response
+  std::list <Switch::Interface::Device::Summary> outDevices;
+  Switch::Interface::eCallResult callResult = _EnumerateDevices (outDevices);
+
+  std::shared_ptr <CachedResponse> pResponse (new CachedResponse ());
+  pResponse->m_result.set ("result", callResult);
+  pResponse->m_result.set ("devices", outDevices);
+  _SetCachedResponseContent (*pResponse, "devices", version);
+
+  // cache successful responses only
+  if (cacheable && (Switch::Interface::CR_OK == callResult))
+  {
+    std::unique_lock <std::mutex> responseCacheLock (m_responseCacheMutex);
+    m_pDevicesResponse = pResponse;
+  }
+
+  return pResponse;
+}
+
+/*!
+  \brief Gets the response of GetDeviceDetails, rebuilding it only if the device catalog changed.
+
+  \param [in] i_deviceId The id of the device.
+
+  \return The response.
+ */
+Switch::HttpInterfaceBase::cached_response_type Switch::HttpInterfaceBase::_GetDeviceDetailsResponse (const uint32_t& i_deviceId)
+{
+  // note: the version is read before the response is built, a change while building only causes a rebuild
+  uint64_t version = 0;
+  bool cacheable = (Switch::Interface::CR_OK == _GetDeviceCatalogVersion (version));
+  if (cacheable)
+  {
+    std::unique_lock <std::mutex> responseCacheLock (m_responseCacheMutex);
+    std::map <uint32_t, cached_response_type>::const_iterator itResponse = m_deviceDetailsResponses.find (i_deviceId);
+    if ((m_deviceDetailsResponses.end () != itResponse) && (version == itResponse->second->m_version))
+    {
+      return itResponse->second;
+    }
+  }
+
+  // build the response
+  Switch::Interface::Device outDeviceDetails;
+  Switch::Interface::eCallResult callResult = _GetDeviceDetails (outDeviceDetails, i_deviceId);
+
+  std::shared_ptr <CachedResponse> pResponse (new CachedResponse ());
+  pResponse->m_result.set ("result", callResult);
+  pResponse->m_result.set ("deviceDetails", outDeviceDetails);
+  std::ostringstream tagStream;
+  tagStream << "device-" << i_deviceId;
+  _SetCachedResponseContent (*pResponse, tagStream.str (), version);
+
+  // cache successful responses only, unknown devices do not fill the cache
+  if (cacheable && (Switch::Interface::CR_OK == callResult))
+  {
+    std::unique_lock <std::mutex> responseCacheLock (m_responseCacheMutex);
+    m_deviceDetailsResponses [i_deviceId] = pResponse;
+  }
+
+  return pResponse;
+}
+
+/*!
+  \brief Serializes a cached response and tags it with its version.
+
+  \param [in,out] io_response The response, its result must be set.
+  \param [in]     i_tag       Name of the resource the response represents.
+  \param [in]     i_version   The device catalog version the response was built for.
+ */
+void Switch::HttpInterfaceBase::_SetCachedResponseContent (CachedResponse& io_response, const std::string& i_tag, const uint64_t& i_version)
+{
+  // note: catalog versions restart with the process, the start time keeps the tags of different runs apart
+  static const uint64_t s_epoch = std::chrono::duration_cast <std::chrono::seconds> (std::chrono::system_clock::now ().time_since_epoch ()).count ();
+
+  io_response.m_version = i_version;
+
+  std::ostringstream bodyStream;
+  io_response.m_result.save (bodyStream, cppcms::json::compact);
+  io_response.m_body = bodyStream.str ();
+
+  std::ostringstream etagStream;
+  etagStream << "\"" << i_tag << "-" << s_epoch << "-" << i_version;
+  io_response.m_etag = etagStream.str () + "\"";
+
+  io_response.m_cborBody.clear ();
+  Switch::Cbor::Encode (io_response.m_cborBody, io_response.m_result);
+  io_response.m_cborEtag = etagStream.str () + "-cbor\"";
+}
+
+/*!
+  \brief Sends a cached response, or 304 Not Modified if the request's If-None-Match matches its entity tag.
+
+  \param [in] i_pResponse The response.
+ */
+void Switch::HttpInterfaceBase::_ServeCachedResponse (const cached_response_type& i_pResponse)
+{
+  const bool cbor = _AcceptsCbor ();
+  const std::string& etag = cbor ? i_pResponse->m_cborEtag : i_pResponse->m_etag;
+
+  // note: clients must revalidate, the response is only current as long as the catalog is
+  response ().set_header ("ETag", etag);
+  response ().set_header ("Cache-Control", "no-cache");
+  response ().set_header ("Vary", "Accept");
+
+  const std::string ifNoneMatch = request ().getenv ("HTTP_IF_NONE_MATCH");
+  if (("*" == ifNoneMatch) || (std::string::npos != ifNoneMatch.find (etag)))
+  {
+    response ().status (304);
+    return;
+  }
+
+  if (cbor)
+  {
+    response ().set_content_header ("application/cbor");
+    response ().out ().write (i_pResponse->m_cborBody.data (), i_pResponse->m_cborBody.size ());
+  }
+  else
+  {
+    response ().set_content_header ("application/json");
+    response ().out () << i_pResponse->m_body;
+  }
+}
@@ -9,6 +9,11 @@
 #ifndef _SWITCH_HTTPINTERFACEBASE
 #define _SWITCH_HTTPINTERFACEBASE
 
+// project includes
+#include "Switch_HttpSubscriptionIndex.h"
+#include "Switch_HttpCodec.h"
+#include "Switch_HttpClientRegistry.h"
+
 // Switch includes
 #include <Switch_Base/Switch_CompilerConfiguration.h>
 #include <Switch_API/Switch_InterfaceTypes.h>
@@ -18,9 +23,17 @@
 #include <cppcms/service.h>
 #include <cppcms/rpc_json.h>
 #include <cppcms/http_context.h>
+#include <booster/aio/deadline_timer.h>
 #include <map>
 #include <set>
+#include <vector>
 #include <mutex>
+#include <memory>
+#include <string>
+#include <deque>
+#include <atomic>
+#include <chrono>
+#include <functional>
 
 namespace Switch
 {
@@ -32,8 +45,10 @@ namespace Switch
   {
   public:
 
+    class SharedState;
+
     // constructor and destructor
-    explicit HttpInterfaceBase (cppcms::service& i_service);
+    explicit HttpInterfaceBase (cppcms::service& i_service, const std::shared_ptr <SharedState>& i_pSharedState);
     virtual ~HttpInterfaceBase ();
 
     // copy constructor and assignment operator disabled
@@ -50,20 +65,89 @@ namespace Switch
     // system methods
     void AddDevice        (const Switch::Interface::Device::Id& i_deviceId);
     void EnumerateDevices ();
+    void EnumerateDevicePage (const uint32_t& i_cursor, const uint32_t& i_limit);
     void GetDeviceDetails (const Switch::Interface::Device::Id& i_deviceId);
     void GetDeviceValues  (const Switch::Interface::Device::Id& i_deviceId);
+    void GetMultipleDeviceValues (const std::list <Switch::Interface::Device::Id>& i_deviceIds);
+    void GetDeviceGroupValues (const std::string& i_group);
+    void GetDeviceReportedValues (const Switch::Interface::Device::Id& i_deviceId);
     void SetDeviceValues  (const Switch::Interface::Device::Id& i_deviceId, const std::list <Switch::Interface::Device::Value>& i_deviceValues);
+    void SetMultipleDeviceValues (const std::map <Switch::Interface::Device::Id, std::list <Switch::Interface::Device::Value>>& i_deviceValues);
+    void GetSceneResults  (const uint32_t& i_sceneId);
+    void GetCommandBacklog ();
+    void GetChangesSince  (const uint64_t& i_version);
     //void SetDeviceProperties (const uint32_t& i_deviceId, const Switch_Device::Properties& i_deviceProperties);
 
     // subscription methods
     void SubscribeToDeviceUpdates     (const Switch::Interface::Device::Id& i_deviceId);
     void UnsubscribeFromDeviceUpdates (const Switch::Interface::Device::Id& i_deviceId);
-    void ListenToDeviceUpdates        ();
+    void SubscribeToDeviceElementUpdates      (const Switch::Interface::Device::Id& i_deviceId, const std::list <uint32_t>& i_addresses);
+    void SubscribeToDeviceElementGroupUpdates (const Switch::Interface::Device::Id& i_deviceId, const std::string& i_elementGroup);
+    void SubscribeToDeviceGroupUpdates      (const std::string& i_group);
+    void UnsubscribeFromDeviceGroupUpdates  (const std::string& i_group);
+    void SubscribeToProductTypeUpdates      (const std::string& i_productType);
+    void UnsubscribeFromProductTypeUpdates  (const std::string& i_productType);
+    void SubscribeToAllDeviceUpdates        ();
+    void UnsubscribeFromAllDeviceUpdates    ();
+    void DefineDeviceGroup            (const std::string& i_group, const std::list <Switch::Interface::Device::Id>& i_deviceIds);
+    void ListenToDeviceUpdates        (const uint64_t& i_cursor);
+    void SetDeviceUpdateInterval      (const uint32_t& i_intervalMs);
+    void StreamDeviceUpdates          ();
+
+    // cached resources
+    void ServeDevices ();
+    void ServeDevice  (std::string i_deviceId);
 
   protected:
 
-    typedef size_t client_id_type;  ///< Type of client identifiers.
-    typedef std::map <client_id_type, booster::shared_ptr <cppcms::rpc::json_call>> device_update_listeners_type;
+    typedef HttpSubscriptionIndex::client_id_type client_id_type; ///< Type of client identifiers.
+    typedef std::vector <client_id_type>          client_ids_type;  ///< Clients an update is sent to.
+
+    class DeviceConnectionUpdate;
+    class DeviceDataUpdate;
+
+    /*!
+      \brief Serialized device update, shared by all listeners it is sent to.
+
+      Connection and data updates keep their content, to be merged into the coalesced
+      updates of rate limited clients.
+     */
+    class DeviceUpdateMessage
+    {
+    public:
+
+      enum eEvent
+      {
+        UE_CONNECTION_UPDATE  = 0,
+        UE_DATA_UPDATE        = 1,
+        UE_OTHER              = 2
+      };
+
+      explicit DeviceUpdateMessage (const cppcms::json::value& i_update);
+      explicit DeviceUpdateMessage (const DeviceConnectionUpdate& i_update);
+      explicit DeviceUpdateMessage (const DeviceDataUpdate& i_update);
+
+      const std::string& GetJson () const;
+      const std::string& GetCbor () const;
+
+      eEvent                                        m_event;
+      uint64_t                                      m_index;      ///< Index of the update, 0 for other events.
+      Switch::Interface::Device::Id                 m_deviceId;   ///< Id of the device the update is related to, 0 for other events.
+      Switch::Interface::Device::Connection         m_connection; ///< The connection, for connection updates.
+      std::list <Switch::Interface::Device::Value>  m_dataValues; ///< The values, for data updates.
+
+    private:
+
+      void _Serialize ();
+
+      cppcms::json::value     m_update;     ///< The update.
+      std::string             m_json;       ///< The update as json text.
+      mutable std::once_flag  m_cborFlag;   ///< Flags if the binary encoding was made.
+      mutable std::string     m_cbor;       ///< The update in binary encoding, made when first sent to a binary listener.
+    };
+
+    typedef std::shared_ptr <const DeviceUpdateMessage> device_update_message_type;
+    typedef std::function <void (const Switch::Interface::Device::Summary&)> device_summary_visitor_type;
 
     class DeviceConnectionUpdate
     {
@@ -71,9 +155,10 @@ namespace Switch
 
       DeviceConnectionUpdate ();
 
-      uint32_t                              m_index;      ///< Unique index identifying this device update.
+      uint64_t                              m_index;      ///< Unique index identifying this device update, from _GenerateUpdateIndex.
       Switch::Interface::Device::Id         m_deviceId;   ///< Id of the device this update is related to.
       Switch::Interface::Device::Connection m_connection;
+      device_update_message_type            m_pMessage;   ///< The serialized update, set when first sent.
     };
 
     class DeviceDataUpdate
@@ -83,38 +168,237 @@ namespace Switch
       DeviceDataUpdate ();
       DeviceDataUpdate& operator= (const DeviceDataUpdate& i_other);
 
-      uint32_t                                      m_index;      ///< Unique index identifying this device update.
+      uint64_t                                      m_index;      ///< Unique index identifying this device update, from _GenerateUpdateIndex.
       Switch::Interface::Device::Id                 m_deviceId;   ///< Id of the device this update is related to.
       std::list <Switch::Interface::Device::Value>  m_dataValues;
+      device_update_message_type                    m_pMessage;   ///< The serialized update, set when first sent.
     };
 
     // utility methods
     void _Help ();
-    void _OnDeviceUpdate (const std::set <client_id_type>& i_deviceUpdateListenerIds, const DeviceConnectionUpdate& i_update);
-    void _OnDeviceUpdate (const std::set <client_id_type>& i_deviceUpdateListenerIds, const DeviceDataUpdate& i_update);
+    void _ReturnResult (const cppcms::json::value& i_result);
+    void _ReturnError  (const cppcms::json::value& i_error);
+    void _ReturnBusy   (cppcms::json::value& io_result);
+    uint64_t _GenerateUpdateIndex ();
+    uint64_t _GetLastUpdateIndex () const;
+    uint64_t _GetFirstUpdateIndex () const;
+    device_update_message_type _CreateResyncRequiredMessage () const;
+    void _OnDeviceUpdate (const client_ids_type& i_deviceUpdateListenerIds, DeviceConnectionUpdate& io_update);
+    void _OnDeviceUpdate (const client_ids_type& i_deviceUpdateListenerIds, DeviceDataUpdate& io_update);
+    void _HandleDeviceUpdate (const client_ids_type& i_deviceUpdateListenerIds, const Switch::Interface::Device::Id& i_deviceId, const device_update_message_type& i_pMessage);
 
     // system methods
     virtual Switch::Interface::eCallResult _AddDevice         (const Switch::Interface::Device::Id& i_deviceId) = 0;
     virtual Switch::Interface::eCallResult _EnumerateDevices  (std::list <Switch::Interface::Device::Summary>& o_deviceInfo) = 0;
+    virtual Switch::Interface::eCallResult _VisitDevices      (uint32_t& o_nextDeviceId, const device_summary_visitor_type& i_visitor, const Switch::Interface::Device::Id& i_firstDeviceId, const uint32_t& i_maxNrDevices) = 0;
     virtual Switch::Interface::eCallResult _GetDeviceDetails  (Switch::Interface::Device& o_deviceDetails, const Switch::Interface::Device::Id& i_deviceId) = 0;
+    virtual Switch::Interface::eCallResult _GetDeviceCatalogVersion (uint64_t& o_version) = 0;
     virtual Switch::Interface::eCallResult _GetDeviceValues   (std::list <Switch::Interface::Device::Value>& o_values, const Switch::Interface::Device::Id& i_deviceId) = 0;
+    virtual Switch::Interface::eCallResult _GetMultipleDeviceValues (std::map <Switch::Interface::Device::Id, std::list <Switch::Interface::Device::Value>>& o_values, const std::set <Switch::Interface::Device::Id>& i_deviceIds) = 0;
+    virtual Switch::Interface::eCallResult _GetDeviceReportedValues (std::list <Switch::Interface::Device::Value>& o_values, const Switch::Interface::Device::Id& i_deviceId) = 0;
     virtual Switch::Interface::eCallResult _SetDeviceValues   (const Switch::Interface::Device::Id& i_deviceId, const std::list <Switch::Interface::Device::Value>& i_values) = 0;
+    virtual Switch::Interface::eCallResult _SetMultipleDeviceValues (std::map <Switch::Interface::Device::Id, Switch::Interface::eCallResult>& o_results, uint32_t& o_sceneId, const std::map <Switch::Interface::Device::Id, std::list <Switch::Interface::Device::Value>>& i_values) = 0;
+    virtual Switch::Interface::eCallResult _GetSceneResults   (std::map <Switch::Interface::Device::Id, Switch::Interface::eCallResult>& o_results, const uint32_t& i_sceneId) = 0;
+    virtual Switch::Interface::eCallResult _GetCommandBacklog (uint32_t& o_nrQueuedCommands, uint32_t& o_drainTimeMicros) = 0;
+    virtual Switch::Interface::eCallResult _GetChangesSince   (uint64_t& o_version, std::list <Switch::Interface::Device::Summary>& o_devices, std::map <Switch::Interface::Device::Id, std::list <Switch::Interface::Device::Value>>& o_values, const uint64_t& i_version) = 0;
     //virtual Switch::Interface::eCallResult _SetDeviceProperties (const uint32_t& i_deviceId, const Switch_Device::Properties& i_deviceProperties) = 0;
 
     // subscription methods
-    virtual Switch::Interface::eCallResult _SubscribeToDeviceUpdates      (const client_id_type& i_clientId, const Switch::Interface::Device::Id& i_deviceId) = 0;
-    virtual Switch::Interface::eCallResult _UnsubscribeFromDeviceUpdates  (const client_id_type& i_clientId, const Switch::Interface::Device::Id& i_deviceId) = 0;
-    virtual void _SendBufferedUpdatesToListener (const client_id_type& i_clientId) = 0;
+    virtual Switch::Interface::eCallResult _SubscribeToDeviceUpdates      (const client_id_type& i_clientId, const SubscriptionTopic& i_topic) = 0;
+    virtual Switch::Interface::eCallResult _UnsubscribeFromDeviceUpdates  (const client_id_type& i_clientId, const SubscriptionTopic& i_topic) = 0;
+    virtual Switch::Interface::eCallResult _DefineDeviceGroup (const std::string& i_group, const std::set <Switch::Interface::Device::Id>& i_deviceIds) = 0;
+    virtual void _GetDeviceGroup (std::set <Switch::Interface::Device::Id>& o_deviceIds, const std::string& i_group) = 0;
+    virtual void _SendBufferedUpdatesToListener (const client_id_type& i_clientId, const uint64_t& i_cursor) = 0;
+    virtual void _RemoveClient (const client_id_type& i_clientId) = 0;
 
   private:
 
-    void _GenerateClientId      (client_id_type& o_clientId);
+    /*!
+      \brief Persistent stream of device updates to a client, sent as server-sent events.
+     */
+    class DeviceUpdateStream
+    {
+    public:
+
+      DeviceUpdateStream ();
+
+      booster::shared_ptr <cppcms::http::context>  m_pContext;       ///< The released context of the streaming request.
+      std::deque <device_update_message_type>     m_pendingEvents;  ///< The messages of the events waiting for the running flush to complete.
+      bool                                        m_flushing;       ///< Flags if a flush is scheduled or running.
+      bool                                        m_closed;         ///< Flags if the client closed the stream.
+    };
+
+    typedef std::map <client_id_type, std::shared_ptr <DeviceUpdateStream>> device_update_streams_type;
+
+    /*!
+      \brief Client waiting for device updates in a parked call.
+     */
+    class DeviceUpdateListener
+    {
+    public:
+
+      DeviceUpdateListener ();
+
+      cppcms::http::context& GetContext ();
+
+      booster::shared_ptr <cppcms::rpc::json_call>  m_pCall;      ///< The released json-rpc call, 0x0 for dispatched calls.
+      booster::shared_ptr <cppcms::http::context>   m_pContext;   ///< The released context of dispatched calls, 0x0 for json-rpc calls.
+      bool                                          m_cbor;       ///< Flags if the client accepts the binary encoding.
+    };
+
+    typedef std::map <client_id_type, DeviceUpdateListener> device_update_listeners_type;
+
+    /*!
+      \brief Minimum interval between the device updates sent to a client, and the updates coalesced meanwhile.
+     */
+    class DeviceUpdateRateLimit
+    {
+    public:
+
+      /*!
+        \brief The coalesced updates of a device, the latest connection and the latest value of every element.
+       */
+      class PendingDeviceUpdate
+      {
+      public:
+
+        PendingDeviceUpdate ();
+
+        uint64_t                                          m_connectionIndex;  ///< Index of the latest connection update, 0 if none.
+        Switch::Interface::Device::Connection             m_connection;
+        uint64_t                                          m_dataIndex;        ///< Index of the latest data update, 0 if none.
+        std::map <uint32_t, Switch::Interface::Device::Value> m_dataValues;   ///< The latest values, mapped to from their element addresses.
+      };
+
+      DeviceUpdateRateLimit ();
+
+      std::chrono::steady_clock::duration           m_minInterval;    ///< Minimum interval between two flushes.
+      std::chrono::steady_clock::time_point         m_lastFlush;      ///< Time the last update was sent.
+      std::map <Switch::Interface::Device::Id, PendingDeviceUpdate> m_pendingUpdates;  ///< The coalesced updates, mapped to from the device ids.
+      bool                                          m_flushScheduled; ///< Flags if a flush of the pending updates is scheduled.
+      std::unique_ptr <booster::aio::deadline_timer> m_pTimer;        ///< Timer of the scheduled flush, made on the event loop of the service.
+    };
+
+    typedef std::map <client_id_type, std::shared_ptr <DeviceUpdateRateLimit>> device_update_rate_limits_type;
+
+    /*!
+      \brief The outcome of one call of a JSON-RPC batch.
+     */
+    class BatchCallResult
+    {
+    public:
+
+      BatchCallResult ();
+
+      bool                m_returned;   ///< Flags if the method returned a result or an error.
+      bool                m_failed;     ///< Flags if the method returned an error.
+      bool                m_released;   ///< Flags if the method released the context to answer later.
+      bool                m_streamed;   ///< Flags if the method wrote its result to the response itself.
+      cppcms::json::value m_value;      ///< The result or the error.
+    };
+
+    typedef std::map <std::string, cppcms::rpc::json_rpc_server::method_type> methods_type;
+    typedef void (HttpInterfaceBase::*codec_method_type) (Switch::Codec::Reader& io_params);
+    typedef std::vector <std::pair <std::string, codec_method_type>>         codec_methods_type;
+
+    /*!
+      \brief Response of a catalog call, valid as long as the device catalog version does not change.
+     */
+    class CachedResponse
+    {
+    public:
+
+      CachedResponse ();
+
+      uint64_t            m_version;  ///< The device catalog version the response was built for.
+      cppcms::json::value m_result;   ///< The result of the rpc call.
+      std::string         m_body;     ///< The serialized result, served to GET requests.
+      std::string         m_etag;     ///< Entity tag identifying the response.
+      std::string         m_cborBody; ///< The result in binary encoding, served to GET requests accepting it.
+      std::string         m_cborEtag; ///< Entity tag identifying the binary response.
+    };
+
+    typedef std::shared_ptr <const CachedResponse> cached_response_type;
+
+    void _HandleSubscriptionCall (const SubscriptionTopic& i_topic, const bool& i_subscribe);
+    void _Bind                  (const std::string& i_name, const cppcms::rpc::json_rpc_server::method_type& i_method, const cppcms::rpc::json_rpc_server::role_type& i_role);
+    bool _IsBatch               ();
+    bool _IsCborRequest         ();
+    bool _AcceptsCbor           ();
+    void _HandleBatch           ();
+    bool _CallInBatch           (cppcms::json::value& o_response, const cppcms::json::value& i_call, const bool& i_single);
+    void _WriteCallResponse     (const cppcms::json::value& i_response, const bool& i_cbor);
+    void _BindCodec             (const std::string& i_name, const codec_method_type& i_method);
+    bool _HandleCodecCall       ();
+    void _DecodeGetDeviceValues         (Switch::Codec::Reader& io_params);
+    void _DecodeGetMultipleDeviceValues (Switch::Codec::Reader& io_params);
+    void _DecodeGetDeviceGroupValues    (Switch::Codec::Reader& io_params);
+    void _GetDeviceValuesSnapshot       (cppcms::json::value& o_result, const std::set <Switch::Interface::Device::Id>& i_deviceIds);
+    void _WriteDeviceValuesSnapshot     (Switch::Codec::Writer& io_writer, const std::set <Switch::Interface::Device::Id>& i_deviceIds);
+    void _DecodeEnumerateDevicePage     (Switch::Codec::Reader& io_params);
+    void _DecodeGetChangesSince         (Switch::Codec::Reader& io_params);
+    void _WriteDevicePage               (Switch::Codec::Writer& io_writer, const uint32_t& i_cursor, const uint32_t& i_limit);
+    void _DecodeSetDeviceValues         (Switch::Codec::Reader& io_params);
+    void _DecodeSetMultipleDeviceValues (Switch::Codec::Reader& io_params);
+
+    std::string _GetClientToken ();
+    bool _GetClientId           (client_id_type& o_clientId);
+    bool _IsClientRegistered    ();
+    void _RemoveIdleClients     (const HttpClientRegistry::clock_type::time_point& i_now);
     void _RemoveListenerContext (const client_id_type& i_clientId);
     void _OnListenerAsyncFlushOutputCompleted (const client_id_type& i_clientId, const cppcms::http::context::completion_type& i_completionType);
-    void _HandleDeviceUpdate    (const std::set <client_id_type>& i_deviceUpdateListenerIds, const Switch::Interface::Device::Id& i_deviceId, const cppcms::json::value& i_message);
+    void _SendDeviceUpdate         (const client_ids_type& i_deviceUpdateListenerIds, const device_update_message_type& i_pMessage);
+    bool _CoalesceDeviceUpdate     (const client_id_type& i_clientId, const std::shared_ptr <DeviceUpdateRateLimit>& i_pRateLimit, const device_update_message_type& i_pMessage, const std::chrono::steady_clock::time_point& i_now);
+    void _CoalesceBackloggedStreamUpdates (const client_ids_type& i_clientIds, const device_update_message_type& i_pMessage);
+    void _ScheduleCoalescedDeviceUpdates (const client_id_type& i_clientId, const std::shared_ptr <DeviceUpdateRateLimit>& i_pRateLimit);
+    void _FlushCoalescedDeviceUpdates    (const client_id_type& i_clientId, const std::shared_ptr <DeviceUpdateRateLimit>& i_pRateLimit, const booster::system::error_code& i_error);
+    void _RemoveDeviceUpdateStream (const client_id_type& i_clientId, const std::shared_ptr <DeviceUpdateStream>& i_pStream);
+    void _FlushDeviceUpdateStream  (const client_id_type& i_clientId, const std::shared_ptr <DeviceUpdateStream>& i_pStream);
+    void _OnDeviceUpdateStreamAsyncFlushOutputCompleted (const client_id_type& i_clientId, const std::shared_ptr <DeviceUpdateStream>& i_pStream, const cppcms::http::context::completion_type& i_completionType);
+    cached_response_type _GetDevicesResponse      ();
+    cached_response_type _GetDeviceDetailsResponse (const Switch::Interface::Device::Id& i_deviceId);
+    void _SetCachedResponseContent (CachedResponse& io_response, const std::string& i_tag, const uint64_t& i_version);
+    void _ServeCachedResponse      (const cached_response_type& i_pResponse);
+
+    methods_type                  m_methods;                    ///< The bound rpc methods, mapped to from their names. Used to dispatch batches.
+    BatchCallResult*              m_pBatchCallResult;           ///< The outcome of the batch call in progress, 0x0 outside of batches.
+    codec_methods_type            m_codecMethods;               ///< The methods of which single json calls are read and answered by the codecs.
+    Switch::Codec::Arena          m_arena;                      ///< Memory of the request being handled, reset per request.
+    Switch::Codec::Writer*        m_pCodecWriter;               ///< The writer of the response of the codec call in progress, 0x0 outside of codec calls.
+    std::shared_ptr <SharedState> m_pSharedState;               ///< The clients, shared with the other instances of the interface.
+    cached_response_type          m_pDevicesResponse;           ///< The cached response of EnumerateDevices, 0x0 if none.
+    std::map <Switch::Interface::Device::Id, cached_response_type> m_deviceDetailsResponses;  ///< The cached responses of GetDeviceDetails, mapped to from the device ids.
+    mutable std::mutex            m_responseCacheMutex;         ///< Protects the cached responses.
+  };
+
+  /*!
+    \brief The clients of the interface and their listeners and streams, shared by all instances.
+
+    The service pools the instances of the interface and hands each request to any
+    of them. A client registered through one instance is served by all of them.
+   */
+  class HttpInterfaceBase::SharedState
+  {
+  public:
+
+    SharedState ();
+    virtual ~SharedState ();
+
+    // copy constructor and assignment operator disabled
+    SharedState (const SharedState& i_other) = delete;
+    SharedState& operator= (const SharedState& i_other) = delete;
 
     device_update_listeners_type  m_deviceUpdateListeners;      ///< Container with the context of all active listeners, mapped to from listener identifiers.
-    mutable std::mutex            m_deviceUpdateListenersMutex; ///< Protects concurrently accessing and using m_deviceUpdateListeners
+    std::mutex                    m_deviceUpdateListenersMutex; ///< Protects concurrently accessing and using m_deviceUpdateListeners
+    device_update_streams_type    m_deviceUpdateStreams;        ///< The update streams of all streaming clients, mapped to from client identifiers.
+    std::mutex                    m_deviceUpdateStreamsMutex;   ///< Protects m_deviceUpdateStreams and the pending output of the streams.
+    device_update_rate_limits_type m_deviceUpdateRateLimits;    ///< The update rate limits of the clients that set one, mapped to from client identifiers.
+    std::mutex                    m_deviceUpdateRateLimitsMutex; ///< Protects m_deviceUpdateRateLimits and the coalesced updates.
+    HttpClientRegistry            m_clientRegistry;             ///< The registered clients and their tokens.
+    HttpClientRegistry::clock_type::time_point m_nextIdleClientsRemoval;  ///< The time of the next check for idle clients.
+    std::mutex                    m_clientRegistryMutex;        ///< Protects m_clientRegistry and m_nextIdleClientsRemoval.
+    const uint64_t                m_firstUpdateIndex;           ///< Index of the first device update, the time in microseconds since the epoch at construction, such that the indices of previous runs are lower.
+    std::atomic <uint64_t>        m_nextUpdateIndex;            ///< Index of the next device update, monotonic across all instances.
   };
 }
 
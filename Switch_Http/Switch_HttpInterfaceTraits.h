@@ -15,6 +15,7 @@
 
 // third-party includes
 #include <cppcms/json.h>
+#include <map>
 
 
 namespace cppcms
@@ -48,6 +49,12 @@ namespace cppcms
             return Switch::Interface::CR_CLIENT_NOT_SUBSCRIBED;
           case Switch::Interface::CR_CLIENT_ALREADY_CONNECTED_TO_SIGNAL:
             return Switch::Interface::CR_CLIENT_ALREADY_CONNECTED_TO_SIGNAL;
+          case Switch::Interface::CR_BUSY:
+            return Switch::Interface::CR_BUSY;
+          case Switch::Interface::CR_PENDING:
+            return Switch::Interface::CR_PENDING;
+          case Switch::Interface::CR_NOT_CONFIRMED:
+            return Switch::Interface::CR_NOT_CONFIRMED;
           default:
             return Switch::Interface::CR_INVALID;
         }
@@ -144,6 +151,7 @@ namespace cppcms
         outDeviceValueDataformat.m_magicNumber  = i_value.get <uint32_t> ("magicNumber");
         outDeviceValueDataformat.m_name         = i_value.get <std::string> ("name");
         outDeviceValueDataformat.m_description  = i_value.get <std::string> ("description");
+        outDeviceValueDataformat.m_group        = i_value.get <std::string> ("group", "");
         outDeviceValueDataformat.m_minValue     = i_value.get <int32_t> ("minValue");
         outDeviceValueDataformat.m_maxValue     = i_value.get <int32_t> ("maxValue");
 
@@ -158,6 +166,7 @@ namespace cppcms
         io_value.set ("magicNumber",  i_deviceValueDataformat.m_magicNumber);
         io_value.set ("name",         i_deviceValueDataformat.m_name);
         io_value.set ("description",  i_deviceValueDataformat.m_description);
+        io_value.set ("group",        i_deviceValueDataformat.m_group);
         io_value.set ("minValue",     i_deviceValueDataformat.m_minValue);
         io_value.set ("maxValue",     i_deviceValueDataformat.m_maxValue);
       }
@@ -316,6 +325,82 @@ namespace cppcms
         io_value.set ("dataFormat",     i_device.m_dataFormat);
       }
     };
+    template <>
+    struct traits <std::map <Switch::Interface::Device::Id, std::list <Switch::Interface::Device::Value>>>
+    {
+      static std::map <Switch::Interface::Device::Id, std::list <Switch::Interface::Device::Value>> get (const value& i_value)
+      {
+        std::map <Switch::Interface::Device::Id, std::list <Switch::Interface::Device::Value>> result;
+        const json::array& jsonArray = i_value.array ();
+
+        for (uint32_t i=0; i<jsonArray.size (); ++i)
+        {
+          // check pre-conditions
+          if (is_object != jsonArray [i].type())
+          {
+            throw bad_value_cast ();
+          }
+
+          // note: values of a device listed more than once are merged
+          std::list <Switch::Interface::Device::Value>& deviceValues = result [jsonArray [i].get <uint32_t> ("deviceId")];
+          std::list <Switch::Interface::Device::Value> values = jsonArray [i].get <std::list <Switch::Interface::Device::Value>> ("values");
+          deviceValues.splice (deviceValues.end (), values);
+        }
+
+        return result;
+      }
+
+      static void set (value& io_value, const std::map <Switch::Interface::Device::Id, std::list <Switch::Interface::Device::Value>>& i_map)
+      {
+        io_value = json::array ();
+        json::array& jsonArray = io_value.array ();
+        jsonArray.resize (i_map.size ());
+
+        std::map <Switch::Interface::Device::Id, std::list <Switch::Interface::Device::Value>>::const_iterator itMap = i_map.begin ();
+        for (uint32_t i=0; i<i_map.size (); ++i, ++itMap)
+        {
+          jsonArray [i].set ("deviceId", itMap->first);
+          jsonArray [i].set ("values",   itMap->second);
+        }
+      }
+    };
+
+    template <>
+    struct traits <std::map <Switch::Interface::Device::Id, Switch::Interface::eCallResult>>
+    {
+      static std::map <Switch::Interface::Device::Id, Switch::Interface::eCallResult> get (const value& i_value)
+      {
+        std::map <Switch::Interface::Device::Id, Switch::Interface::eCallResult> result;
+        const json::array& jsonArray = i_value.array ();
+
+        for (uint32_t i=0; i<jsonArray.size (); ++i)
+        {
+          // check pre-conditions
+          if (is_object != jsonArray [i].type())
+          {
+            throw bad_value_cast ();
+          }
+
+          result [jsonArray [i].get <uint32_t> ("deviceId")] = jsonArray [i].get <Switch::Interface::eCallResult> ("result");
+        }
+
+        return result;
+      }
+
+      static void set (value& io_value, const std::map <Switch::Interface::Device::Id, Switch::Interface::eCallResult>& i_map)
+      {
+        io_value = json::array ();
+        json::array& jsonArray = io_value.array ();
+        jsonArray.resize (i_map.size ());
+
+        std::map <Switch::Interface::Device::Id, Switch::Interface::eCallResult>::const_iterator itMap = i_map.begin ();
+        for (uint32_t i=0; i<i_map.size (); ++i, ++itMap)
+        {
+          jsonArray [i].set ("deviceId", itMap->first);
+          jsonArray [i].set ("result",   itMap->second);
+        }
+      }
+    };
   } // json
 } // cppcms
 
@@ -0,0 +1,508 @@
+/*?*************************************************************************
+*                           Switch_HttpSubscriptionIndex.cpp
+*                           -----------------------
+*    copyright            : (C) 2013 by Wouter Charle
+*    email                : wouter.charle@gmail.com
+*
+***************************************************************************/
+
+#include "Switch_HttpSubscriptionIndex.h"
+
+// Switch includes
+#include <Switch_Base/Switch_Debug.h>
+
+// third-party includes
+#include <algorithm>
+
+
+void Switch::ClientSet::Insert (const uint32_t& i_slot)
+{
+  if (m_words.size () <= i_slot / 64)
+  {
+    m_words.resize (i_slot / 64 + 1, 0);
+  }
+  m_words [i_slot / 64] |= (uint64_t (1) << (i_slot % 64));
+}
+
+void Switch::ClientSet::Erase (const uint32_t& i_slot)
+{
+  if (i_slot / 64 < m_words.size ())
+  {
+    m_words [i_slot / 64] &= ~(uint64_t (1) << (i_slot % 64));
+  }
+}
+
+bool Switch::ClientSet::Contains (const uint32_t& i_slot) const
+{
+  return (i_slot / 64 < m_words.size ()) && (0 != (m_words [i_slot / 64] & (uint64_t (1) << (i_slot % 64))));
+}
+
+bool Switch::ClientSet::IsEmpty () const
+{
+  for (std::vector <uint64_t>::const_iterator itWord=m_words.begin (); m_words.end ()!=itWord; ++itWord)
+  {
+    if (0 != *itWord)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+void Switch::ClientSet::Clear ()
+{
+  // note: the words are kept, clearing a set does not release its memory
+  std::fill (m_words.begin (), m_words.end (), 0);
+}
+
+void Switch::ClientSet::Unite (const ClientSet& i_other)
+{
+  if (m_words.size () < i_other.m_words.size ())
+  {
+    m_words.resize (i_other.m_words.size (), 0);
+  }
+  for (size_t i=0; i<i_other.m_words.size (); ++i)
+  {
+    m_words [i] |= i_other.m_words [i];
+  }
+}
+
+bool Switch::ElementFilter::IsActive () const
+{
+  return !m_addresses.empty () || !m_group.empty ();
+}
+
+void Switch::ElementFilter::Apply (std::list <Switch::Interface::Device::Value>& o_values, const std::list <Switch::Interface::Device::Value>& i_values) const
+{
+  o_values.clear ();
+  std::list <Switch::Interface::Device::Value>::const_iterator itValues;
+  for (itValues=i_values.begin (); i_values.end ()!=itValues; ++itValues)
+  {
+    if (m_addresses.end () != m_addresses.find ((*itValues).m_address))
+    {
+      o_values.push_back (*itValues);
+    }
+  }
+}
+
+bool Switch::ElementFilter::operator== (const ElementFilter& i_other) const
+{
+  return (m_group == i_other.m_group) && (m_addresses == i_other.m_addresses);
+}
+
+Switch::SubscriptionTopic::SubscriptionTopic ()
+: m_kind (ST_DEVICE),
+  m_deviceId (0)
+{
+}
+
+Switch::SubscriptionTopic::SubscriptionTopic (const eKind& i_kind, const Switch::Interface::Device::Id& i_deviceId, const std::string& i_name)
+: m_kind (i_kind),
+  m_deviceId (i_deviceId),
+  m_name (i_name)
+{
+}
+
+Switch::HttpSubscriptionIndex::DeviceEntry::DeviceEntry ()
+{
+}
+
+Switch::HttpSubscriptionIndex::Slot::Slot ()
+: m_clientId (0),
+  m_nrSubscriptions (0)
+{
+}
+
+Switch::HttpSubscriptionIndex::HttpSubscriptionIndex ()
+: m_nrProductTypeSubscriptions (0)
+{
+}
+
+Switch::HttpSubscriptionIndex::~HttpSubscriptionIndex ()
+{
+}
+
+bool Switch::HttpSubscriptionIndex::Subscribe (const client_id_type& i_clientId, const SubscriptionTopic& i_topic)
+{
+  // get the slot of the client, a client gets a slot with its first subscription
+  uint32_t slot;
+  std::map <client_id_type, uint32_t>::iterator itClientSlot = m_clientSlots.find (i_clientId);
+  if (m_clientSlots.end () != itClientSlot)
+  {
+    slot = itClientSlot->second;
+  }
+  else if (!m_freeSlots.empty ())
+  {
+    slot = m_freeSlots.back ();
+    m_freeSlots.pop_back ();
+    m_clientSlots [i_clientId] = slot;
+  }
+  else
+  {
+    slot = static_cast <uint32_t> (m_slots.size ());
+    m_slots.push_back (Slot ());
+    m_clientSlots [i_clientId] = slot;
+  }
+  m_slots [slot].m_clientId = i_clientId;
+
+  ClientSet* pTopicSet = _GetTopicSet (i_topic, true);
+  if (pTopicSet->Contains (slot))
+  {
+    return false;
+  }
+  pTopicSet->Insert (slot);
+
+  ++m_slots [slot].m_nrSubscriptions;
+  if (SubscriptionTopic::ST_PRODUCT_TYPE == i_topic.m_kind)
+  {
+    ++m_nrProductTypeSubscriptions;
+  }
+
+  return true;
+}
+
+bool Switch::HttpSubscriptionIndex::Unsubscribe (const client_id_type& i_clientId, const SubscriptionTopic& i_topic)
+{
+  std::map <client_id_type, uint32_t>::iterator itClientSlot = m_clientSlots.find (i_clientId);
+  if (m_clientSlots.end () == itClientSlot)
+  {
+    return false;
+  }
+  const uint32_t slot = itClientSlot->second;
+
+  ClientSet* pTopicSet = _GetTopicSet (i_topic, false);
+  if ((0x0 == pTopicSet) || !pTopicSet->Contains (slot))
+  {
+    return false;
+  }
+  pTopicSet->Erase (slot);
+
+  // drop the entry of a device which is only known for its subscribers
+  if (SubscriptionTopic::ST_DEVICE == i_topic.m_kind)
+  {
+    std::map <Switch::Interface::Device::Id, DeviceEntry>::iterator itDevice = m_devices.find (i_topic.m_deviceId);
+    if (pTopicSet->IsEmpty () && itDevice->second.m_productType.empty () && itDevice->second.m_groups.empty ())
+    {
+      m_devices.erase (itDevice);
+    }
+  }
+  // drop the set of a group or product type without subscribers, the devices no longer point to it
+  else if ((SubscriptionTopic::ST_DEVICE_GROUP == i_topic.m_kind) && pTopicSet->IsEmpty ())
+  {
+    m_groupSubscribers.erase (i_topic.m_name);
+    const std::set <Switch::Interface::Device::Id>& deviceIds = m_groups [i_topic.m_name];
+    for (std::set <Switch::Interface::Device::Id>::const_iterator itDeviceId=deviceIds.begin (); deviceIds.end ()!=itDeviceId; ++itDeviceId)
+    {
+      _UpdateTopicSets (m_devices [*itDeviceId]);
+    }
+    if (deviceIds.empty ())
+    {
+      m_groups.erase (i_topic.m_name);
+    }
+  }
+  else if (SubscriptionTopic::ST_PRODUCT_TYPE == i_topic.m_kind)
+  {
+    --m_nrProductTypeSubscriptions;
+    if (pTopicSet->IsEmpty ())
+    {
+      m_productTypeSubscribers.erase (i_topic.m_name);
+      for (std::map <Switch::Interface::Device::Id, DeviceEntry>::iterator itDevice=m_devices.begin (); m_devices.end ()!=itDevice; ++itDevice)
+      {
+        if (i_topic.m_name == itDevice->second.m_productType)
+        {
+          _UpdateTopicSets (itDevice->second);
+        }
+      }
+    }
+  }
+
+  // release the slot of a client without subscriptions
+  if (0 == --m_slots [slot].m_nrSubscriptions)
+  {
+    m_clientSlots.erase (itClientSlot);
+    m_freeSlots.push_back (slot);
+  }
+
+  return true;
+}
+
+void Switch::HttpSubscriptionIndex::DefineDeviceGroup (const std::string& i_group, const std::set <Switch::Interface::Device::Id>& i_deviceIds)
+{
+  std::set <Switch::Interface::Device::Id>& groupDeviceIds = m_groups [i_group];
+
+  // remove the group from the devices leaving it
+  for (std::set <Switch::Interface::Device::Id>::const_iterator itDeviceId=groupDeviceIds.begin (); groupDeviceIds.end ()!=itDeviceId; ++itDeviceId)
+  {
+    if (i_deviceIds.end () == i_deviceIds.find (*itDeviceId))
+    {
+      DeviceEntry& device = m_devices [*itDeviceId];
+      device.m_groups.erase (i_group);
+      _UpdateTopicSets (device);
+    }
+  }
+
+  // add the group to the devices joining it
+  for (std::set <Switch::Interface::Device::Id>::const_iterator itDeviceId=i_deviceIds.begin (); i_deviceIds.end ()!=itDeviceId; ++itDeviceId)
+  {
+    if (groupDeviceIds.end () == groupDeviceIds.find (*itDeviceId))
+    {
+      DeviceEntry& device = m_devices [*itDeviceId];
+      device.m_groups.insert (i_group);
+      _UpdateTopicSets (device);
+    }
+  }
+
+  if (i_deviceIds.empty () && (m_groupSubscribers.end () == m_groupSubscribers.find (i_group)))
+  {
+    m_groups.erase (i_group);
+  }
+  else
+  {
+    groupDeviceIds = i_deviceIds;
+  }
+}
+
+void Switch::HttpSubscriptionIndex::GetDeviceGroup (std::set <Switch::Interface::Device::Id>& o_deviceIds, const std::string& i_group) const
+{
+  std::map <std::string, std::set <Switch::Interface::Device::Id>>::const_iterator itGroup = m_groups.find (i_group);
+  if (m_groups.end () == itGroup)
+  {
+    o_deviceIds.clear ();
+    return;
+  }
+  o_deviceIds = itGroup->second;
+}
+
+void Switch::HttpSubscriptionIndex::SetDeviceProductType (const Switch::Interface::Device::Id& i_deviceId, const std::string& i_productType)
+{
+  DeviceEntry& device = m_devices [i_deviceId];
+  if (device.m_productType != i_productType)
+  {
+    device.m_productType = i_productType;
+    _UpdateTopicSets (device);
+  }
+}
+
+bool Switch::HttpSubscriptionIndex::HasProductTypeSubscriptions () const
+{
+  return (0 != m_nrProductTypeSubscriptions);
+}
+
+void Switch::HttpSubscriptionIndex::Resolve (std::vector <client_id_type>& o_clientIds, const Switch::Interface::Device::Id& i_deviceId) const
+{
+  o_clientIds.clear ();
+
+  m_resolved.Clear ();
+  _UniteSubscribers (m_resolved, i_deviceId);
+
+  // translate the slots to client ids
+  for (size_t i=0; i<m_resolved.m_words.size (); ++i)
+  {
+    uint64_t word = m_resolved.m_words [i];
+    while (0 != word)
+    {
+      const uint32_t slot = static_cast <uint32_t> (64 * i + __builtin_ctzll (word));
+      o_clientIds.push_back (m_slots [slot].m_clientId);
+      word &= word - 1;
+    }
+  }
+}
+
+void Switch::HttpSubscriptionIndex::RemoveClient (const client_id_type& i_clientId)
+{
+  std::map <client_id_type, uint32_t>::const_iterator itClientSlot = m_clientSlots.find (i_clientId);
+  if (m_clientSlots.end () == itClientSlot)
+  {
+    return;
+  }
+  const uint32_t slot = itClientSlot->second;
+
+  // collect the topics of the client first, unsubscribing drops sets and devices
+  std::vector <SubscriptionTopic> topics;
+  for (std::map <Switch::Interface::Device::Id, DeviceEntry>::const_iterator itDevice=m_devices.begin (); m_devices.end ()!=itDevice; ++itDevice)
+  {
+    if (itDevice->second.m_subscribers.Contains (slot))
+    {
+      topics.push_back (SubscriptionTopic (SubscriptionTopic::ST_DEVICE, itDevice->first, ""));
+    }
+  }
+  for (std::map <std::string, ClientSet>::const_iterator itGroup=m_groupSubscribers.begin (); m_groupSubscribers.end ()!=itGroup; ++itGroup)
+  {
+    if (itGroup->second.Contains (slot))
+    {
+      topics.push_back (SubscriptionTopic (SubscriptionTopic::ST_DEVICE_GROUP, 0, itGroup->first));
+    }
+  }
+  for (std::map <std::string, ClientSet>::const_iterator itProductType=m_productTypeSubscribers.begin (); m_productTypeSubscribers.end ()!=itProductType; ++itProductType)
+  {
+    if (itProductType->second.Contains (slot))
+    {
+      topics.push_back (SubscriptionTopic (SubscriptionTopic::ST_PRODUCT_TYPE, 0, itProductType->first));
+    }
+  }
+  if (m_allSubscribers.Contains (slot))
+  {
+    topics.push_back (SubscriptionTopic (SubscriptionTopic::ST_ALL_DEVICES, 0, ""));
+  }
+
+  // note: the slot is released with the last subscription
+  for (std::vector <SubscriptionTopic>::const_iterator itTopic=topics.begin (); topics.end ()!=itTopic; ++itTopic)
+  {
+    Unsubscribe (i_clientId, *itTopic);
+  }
+}
+
+bool Switch::HttpSubscriptionIndex::HasSubscriptions (const client_id_type& i_clientId) const
+{
+  return (m_clientSlots.end () != m_clientSlots.find (i_clientId));
+}
+
+bool Switch::HttpSubscriptionIndex::Matches (const client_id_type& i_clientId, const Switch::Interface::Device::Id& i_deviceId) const
+{
+  std::map <client_id_type, uint32_t>::const_iterator itClientSlot = m_clientSlots.find (i_clientId);
+  if (m_clientSlots.end () == itClientSlot)
+  {
+    return false;
+  }
+  const uint32_t slot = itClientSlot->second;
+
+  if (m_allSubscribers.Contains (slot))
+  {
+    return true;
+  }
+
+  std::map <Switch::Interface::Device::Id, DeviceEntry>::const_iterator itDevice = m_devices.find (i_deviceId);
+  if (m_devices.end () == itDevice)
+  {
+    return false;
+  }
+  const DeviceEntry& device = itDevice->second;
+  if (device.m_subscribers.Contains (slot))
+  {
+    return true;
+  }
+  for (std::vector <const ClientSet*>::const_iterator itTopicSet=device.m_topicSets.begin (); device.m_topicSets.end ()!=itTopicSet; ++itTopicSet)
+  {
+    if ((*itTopicSet)->Contains (slot))
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/*!
+  \brief Gets the set of subscribers of a topic.
+
+  \param [in] i_topic  The topic.
+  \param [in] i_create Flags if the set is created when it does not exist.
+
+  \return The set, 0x0 if it does not exist and is not created.
+ */
+Switch::ClientSet* Switch::HttpSubscriptionIndex::_GetTopicSet (const SubscriptionTopic& i_topic, const bool& i_create)
+{
+  switch (i_topic.m_kind)
+  {
+  case SubscriptionTopic::ST_DEVICE:
+    {
+      std::map <Switch::Interface::Device::Id, DeviceEntry>::iterator itDevice = m_devices.find (i_topic.m_deviceId);
+      if (m_devices.end () == itDevice)
+      {
+        if (!i_create)
+        {
+          return 0x0;
+        }
+        itDevice = m_devices.insert (std::make_pair (i_topic.m_deviceId, DeviceEntry ())).first;
+      }
+      return &itDevice->second.m_subscribers;
+    }
+
+  case SubscriptionTopic::ST_DEVICE_GROUP:
+    {
+      std::map <std::string, ClientSet>::iterator itGroup = m_groupSubscribers.find (i_topic.m_name);
+      if (m_groupSubscribers.end () == itGroup)
+      {
+        if (!i_create)
+        {
+          return 0x0;
+        }
+
+        // let the devices of the group point to the new set
+        itGroup = m_groupSubscribers.insert (std::make_pair (i_topic.m_name, ClientSet ())).first;
+        const std::set <Switch::Interface::Device::Id>& deviceIds = m_groups [i_topic.m_name];
+        for (std::set <Switch::Interface::Device::Id>::const_iterator itDeviceId=deviceIds.begin (); deviceIds.end ()!=itDeviceId; ++itDeviceId)
+        {
+          _UpdateTopicSets (m_devices [*itDeviceId]);
+        }
+      }
+      return &itGroup->second;
+    }
+
+  case SubscriptionTopic::ST_PRODUCT_TYPE:
+    {
+      std::map <std::string, ClientSet>::iterator itProductType = m_productTypeSubscribers.find (i_topic.m_name);
+      if (m_productTypeSubscribers.end () == itProductType)
+      {
+        if (!i_create)
+        {
+          return 0x0;
+        }
+
+        // let the devices of the product type point to the new set
+        itProductType = m_productTypeSubscribers.insert (std::make_pair (i_topic.m_name, ClientSet ())).first;
+        for (std::map <Switch::Interface::Device::Id, DeviceEntry>::iterator itDevice=m_devices.begin (); m_devices.end ()!=itDevice; ++itDevice)
+        {
+          if (i_topic.m_name == itDevice->second.m_productType)
+          {
+            _UpdateTopicSets (itDevice->second);
+          }
+        }
+      }
+      return &itProductType->second;
+    }
+
+  case SubscriptionTopic::ST_ALL_DEVICES:
+  default:
+    return &m_allSubscribers;
+  }
+}
+
+/*!
+  \brief Points a device to the subscriber sets of its product type and groups.
+ */
+void Switch::HttpSubscriptionIndex::_UpdateTopicSets (DeviceEntry& io_device)
+{
+  io_device.m_topicSets.clear ();
+
+  std::map <std::string, ClientSet>::const_iterator itProductType = m_productTypeSubscribers.find (io_device.m_productType);
+  if (m_productTypeSubscribers.end () != itProductType)
+  {
+    io_device.m_topicSets.push_back (&itProductType->second);
+  }
+
+  for (std::set <std::string>::const_iterator itGroup=io_device.m_groups.begin (); io_device.m_groups.end ()!=itGroup; ++itGroup)
+  {
+    std::map <std::string, ClientSet>::const_iterator itGroupSubscribers = m_groupSubscribers.find (*itGroup);
+    if (m_groupSubscribers.end () != itGroupSubscribers)
+    {
+      io_device.m_topicSets.push_back (&itGroupSubscribers->second);
+    }
+  }
+}
+
+void Switch::HttpSubscriptionIndex::_UniteSubscribers (ClientSet& o_clients, const Switch::Interface::Device::Id& i_deviceId) const
+{
+  o_clients.Unite (m_allSubscribers);
+
+  std::map <Switch::Interface::Device::Id, DeviceEntry>::const_iterator itDevice = m_devices.find (i_deviceId);
+  if (m_devices.end () != itDevice)
+  {
+    const DeviceEntry& device = itDevice->second;
+    o_clients.Unite (device.m_subscribers);
+    for (std::vector <const ClientSet*>::const_iterator itTopicSet=device.m_topicSets.begin (); device.m_topicSets.end ()!=itTopicSet; ++itTopicSet)
+    {
+      o_clients.Unite (**itTopicSet);
+    }
+  }
+}
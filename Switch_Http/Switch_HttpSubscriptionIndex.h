@@ -0,0 +1,206 @@
+/*?*************************************************************************
+*                           Switch_HttpSubscriptionIndex.h
+*                           -----------------------
+*    copyright            : (C) 2013 by Wouter Charle
+*    email                : wouter.charle@gmail.com
+*
+***************************************************************************/
+
+#ifndef _SWITCH_HTTPSUBSCRIPTIONINDEX
+#define _SWITCH_HTTPSUBSCRIPTIONINDEX
+
+// Switch includes
+#include <Switch_Base/Switch_CompilerConfiguration.h>
+#include <Switch_API/Switch_InterfaceTypes.h>
+
+// third-party includes
+#include <map>
+#include <set>
+#include <list>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace Switch
+{
+  /*!
+    \brief Set of clients, one bit per client slot.
+   */
+  class ClientSet
+  {
+  public:
+
+    void Insert   (const uint32_t& i_slot);
+    void Erase    (const uint32_t& i_slot);
+    bool Contains (const uint32_t& i_slot) const;
+    bool IsEmpty  () const;
+    void Clear    ();
+    /*!
+      \brief Adds the clients of another set to this set.
+     */
+    void Unite    (const ClientSet& i_other);
+
+    std::vector <uint64_t> m_words; ///< The bits of the set, the bit of slot s being bit s%64 of word s/64.
+  };
+
+  /*!
+    \brief The elements of a device a client gets the values of, given by their addresses or their group.
+   */
+  class ElementFilter
+  {
+  public:
+
+    /*!
+      \return True if the filter holds back values, false if all elements pass.
+     */
+    bool IsActive () const;
+    /*!
+      \brief Copies the values of the elements passing the filter.
+
+      \param [out] o_values The values passing the filter.
+      \param [in]  i_values The values to filter.
+     */
+    void Apply (std::list <Switch::Interface::Device::Value>& o_values, const std::list <Switch::Interface::Device::Value>& i_values) const;
+    bool operator== (const ElementFilter& i_other) const;
+
+    std::set <uint32_t> m_addresses;  ///< The addresses of the elements passing, resolved from the device's data format for group filters.
+    std::string         m_group;      ///< The group of the elements passing, empty for filters by address.
+  };
+
+  /*!
+    \brief What a client subscribes to: a device, a group of devices, a product type or all devices.
+   */
+  class SubscriptionTopic
+  {
+  public:
+
+    enum eKind
+    {
+      ST_DEVICE       = 0,
+      ST_DEVICE_GROUP = 1,
+      ST_PRODUCT_TYPE = 2,
+      ST_ALL_DEVICES  = 3
+    };
+
+    SubscriptionTopic ();
+    SubscriptionTopic (const eKind& i_kind, const Switch::Interface::Device::Id& i_deviceId, const std::string& i_name);
+
+    eKind                         m_kind;
+    Switch::Interface::Device::Id m_deviceId; ///< The device, for ST_DEVICE topics.
+    std::string                   m_name;     ///< The group or product type, for ST_DEVICE_GROUP and ST_PRODUCT_TYPE topics.
+    ElementFilter                 m_elementFilter;  ///< The elements of the device subscribed to, for ST_DEVICE topics.
+  };
+
+  /*!
+    \brief Inverted index of the subscriptions of the clients of the http interface.
+
+    Every client with subscriptions gets a slot, a bit position in the client sets of
+    the topics. Every known device keeps pointers to the sets of the topics it belongs
+    to, resolving the clients subscribed to a device is the union of a handful of sets.
+
+    \note Not thread-safe, the interface guards the index with its update buffer mutex.
+   */
+  class HttpSubscriptionIndex
+  {
+  public:
+
+    typedef size_t client_id_type;  ///< Type of client identifiers, as in the http interface.
+
+    HttpSubscriptionIndex ();
+    ~HttpSubscriptionIndex ();
+
+    // copy constructor and assignment operator disabled, the devices point into the index
+    HttpSubscriptionIndex (const HttpSubscriptionIndex& i_other) = delete;
+    HttpSubscriptionIndex& operator= (const HttpSubscriptionIndex& i_other) = delete;
+
+    /*!
+      \return True if the client was subscribed, false if it already was.
+     */
+    bool Subscribe   (const client_id_type& i_clientId, const SubscriptionTopic& i_topic);
+    /*!
+      \return True if the client was unsubscribed, false if it was not subscribed.
+     */
+    bool Unsubscribe (const client_id_type& i_clientId, const SubscriptionTopic& i_topic);
+    /*!
+      \brief Removes all subscriptions of a client.
+     */
+    void RemoveClient (const client_id_type& i_clientId);
+    /*!
+      \brief Replaces the devices of a group, an empty list removes the group.
+     */
+    void DefineDeviceGroup (const std::string& i_group, const std::set <Switch::Interface::Device::Id>& i_deviceIds);
+    /*!
+      \brief Gets the devices of a group, none if the group is not defined.
+     */
+    void GetDeviceGroup (std::set <Switch::Interface::Device::Id>& o_deviceIds, const std::string& i_group) const;
+    /*!
+      \brief Sets the product type of a device, subscribing it to the product type's topic.
+     */
+    void SetDeviceProductType (const Switch::Interface::Device::Id& i_deviceId, const std::string& i_productType);
+    bool HasProductTypeSubscriptions () const;
+
+    /*!
+      \brief Collects the clients subscribed to a device, directly or through a group, its product type or all devices.
+
+      \param [out] o_clientIds The ids of the subscribed clients.
+      \param [in]  i_deviceId  The id of the device.
+     */
+    void Resolve (std::vector <client_id_type>& o_clientIds, const Switch::Interface::Device::Id& i_deviceId) const;
+    /*!
+      \return True if the client has any subscription.
+     */
+    bool HasSubscriptions (const client_id_type& i_clientId) const;
+    /*!
+      \return True if the client is subscribed to the device, in any way.
+     */
+    bool Matches (const client_id_type& i_clientId, const Switch::Interface::Device::Id& i_deviceId) const;
+
+  private:
+
+    /*!
+      \brief The subscribers of a device and the sets of the topics it belongs to.
+     */
+    class DeviceEntry
+    {
+    public:
+
+      DeviceEntry ();
+
+      ClientSet                       m_subscribers;  ///< Clients subscribed to the device itself.
+      std::string                     m_productType;  ///< Product type of the device, empty if not known.
+      std::set <std::string>          m_groups;       ///< Groups the device belongs to.
+      std::vector <const ClientSet*>  m_topicSets;    ///< Subscribers of the device's product type and groups.
+    };
+
+    /*!
+      \brief A client with subscriptions.
+     */
+    class Slot
+    {
+    public:
+
+      Slot ();
+
+      client_id_type  m_clientId;
+      uint32_t        m_nrSubscriptions;
+    };
+
+    ClientSet* _GetTopicSet (const SubscriptionTopic& i_topic, const bool& i_create);
+    void _UpdateTopicSets (DeviceEntry& io_device);
+    void _UniteSubscribers (ClientSet& o_clients, const Switch::Interface::Device::Id& i_deviceId) const;
+
+    std::map <client_id_type, uint32_t>       m_clientSlots;  ///< The slots of the clients with subscriptions, mapped to from their ids.
+    std::vector <Slot>                        m_slots;
+    std::vector <uint32_t>                    m_freeSlots;
+
+    std::map <Switch::Interface::Device::Id, DeviceEntry> m_devices;
+    std::map <std::string, ClientSet>         m_groupSubscribers;       ///< Subscribers of device groups, mapped to from the group names.
+    std::map <std::string, ClientSet>         m_productTypeSubscribers; ///< Subscribers of product types, mapped to from the product types.
+    ClientSet                                 m_allSubscribers;         ///< Clients subscribed to all devices.
+    std::map <std::string, std::set <Switch::Interface::Device::Id>> m_groups;  ///< The devices of the groups, mapped to from the group names.
+    uint32_t                                  m_nrProductTypeSubscriptions;
+    mutable ClientSet                         m_resolved;               ///< Scratch set of Resolve.
+  };
+}
+
+#endif // _SWITCH_HTTPSUBSCRIPTIONINDEX
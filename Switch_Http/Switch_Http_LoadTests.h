@@ -0,0 +1,1389 @@
+/*?*************************************************************************
+*                           Switch_Http_LoadTests.h
+*                           -----------------------
+*    copyright            : (C) 2014 by Wouter Charle
+*    email                : wouter.charle@gmail.com
+*
+***************************************************************************/
+
+#ifndef _SWITCH_HTTP_LOADTESTS
+#define _SWITCH_HTTP_LOADTESTS
+
+// project includes
+#include "Switch_Http/Switch_HttpInterface.h"
+
+// switch includes
+#include <Switch_Base/Switch_CompilerConfiguration.h>
+#include <Switch_Base/Switch_Types.h>
+#include <Switch_Base/Switch_Debug.h>
+#include <Switch_API/Switch_FunctionalInterface.h>
+#include <Switch_Controller/Switch_ObserverRegistry.h>
+
+// third party includes
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <cppcms/json.h>
+#include <cppcms/application.h>
+#include <cppcms/applications_pool.h>
+#include <cppcms/service.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+
+namespace Switch
+{
+  namespace HttpLoadTests
+  {
+    typedef std::chrono::steady_clock clock_type;
+
+    /*!
+      \brief Parameters of a load test run.
+     */
+    class Parameters
+    {
+    public:
+
+      Parameters ();
+
+      uint16_t  m_port;                 ///< Port of the service, bound to localhost.
+      uint32_t  m_nrWorkerThreads;      ///< Worker threads of the service, each request is handled by any of the pooled interface instances.
+      uint32_t  m_nrDevices;            ///< Number of devices of the synthetic controller.
+      uint32_t  m_nrValuesPerDevice;    ///< Number of values of every device.
+      uint32_t  m_nrUpdatesPerSecond;   ///< Number of device data updates generated by the synthetic controller per second.
+      uint32_t  m_nrClients;            ///< Number of simulated clients.
+      uint32_t  m_setIntervalMs;        ///< Interval between the SetDeviceValues calls of a client.
+      uint32_t  m_rampUpSeconds;        ///< Time over which the clients are started.
+      uint32_t  m_durationSeconds;      ///< Duration of the run, ramp-up included.
+    };
+
+    /*!
+      \brief Controller generating device updates at a fixed rate.
+
+      The values sent in the updates are timestamps (see GetTimestamp), which lets
+      the clients measure the delivery latency of every update they receive.
+     */
+    class SyntheticController : public Switch::FunctionalInterface
+    {
+    public:
+
+      SyntheticController (const uint32_t& i_nrDevices, const uint32_t& i_nrValuesPerDevice);
+      virtual ~SyntheticController ();
+
+      // copy constructor and assignment operator disabled
+      SyntheticController (const SyntheticController& i_other) = delete;
+      SyntheticController& operator= (const SyntheticController& i_other) = delete;
+
+      void Start (const uint32_t& i_nrUpdatesPerSecond);
+      void Stop ();
+      uint64_t GetNrUpdates () const;
+
+      // signals
+      virtual Switch::ObserverConnection ConnectToDeviceConnectionUpdateSignal (const DeviceConnectionUpdateSlot& i_receiver);
+      virtual Switch::ObserverConnection ConnectToDeviceDataUpdateSignal (const DeviceDataUpdateSlot& i_receiver);
+
+      // functionality
+      virtual Switch::Interface::eCallResult AddDevice        (const uint32_t& i_deviceAddress);
+      virtual Switch::Interface::eCallResult EnumerateDevices (std::list <Switch::Interface::Device::Summary>& o_deviceInfo);
+      virtual Switch::Interface::eCallResult VisitDevices (uint32_t& o_nextDeviceAddress, const DeviceSummaryVisitor& i_visitor, const uint32_t& i_firstDeviceAddress, const uint32_t& i_maxNrDevices);
+      virtual Switch::Interface::eCallResult GetDeviceDetails (Switch::Interface::Device& o_deviceDetails, const uint32_t& i_deviceAddress);
+      virtual Switch::Interface::eCallResult GetDeviceCatalogVersion (uint64_t& o_version);
+      virtual Switch::Interface::eCallResult GetDeviceValues  (std::list <Switch::Interface::Device::Value>& o_values, const uint32_t& i_deviceAddress);
+      virtual Switch::Interface::eCallResult GetMultipleDeviceValues (std::map <uint32_t, std::list <Switch::Interface::Device::Value>>& o_values, const std::set <uint32_t>& i_deviceAddresses);
+      virtual Switch::Interface::eCallResult GetDeviceReportedValues (std::list <Switch::Interface::Device::Value>& o_values, const uint32_t& i_deviceAddress);
+      virtual Switch::Interface::eCallResult SetDeviceValues  (const uint32_t& i_deviceAddress, const std::list <Switch::Interface::Device::Value>& i_values);
+      virtual Switch::Interface::eCallResult SetMultipleDeviceValues (std::map <uint32_t, Switch::Interface::eCallResult>& o_results, uint32_t& o_sceneId, const std::map <uint32_t, std::list <Switch::Interface::Device::Value>>& i_values);
+      virtual Switch::Interface::eCallResult GetSceneResults (std::map <uint32_t, Switch::Interface::eCallResult>& o_results, const uint32_t& i_sceneId);
+      virtual Switch::Interface::eCallResult GetCommandBacklog (uint32_t& o_nrQueuedCommands, uint32_t& o_drainTimeMicros);
+      virtual Switch::Interface::eCallResult GetChangesSince (uint64_t& o_version, std::list <Switch::Interface::Device::Summary>& o_devices, std::map <uint32_t, std::list <Switch::Interface::Device::Value>>& o_values, const uint64_t& i_version);
+
+    private:
+
+      typedef Switch::ObserverRegistry <const uint32_t&, const Switch::Interface::Device::Connection&> DeviceConnectionUpdateSignal;
+      typedef Switch::ObserverRegistry <const uint32_t&, const std::list <Switch::Interface::Device::Value>&> DeviceDataUpdateSignal;
+
+      void _GenerateUpdates (const uint32_t i_nrUpdatesPerSecond);
+
+      const uint32_t                m_nrDevices;
+      const uint32_t                m_nrValuesPerDevice;
+      std::vector <uint32_t>        m_values;         ///< The values of all devices, device by device.
+      std::mutex                    m_valuesMutex;
+      DeviceConnectionUpdateSignal  m_deviceConnectionUpdateSignal;
+      DeviceDataUpdateSignal        m_deviceDataUpdateSignal;
+      std::thread                   m_updateThread;
+      std::atomic <bool>            m_running;
+      std::atomic <uint64_t>        m_nrUpdates;      ///< Number of updates emitted, generated and set ones.
+    };
+
+    /*!
+      \brief Latency samples of one type of call, in microseconds.
+     */
+    class LatencyStatistics
+    {
+    public:
+
+      LatencyStatistics ();
+
+      void Add (const double& i_microseconds);
+      void Report (std::ostream& io_stream, const std::string& i_name, const double& i_seconds);
+
+      std::vector <double>  m_samples;
+      uint64_t              m_nrErrors;
+    };
+
+    /*!
+      \brief Incremental reader of an HTTP/1.1 response.
+     */
+    class ResponseReader
+    {
+    public:
+
+      enum eState
+      {
+        RS_HEADERS,
+        RS_BODY,
+        RS_CHUNK_SIZE,
+        RS_CHUNK_DATA,
+        RS_CHUNK_END,
+        RS_TRAILER,
+        RS_UNTIL_CLOSE,
+        RS_DONE
+      };
+
+      ResponseReader ();
+
+      void Reset ();
+      /*!
+        \brief Consumes the received bytes of io_input, appending the decoded body to io_body.
+
+        \return True if the response is complete, false if more input is needed.
+       */
+      bool Read (std::string& io_input, std::string& io_body);
+
+      eState      m_state;
+      uint32_t    m_status;
+      std::string m_cookie;     ///< The cookies set by the response, if any.
+      size_t      m_remaining;  ///< Bytes left in the body or the current chunk.
+    };
+
+    /*!
+      \brief Non-blocking connection to the service.
+     */
+    class Connection
+    {
+    public:
+
+      Connection ();
+      ~Connection ();
+
+      bool Open (const uint16_t& i_port);
+      void Close ();
+      bool IsOpen () const;
+      /*!
+        \brief Writes as much of the pending output as the socket accepts.
+
+        \return False if the connection failed.
+       */
+      bool Send ();
+      /*!
+        \brief Appends the available input to m_input.
+
+        \return False if the connection was closed or failed.
+       */
+      bool Receive ();
+
+      int         m_socket;
+      bool        m_connecting;   ///< Set while the connect is in progress.
+      std::string m_output;       ///< Output not yet written.
+      std::string m_input;        ///< Input not yet consumed.
+    };
+
+    /*!
+      \brief Simulated client.
+
+      Registers, subscribes to one device, listens to its updates on a second
+      connection and sets its values at a fixed interval.
+     */
+    class Client
+    {
+    public:
+
+      enum eState
+      {
+        CS_IDLE,
+        CS_REGISTERING,
+        CS_SUBSCRIBING,
+        CS_WAITING,
+        CS_SETTING,
+        CS_FAILED
+      };
+
+      Client ();
+
+      eState                  m_state;
+      uint32_t                m_deviceId;
+      std::string             m_token;          ///< The token returned by Register.
+      clock_type::time_point  m_startTime;
+      clock_type::time_point  m_callTime;       ///< Time the pending call was sent.
+      clock_type::time_point  m_nextSetTime;
+
+      Connection              m_control;        ///< Keep-alive connection for the calls.
+      ResponseReader          m_controlReader;
+      std::string             m_controlBody;
+
+      Connection              m_listen;         ///< Connection of the pending ListenToDeviceUpdates call.
+      ResponseReader          m_listenReader;
+      std::string             m_listenBody;     ///< Received updates not yet parsed.
+      bool                    m_listening;
+      uint32_t                m_listenTimestamp; ///< Timestamp of the listen call, earlier updates are replays.
+      clock_type::time_point  m_nextListenTime;
+      uint64_t                m_cursor;         ///< Index of the last update received.
+    };
+
+    /*!
+      \brief Drives the simulated clients from a single thread.
+     */
+    class LoadDriver
+    {
+    public:
+
+      explicit LoadDriver (const Parameters& i_parameters);
+      ~LoadDriver ();
+
+      void Run (const SyntheticController& i_controller);
+
+    private:
+
+      void _StartClient (Client& io_client);
+      void _FailClient (Client& io_client, LatencyStatistics& io_statistics);
+      void _Call (Client& io_client, const std::string& i_method, const std::string& i_params);
+      void _SetValues (Client& io_client);
+      void _Listen (Client& io_client);
+      void _HandleControlInput (Client& io_client);
+      void _HandleListenInput (Client& io_client);
+      void _ParseUpdates (Client& io_client);
+      void _Report (const double& i_seconds, const SyntheticController& i_controller);
+
+      const Parameters        m_parameters;
+      std::vector <Client>    m_clients;
+      uint64_t                m_nextCallId;
+
+      LatencyStatistics       m_register;
+      LatencyStatistics       m_subscribe;
+      LatencyStatistics       m_set;
+      LatencyStatistics       m_update;         ///< Delivery latency of the updates, from their generation.
+      uint64_t                m_nrReplayedUpdates;
+      uint64_t                m_nrResyncs;
+      uint64_t                m_nrListens;
+      uint64_t                m_nrListenErrors;
+      uint64_t                m_baseResidentSetSize;
+      uint64_t                m_peakResidentSetSize;
+    };
+
+    uint32_t GetTimestamp ();
+    uint64_t GetResidentSetSize ();
+    void BenchmarkLoad (const Parameters& i_parameters);
+    void Run ();
+  }
+}
+
+/*!
+  \brief Microseconds since the start of the process, wrapping around after 71 minutes.
+ */
+uint32_t Switch::HttpLoadTests::GetTimestamp ()
+{
+  static const clock_type::time_point s_epoch = clock_type::now ();
+  return static_cast <uint32_t> (std::chrono::duration_cast <std::chrono::microseconds> (clock_type::now () - s_epoch).count ());
+}
+
+/*!
+  \brief Resident set size of the process in bytes, clients and server alike.
+ */
+uint64_t Switch::HttpLoadTests::GetResidentSetSize ()
+{
+  uint64_t totalPages = 0;
+  uint64_t residentPages = 0;
+  std::ifstream statm ("/proc/self/statm");
+  statm >> totalPages >> residentPages;
+  return residentPages * static_cast <uint64_t> (sysconf (_SC_PAGESIZE));
+}
+
+Switch::HttpLoadTests::Parameters::Parameters ()
+  : m_port (8088)
+  , m_nrWorkerThreads (4)
+  , m_nrDevices (100)
+  , m_nrValuesPerDevice (4)
+  , m_nrUpdatesPerSecond (1000)
+  , m_nrClients (2000)
+  , m_setIntervalMs (1000)
+  , m_rampUpSeconds (5)
+  , m_durationSeconds (30)
+{
+
+}
+
+Switch::HttpLoadTests::SyntheticController::SyntheticController (const uint32_t& i_nrDevices, const uint32_t& i_nrValuesPerDevice)
+  : m_nrDevices (i_nrDevices)
+  , m_nrValuesPerDevice (i_nrValuesPerDevice)
+  , m_values (i_nrDevices * i_nrValuesPerDevice, 0)
+  , m_running (false)
+  , m_nrUpdates (0)
+{
+
+}
+
+Switch::HttpLoadTests::SyntheticController::~SyntheticController ()
+{
+  Stop ();
+}
+
+void Switch::HttpLoadTests::SyntheticController::Start (const uint32_t& i_nrUpdatesPerSecond)
+{
+  SWITCH_ASSERT (!m_running);
+  m_running = true;
+  m_updateThread = std::thread (&Switch::HttpLoadTests::SyntheticController::_GenerateUpdates, this, i_nrUpdatesPerSecond);
+}
+
+void Switch::HttpLoadTests::SyntheticController::Stop ()
+{
+  m_running = false;
+  if (m_updateThread.joinable ())
+  {
+    m_updateThread.join ();
+  }
+}
+
+uint64_t Switch::HttpLoadTests::SyntheticController::GetNrUpdates () const
+{
+  return m_nrUpdates;
+}
+
+Switch::ObserverConnection Switch::HttpLoadTests::SyntheticController::ConnectToDeviceConnectionUpdateSignal (const DeviceConnectionUpdateSlot& i_receiver)
+{
+  return m_deviceConnectionUpdateSignal.Connect (i_receiver);
+}
+
+Switch::ObserverConnection Switch::HttpLoadTests::SyntheticController::ConnectToDeviceDataUpdateSignal (const DeviceDataUpdateSlot& i_receiver)
+{
+  return m_deviceDataUpdateSignal.Connect (i_receiver);
+}
+
+Switch::Interface::eCallResult Switch::HttpLoadTests::SyntheticController::AddDevice (const uint32_t& i_deviceAddress)
+{
+  return ((0 < i_deviceAddress) && (m_nrDevices >= i_deviceAddress)) ? Switch::Interface::CR_OK : Switch::Interface::CR_UNKNOWN_DEVICE;
+}
+
+Switch::Interface::eCallResult Switch::HttpLoadTests::SyntheticController::EnumerateDevices (std::list <Switch::Interface::Device::Summary>& o_deviceInfo)
+{
+  o_deviceInfo.clear ();
+  uint32_t nextDeviceAddress = 0;
+  return VisitDevices (nextDeviceAddress, [&o_deviceInfo] (const Switch::Interface::Device::Summary& i_summary) { o_deviceInfo.push_back (i_summary); }, 0, m_nrDevices);
+}
+
+Switch::Interface::eCallResult Switch::HttpLoadTests::SyntheticController::VisitDevices (uint32_t& o_nextDeviceAddress, const DeviceSummaryVisitor& i_visitor, const uint32_t& i_firstDeviceAddress, const uint32_t& i_maxNrDevices)
+{
+  Switch::Interface::Device::Summary summary;
+  summary.m_productInfo.m_brandId       = 1;
+  summary.m_productInfo.m_brandName     = "Switch";
+  summary.m_productInfo.m_productId     = 1;
+  summary.m_productInfo.m_productType   = "Synthetic";
+  summary.m_productInfo.m_productVersion = 1;
+  summary.m_online                      = true;
+
+  o_nextDeviceAddress = 0;
+  uint32_t nrDevices = 0;
+  for (uint32_t deviceId=std::max <uint32_t> (1, i_firstDeviceAddress); deviceId<=m_nrDevices; ++deviceId)
+  {
+    if (i_maxNrDevices == nrDevices)
+    {
+      o_nextDeviceAddress = deviceId;
+      break;
+    }
+    summary.m_deviceId = deviceId;
+    i_visitor (summary);
+    ++nrDevices;
+  }
+
+  return Switch::Interface::CR_OK;
+}
+
+Switch::Interface::eCallResult Switch::HttpLoadTests::SyntheticController::GetDeviceDetails (Switch::Interface::Device& o_deviceDetails, const uint32_t& i_deviceAddress)
+{
+  if ((0 == i_deviceAddress) || (m_nrDevices < i_deviceAddress))
+  {
+    return Switch::Interface::CR_UNKNOWN_DEVICE;
+  }
+
+  o_deviceDetails.m_deviceId                      = i_deviceAddress;
+  o_deviceDetails.m_productInfo.m_brandId         = 1;
+  o_deviceDetails.m_productInfo.m_brandName       = "Switch";
+  o_deviceDetails.m_productInfo.m_productId       = 1;
+  o_deviceDetails.m_productInfo.m_productType     = "Synthetic";
+  o_deviceDetails.m_productInfo.m_productVersion  = 1;
+  o_deviceDetails.m_connectionInfo.m_online       = true;
+  o_deviceDetails.m_dataFormat.m_values.clear ();
+  for (uint32_t address=0; address<m_nrValuesPerDevice; ++address)
+  {
+    Switch::Interface::Device::Value::DataFormat valueFormat;
+    valueFormat.m_address     = address;
+    valueFormat.m_magicNumber = 0;
+    valueFormat.m_name        = "value";
+    valueFormat.m_description = "Synthetic value";
+    valueFormat.m_minValue    = 0;
+    valueFormat.m_maxValue    = 0xFFFFFFFF;
+    o_deviceDetails.m_dataFormat.m_values.push_back (valueFormat);
+  }
+
+  return Switch::Interface::CR_OK;
+}
+
+Switch::Interface::eCallResult Switch::HttpLoadTests::SyntheticController::GetDeviceCatalogVersion (uint64_t& o_version)
+{
+  // note: the devices never change
+  o_version = 1;
+  return Switch::Interface::CR_OK;
+}
+
+Switch::Interface::eCallResult Switch::HttpLoadTests::SyntheticController::GetDeviceValues (std::list <Switch::Interface::Device::Value>& o_values, const uint32_t& i_deviceAddress)
+{
+  if ((0 == i_deviceAddress) || (m_nrDevices < i_deviceAddress))
+  {
+    return Switch::Interface::CR_UNKNOWN_DEVICE;
+  }
+
+  o_values.clear ();
+  std::unique_lock <std::mutex> valuesLock (m_valuesMutex);
+  for (uint32_t address=0; address<m_nrValuesPerDevice; ++address)
+  {
+    Switch::Interface::Device::Value value;
+    value.m_address     = address;
+    value.m_magicNumber = 0;
+    value.m_value       = m_values [(i_deviceAddress - 1) * m_nrValuesPerDevice + address];
+    o_values.push_back (value);
+  }
+
+  return Switch::Interface::CR_OK;
+}
+
+Switch::Interface::eCallResult Switch::HttpLoadTests::SyntheticController::GetMultipleDeviceValues (std::map <uint32_t, std::list <Switch::Interface::Device::Value>>& o_values, const std::set <uint32_t>& i_deviceAddresses)
+{
+  o_values.clear ();
+  std::set <uint32_t>::const_iterator itDeviceAddress;
+  for (itDeviceAddress = i_deviceAddresses.begin (); i_deviceAddresses.end () != itDeviceAddress; ++itDeviceAddress)
+  {
+    std::list <Switch::Interface::Device::Value> values;
+    if (Switch::Interface::CR_OK == GetDeviceValues (values, *itDeviceAddress))
+    {
+      o_values [*itDeviceAddress].swap (values);
+    }
+  }
+
+  return Switch::Interface::CR_OK;
+}
+
+Switch::Interface::eCallResult Switch::HttpLoadTests::SyntheticController::GetDeviceReportedValues (std::list <Switch::Interface::Device::Value>& o_values, const uint32_t& i_deviceAddress)
+{
+  // note: the synthetic devices acknowledge every value immediately
+  return GetDeviceValues (o_values, i_deviceAddress);
+}
+
+Switch::Interface::eCallResult Switch::HttpLoadTests::SyntheticController::SetDeviceValues (const uint32_t& i_deviceAddress, const std::list <Switch::Interface::Device::Value>& i_values)
+{
+  if ((0 == i_deviceAddress) || (m_nrDevices < i_deviceAddress))
+  {
+    return Switch::Interface::CR_UNKNOWN_DEVICE;
+  }
+
+  {
+    std::unique_lock <std::mutex> valuesLock (m_valuesMutex);
+    for (std::list <Switch::Interface::Device::Value>::const_iterator itValue=i_values.begin (); i_values.end ()!=itValue; ++itValue)
+    {
+      if (m_nrValuesPerDevice <= itValue->m_address)
+      {
+        return Switch::Interface::CR_INVALID;
+      }
+      m_values [(i_deviceAddress - 1) * m_nrValuesPerDevice + itValue->m_address] = itValue->m_value;
+    }
+  }
+
+  // the device reports the changed values, as a real device would
+  m_deviceDataUpdateSignal.Emit (i_deviceAddress, i_values);
+  ++m_nrUpdates;
+
+  return Switch::Interface::CR_OK;
+}
+
+Switch::Interface::eCallResult Switch::HttpLoadTests::SyntheticController::SetMultipleDeviceValues (std::map <uint32_t, Switch::Interface::eCallResult>& o_results, uint32_t& o_sceneId, const std::map <uint32_t, std::list <Switch::Interface::Device::Value>>& i_values)
+{
+  o_results.clear ();
+  for (std::map <uint32_t, std::list <Switch::Interface::Device::Value>>::const_iterator itDevice=i_values.begin (); i_values.end ()!=itDevice; ++itDevice)
+  {
+    o_results [itDevice->first] = SetDeviceValues (itDevice->first, itDevice->second);
+  }
+
+  // values are applied at once, no scenes are kept
+  o_sceneId = 0;
+
+  return Switch::Interface::CR_OK;
+}
+
+Switch::Interface::eCallResult Switch::HttpLoadTests::SyntheticController::GetSceneResults (std::map <uint32_t, Switch::Interface::eCallResult>& o_results, const uint32_t& i_sceneId)
+{
+  o_results.clear ();
+
+  return Switch::Interface::CR_INVALID;
+}
+
+Switch::Interface::eCallResult Switch::HttpLoadTests::SyntheticController::GetCommandBacklog (uint32_t& o_nrQueuedCommands, uint32_t& o_drainTimeMicros)
+{
+  // values are applied at once, nothing is ever queued
+  o_nrQueuedCommands = 0;
+  o_drainTimeMicros  = 0;
+
+  return Switch::Interface::CR_OK;
+}
+
+Switch::Interface::eCallResult Switch::HttpLoadTests::SyntheticController::GetChangesSince (uint64_t& o_version, std::list <Switch::Interface::Device::Summary>& o_devices, std::map <uint32_t, std::list <Switch::Interface::Device::Value>>& o_values, const uint64_t& i_version)
+{
+  // no versions are kept, every call gets all devices and values
+  o_version = 0;
+  o_values.clear ();
+  EnumerateDevices (o_devices);
+  for (uint32_t deviceId=1; deviceId<=m_nrDevices; ++deviceId)
+  {
+    GetDeviceValues (o_values [deviceId], deviceId);
+  }
+
+  return Switch::Interface::CR_OK;
+}
+
+void Switch::HttpLoadTests::SyntheticController::_GenerateUpdates (const uint32_t i_nrUpdatesPerSecond)
+{
+  std::mt19937 random (12345);
+  const clock_type::time_point start = clock_type::now ();
+  uint64_t nrGenerated = 0;
+
+  while (m_running)
+  {
+    // catch up with the rate, the sleep granularity being a millisecond
+    const double seconds = std::chrono::duration_cast <std::chrono::duration <double>> (clock_type::now () - start).count ();
+    const uint64_t nrDue = static_cast <uint64_t> (seconds * i_nrUpdatesPerSecond);
+    for (; nrGenerated<nrDue; ++nrGenerated)
+    {
+      std::list <Switch::Interface::Device::Value> values (1);
+      values.front ().m_address     = random () % m_nrValuesPerDevice;
+      values.front ().m_magicNumber = 0;
+      values.front ().m_value       = GetTimestamp ();
+      const uint32_t deviceId = 1 + random () % m_nrDevices;
+      {
+        std::unique_lock <std::mutex> valuesLock (m_valuesMutex);
+        m_values [(deviceId - 1) * m_nrValuesPerDevice + values.front ().m_address] = values.front ().m_value;
+      }
+
+      m_deviceDataUpdateSignal.Emit (deviceId, values);
+      ++m_nrUpdates;
+    }
+
+    std::this_thread::sleep_for (std::chrono::milliseconds (1));
+  }
+}
+
+Switch::HttpLoadTests::LatencyStatistics::LatencyStatistics ()
+  : m_nrErrors (0)
+{
+
+}
+
+void Switch::HttpLoadTests::LatencyStatistics::Add (const double& i_microseconds)
+{
+  m_samples.push_back (i_microseconds);
+}
+
+void Switch::HttpLoadTests::LatencyStatistics::Report (std::ostream& io_stream, const std::string& i_name, const double& i_seconds)
+{
+  std::sort (m_samples.begin (), m_samples.end ());
+
+  io_stream << std::left << std::setw (12) << i_name << std::right
+            << std::setw (10) << m_samples.size ()
+            << std::setw (8)  << m_nrErrors
+            << std::setw (10) << std::fixed << std::setprecision (1) << (m_samples.size () / i_seconds);
+
+  const double percentiles [4] = { 0.5, 0.9, 0.99, 1.0 };
+  for (uint32_t i=0; i<4; ++i)
+  {
+    double microseconds = 0.0;
+    if (!m_samples.empty ())
+    {
+      microseconds = m_samples [std::min (m_samples.size () - 1, static_cast <size_t> (percentiles [i] * m_samples.size ()))];
+    }
+    io_stream << std::setw (10) << std::setprecision (0) << microseconds;
+  }
+  io_stream << std::endl;
+}
+
+Switch::HttpLoadTests::ResponseReader::ResponseReader ()
+{
+  Reset ();
+}
+
+void Switch::HttpLoadTests::ResponseReader::Reset ()
+{
+  m_state     = RS_HEADERS;
+  m_status    = 0;
+  m_remaining = 0;
+  m_cookie.clear ();
+}
+
+bool Switch::HttpLoadTests::ResponseReader::Read (std::string& io_input, std::string& io_body)
+{
+  while (true)
+  {
+    switch (m_state)
+    {
+    case RS_HEADERS:
+      {
+        const size_t headersEnd = io_input.find ("\r\n\r\n");
+        if (std::string::npos == headersEnd)
+        {
+          return false;
+        }
+
+        // parse the status line and the headers we need
+        std::istringstream headers (io_input.substr (0, headersEnd));
+        io_input.erase (0, headersEnd + 4);
+
+        std::string line;
+        std::getline (headers, line);
+        std::istringstream statusLine (line);
+        std::string version;
+        statusLine >> version >> m_status;
+
+        bool chunked = false;
+        bool hasLength = false;
+        while (std::getline (headers, line))
+        {
+          const size_t colon = line.find (':');
+          if (std::string::npos == colon)
+          {
+            continue;
+          }
+          std::string name = line.substr (0, colon);
+          std::transform (name.begin (), name.end (), name.begin (), ::tolower);
+          std::string value = line.substr (colon + 1);
+          value.erase (0, value.find_first_not_of (' '));
+          value.erase (value.find_last_not_of ("\r ") + 1);
+
+          if ("content-length" == name)
+          {
+            hasLength = true;
+            m_remaining = std::strtoul (value.c_str (), 0x0, 10);
+          }
+          else if (("transfer-encoding" == name) && (std::string::npos != value.find ("chunked")))
+          {
+            chunked = true;
+          }
+          else if ("set-cookie" == name)
+          {
+            if (!m_cookie.empty ())
+            {
+              m_cookie += "; ";
+            }
+            m_cookie += value.substr (0, value.find (';'));
+          }
+        }
+
+        if (chunked)
+        {
+          m_state = RS_CHUNK_SIZE;
+        }
+        else if (hasLength)
+        {
+          m_state = (0 == m_remaining) ? RS_DONE : RS_BODY;
+        }
+        else
+        {
+          m_state = ((204 == m_status) || (304 == m_status)) ? RS_DONE : RS_UNTIL_CLOSE;
+        }
+      }
+      break;
+
+    case RS_BODY:
+    case RS_CHUNK_DATA:
+      {
+        const size_t size = std::min (m_remaining, io_input.size ());
+        io_body.append (io_input, 0, size);
+        io_input.erase (0, size);
+        m_remaining -= size;
+        if (0 != m_remaining)
+        {
+          return false;
+        }
+        m_state = (RS_BODY == m_state) ? RS_DONE : RS_CHUNK_END;
+      }
+      break;
+
+    case RS_CHUNK_SIZE:
+      {
+        const size_t lineEnd = io_input.find ("\r\n");
+        if (std::string::npos == lineEnd)
+        {
+          return false;
+        }
+        m_remaining = std::strtoul (io_input.substr (0, lineEnd).c_str (), 0x0, 16);
+        io_input.erase (0, lineEnd + 2);
+        m_state = (0 == m_remaining) ? RS_TRAILER : RS_CHUNK_DATA;
+      }
+      break;
+
+    case RS_CHUNK_END:
+      if (2 > io_input.size ())
+      {
+        return false;
+      }
+      io_input.erase (0, 2);
+      m_state = RS_CHUNK_SIZE;
+      break;
+
+    case RS_TRAILER:
+      {
+        const size_t lineEnd = io_input.find ("\r\n");
+        if (std::string::npos == lineEnd)
+        {
+          return false;
+        }
+        io_input.erase (0, lineEnd + 2);
+        if (0 == lineEnd)
+        {
+          m_state = RS_DONE;
+        }
+      }
+      break;
+
+    case RS_UNTIL_CLOSE:
+      io_body.append (io_input);
+      io_input.clear ();
+      return false;
+
+    case RS_DONE:
+      return true;
+    }
+  }
+}
+
+Switch::HttpLoadTests::Connection::Connection ()
+  : m_socket (-1)
+  , m_connecting (false)
+{
+
+}
+
+Switch::HttpLoadTests::Connection::~Connection ()
+{
+  Close ();
+}
+
+bool Switch::HttpLoadTests::Connection::Open (const uint16_t& i_port)
+{
+  Close ();
+
+  m_socket = socket (AF_INET, SOCK_STREAM, 0);
+  if (0 > m_socket)
+  {
+    return false;
+  }
+  fcntl (m_socket, F_SETFL, fcntl (m_socket, F_GETFL, 0) | O_NONBLOCK);
+  int noDelay = 1;
+  setsockopt (m_socket, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof (noDelay));
+
+  sockaddr_in address;
+  std::memset (&address, 0, sizeof (address));
+  address.sin_family      = AF_INET;
+  address.sin_port        = htons (i_port);
+  address.sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+  if ((0 != connect (m_socket, reinterpret_cast <sockaddr*> (&address), sizeof (address))) && (EINPROGRESS != errno))
+  {
+    Close ();
+    return false;
+  }
+
+  m_connecting = true;
+  return true;
+}
+
+void Switch::HttpLoadTests::Connection::Close ()
+{
+  if (0 <= m_socket)
+  {
+    close (m_socket);
+    m_socket = -1;
+  }
+  m_connecting = false;
+  m_output.clear ();
+  m_input.clear ();
+}
+
+bool Switch::HttpLoadTests::Connection::IsOpen () const
+{
+  return (0 <= m_socket);
+}
+
+bool Switch::HttpLoadTests::Connection::Send ()
+{
+  if (m_connecting)
+  {
+    int error = 0;
+    socklen_t errorSize = sizeof (error);
+    if ((0 != getsockopt (m_socket, SOL_SOCKET, SO_ERROR, &error, &errorSize)) || (0 != error))
+    {
+      return false;
+    }
+    m_connecting = false;
+  }
+
+  while (!m_output.empty ())
+  {
+    const ssize_t nrSent = send (m_socket, m_output.data (), m_output.size (), MSG_NOSIGNAL);
+    if (0 > nrSent)
+    {
+      return (EAGAIN == errno) || (EWOULDBLOCK == errno);
+    }
+    m_output.erase (0, nrSent);
+  }
+
+  return true;
+}
+
+bool Switch::HttpLoadTests::Connection::Receive ()
+{
+  char buffer [16384];
+  while (true)
+  {
+    const ssize_t nrReceived = recv (m_socket, buffer, sizeof (buffer), 0);
+    if (0 < nrReceived)
+    {
+      m_input.append (buffer, nrReceived);
+    }
+    else if (0 == nrReceived)
+    {
+      return false;
+    }
+    else
+    {
+      return (EAGAIN == errno) || (EWOULDBLOCK == errno);
+    }
+  }
+}
+
+Switch::HttpLoadTests::Client::Client ()
+  : m_state (CS_IDLE)
+  , m_deviceId (0)
+  , m_listening (false)
+  , m_listenTimestamp (0)
+  , m_cursor (0)
+{
+
+}
+
+Switch::HttpLoadTests::LoadDriver::LoadDriver (const Parameters& i_parameters)
+  : m_parameters (i_parameters)
+  , m_clients (i_parameters.m_nrClients)
+  , m_nextCallId (1)
+  , m_nrReplayedUpdates (0)
+  , m_nrResyncs (0)
+  , m_nrListens (0)
+  , m_nrListenErrors (0)
+  , m_baseResidentSetSize (0)
+  , m_peakResidentSetSize (0)
+{
+  // spread the clients over the devices and the ramp-up
+  const clock_type::time_point now = clock_type::now ();
+  std::mt19937 random (54321);
+  for (uint32_t i=0; i<m_clients.size (); ++i)
+  {
+    Client& client = m_clients [i];
+    client.m_deviceId   = 1 + i % m_parameters.m_nrDevices;
+    client.m_startTime  = now + std::chrono::microseconds (static_cast <uint64_t> (i) * m_parameters.m_rampUpSeconds * 1000000 / m_clients.size ());
+    client.m_nextSetTime = client.m_startTime + std::chrono::milliseconds (random () % (m_parameters.m_setIntervalMs + 1));
+  }
+}
+
+Switch::HttpLoadTests::LoadDriver::~LoadDriver ()
+{
+
+}
+
+void Switch::HttpLoadTests::LoadDriver::Run (const SyntheticController& i_controller)
+{
+  m_baseResidentSetSize = GetResidentSetSize ();
+  m_peakResidentSetSize = m_baseResidentSetSize;
+
+  const clock_type::time_point start = clock_type::now ();
+  const clock_type::time_point end = start + std::chrono::seconds (m_parameters.m_durationSeconds);
+  clock_type::time_point nextProgress = start + std::chrono::seconds (1);
+
+  std::vector <pollfd> pollFds;
+  std::vector <std::pair <Client*, bool>> pollClients;   // the client of every polled socket, and if it is its listen connection
+  pollFds.reserve (2 * m_clients.size ());
+  pollClients.reserve (2 * m_clients.size ());
+
+  while (clock_type::now () < end)
+  {
+    // 1. Poll the open connections
+    pollFds.clear ();
+    pollClients.clear ();
+    for (std::vector <Client>::iterator itClient=m_clients.begin (); m_clients.end ()!=itClient; ++itClient)
+    {
+      Connection* connections [2] = { &itClient->m_control, &itClient->m_listen };
+      for (uint32_t c=0; c<2; ++c)
+      {
+        if (!connections [c]->IsOpen ())
+        {
+          continue;
+        }
+        pollfd pollFd;
+        pollFd.fd      = connections [c]->m_socket;
+        pollFd.events  = POLLIN | ((connections [c]->m_connecting || !connections [c]->m_output.empty ()) ? POLLOUT : 0);
+        pollFd.revents = 0;
+        pollFds.push_back (pollFd);
+        pollClients.push_back (std::make_pair (&*itClient, 1 == c));
+      }
+    }
+    poll (pollFds.data (), pollFds.size (), 5);
+
+    for (size_t i=0; i<pollFds.size (); ++i)
+    {
+      if (0 == pollFds [i].revents)
+      {
+        continue;
+      }
+      Client& client = *pollClients [i].first;
+      if (pollClients [i].second)
+      {
+        if (!client.m_listen.Send ())
+        {
+          client.m_listen.Close ();
+          ++m_nrListenErrors;
+          continue;
+        }
+        _HandleListenInput (client);
+      }
+      else
+      {
+        if (!client.m_control.Send ())
+        {
+          _FailClient (client, (Client::CS_REGISTERING == client.m_state) ? m_register : m_set);
+          continue;
+        }
+        _HandleControlInput (client);
+      }
+    }
+
+    // 2. Start clients, send the due calls and restore the dropped listen calls
+    const clock_type::time_point now = clock_type::now ();
+    for (std::vector <Client>::iterator itClient=m_clients.begin (); m_clients.end ()!=itClient; ++itClient)
+    {
+      if ((Client::CS_IDLE == itClient->m_state) && (itClient->m_startTime <= now))
+      {
+        _StartClient (*itClient);
+      }
+      else if ((Client::CS_WAITING == itClient->m_state) && (itClient->m_nextSetTime <= now))
+      {
+        _SetValues (*itClient);
+      }
+
+      if (itClient->m_listening && !itClient->m_listen.IsOpen () && (itClient->m_nextListenTime <= now))
+      {
+        _Listen (*itClient);
+      }
+    }
+
+    // 3. Report progress
+    if (nextProgress <= now)
+    {
+      nextProgress += std::chrono::seconds (1);
+
+      uint32_t nrListening = 0;
+      for (std::vector <Client>::const_iterator itClient=m_clients.begin (); m_clients.end ()!=itClient; ++itClient)
+      {
+        nrListening += itClient->m_listen.IsOpen () ? 1 : 0;
+      }
+      const uint64_t residentSetSize = GetResidentSetSize ();
+      m_peakResidentSetSize = std::max (m_peakResidentSetSize, residentSetSize);
+
+      std::cout << std::chrono::duration_cast <std::chrono::seconds> (now - start).count () << " s: "
+                << nrListening << " listening, " << m_set.m_samples.size () << " sets, "
+                << m_update.m_samples.size () << " updates received, rss "
+                << (residentSetSize >> 20) << " MiB" << std::endl;
+    }
+  }
+
+  _Report (std::chrono::duration_cast <std::chrono::duration <double>> (clock_type::now () - start).count (), i_controller);
+
+  for (std::vector <Client>::iterator itClient=m_clients.begin (); m_clients.end ()!=itClient; ++itClient)
+  {
+    itClient->m_control.Close ();
+    itClient->m_listen.Close ();
+  }
+}
+
+void Switch::HttpLoadTests::LoadDriver::_StartClient (Client& io_client)
+{
+  if (!io_client.m_control.Open (m_parameters.m_port))
+  {
+    _FailClient (io_client, m_register);
+    return;
+  }
+
+  io_client.m_state = Client::CS_REGISTERING;
+  _Call (io_client, "Register", "");
+}
+
+void Switch::HttpLoadTests::LoadDriver::_FailClient (Client& io_client, LatencyStatistics& io_statistics)
+{
+  ++io_statistics.m_nrErrors;
+  io_client.m_state = Client::CS_FAILED;
+  io_client.m_listening = false;
+  io_client.m_control.Close ();
+  io_client.m_listen.Close ();
+}
+
+void Switch::HttpLoadTests::LoadDriver::_Call (Client& io_client, const std::string& i_method, const std::string& i_params)
+{
+  std::ostringstream body;
+  body << "{\"id\":" << m_nextCallId++ << ",\"method\":\"" << i_method << "\",\"params\":[" << i_params << "]}";
+  const std::string bodyString = body.str ();
+
+  std::ostringstream request;
+  request << "POST /Switch HTTP/1.1\r\n"
+          << "Host: 127.0.0.1\r\n"
+          << "Content-Type: application/json\r\n"
+          << "Content-Length: " << bodyString.size () << "\r\n";
+  if (!io_client.m_token.empty ())
+  {
+    request << "Authorization: Bearer " << io_client.m_token << "\r\n";
+  }
+  request << "\r\n" << bodyString;
+
+  Connection& connection = ("ListenToDeviceUpdates" == i_method) ? io_client.m_listen : io_client.m_control;
+  connection.m_output += request.str ();
+  io_client.m_callTime = clock_type::now ();
+}
+
+void Switch::HttpLoadTests::LoadDriver::_SetValues (Client& io_client)
+{
+  std::ostringstream params;
+  params << io_client.m_deviceId << ",[{\"address\":" << (m_nextCallId % m_parameters.m_nrValuesPerDevice)
+         << ",\"magicNumber\":0,\"value\":" << GetTimestamp () << "}]";
+
+  io_client.m_state = Client::CS_SETTING;
+  io_client.m_nextSetTime += std::chrono::milliseconds (m_parameters.m_setIntervalMs);
+  _Call (io_client, "SetDeviceValues", params.str ());
+}
+
+void Switch::HttpLoadTests::LoadDriver::_Listen (Client& io_client)
+{
+  if (!io_client.m_listen.Open (m_parameters.m_port))
+  {
+    ++m_nrListenErrors;
+    io_client.m_nextListenTime = clock_type::now () + std::chrono::milliseconds (100);
+    return;
+  }
+
+  std::ostringstream params;
+  params << io_client.m_cursor;
+
+  ++m_nrListens;
+  io_client.m_listenReader.Reset ();
+  io_client.m_listenBody.clear ();
+  io_client.m_listenTimestamp = GetTimestamp ();
+  _Call (io_client, "ListenToDeviceUpdates", params.str ());
+}
+
+void Switch::HttpLoadTests::LoadDriver::_HandleControlInput (Client& io_client)
+{
+  const bool open = io_client.m_control.Receive ();
+  if (!io_client.m_controlReader.Read (io_client.m_control.m_input, io_client.m_controlBody))
+  {
+    if (!open)
+    {
+      _FailClient (io_client, (Client::CS_REGISTERING == io_client.m_state) ? m_register : ((Client::CS_SUBSCRIBING == io_client.m_state) ? m_subscribe : m_set));
+    }
+    return;
+  }
+
+  const double microseconds = std::chrono::duration_cast <std::chrono::duration <double, std::micro>> (clock_type::now () - io_client.m_callTime).count ();
+  const bool succeeded = (200 == io_client.m_controlReader.m_status) && (std::string::npos != io_client.m_controlBody.find ("\"error\":null"));
+  if (succeeded && (Client::CS_REGISTERING == io_client.m_state))
+  {
+    // note: the token identifies the client in its next calls
+    static const std::string tokenMember = "\"token\":\"";
+    const size_t tokenBegin = io_client.m_controlBody.find (tokenMember);
+    if (std::string::npos != tokenBegin)
+    {
+      const size_t tokenEnd = io_client.m_controlBody.find ('"', tokenBegin + tokenMember.size ());
+      io_client.m_token = io_client.m_controlBody.substr (tokenBegin + tokenMember.size (), tokenEnd - tokenBegin - tokenMember.size ());
+    }
+  }
+  io_client.m_controlReader.Reset ();
+  io_client.m_controlBody.clear ();
+
+  switch (io_client.m_state)
+  {
+  case Client::CS_REGISTERING:
+    if (!succeeded)
+    {
+      _FailClient (io_client, m_register);
+      return;
+    }
+    m_register.Add (microseconds);
+
+    io_client.m_state = Client::CS_SUBSCRIBING;
+    {
+      std::ostringstream params;
+      params << io_client.m_deviceId;
+      _Call (io_client, "SubscribeToDeviceUpdates", params.str ());
+    }
+    break;
+
+  case Client::CS_SUBSCRIBING:
+    if (!succeeded)
+    {
+      _FailClient (io_client, m_subscribe);
+      return;
+    }
+    m_subscribe.Add (microseconds);
+
+    io_client.m_state     = Client::CS_WAITING;
+    io_client.m_listening = true;
+    _Listen (io_client);
+    break;
+
+  case Client::CS_SETTING:
+    if (succeeded)
+    {
+      m_set.Add (microseconds);
+    }
+    else
+    {
+      ++m_set.m_nrErrors;
+    }
+    io_client.m_state = Client::CS_WAITING;
+    break;
+
+  default:
+    break;
+  }
+
+  if (!open)
+  {
+    _FailClient (io_client, m_set);
+  }
+}
+
+void Switch::HttpLoadTests::LoadDriver::_HandleListenInput (Client& io_client)
+{
+  const bool open = io_client.m_listen.Receive ();
+  const bool completed = io_client.m_listenReader.Read (io_client.m_listen.m_input, io_client.m_listenBody);
+  _ParseUpdates (io_client);
+
+  // note: the interface keeps the listen call open, a completed response is an error
+  if (completed || !open)
+  {
+    if (completed)
+    {
+      ++m_nrListenErrors;
+    }
+    io_client.m_listen.Close ();
+    io_client.m_nextListenTime = clock_type::now () + std::chrono::milliseconds (completed ? 100 : 0);
+  }
+}
+
+/*!
+  \brief Parses the complete updates received on the listen connection.
+
+  The updates are json objects written one after the other. The values they carry
+  are the timestamps of their generation, updates generated before the listen call
+  are replays of the buffered state.
+ */
+void Switch::HttpLoadTests::LoadDriver::_ParseUpdates (Client& io_client)
+{
+  const std::string& body = io_client.m_listenBody;
+  size_t consumed = 0;
+  uint32_t depth = 0;
+  bool inString = false;
+  for (size_t i=0; i<body.size (); ++i)
+  {
+    const char c = body [i];
+    if (inString)
+    {
+      if ('\\' == c)
+      {
+        ++i;
+      }
+      else if ('"' == c)
+      {
+        inString = false;
+      }
+      continue;
+    }
+    if ('"' == c)
+    {
+      inString = true;
+    }
+    else if ('{' == c)
+    {
+      ++depth;
+    }
+    else if (('}' == c) && (0 < depth) && (0 == --depth))
+    {
+      // a complete update
+      const std::string update = body.substr (consumed, i + 1 - consumed);
+      consumed = i + 1;
+
+      const uint32_t now = GetTimestamp ();
+      if (std::string::npos != update.find ("\"resyncRequired\""))
+      {
+        ++m_nrResyncs;
+      }
+      for (size_t position=update.find ("\"value\":"); std::string::npos!=position; position=update.find ("\"value\":", position + 1))
+      {
+        const uint32_t timestamp = static_cast <uint32_t> (std::strtoul (update.c_str () + position + 8, 0x0, 10));
+        if (static_cast <int32_t> (timestamp - io_client.m_listenTimestamp) < 0)
+        {
+          ++m_nrReplayedUpdates;
+        }
+        else
+        {
+          m_update.Add (static_cast <uint32_t> (now - timestamp));
+        }
+      }
+      const size_t indexPosition = update.find ("\"index\":");
+      if (std::string::npos != indexPosition)
+      {
+        io_client.m_cursor = std::max <uint64_t> (io_client.m_cursor, std::strtoull (update.c_str () + indexPosition + 8, 0x0, 10));
+      }
+    }
+  }
+  io_client.m_listenBody.erase (0, consumed);
+}
+
+void Switch::HttpLoadTests::LoadDriver::_Report (const double& i_seconds, const SyntheticController& i_controller)
+{
+  uint32_t nrFailed = 0;
+  for (std::vector <Client>::const_iterator itClient=m_clients.begin (); m_clients.end ()!=itClient; ++itClient)
+  {
+    nrFailed += (Client::CS_FAILED == itClient->m_state) ? 1 : 0;
+  }
+  m_peakResidentSetSize = std::max (m_peakResidentSetSize, GetResidentSetSize ());
+
+  std::cout << std::endl
+            << m_parameters.m_nrClients << " clients (" << nrFailed << " failed), "
+            << m_parameters.m_nrDevices << " devices, "
+            << m_parameters.m_nrUpdatesPerSecond << " generated updates/s, a set every "
+            << m_parameters.m_setIntervalMs << " ms per client, "
+            << std::fixed << std::setprecision (1) << i_seconds << " s" << std::endl
+            << std::left << std::setw (12) << "call" << std::right
+            << std::setw (10) << "count" << std::setw (8) << "errors" << std::setw (10) << "per s"
+            << std::setw (10) << "p50 us" << std::setw (10) << "p90 us" << std::setw (10) << "p99 us" << std::setw (10) << "max us" << std::endl;
+
+  m_register.Report (std::cout, "Register", i_seconds);
+  m_subscribe.Report (std::cout, "Subscribe", i_seconds);
+  m_set.Report (std::cout, "Set", i_seconds);
+  m_update.Report (std::cout, "Update", i_seconds);
+
+  std::cout << "updates emitted " << i_controller.GetNrUpdates () << ", replayed " << m_nrReplayedUpdates
+            << ", resyncs " << m_nrResyncs << ", listen calls " << m_nrListens << " (" << m_nrListenErrors << " failed)" << std::endl
+            << "rss before clients " << (m_baseResidentSetSize >> 10) << " KiB, peak " << (m_peakResidentSetSize >> 10)
+            << " KiB, " << ((m_peakResidentSetSize - std::min (m_peakResidentSetSize, m_baseResidentSetSize)) / std::max <uint32_t> (1, m_parameters.m_nrClients))
+            << " bytes per client" << std::endl;
+}
+
+/*!
+  \brief Runs the http interface on a service bound to localhost and loads it with simulated clients.
+
+  Clients and service share the process, the reported memory includes the
+  buffers of the clients.
+ */
+void Switch::HttpLoadTests::BenchmarkLoad (const Parameters& i_parameters)
+{
+  // every client needs two sockets, the service as many
+  rlimit fileLimit;
+  if (0 == getrlimit (RLIMIT_NOFILE, &fileLimit))
+  {
+    fileLimit.rlim_cur = fileLimit.rlim_max;
+    setrlimit (RLIMIT_NOFILE, &fileLimit);
+    if (fileLimit.rlim_cur < 4 * i_parameters.m_nrClients + 64)
+    {
+      std::cout << "warning: the open file limit " << fileLimit.rlim_cur << " is too low for " << i_parameters.m_nrClients << " clients" << std::endl;
+    }
+  }
+
+  SyntheticController controller (i_parameters.m_nrDevices, i_parameters.m_nrValuesPerDevice);
+
+  cppcms::json::value settings;
+  settings.set ("service.api",                "http");
+  settings.set ("service.ip",                 "127.0.0.1");
+  settings.set ("service.port",               i_parameters.m_port);
+  settings.set ("service.worker_threads",     i_parameters.m_nrWorkerThreads);
+  settings.set ("service.backlog",            4 * i_parameters.m_nrClients);
+  settings.set ("http.script",                "/Switch");
+  settings.set ("session.location",           "server");
+  settings.set ("session.server.storage",     "memory");
+  settings.set ("session.expire",             "renew");
+  settings.set ("session.timeout",            3600);
+
+  // create the http interface
+  cppcms::service httpService (settings);
+  httpService.applications_pool ().mount (cppcms::applications_factory <Switch::HttpInterface, Switch::FunctionalInterface&, std::shared_ptr <Switch::HttpInterface::SharedState>> (controller, std::make_shared <Switch::HttpInterface::SharedState> ()));
+  std::thread serviceThread ([&httpService] () { httpService.run (); });
+
+  // note: give the service the time to bind its socket
+  std::this_thread::sleep_for (std::chrono::milliseconds (500));
+  controller.Start (i_parameters.m_nrUpdatesPerSecond);
+
+  {
+    LoadDriver driver (i_parameters);
+    driver.Run (controller);
+  }
+
+  controller.Stop ();
+  httpService.shutdown ();
+  serviceThread.join ();
+}
+
+void Switch::HttpLoadTests::Run ()
+{
+  try
+  {
+    Parameters parameters;
+    BenchmarkLoad (parameters);
+  }
+  catch (const std::exception& i_exception)
+  {
+    std::cout << "Uncaught exception: " << i_exception.what () << std::endl;
+  }
+  catch (...)
+  {
+    std::cout << "Uncaught exception: unknown-type" << std::endl;
+  }
+}
+
+
+#endif // _SWITCH_HTTP_LOADTESTS
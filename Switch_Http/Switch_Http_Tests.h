@@ -11,6 +11,11 @@
 
 // project includes
 #include "Switch_Http/Switch_HttpInterface.h"
+#include "Switch_Http/Switch_HttpInterfaceTraits.h"
+#include "Switch_Http/Switch_HttpCbor.h"
+#include "Switch_Http/Switch_HttpCodec.h"
+#include "Switch_Http/Switch_HttpSubscriptionIndex.h"
+#include "Switch_Http/Switch_HttpClientRegistry.h"
 
 // switch includes
 #include <Switch_Base/Switch_CompilerConfiguration.h>
@@ -24,6 +29,8 @@
 
 // third party includes
 #include <thread>
+#include <chrono>
+#include <sstream>
 #include <SSVUtils/Core/FileSystem/FileSystem.hpp>
 #include <cppcms/application.h>
 #include <cppcms/applications_pool.h>
@@ -39,6 +46,12 @@ namespace Switch
     void Run ();
     void TestFunctional ();
     void TestNoInterProcess ();
+    void TestCbor ();
+    void BenchmarkCbor ();
+    void TestCodec ();
+    void BenchmarkCodec ();
+    void TestSubscriptionIndex ();
+    void TestClientRegistry ();
   }
 }
 
@@ -53,7 +66,7 @@ void Switch::HttpTests::TestFunctional ()
   Switch::FunctionalFacade controllerFacade (controller);
   cppcms::service httpService (nrArguments, arguments);
 
-  httpService.applications_pool ().mount (cppcms::applications_factory <Switch::HttpInterface, Switch::FunctionalFacade> (controllerFacade));
+  httpService.applications_pool ().mount (cppcms::applications_factory <Switch::HttpInterface, Switch::FunctionalFacade, std::shared_ptr <Switch::HttpInterface::SharedState>> (controllerFacade, std::make_shared <Switch::HttpInterface::SharedState> ()));
   httpService.run ();
 }
 
@@ -123,10 +136,427 @@ void Switch::HttpTests::TestNoInterProcess ()
   Switch::FunctionalFacade controllerFacade (controller);
   cppcms::service httpService (nrArguments, arguments);
 
-  httpService.applications_pool ().mount (cppcms::applications_factory <Switch::HttpInterface, Switch::FunctionalFacade> (controllerFacade));
+  httpService.applications_pool ().mount (cppcms::applications_factory <Switch::HttpInterface, Switch::FunctionalFacade, std::shared_ptr <Switch::HttpInterface::SharedState>> (controllerFacade, std::make_shared <Switch::HttpInterface::SharedState> ()));
   httpService.run ();
 }
 
+void Switch::HttpTests::TestCbor ()
+{
+  std::list <Switch::Interface::Device::Value> values (3);
+  int32_t i = 0;
+  for (std::list <Switch::Interface::Device::Value>::iterator itValue = values.begin (); values.end () != itValue; ++itValue, ++i)
+  {
+    itValue->m_address     = i;
+    itValue->m_magicNumber = 1234567;
+    itValue->m_value       = 1000 * i - 1500;
+  }
+
+  cppcms::json::value response;
+  response.set ("result", Switch::Interface::CR_OK);
+  response.set ("deviceValues", values);
+  response.set ("fraction", 0.25);
+  response.set ("flag", true);
+  response.set ("unknownKey", "text");
+
+  // the decoded value equals the encoded one
+  std::string bytes;
+  Switch::Cbor::Encode (bytes, response);
+  const char* pBegin = bytes.data ();
+  cppcms::json::value decoded;
+  SWITCH_ASSERT (Switch::Cbor::Decode (decoded, pBegin, bytes.data () + bytes.size ()));
+  SWITCH_ASSERT (bytes.data () + bytes.size () == pBegin);
+  SWITCH_ASSERT (response == decoded);
+  std::list <Switch::Interface::Device::Value> decodedValues = decoded.get <std::list <Switch::Interface::Device::Value>> ("deviceValues");
+  SWITCH_ASSERT ((3 == decodedValues.size ()) && (-1500 == decodedValues.front ().m_value) && (1234567 == decodedValues.back ().m_magicNumber));
+
+  // truncated data is rejected
+  for (size_t size=0; size<bytes.size (); ++size)
+  {
+    pBegin = bytes.data ();
+    SWITCH_ASSERT (!Switch::Cbor::Decode (decoded, pBegin, bytes.data () + size));
+  }
+
+  // too deeply nested data is rejected
+  std::string nested (HTTP_CBOR_MAX_NESTING + 2, '\x81');
+  nested.push_back ('\x00');
+  pBegin = nested.data ();
+  SWITCH_ASSERT (!Switch::Cbor::Decode (decoded, pBegin, nested.data () + nested.size ()));
+}
+
+void Switch::HttpTests::BenchmarkCbor ()
+{
+  const uint32_t nrValues     = 16;
+  const uint32_t nrEncodings  = 100000;
+
+  std::list <Switch::Interface::Device::Value> values (nrValues);
+  int32_t i = 0;
+  for (std::list <Switch::Interface::Device::Value>::iterator itValue = values.begin (); values.end () != itValue; ++itValue, ++i)
+  {
+    itValue->m_address     = i;
+    itValue->m_magicNumber = 1234567 + i;
+    itValue->m_value       = 17 * i - 40;
+  }
+
+  // the result of GetDeviceValues and a data update push of two values
+  cppcms::json::value valuesResult;
+  valuesResult.set ("result", Switch::Interface::CR_OK);
+  valuesResult.set ("deviceValues", values);
+
+  std::list <Switch::Interface::Device::Value> updateValues (values.begin (), ++(++values.begin ()));
+  cppcms::json::value dataUpdate;
+  dataUpdate.set ("index", 123456);
+  dataUpdate.set ("event", "dataUpdate");
+  dataUpdate.set ("data.deviceId", 12);
+  dataUpdate.set ("data.values", updateValues);
+
+  const cppcms::json::value* messages [2] = { &valuesResult, &dataUpdate };
+  const char* names [2] = { "GetDeviceValues", "dataUpdate" };
+  for (uint32_t m=0; m<2; ++m)
+  {
+    size_t jsonSize = 0;
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now ();
+    for (uint32_t n=0; n<nrEncodings; ++n)
+    {
+      std::ostringstream jsonStream;
+      messages [m]->save (jsonStream, cppcms::json::compact);
+      jsonSize = jsonStream.str ().size ();
+    }
+    double jsonNanos = std::chrono::duration_cast <std::chrono::duration <double, std::nano>> (std::chrono::high_resolution_clock::now () - start).count ();
+
+    size_t cborSize = 0;
+    start = std::chrono::high_resolution_clock::now ();
+    for (uint32_t n=0; n<nrEncodings; ++n)
+    {
+      std::string bytes;
+      Switch::Cbor::Encode (bytes, *messages [m]);
+      cborSize = bytes.size ();
+    }
+    double cborNanos = std::chrono::duration_cast <std::chrono::duration <double, std::nano>> (std::chrono::high_resolution_clock::now () - start).count ();
+
+    std::cout << names [m] << ": json " << jsonSize << " bytes in " << jsonNanos/nrEncodings << " ns, cbor "
+              << cborSize << " bytes in " << cborNanos/nrEncodings << " ns" << std::endl;
+  }
+}
+
+void Switch::HttpTests::TestCodec ()
+{
+  typedef Switch::Interface::Device::Value Value;
+
+  Switch::Codec::Arena arena;
+  {
+    std::list <Value> values (3);
+    uint32_t i = 0;
+    for (std::list <Value>::iterator itValue = values.begin (); values.end () != itValue; ++itValue, ++i)
+    {
+      itValue->m_address     = i;
+      itValue->m_magicNumber = 1234567;
+      itValue->m_value       = 1000 * i;
+    }
+
+    // the written values are read back, by the codecs and by the json traits
+    std::ostringstream stream;
+    {
+      Switch::Codec::Writer writer (stream);
+      Switch::Codec::Write (writer, values);
+    }
+    const std::string text = stream.str ();
+    Switch::Codec::ArenaVector <Value> decoded ((Switch::Codec::ArenaAllocator <Value> (arena)));
+    Switch::Codec::Reader reader (text.data (), text.data () + text.size (), arena);
+    SWITCH_ASSERT (Switch::Codec::Read (reader, decoded) && reader.IsAtEnd ());
+    SWITCH_ASSERT ((3 == decoded.size ()) && (2000 == decoded.back ().m_value) && (1234567 == decoded.front ().m_magicNumber));
+    cppcms::json::value parsed;
+    const char* pText = text.data ();
+    SWITCH_ASSERT (parsed.load (pText, text.data () + text.size (), true));
+    SWITCH_ASSERT (2000 == parsed.get_value <std::list <Value>> ().back ().m_value);
+
+    // parameters of SetMultipleDeviceValues with white space, escapes, unknown members and members in any order
+    const std::string params = " [ [ {\"values\": [{\"value\": 5, \"address\": 1, \"magicNumber\": 7, \"note\": \"a\\\"b\\u00e9\"}], \"deviceId\": 12},\n"
+                               "      {\"deviceId\": 13, \"values\": []} ] ] ";
+    Switch::Codec::ArenaVector <Switch::Codec::DeviceValues> deviceValues ((Switch::Codec::ArenaAllocator <Switch::Codec::DeviceValues> (arena)));
+    Switch::Codec::Reader paramsReader (params.data (), params.data () + params.size (), arena);
+    SWITCH_ASSERT (Switch::Codec::ReadTuple (paramsReader, deviceValues) && paramsReader.IsAtEnd ());
+    SWITCH_ASSERT ((2 == deviceValues.size ()) && (12 == deviceValues [0].m_deviceId) && (13 == deviceValues [1].m_deviceId));
+    SWITCH_ASSERT ((1 == deviceValues [0].m_values.size ()) && (5 == deviceValues [0].m_values [0].m_value) && deviceValues [1].m_values.empty ());
+    SWITCH_ASSERT (&arena == deviceValues [0].m_values.get_allocator ().m_pArena);
+
+    // strings are unescaped, characters outside the basic plane included
+    const std::string escaped = "\"a\\\"b\\u00e9\\ud83d\\ude00\"";
+    Switch::Codec::Reader stringReader (escaped.data (), escaped.data () + escaped.size (), arena);
+    std::string unescaped;
+    SWITCH_ASSERT (Switch::Codec::Read (stringReader, unescaped) && ("a\"b\xc3\xa9\xf0\x9f\x98\x80" == unescaped));
+    stream.str ("");
+    {
+      Switch::Codec::Writer writer (stream);
+      Switch::Codec::Write (writer, std::string ("a\"\n"));
+    }
+    SWITCH_ASSERT ("\"a\\\"\\n\"" == stream.str ());
+
+    // malformed and incomplete parameters are rejected
+    const char* invalidParams [] =
+    {
+      "[[{\"deviceId\": 12}]]",
+      "[[{\"deviceId\": 12, \"values\": [],}]]",
+      "[[{\"deviceId\": 1.5, \"values\": []}]]",
+      "[[{\"deviceId\": -12, \"values\": []}]]",
+      "[[{\"deviceId\": \"12\", \"values\": []}]]",
+      "[[{\"deviceId\": 12, \"values\": [{\"address\": 1, \"value\": 2}]}]]",
+      "[[{\"deviceId\": 12 \"values\": []}]]",
+      "[[], []]",
+      "[[]",
+      "[]"
+    };
+    for (uint32_t p=0; p<sizeof (invalidParams)/sizeof (invalidParams [0]); ++p)
+    {
+      Switch::Codec::ArenaVector <Switch::Codec::DeviceValues> invalidValues ((Switch::Codec::ArenaAllocator <Switch::Codec::DeviceValues> (arena)));
+      Switch::Codec::Reader invalidReader (invalidParams [p], invalidParams [p] + strlen (invalidParams [p]), arena);
+      SWITCH_ASSERT (!(Switch::Codec::ReadTuple (invalidReader, invalidValues) && invalidReader.IsAtEnd ()));
+    }
+
+    // too deeply nested data is rejected
+    std::string nested (HTTP_CODEC_MAX_NESTING + 2, '[');
+    nested.append (HTTP_CODEC_MAX_NESTING + 2, ']');
+    Switch::Codec::Reader nestedReader (nested.data (), nested.data () + nested.size (), arena);
+    SWITCH_ASSERT (!nestedReader.Skip ());
+  }
+
+  // the arena keeps its blocks for the next request
+  arena.Reset ();
+  void* pMemory = arena.Allocate (8, 8);
+  arena.Reset ();
+  SWITCH_ASSERT (pMemory == arena.Allocate (8, 8));
+}
+
+void Switch::HttpTests::BenchmarkCodec ()
+{
+  const uint32_t nrDevices  = 8;
+  const uint32_t nrValues   = 16;
+  const uint32_t nrCalls    = 20000;
+
+  std::map <Switch::Interface::Device::Id, std::list <Switch::Interface::Device::Value>> deviceValues;
+  for (uint32_t d=0; d<nrDevices; ++d)
+  {
+    std::list <Switch::Interface::Device::Value>& values = deviceValues [d + 1];
+    values.resize (nrValues);
+    uint32_t i = 0;
+    for (std::list <Switch::Interface::Device::Value>::iterator itValue = values.begin (); values.end () != itValue; ++itValue, ++i)
+    {
+      itValue->m_address     = 8 * i;
+      itValue->m_magicNumber = 1234567 + i;
+      itValue->m_value       = 17 * i;
+    }
+  }
+
+  // the parameters of SetMultipleDeviceValues
+  std::ostringstream paramsStream;
+  {
+    Switch::Codec::Writer writer (paramsStream);
+    writer.BeginArray ();
+    writer.NextElement ();
+    Switch::Codec::Write (writer, deviceValues);
+    writer.EndArray ();
+  }
+  const std::string params = paramsStream.str ();
+
+  // decoding: json value and traits, codec into the arena, codec and the copy into the lists of the functional interface
+  std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now ();
+  for (uint32_t n=0; n<nrCalls; ++n)
+  {
+    cppcms::json::value paramsValue;
+    const char* pParams = params.data ();
+    paramsValue.load (pParams, params.data () + params.size (), true);
+    std::map <Switch::Interface::Device::Id, std::list <Switch::Interface::Device::Value>> decoded = paramsValue.array () [0].get_value <std::map <Switch::Interface::Device::Id, std::list <Switch::Interface::Device::Value>>> ();
+  }
+  double traitsNanos = std::chrono::duration_cast <std::chrono::duration <double, std::nano>> (std::chrono::high_resolution_clock::now () - start).count ();
+
+  Switch::Codec::Arena arena;
+  double codecNanos [2];
+  for (uint32_t copy=0; copy<2; ++copy)
+  {
+    start = std::chrono::high_resolution_clock::now ();
+    for (uint32_t n=0; n<nrCalls; ++n)
+    {
+      arena.Reset ();
+      Switch::Codec::ArenaVector <Switch::Codec::DeviceValues> decoded ((Switch::Codec::ArenaAllocator <Switch::Codec::DeviceValues> (arena)));
+      Switch::Codec::Reader reader (params.data (), params.data () + params.size (), arena);
+      SWITCH_ASSERT (Switch::Codec::ReadTuple (reader, decoded));
+      if (0 != copy)
+      {
+        std::map <Switch::Interface::Device::Id, std::list <Switch::Interface::Device::Value>> values;
+        for (Switch::Codec::ArenaVector <Switch::Codec::DeviceValues>::const_iterator itDevice = decoded.begin (); decoded.end () != itDevice; ++itDevice)
+        {
+          values [itDevice->m_deviceId].assign (itDevice->m_values.begin (), itDevice->m_values.end ());
+        }
+      }
+    }
+    codecNanos [copy] = std::chrono::duration_cast <std::chrono::duration <double, std::nano>> (std::chrono::high_resolution_clock::now () - start).count ();
+  }
+
+  std::cout << "SetMultipleDeviceValues " << params.size () << " bytes: traits " << traitsNanos/nrCalls << " ns, codec "
+            << codecNanos [0]/nrCalls << " ns, codec and lists " << codecNanos [1]/nrCalls << " ns" << std::endl;
+
+  // encoding: the result of GetDeviceValues
+  const std::list <Switch::Interface::Device::Value>& values = deviceValues.begin ()->second;
+  size_t traitsSize = 0;
+  start = std::chrono::high_resolution_clock::now ();
+  for (uint32_t n=0; n<nrCalls; ++n)
+  {
+    cppcms::json::value result;
+    result.set ("result", Switch::Interface::CR_OK);
+    result.set ("deviceValues", values);
+    std::ostringstream stream;
+    result.save (stream, cppcms::json::compact);
+    traitsSize = stream.str ().size ();
+  }
+  traitsNanos = std::chrono::duration_cast <std::chrono::duration <double, std::nano>> (std::chrono::high_resolution_clock::now () - start).count ();
+
+  size_t codecSize = 0;
+  start = std::chrono::high_resolution_clock::now ();
+  for (uint32_t n=0; n<nrCalls; ++n)
+  {
+    std::ostringstream stream;
+    {
+      Switch::Codec::Writer writer (stream);
+      writer.BeginObject ();
+      writer.Name ("result");
+      Switch::Codec::Write (writer, Switch::Interface::CR_OK);
+      writer.Name ("deviceValues");
+      Switch::Codec::Write (writer, values);
+      writer.EndObject ();
+    }
+    codecSize = stream.str ().size ();
+  }
+  codecNanos [0] = std::chrono::duration_cast <std::chrono::duration <double, std::nano>> (std::chrono::high_resolution_clock::now () - start).count ();
+
+  std::cout << "GetDeviceValues: traits " << traitsSize << " bytes in " << traitsNanos/nrCalls << " ns, codec "
+            << codecSize << " bytes in " << codecNanos [0]/nrCalls << " ns" << std::endl;
+}
+
+void Switch::HttpTests::TestSubscriptionIndex ()
+{
+  typedef Switch::SubscriptionTopic Topic;
+  Switch::HttpSubscriptionIndex index;
+  std::vector <Switch::HttpSubscriptionIndex::client_id_type> clientIds;
+
+  // device 1 and 2 are dimmers on the first floor, device 3 is a switch
+  std::set <uint32_t> firstFloor;
+  firstFloor.insert (1);
+  firstFloor.insert (2);
+  index.DefineDeviceGroup ("firstFloor", firstFloor);
+  index.SetDeviceProductType (1, "Dimmer");
+  index.SetDeviceProductType (2, "Dimmer");
+  index.SetDeviceProductType (3, "Switch");
+
+  SWITCH_ASSERT (index.Subscribe (10, Topic (Topic::ST_DEVICE, 1, "")));
+  SWITCH_ASSERT (!index.Subscribe (10, Topic (Topic::ST_DEVICE, 1, "")));
+  SWITCH_ASSERT (index.Subscribe (11, Topic (Topic::ST_DEVICE_GROUP, 0, "firstFloor")));
+  SWITCH_ASSERT (index.Subscribe (12, Topic (Topic::ST_PRODUCT_TYPE, 0, "Switch")));
+  SWITCH_ASSERT (index.Subscribe (13, Topic (Topic::ST_ALL_DEVICES, 0, "")));
+  SWITCH_ASSERT (index.Subscribe (13, Topic (Topic::ST_DEVICE, 1, "")));
+  SWITCH_ASSERT (index.HasProductTypeSubscriptions ());
+
+  // a client subscribed several ways is resolved once
+  index.Resolve (clientIds, 1);
+  SWITCH_ASSERT ((3 == clientIds.size ()) && (10 == clientIds [0]) && (11 == clientIds [1]) && (13 == clientIds [2]));
+  index.Resolve (clientIds, 3);
+  SWITCH_ASSERT ((2 == clientIds.size ()) && (12 == clientIds [0]) && (13 == clientIds [1]));
+  index.Resolve (clientIds, 4);
+  SWITCH_ASSERT ((1 == clientIds.size ()) && (13 == clientIds [0]));
+  SWITCH_ASSERT (index.Matches (11, 2) && !index.Matches (11, 3) && !index.Matches (14, 1));
+
+  // moving a device between groups and product types moves its subscribers
+  firstFloor.erase (2);
+  firstFloor.insert (3);
+  index.DefineDeviceGroup ("firstFloor", firstFloor);
+  index.SetDeviceProductType (3, "Dimmer");
+  std::set <Switch::Interface::Device::Id> groupDeviceIds;
+  index.GetDeviceGroup (groupDeviceIds, "firstFloor");
+  SWITCH_ASSERT (firstFloor == groupDeviceIds);
+  index.GetDeviceGroup (groupDeviceIds, "secondFloor");
+  SWITCH_ASSERT (groupDeviceIds.empty ());
+  index.Resolve (clientIds, 2);
+  SWITCH_ASSERT ((1 == clientIds.size ()) && (13 == clientIds [0]));
+  index.Resolve (clientIds, 3);
+  SWITCH_ASSERT ((2 == clientIds.size ()) && (11 == clientIds [0]) && (13 == clientIds [1]));
+
+  // unsubscribed clients release their slot, which is reused
+  SWITCH_ASSERT (!index.Unsubscribe (12, Topic (Topic::ST_DEVICE, 3, "")));
+  SWITCH_ASSERT (index.Unsubscribe (12, Topic (Topic::ST_PRODUCT_TYPE, 0, "Switch")));
+  SWITCH_ASSERT (!index.HasSubscriptions (12) && !index.HasProductTypeSubscriptions ());
+  SWITCH_ASSERT (index.Subscribe (14, Topic (Topic::ST_DEVICE_GROUP, 0, "firstFloor")));
+  index.Resolve (clientIds, 1);
+  SWITCH_ASSERT ((4 == clientIds.size ()) && (14 == clientIds [2]));
+  SWITCH_ASSERT (index.Unsubscribe (13, Topic (Topic::ST_ALL_DEVICES, 0, "")));
+  index.Resolve (clientIds, 4);
+  SWITCH_ASSERT (clientIds.empty ());
+
+  // more clients than bits in a word
+  for (Switch::HttpSubscriptionIndex::client_id_type clientId=100; clientId<300; ++clientId)
+  {
+    SWITCH_ASSERT (index.Subscribe (clientId, Topic (Topic::ST_DEVICE, 4, "")));
+  }
+  index.Resolve (clientIds, 4);
+  SWITCH_ASSERT ((200 == clientIds.size ()) && (299 == clientIds.back ()));
+
+  // removed clients lose all their subscriptions
+  SWITCH_ASSERT (index.Subscribe (299, Topic (Topic::ST_DEVICE_GROUP, 0, "firstFloor")));
+  index.RemoveClient (299);
+  SWITCH_ASSERT (!index.HasSubscriptions (299) && !index.Matches (299, 1) && !index.Matches (299, 4));
+  index.Resolve (clientIds, 4);
+  SWITCH_ASSERT ((199 == clientIds.size ()) && (298 == clientIds.back ()));
+
+  // element filters pass the values of their elements only
+  Switch::ElementFilter elementFilter;
+  SWITCH_ASSERT (!elementFilter.IsActive ());
+  elementFilter.m_group = "Output";
+  SWITCH_ASSERT (elementFilter.IsActive ());
+  elementFilter.m_addresses.insert (8);
+  std::list <Switch::Interface::Device::Value> values (3);
+  uint32_t address = 0;
+  std::list <Switch::Interface::Device::Value>::iterator itValue;
+  for (itValue=values.begin (); values.end ()!=itValue; ++itValue, address+=8)
+  {
+    itValue->m_address = address;
+  }
+  std::list <Switch::Interface::Device::Value> filteredValues;
+  elementFilter.Apply (filteredValues, values);
+  SWITCH_ASSERT ((1 == filteredValues.size ()) && (8 == filteredValues.front ().m_address));
+}
+
+void Switch::HttpTests::TestClientRegistry ()
+{
+  typedef Switch::HttpClientRegistry::clock_type clock_type;
+  Switch::HttpClientRegistry registry;
+  const clock_type::time_point start = clock_type::now ();
+
+  std::string firstToken;
+  std::string secondToken;
+  const Switch::HttpClientRegistry::client_id_type firstClientId  = registry.Register (firstToken, start);
+  const Switch::HttpClientRegistry::client_id_type secondClientId = registry.Register (secondToken, start);
+  SWITCH_ASSERT ((firstClientId != secondClientId) && (Switch::HttpClientRegistry::s_tokenSize == firstToken.size ()));
+
+  // valid tokens identify their client
+  Switch::HttpClientRegistry::client_id_type clientId = 0;
+  SWITCH_ASSERT (registry.Validate (clientId, firstToken, start) && (firstClientId == clientId));
+  SWITCH_ASSERT (registry.Validate (clientId, secondToken, start) && (secondClientId == clientId));
+
+  // tokens with another client id or hash are refused
+  std::string forgedToken = secondToken;
+  forgedToken.replace (0, Switch::HttpClientRegistry::s_tokenSize / 2, firstToken, 0, Switch::HttpClientRegistry::s_tokenSize / 2);
+  SWITCH_ASSERT (!registry.Validate (clientId, forgedToken, start));
+  forgedToken = firstToken;
+  forgedToken [Switch::HttpClientRegistry::s_tokenSize - 1] = ('0' == forgedToken [Switch::HttpClientRegistry::s_tokenSize - 1]) ? '1' : '0';
+  SWITCH_ASSERT (!registry.Validate (clientId, forgedToken, start));
+  SWITCH_ASSERT (!registry.Validate (clientId, "", start) && !registry.Validate (clientId, firstToken + "0", start));
+
+  // idle clients are removed, their tokens refused
+  std::vector <Switch::HttpClientRegistry::client_id_type> idleClientIds;
+  registry.Touch (secondClientId, start + std::chrono::seconds (20));
+  registry.RemoveIdleClients (idleClientIds, start + std::chrono::seconds (10));
+  SWITCH_ASSERT ((1 == idleClientIds.size ()) && (firstClientId == idleClientIds [0]) && (1 == registry.GetNrClients ()));
+  SWITCH_ASSERT (!registry.Validate (clientId, firstToken, start + std::chrono::seconds (20)));
+  SWITCH_ASSERT (registry.Validate (clientId, secondToken, start + std::chrono::seconds (20)));
+}
+
 void Switch::HttpTests::Run ()
 {
 //#ifdef _DEBUG
@@ -169,6 +599,13 @@ void Switch::HttpTests::Run ()
       TestNoInterProcess ();
     }*/
 
+    TestCbor ();
+    BenchmarkCbor ();
+    TestCodec ();
+    BenchmarkCodec ();
+    TestSubscriptionIndex ();
+    TestClientRegistry ();
+
     TestNoInterProcess ();
   }
   catch (const std::exception& i_exception)
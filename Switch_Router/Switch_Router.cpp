@@ -41,6 +41,7 @@
 
 // std includes
 #include <limits>
+#include <map>
 
 
 /*!
@@ -209,11 +210,13 @@ void Switch::Router::CommunicationInfo::SetTxAddress (const switch_pipe_address_
 Switch::Router::EventHandler::EventHandler (const NodeDiscoveredCallback& i_newNodeDiscoveredCallback,
                                             const NodeConnectionUpdateCallback& i_nodeConnectionUpdateCallback,
                                             const NodeDataReceivedCallback& i_nodeDataReceivedCallback,
-                                            const NodeDataTransmittedCallback& i_nodeDataTransmittedCallback)
+                                            const NodeDataTransmittedCallback& i_nodeDataTransmittedCallback,
+                                            const CycleCompletedCallback& i_cycleCompletedCallback)
 : m_newNodeDiscoveredCallback     (i_newNodeDiscoveredCallback),
   m_nodeConnectionUpdateCallback  (i_nodeConnectionUpdateCallback),
   m_nodeDataReceivedCallback      (i_nodeDataReceivedCallback),
-  m_nodeDataTransmittedCallback   (i_nodeDataTransmittedCallback)
+  m_nodeDataTransmittedCallback   (i_nodeDataTransmittedCallback),
+  m_cycleCompletedCallback        (i_cycleCompletedCallback)
 {
 }
 
@@ -294,6 +297,20 @@ void Switch::Router::EventHandler::NodeDataTransmitted (const switch_device_addr
   return m_nodeDataTransmittedCallback (i_deviceAddress, i_result);
 }
 
+/*!
+  \brief Signals that the router completed an update cycle.
+ */
+void Switch::Router::EventHandler::CycleCompleted ()
+{
+  if (!m_cycleCompletedCallback)
+  {
+    // note: optional callback, no need to report
+    return;
+  }
+
+  m_cycleCompletedCallback ();
+}
+
 /*!
   \brief Default constructor.
  */
@@ -514,6 +531,9 @@ void Switch::Router::_Run ()
       // transmit data in the network
       _HandleTransmitData ();
 
+      // signal the end of the cycle so the handler can process its events in one batch
+      m_eventHandler.CycleCompleted ();
+
       // compute the time spent
       std::chrono::high_resolution_clock::time_point endTime = std::chrono::high_resolution_clock::now ();
       uint32_t microsecondsElapsed = std::chrono::duration_cast <std::chrono::microseconds> (endTime - beginTime).count ();
@@ -654,6 +674,62 @@ void Switch::Router::TransmitData (const switch_device_address_type& i_nodeDevic
   m_updateCondition.notify_all ();
 }
 
+/*!
+  \brief Sends data to multiple nodes
+
+  \param[in] i_messages The device addresses of the nodes and the data payloads to send
+ */
+void Switch::Router::TransmitData (const std::list <std::pair <switch_device_address_type, Switch::DataPayload>>& i_messages)
+{
+  SWITCH_DEBUG_MSG_1 ("adding %u tx messages to queue\n", static_cast <uint32_t> (i_messages.size ()));
+
+  // group the messages per child of the root they are routed through
+  // note: messages to unknown or unconnected nodes are grouped together, they are rejected when handled
+  std::map <uint8_t, std::list <std::pair <switch_device_address_type, Switch::DataPayload>>> messagesPerChild;
+  {
+    // lock the network model
+    // NOTE: a read-lock would be sufficient
+    std::unique_lock <std::mutex> modelLock (m_networkModelMutex);
+
+    std::list <std::pair <switch_device_address_type, Switch::DataPayload>>::const_iterator itMessage;
+    for (itMessage = i_messages.begin (); i_messages.end () != itMessage; ++itMessage)
+    {
+      uint8_t childIndex = std::numeric_limits <uint8_t>::max ();
+      const Switch::RouterNodeModel* pNodeModel = m_pNetworkModel->GetNode (itMessage->first);
+      if ((0x0 != pNodeModel) && (pNodeModel->networkAddress != 0x0))
+      {
+        childIndex = pNodeModel->networkAddress.GetChildIndex (0);
+      }
+      messagesPerChild [childIndex].push_back (*itMessage);
+    }
+  }
+
+  // interleave the messages of all children
+  std::list <std::pair <switch_device_address_type, Switch::DataPayload>> interleavedMessages;
+  while (!messagesPerChild.empty ())
+  {
+    std::map <uint8_t, std::list <std::pair <switch_device_address_type, Switch::DataPayload>>>::iterator itChild = messagesPerChild.begin ();
+    while (messagesPerChild.end () != itChild)
+    {
+      interleavedMessages.splice (interleavedMessages.end (), itChild->second, itChild->second.begin ());
+      if (itChild->second.empty ())
+      {
+        messagesPerChild.erase (itChild++);
+      }
+      else
+      {
+        ++itChild;
+      }
+    }
+  }
+
+  std::unique_lock <std::mutex> dataLock (m_dataTransmitDataMutex);
+
+  m_dataTransmitData.splice (m_dataTransmitData.end (), interleavedMessages);
+
+  m_updateCondition.notify_all ();
+}
+
 /*!
   \brief Handles all data in the TransmitData list.
  */
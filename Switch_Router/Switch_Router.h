@@ -103,6 +103,7 @@ namespace Switch
       typedef std::function <void (const switch_device_address_type&, const bool&)>                 NodeConnectionUpdateCallback;
       typedef std::function <bool (const switch_device_address_type&, const Switch::DataPayload&)>  NodeDataReceivedCallback;
       typedef std::function <void (const switch_device_address_type&, const bool&)>                 NodeDataTransmittedCallback;
+      typedef std::function <void ()>                                                               CycleCompletedCallback;
 
       /*!
         \brief Constructor
@@ -110,7 +111,8 @@ namespace Switch
       EventHandler (const NodeDiscoveredCallback& i_newNodeDiscoveredCallback=nullptr,
                     const NodeConnectionUpdateCallback& i_nodeConnectionUpdateCallback=nullptr,
                     const NodeDataReceivedCallback& i_nodeDataReceivedCallback=nullptr,
-                    const NodeDataTransmittedCallback& i_nodeDataTransmittedCallback=nullptr);
+                    const NodeDataTransmittedCallback& i_nodeDataTransmittedCallback=nullptr,
+                    const CycleCompletedCallback& i_cycleCompletedCallback=nullptr);
       /*!
         \brief Destructor
        */
@@ -152,6 +154,13 @@ namespace Switch
         \param [in] i_result Flags if the transmission was successfull (true) or not (false).
        */
       void NodeDataTransmitted (const switch_device_address_type& i_deviceAddress, const bool& i_result);
+      /*!
+        \brief Signals that the router completed an update cycle.
+
+        All events of the cycle have been signalled before. Allows the handler to
+        process the events of one cycle as a batch.
+       */
+      void CycleCompleted ();
 
     private:
 
@@ -160,6 +169,7 @@ namespace Switch
       NodeConnectionUpdateCallback  m_nodeConnectionUpdateCallback;
       NodeDataReceivedCallback      m_nodeDataReceivedCallback;
       NodeDataTransmittedCallback   m_nodeDataTransmittedCallback;
+      CycleCompletedCallback        m_cycleCompletedCallback;
 
     };
 
@@ -248,6 +258,18 @@ namespace Switch
       \note Requires that the node is connected to the root
      */
     void TransmitData (const switch_device_address_type& i_nodeDeviceAddress, const Switch::DataPayload& i_dataPayload);
+    /*!
+      \brief Sends data to multiple nodes
+
+      The messages are interleaved over the children of the root through which
+      they are routed, such that the messages handled in one cycle are spread
+      over the child pipes instead of queueing up behind a single child.
+
+      \param[in] i_messages The device addresses of the nodes and the data payloads to send
+
+      \note Requires that the nodes are connected to the root
+     */
+    void TransmitData (const std::list <std::pair <switch_device_address_type, Switch::DataPayload>>& i_messages);
 
   protected:
 